@@ -26,7 +26,9 @@
 #include <sole.hpp>
 
 #include "src/carnot/carnot.h"
+#include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/exec/parallel_pipeline.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/udf/udf.h"
 #include "src/common/base/base.h"
@@ -41,6 +43,7 @@ namespace carnot {
 namespace exec {
 
 using table_store::Table;
+using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 constexpr char kGroupByNoneQuery[] = R"pxl(
@@ -121,6 +124,93 @@ void BM_Query_Int(benchmark::State& state, std::vector<types::DataType> types,
   BM_Query(state, types, distribution_types, query, num_batches, default_params, default_params);
 }
 
+// Creates a table with a key column (col0) that has exactly num_groups distinct values and an
+// int value column (col1).
+std::shared_ptr<Table> CreateGroupCountTable(types::DataType key_type, int64_t num_groups,
+                                             int64_t rb_size, int64_t num_batches) {
+  std::vector<types::DataType> types = {key_type, types::DataType::INT64};
+  auto table = Table::Create(
+      "test_table", table_store::schema::Relation(types, table_store::DefaultColumnNames(2)));
+  for (int64_t batch_idx = 0; batch_idx < num_batches; ++batch_idx) {
+    RowBatch rb(RowDescriptor(types), rb_size);
+    auto keys = datagen::CreateLargeData<types::Int64Value>(rb_size, 0, num_groups - 1);
+    if (key_type == types::DataType::STRING) {
+      std::vector<types::StringValue> str_keys;
+      str_keys.reserve(keys.size());
+      for (const auto& key : keys) {
+        str_keys.emplace_back(absl::StrCat("/api/v1/service-", key.val));
+      }
+      PL_CHECK_OK(rb.AddColumn(types::ToArrow(str_keys, arrow::default_memory_pool())));
+    } else {
+      PL_CHECK_OK(rb.AddColumn(types::ToArrow(keys, arrow::default_memory_pool())));
+    }
+    auto values = datagen::CreateLargeData<types::Int64Value>(rb_size);
+    PL_CHECK_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    PL_CHECK_OK(table->WriteRowBatch(rb));
+  }
+  return table;
+}
+
+// Compares the columnar and RowTuple group by hash tables. The range is the number of groups.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryGroupCount(benchmark::State& state, types::DataType key_type, bool columnar_hash) {
+  constexpr int64_t kRowBatchSize = 1024;
+  constexpr int64_t kNumBatches = 256;
+  FLAGS_carnot_agg_columnar_hash = columnar_hash;
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto server = LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+  table_store->AddTable("test_table",
+                        CreateGroupCountTable(key_type, state.range(0), kRowBatchSize, kNumBatches));
+
+  int i = 0;
+  for (auto _ : state) {
+    auto query = absl::Substitute(kGroupByOneQuery, "results_" + std::to_string(i));
+    auto res = carnot->ExecuteQuery(query, sole::uuid4(), CurrentTimeNS());
+    if (!res.ok()) {
+      LOG(FATAL) << "Aggregate benchmark query did not execute successfully.";
+    }
+    ++i;
+  }
+
+  state.SetItemsProcessed(state.iterations() * kRowBatchSize * kNumBatches);
+  FLAGS_carnot_agg_columnar_hash = true;
+}
+
+// Runs a group by on a multi-million row table with parallel execution. The range is the number
+// of worker threads.
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryParallelGroupBy(benchmark::State& state, types::DataType key_type,
+                             int64_t num_groups) {
+  constexpr int64_t kRowBatchSize = 1024;
+  constexpr int64_t kNumBatches = 4096;
+  FLAGS_carnot_exec_worker_threads = state.range(0);
+  // The default table size limit would expire most of the table.
+  int32_t table_size_limit = FLAGS_table_store_table_size_limit;
+  FLAGS_table_store_table_size_limit = 1024 * 1024 * 1024;
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  auto server = LocalGRPCResultSinkServer();
+  auto carnot = SetUpCarnot(table_store, &server);
+  table_store->AddTable("test_table",
+                        CreateGroupCountTable(key_type, num_groups, kRowBatchSize, kNumBatches));
+
+  int i = 0;
+  for (auto _ : state) {
+    auto query = absl::Substitute(kGroupByOneQuery, "results_" + std::to_string(i));
+    auto res = carnot->ExecuteQuery(query, sole::uuid4(), CurrentTimeNS());
+    if (!res.ok()) {
+      LOG(FATAL) << "Aggregate benchmark query did not execute successfully.";
+    }
+    ++i;
+  }
+
+  state.SetItemsProcessed(state.iterations() * kRowBatchSize * kNumBatches);
+  FLAGS_carnot_exec_worker_threads = 1;
+  FLAGS_table_store_table_size_limit = table_size_limit;
+}
+
 const std::unique_ptr<const datagen::DistributionParams> sample_selection_params =
     std::make_unique<const datagen::ZipfianParams>(2, 2, 999);
 const std::unique_ptr<const datagen::DistributionParams> sample_length_params =
@@ -189,6 +279,44 @@ BENCHMARK_CAPTURE(BM_Query_Int, eval_group_by_one_exponential_int,
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
 
+// Group count sweeps.
+BENCHMARK_CAPTURE(BM_QueryGroupCount, group_by_int_row_tuple_hash, types::DataType::INT64, false)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 18);
+
+BENCHMARK_CAPTURE(BM_QueryGroupCount, group_by_int_columnar_hash, types::DataType::INT64, true)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 18);
+
+BENCHMARK_CAPTURE(BM_QueryGroupCount, group_by_string_row_tuple_hash, types::DataType::STRING,
+                  false)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 18);
+
+BENCHMARK_CAPTURE(BM_QueryGroupCount, group_by_string_columnar_hash, types::DataType::STRING,
+                  true)
+    ->RangeMultiplier(8)
+    ->Range(1, 1 << 18);
+
+// Worker thread sweeps.
+BENCHMARK_CAPTURE(BM_QueryParallelGroupBy, parallel_group_by_int_few_groups,
+                  types::DataType::INT64, 16)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_QueryParallelGroupBy, parallel_group_by_int_many_groups,
+                  types::DataType::INT64, 1 << 16)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime();
+
+BENCHMARK_CAPTURE(BM_QueryParallelGroupBy, parallel_group_by_string, types::DataType::STRING,
+                  1024)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->UseRealTime();
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
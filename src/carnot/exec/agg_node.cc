@@ -23,9 +23,12 @@
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <utility>
 
 #include <magic_enum.hpp>
 
+#include <absl/strings/substitute.h>
+
 #include "src/carnot/exec/expression_evaluator.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
@@ -35,12 +38,20 @@
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 
+DEFINE_bool(carnot_agg_columnar_hash,
+            gflags::BoolFromEnv("PL_CARNOT_AGG_COLUMNAR_HASH", true),
+            "Use the columnar hash table for group by aggregates. Keys are hashed in batch straight "
+            "from the arrow arrays and UDAs are updated through selection vectors.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
 using SharedArray = std::shared_ptr<arrow::Array>;
 constexpr int64_t kAggCompactionThreshold = 512;
+// Rough size of the state of a single UDA instance (the UDAInfo and the heap allocated UDA), used
+// to account the columnar group state against the query memory budget.
+constexpr int64_t kUDAStateBytesEstimate = 64;
 
 using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
@@ -135,11 +146,17 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
+  use_columnar_hash_ = FLAGS_carnot_agg_columnar_hash;
+  if (use_columnar_hash_) {
+    group_key_table_ = std::make_unique<GroupKeyTable>(group_data_types_);
+  }
+
   return CreateColumnMapping();
 }
 
 Status AggNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
+  memory_reservation_.set_budget(exec_state->memory_budget());
   return Status::OK();
 }
 
@@ -154,6 +171,9 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   if (HasNoGroups()) {
     return AggregateGroupByNone(exec_state, rb);
   }
+  if (use_columnar_hash_) {
+    return AggregateGroupByClauseColumnar(exec_state, rb);
+  }
   return AggregateGroupByClause(exec_state, rb);
 }
 
@@ -162,10 +182,55 @@ Status AggNode::CloseImpl(ExecState*) {
   group_args_chunk_.clear();
   group_args_pool_.Clear();
   udas_pool_.Clear();
+  group_udas_.clear();
+  if (group_key_table_ != nullptr) {
+    group_key_table_->Clear();
+  }
+  spill_.reset();
+  memory_reservation_.Reset();
 
   return Status::OK();
 }
 
+Status AggNode::MergeFrom(ExecState* exec_state, AggNode* partial) {
+  DCHECK(SupportsParallelMerge());
+  DCHECK(partial->SupportsParallelMerge());
+  if (HasNoGroups()) {
+    DCHECK_EQ(udas_no_groups_.size(), partial->udas_no_groups_.size());
+    for (const auto& [idx, uda_info] : Enumerate(udas_no_groups_)) {
+      PL_RETURN_IF_ERROR(uda_info.def->Merge(
+          uda_info.uda.get(), partial->udas_no_groups_[idx].uda.get(), function_ctx_.get()));
+    }
+    return Status::OK();
+  }
+
+  // Look up the keys of the partial groups in this table, then merge the UDAs group by group.
+  int64_t num_partial_groups = partial->group_key_table_->num_groups();
+  std::vector<std::shared_ptr<arrow::Array>> partial_keys;
+  std::vector<const arrow::Array*> key_cols;
+  for (const auto& [group_idx, group_dt] : Enumerate(group_data_types_)) {
+    auto builder = types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(partial->group_key_table_->AppendKeysToBuilder(group_idx, builder.get()));
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    key_cols.push_back(arr.get());
+    partial_keys.push_back(std::move(arr));
+  }
+  group_key_table_->FindOrInsertBatch(key_cols, num_partial_groups, &row_group_ids_);
+  while (static_cast<int64_t>(group_udas_.size()) < group_key_table_->num_groups()) {
+    PL_RETURN_IF_ERROR(CreateUDAInfoValues(&group_udas_.emplace_back(), exec_state));
+  }
+  for (int64_t partial_group_id = 0; partial_group_id < num_partial_groups; ++partial_group_id) {
+    auto& udas = group_udas_[row_group_ids_[partial_group_id]];
+    auto& partial_udas = partial->group_udas_[partial_group_id];
+    for (size_t value_idx = 0; value_idx < udas.size(); ++value_idx) {
+      PL_RETURN_IF_ERROR(udas[value_idx].def->Merge(
+          udas[value_idx].uda.get(), partial_udas[value_idx].uda.get(), function_ctx_.get()));
+    }
+  }
+  return Status::OK();
+}
+
 bool AggNode::ReadyToEmitBatches(const RowBatch& rb) const {
   return rb.eos() || (rb.eow() && plan_node_->windowed());
 }
@@ -176,6 +241,11 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     PL_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
   agg_hash_map_.clear();
+  if (group_key_table_ != nullptr) {
+    group_key_table_->Clear();
+  }
+  group_udas_.clear();
+  memory_reservation_.Reset();
   return Status::OK();
 }
 
@@ -374,6 +444,238 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
   return Status::OK();
 }
 
+Status AggNode::AggregateGroupByClauseColumnar(ExecState* exec_state, const RowBatch& rb) {
+  PL_RETURN_IF_ERROR(AggregateColumnarBatch(exec_state, rb, /* can_spill */ true));
+  if (!ReadyToEmitBatches(rb)) {
+    return Status::OK();
+  }
+  if (spill_ != nullptr) {
+    return EmitSpilledGroups(exec_state, rb.eow(), rb.eos());
+  }
+  return EmitGroups(exec_state, rb.eow(), rb.eos());
+}
+
+Status AggNode::AggregateColumnarBatch(ExecState* exec_state, const RowBatch& rb, bool can_spill) {
+  // The columnar path works as follows:
+  // 1. Hash the key columns of the batch and look up (or create) the group id of every row.
+  // 2. Create the UDA state for any groups that are new in this batch.
+  // 3. Bucket the rows of the batch by group into a selection vector.
+  // 4. Update the UDAs of each group directly from the input arrays using the selection vector.
+  // Blocking aggregates that exceed the query memory budget stop creating groups in memory. From
+  // then on, rows of groups that aren't in memory are hash partitioned to disk by their group key,
+  // and each partition is aggregated separately once the input is done.
+  can_spill = can_spill && !plan_node_->windowed();
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(plan_node_->groups().size());
+  for (const auto& grp : plan_node_->groups()) {
+    DCHECK(grp.idx < input_descriptor_->size());
+    key_cols.push_back(rb.ColumnAt(grp.idx).get());
+  }
+
+  if (can_spill && spill_ != nullptr) {
+    group_key_table_->FindBatch(key_cols, rb.num_rows(), &row_group_ids_);
+    spill_rows_.clear();
+    for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      if (row_group_ids_[row_idx] < 0) {
+        spill_rows_.push_back(row_idx);
+      }
+    }
+    if (!spill_rows_.empty()) {
+      spill_->ComputePartitions(rb, &spill_row_partitions_);
+      PL_RETURN_IF_ERROR(spill_->Write(rb, spill_rows_, spill_row_partitions_));
+    }
+  } else {
+    group_key_table_->FindOrInsertBatch(key_cols, rb.num_rows(), &row_group_ids_);
+    while (static_cast<int64_t>(group_udas_.size()) < group_key_table_->num_groups()) {
+      PL_RETURN_IF_ERROR(CreateUDAInfoValues(&group_udas_.emplace_back(), exec_state));
+    }
+  }
+
+  if (plan_node_->values().size() > 0 && rb.num_rows() > 0) {
+    BuildGroupSelection(rb.num_rows());
+    PL_RETURN_IF_ERROR(UpdateGroupsWithSelection(exec_state, rb));
+  }
+
+  // The batch that pushes the state over the budget is kept in memory, only the batches after it
+  // spill.
+  if (can_spill && spill_ == nullptr && !memory_reservation_.TryResize(EstimateGroupStateBytes())) {
+    VLOG(1) << absl::Substitute(
+        "Aggregate exceeded the query memory budget ($0 bytes) with $1 groups, spilling to $2",
+        exec_state->memory_budget()->budget_bytes(), group_key_table_->num_groups(),
+        exec_state->spill_dir());
+    std::vector<int64_t> key_indices;
+    for (const auto& grp : plan_node_->groups()) {
+      key_indices.push_back(grp.idx);
+    }
+    exec_state->MarkSpilling();
+    spill_ = std::make_unique<PartitionedSpill>(exec_state->spill_dir(), std::move(key_indices),
+                                                group_data_types_);
+  }
+  return Status::OK();
+}
+
+int64_t AggNode::EstimateGroupStateBytes() const {
+  return group_key_table_->NumBytes() +
+         static_cast<int64_t>(group_udas_.capacity() * sizeof(std::vector<UDAInfo>)) +
+         group_key_table_->num_groups() * static_cast<int64_t>(plan_node_->values().size()) *
+             kUDAStateBytesEstimate;
+}
+
+Status AggNode::EmitGroups(ExecState* exec_state, bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, group_key_table_->num_groups());
+  PL_RETURN_IF_ERROR(ConvertGroupKeyTableToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return ClearAggState(exec_state);
+}
+
+Status AggNode::EmitSpilledGroups(ExecState* exec_state, bool eow, bool eos) {
+  // The groups of a partition never overlap with the groups in memory or with the groups of the
+  // other partitions, so each of them can be emitted on its own. Only the last batch carries
+  // eow/eos.
+  auto spill = std::move(spill_);
+  int last_partition = -1;
+  for (int idx = 0; idx < kNumSpillPartitions; ++idx) {
+    if (spill->partition(idx) != nullptr) {
+      last_partition = idx;
+    }
+  }
+  VLOG(1) << absl::Substitute("Aggregating $0 spilled rows", spill->num_rows());
+
+  bool last = last_partition < 0;
+  PL_RETURN_IF_ERROR(EmitGroups(exec_state, last && eow, last && eos));
+  for (int idx = 0; idx <= last_partition; ++idx) {
+    SpillFile* partition = spill->partition(idx);
+    if (partition == nullptr) {
+      continue;
+    }
+    PL_RETURN_IF_ERROR(partition->StartRead());
+    while (true) {
+      PL_ASSIGN_OR_RETURN(auto spilled_rb, partition->ReadNext());
+      if (spilled_rb == nullptr) {
+        break;
+      }
+      PL_RETURN_IF_ERROR(AggregateColumnarBatch(exec_state, *spilled_rb, /* can_spill */ false));
+    }
+    last = idx == last_partition;
+    PL_RETURN_IF_ERROR(EmitGroups(exec_state, last && eow, last && eos));
+  }
+  return Status::OK();
+}
+
+void AggNode::BuildGroupSelection(int64_t num_rows) {
+  // This is a counting sort of the row indices by group, which only touches the groups that are
+  // present in the batch.
+  group_to_batch_idx_.resize(group_key_table_->num_groups(), -1);
+  batch_group_ids_.clear();
+  batch_group_offsets_.clear();
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    int64_t group_id = row_group_ids_[row_idx];
+    // Rows without a group were spilled.
+    if (group_id < 0) {
+      continue;
+    }
+    if (group_to_batch_idx_[group_id] < 0) {
+      group_to_batch_idx_[group_id] = batch_group_ids_.size();
+      batch_group_ids_.push_back(group_id);
+      batch_group_offsets_.push_back(0);
+    }
+    ++batch_group_offsets_[group_to_batch_idx_[group_id]];
+  }
+
+  // Convert the counts into start offsets.
+  int64_t offset = 0;
+  for (auto& group_offset : batch_group_offsets_) {
+    int64_t count = group_offset;
+    group_offset = offset;
+    offset += count;
+  }
+  batch_group_offsets_.push_back(offset);
+
+  selection_.resize(num_rows);
+  // Use the trailing offsets as the write cursors. They are restored afterwards by shifting.
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    if (row_group_ids_[row_idx] < 0) {
+      continue;
+    }
+    int64_t batch_idx = group_to_batch_idx_[row_group_ids_[row_idx]];
+    selection_[batch_group_offsets_[batch_idx]++] = row_idx;
+  }
+  // Each offset now points at the start of the next group, shift them back by one.
+  for (size_t i = batch_group_offsets_.size() - 1; i > 0; --i) {
+    batch_group_offsets_[i] = batch_group_offsets_[i - 1];
+  }
+  batch_group_offsets_[0] = 0;
+
+  // Reset the lookup for the next batch.
+  for (auto group_id : batch_group_ids_) {
+    group_to_batch_idx_[group_id] = -1;
+  }
+}
+
+Status AggNode::UpdateGroupsWithSelection(ExecState* exec_state, const RowBatch& rb) {
+  const auto& values = plan_node_->values();
+  // Agg args can only be columns or constants, so they are resolved once for the whole batch.
+  std::vector<std::vector<const arrow::Array*>> value_args(values.size());
+  std::vector<SharedArray> constant_args;
+  for (const auto& [value_idx, value] : Enumerate(values)) {
+    for (auto* dep : value->Deps()) {
+      switch (dep->ExpressionType()) {
+        case plan::Expression::kColumn:
+          value_args[value_idx].push_back(
+              rb.ColumnAt(static_cast<const plan::Column*>(dep)->Index()).get());
+          break;
+        case plan::Expression::kConstant:
+          constant_args.push_back(EvalScalarToArrow(
+              exec_state, *static_cast<const plan::ScalarValue*>(dep), rb.num_rows()));
+          value_args[value_idx].push_back(constant_args.back().get());
+          break;
+        default:
+          return error::InvalidArgument("Invalid expression type in agg: $0",
+                                        magic_enum::enum_name(dep->ExpressionType()));
+      }
+    }
+  }
+
+  for (size_t batch_idx = 0; batch_idx < batch_group_ids_.size(); ++batch_idx) {
+    auto& udas = group_udas_[batch_group_ids_[batch_idx]];
+    const int64_t* selection = selection_.data() + batch_group_offsets_[batch_idx];
+    size_t count = batch_group_offsets_[batch_idx + 1] - batch_group_offsets_[batch_idx];
+    for (size_t value_idx = 0; value_idx < values.size(); ++value_idx) {
+      const auto& uda_info = udas[value_idx];
+      PL_RETURN_IF_ERROR(uda_info.def->ExecBatchUpdateArrowSelection(
+          uda_info.uda.get(), nullptr /* ctx */, value_args[value_idx], selection, count));
+    }
+  }
+  return Status::OK();
+}
+
+Status AggNode::ConvertGroupKeyTableToRowBatch(ExecState* exec_state, RowBatch* output_rb) {
+  DCHECK(output_rb != nullptr);
+  for (const auto& [group_idx, group_dt] : Enumerate(group_data_types_)) {
+    auto builder = types::MakeArrowBuilder(group_dt, exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(group_key_table_->AppendKeysToBuilder(group_idx, builder.get()));
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
+
+  for (const auto& [value_idx, value_dt] : Enumerate(value_data_types_)) {
+    auto builder = types::MakeArrowBuilder(value_dt, exec_state->exec_mem_pool());
+    PL_RETURN_IF_ERROR(builder->Reserve(group_udas_.size()));
+    for (const auto& udas : group_udas_) {
+      const auto& uda_info = udas[value_idx];
+      PL_RETURN_IF_ERROR(
+          uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    }
+    std::shared_ptr<arrow::Array> arr;
+    PL_RETURN_IF_ERROR(builder->Finish(&arr));
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  }
+  return Status::OK();
+}
+
 StatusOr<types::DataType> AggNode::GetTypeOfDep(const plan::ScalarExpression& expr) const {
   // Agg exprs can only be of type col, or  const.
   switch (expr.ExpressionType()) {
@@ -27,7 +27,10 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/group_key_table.h"
+#include "src/carnot/exec/memory_budget.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
@@ -40,6 +43,8 @@
 #include "src/shared/types/types.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_agg_columnar_hash);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -70,9 +75,28 @@ class AggNode : public ProcessingNode {
   AggNode() = default;
   virtual ~AggNode() = default;
 
+  /**
+   * Whether the state of another instance of this aggregate can be merged into this one with
+   * MergeFrom. This holds for blocking aggregates that either have no groups or use the columnar
+   * group table.
+   */
+  bool SupportsParallelMerge() const {
+    return !plan_node_->windowed() && (HasNoGroups() || use_columnar_hash_);
+  }
+
+  /**
+   * Merges the partial aggregate state of another instance of the same aggregate (created from
+   * the same plan node) into this one, using the merge functions of the UDAs. The partial node
+   * must not have emitted any batches yet. Used to combine the per worker aggregates of a
+   * parallel pipeline.
+   */
+  Status MergeFrom(ExecState* exec_state, AggNode* partial);
+
  protected:
   Status AggregateGroupByNone(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status AggregateGroupByClause(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status AggregateGroupByClauseColumnar(ExecState* exec_state,
+                                        const table_store::schema::RowBatch& rb);
 
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -133,6 +157,33 @@ class AggNode : public ProcessingNode {
   std::vector<GroupArgs> group_args_chunk_;
   // END: Variables specific to GroupBy Agg.
 
+  // Variables specific to the columnar GroupBy Agg (FLAGS_carnot_agg_columnar_hash).
+  // Whether this node uses the columnar path. Captured at Init so that the flag can't change
+  // underneath a running query.
+  bool use_columnar_hash_ = false;
+  std::unique_ptr<GroupKeyTable> group_key_table_;
+  // The UDA state of each group, indexed by the group id assigned by group_key_table_.
+  std::vector<std::vector<UDAInfo>> group_udas_;
+  // Scratch space reused across row batches:
+  // The group id of each row in the batch.
+  std::vector<int64_t> row_group_ids_;
+  // Maps a group id to its position in batch_group_ids_, or -1 if the group isn't in the batch.
+  std::vector<int64_t> group_to_batch_idx_;
+  // The distinct groups in the batch, in order of first appearance.
+  std::vector<int64_t> batch_group_ids_;
+  // The rows of batch group i are selection_[batch_group_offsets_[i], batch_group_offsets_[i+1]).
+  std::vector<int64_t> batch_group_offsets_;
+  std::vector<int64_t> selection_;
+  // The share of the query memory budget held by the group state. Only blocking aggregates are
+  // accounted, since windowed aggregates clear their state at every window.
+  MemoryReservation memory_reservation_;
+  // Set once the group state exceeds the memory budget, holds the rows of the groups that didn't
+  // fit in memory.
+  std::unique_ptr<PartitionedSpill> spill_;
+  std::vector<int64_t> spill_rows_;
+  std::vector<int> spill_row_partitions_;
+  // END: Variables specific to the columnar GroupBy Agg.
+
   // Creates a mapping between plan cols and stored cols (see above comment).
   Status CreateColumnMapping();
 
@@ -149,6 +200,22 @@ class AggNode : public ProcessingNode {
   }
 
   Status CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_state);
+
+  // Aggregates a batch into the group state. If can_spill is set (and the aggregate is blocking),
+  // rows may be spilled to disk instead once the memory budget is exceeded.
+  Status AggregateColumnarBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                                bool can_spill);
+  int64_t EstimateGroupStateBytes() const;
+  Status EmitGroups(ExecState* exec_state, bool eow, bool eos);
+  // Emits the groups in memory, followed by the groups of each of the spilled partitions.
+  Status EmitSpilledGroups(ExecState* exec_state, bool eow, bool eos);
+
+  // Groups the rows of the current batch by their group id, filling in batch_group_ids_,
+  // batch_group_offsets_ and selection_.
+  void BuildGroupSelection(int64_t num_rows);
+  Status UpdateGroupsWithSelection(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status ConvertGroupKeyTableToRowBatch(ExecState* exec_state,
+                                        table_store::schema::RowBatch* output_rb);
 };
 
 }  // namespace exec
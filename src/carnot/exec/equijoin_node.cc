@@ -112,6 +112,24 @@ Status EquijoinNode::InitImpl(const plan::Operator& plan_node) {
     selected_spec.output_col_indices.emplace_back(i);
   }
 
+  if (plan_node_->streaming()) {
+    streaming_ = true;
+    streaming_window_ns_ = plan_node_->streaming_window().window_ns();
+    int64_t left_time_idx = plan_node_->streaming_window().left_time_column_index();
+    int64_t right_time_idx = plan_node_->streaming_window().right_time_column_index();
+    bool probe_is_left = probe_table_ == EquijoinNode::JoinInputTable::kLeftTable;
+    probe_spec_.time_col_index = probe_is_left ? left_time_idx : right_time_idx;
+    build_spec_.time_col_index = probe_is_left ? right_time_idx : left_time_idx;
+    if (input_descriptors_[0].type(left_time_idx) != types::DataType::TIME64NS ||
+        input_descriptors_[1].type(right_time_idx) != types::DataType::TIME64NS) {
+      return error::InvalidArgument("Streaming join time columns must be of type TIME64NS");
+    }
+    build_stream_ = std::make_unique<StreamingJoinBuffer>(
+        build_spec_.key_indices, key_data_types_, build_spec_.time_col_index);
+    probe_stream_ = std::make_unique<StreamingJoinBuffer>(
+        probe_spec_.key_indices, key_data_types_, probe_spec_.time_col_index);
+  }
+
   return Status::OK();
 }
 
@@ -124,7 +142,8 @@ Status EquijoinNode::InitializeColumnBuilders() {
   return Status::OK();
 }
 
-Status EquijoinNode::PrepareImpl(ExecState* /*exec_state*/) {
+Status EquijoinNode::PrepareImpl(ExecState* exec_state) {
+  memory_reservation_.set_budget(exec_state->memory_budget());
   column_builders_.resize(output_descriptor_->size());
   PL_RETURN_IF_ERROR(InitializeColumnBuilders());
 
@@ -138,6 +157,14 @@ Status EquijoinNode::CloseImpl(ExecState* /*exec_state*/) {
   build_buffer_.clear();
   probed_keys_.clear();
   key_values_pool_.Clear();
+  probe_queue_spill_.reset();
+  build_spill_.reset();
+  probe_matched_spill_.reset();
+  probe_unmatched_spill_.reset();
+  build_stream_.reset();
+  probe_stream_.reset();
+  streaming_rows_.clear();
+  memory_reservation_.Reset();
   return Status::OK();
 }
 
@@ -347,6 +374,12 @@ Status EquijoinNode::MatchBuildValuesAndFlush(ExecState* exec_state,
 }
 
 Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb) {
+  return ProbeBatch(exec_state, rb, probe_spec_.emit_unmatched_rows,
+                    /* spill_probe */ build_spill_ != nullptr);
+}
+
+Status EquijoinNode::ProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                                bool emit_unmatched, bool spill_probe) {
   if (rb.eos()) {
     probe_eos_ = true;
   }
@@ -367,6 +400,11 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     }
   }
 
+  probe_row_spilled_.assign(rb.num_rows(), false);
+  if (spill_probe) {
+    PL_RETURN_IF_ERROR(SpillProbeRows(rb));
+  }
+
   auto rb_ptr = std::make_shared<RowBatch>(rb);
 
   for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
@@ -375,7 +413,9 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
     }
 
     if (probe_wrappers_chunk_[row_idx] == nullptr) {
-      if (probe_spec_.emit_unmatched_rows) {
+      // Spilled rows may still match the spilled build rows, so whether they are unmatched is
+      // only known once their partition is joined.
+      if (emit_unmatched && !probe_row_spilled_[row_idx]) {
         OutputChunk c{rb_ptr, nullptr, 1, 0, row_idx};
         chunks_.emplace_back(c);
         queued_rows_ += 1;
@@ -395,6 +435,27 @@ Status EquijoinNode::DoProbe(ExecState* exec_state, const table_store::schema::R
   return Status::OK();
 }
 
+Status EquijoinNode::SpillProbeRows(const table_store::schema::RowBatch& rb) {
+  DCHECK(build_spill_ != nullptr);
+  probe_matched_spill_->ComputePartitions(rb, &probe_row_partitions_);
+  probe_matched_rows_.clear();
+  probe_unmatched_rows_.clear();
+  for (auto row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    if (build_spill_->partition(probe_row_partitions_[row_idx]) == nullptr) {
+      // No build rows were spilled for this partition, so the in memory probe is the full result.
+      continue;
+    }
+    probe_row_spilled_[row_idx] = true;
+    if (probe_wrappers_chunk_[row_idx] != nullptr) {
+      probe_matched_rows_.push_back(row_idx);
+    } else {
+      probe_unmatched_rows_.push_back(row_idx);
+    }
+  }
+  PL_RETURN_IF_ERROR(probe_matched_spill_->Write(rb, probe_matched_rows_, probe_row_partitions_));
+  return probe_unmatched_spill_->Write(rb, probe_unmatched_rows_, probe_row_partitions_);
+}
+
 Status EquijoinNode::EmitUnmatchedBuildRows(ExecState* exec_state) {
   for (auto it = build_buffer_.begin(); it != build_buffer_.end(); ++it) {
     if (probed_keys_.find(it->first) != probed_keys_.end()) {
@@ -416,14 +477,72 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
     build_eos_ = true;
   }
 
-  PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
-  PL_RETURN_IF_ERROR(HashRowBatch(rb));
+  if (build_spill_ != nullptr) {
+    PL_RETURN_IF_ERROR(build_spill_->Write(rb));
+  } else {
+    PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(rb, false));
+    PL_RETURN_IF_ERROR(HashRowBatch(rb));
+    build_bytes_ += rb.NumBytes();
+    // Joins ordered by time can't spill build rows, since the rows of the spilled partitions are
+    // only joined at the end, out of order with the rest of the probe table.
+    if (!memory_reservation_.TryResize(build_bytes_ + queued_probe_bytes_) &&
+        !plan_node_->order_by_time()) {
+      VLOG(1) << absl::Substitute(
+          "Join exceeded the query memory budget ($0 bytes), spilling build rows to $1",
+          exec_state->memory_budget()->budget_bytes(), exec_state->spill_dir());
+      exec_state->MarkSpilling();
+      build_spill_ = std::make_unique<PartitionedSpill>(exec_state->spill_dir(),
+                                                        build_spec_.key_indices, key_data_types_);
+      probe_matched_spill_ = std::make_unique<PartitionedSpill>(
+          exec_state->spill_dir(), probe_spec_.key_indices, key_data_types_);
+      probe_unmatched_spill_ = std::make_unique<PartitionedSpill>(
+          exec_state->spill_dir(), probe_spec_.key_indices, key_data_types_);
+    }
+  }
 
   if (build_eos_) {
-    while (probe_batches_.size()) {
-      PL_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
-      probe_batches_.pop();
+    PL_RETURN_IF_ERROR(ProbeQueuedBatches(exec_state));
+  }
+  return Status::OK();
+}
+
+Status EquijoinNode::QueueProbeBatch(ExecState* exec_state,
+                                     const table_store::schema::RowBatch& rb) {
+  // Once a probe batch is spilled, all the following ones are too so that the order of the probe
+  // batches is preserved.
+  if (probe_queue_spill_ == nullptr) {
+    int64_t bytes = rb.NumBytes();
+    if (memory_reservation_.TryResize(build_bytes_ + queued_probe_bytes_ + bytes)) {
+      queued_probe_bytes_ += bytes;
+      probe_batches_.push(rb);
+      return Status::OK();
+    }
+    exec_state->MarkSpilling();
+    PL_ASSIGN_OR_RETURN(probe_queue_spill_, SpillFile::Create(exec_state->spill_dir()));
+  }
+  return probe_queue_spill_->Write(rb);
+}
+
+Status EquijoinNode::ProbeQueuedBatches(ExecState* exec_state) {
+  while (probe_batches_.size()) {
+    PL_RETURN_IF_ERROR(DoProbe(exec_state, probe_batches_.front()));
+    probe_batches_.pop();
+  }
+  queued_probe_bytes_ = 0;
+  // Give back what was reserved for the queued probe batches. Shrinking always succeeds.
+  memory_reservation_.TryResize(std::min(memory_reservation_.reserved_bytes(), build_bytes_));
+
+  if (probe_queue_spill_ == nullptr) {
+    return Status::OK();
+  }
+  auto probe_queue_spill = std::move(probe_queue_spill_);
+  PL_RETURN_IF_ERROR(probe_queue_spill->StartRead());
+  while (true) {
+    PL_ASSIGN_OR_RETURN(auto probe_rb, probe_queue_spill->ReadNext());
+    if (probe_rb == nullptr) {
+      break;
     }
+    PL_RETURN_IF_ERROR(DoProbe(exec_state, *probe_rb));
   }
   return Status::OK();
 }
@@ -431,14 +550,242 @@ Status EquijoinNode::ConsumeBuildBatch(ExecState* exec_state,
 Status EquijoinNode::ConsumeProbeBatch(ExecState* exec_state,
                                        const table_store::schema::RowBatch& rb) {
   if (!build_eos_) {
-    probe_batches_.push(rb);
-    return Status::OK();
+    return QueueProbeBatch(exec_state, rb);
   }
   return DoProbe(exec_state, rb);
 }
 
+void EquijoinNode::ClearBuildState() {
+  // The queued chunks reference the build wrappers, so they must be flushed before the build
+  // state is dropped.
+  DCHECK_EQ(queued_rows_, 0);
+  build_buffer_.clear();
+  build_buffer_rows_.clear();
+  probed_keys_.clear();
+  join_keys_chunk_.clear();
+  build_wrappers_chunk_.clear();
+  probe_wrappers_chunk_.clear();
+  key_values_pool_.Clear();
+  column_values_pool_.Clear();
+  build_bytes_ = 0;
+  memory_reservation_.Reset();
+}
+
+Status EquijoinNode::ProbeSpillFile(ExecState* exec_state, SpillFile* spill_file,
+                                    bool emit_unmatched) {
+  PL_RETURN_IF_ERROR(spill_file->StartRead());
+  while (true) {
+    PL_ASSIGN_OR_RETURN(auto probe_rb, spill_file->ReadNext());
+    if (probe_rb == nullptr) {
+      return Status::OK();
+    }
+    PL_RETURN_IF_ERROR(ProbeBatch(exec_state, *probe_rb, emit_unmatched, /* spill_probe */ false));
+  }
+}
+
+Status EquijoinNode::JoinSpilledPartitions(ExecState* exec_state) {
+  // This is a grace hash join of the spilled build rows: each partition's build rows are loaded
+  // into a fresh build buffer and probed with the probe rows of the same partition. A partition
+  // is assumed to fit in memory, it isn't partitioned any further.
+  auto build_spill = std::move(build_spill_);
+  auto probe_matched_spill = std::move(probe_matched_spill_);
+  auto probe_unmatched_spill = std::move(probe_unmatched_spill_);
+  VLOG(1) << absl::Substitute("Joining $0 spilled build rows with $1 spilled probe rows",
+                              build_spill->num_rows(),
+                              probe_matched_spill->num_rows() + probe_unmatched_spill->num_rows());
+
+  for (int idx = 0; idx < kNumSpillPartitions; ++idx) {
+    SpillFile* build_partition = build_spill->partition(idx);
+    if (build_partition == nullptr) {
+      continue;
+    }
+    ClearBuildState();
+    PL_RETURN_IF_ERROR(build_partition->StartRead());
+    while (true) {
+      PL_ASSIGN_OR_RETURN(auto build_rb, build_partition->ReadNext());
+      if (build_rb == nullptr) {
+        break;
+      }
+      PL_RETURN_IF_ERROR(ExtractJoinKeysForBatch(*build_rb, false));
+      PL_RETURN_IF_ERROR(HashRowBatch(*build_rb));
+    }
+
+    // Probe rows that already matched in memory must not be emitted as unmatched.
+    if (probe_matched_spill->partition(idx) != nullptr) {
+      PL_RETURN_IF_ERROR(ProbeSpillFile(exec_state, probe_matched_spill->partition(idx),
+                                        /* emit_unmatched */ false));
+    }
+    if (probe_unmatched_spill->partition(idx) != nullptr) {
+      PL_RETURN_IF_ERROR(ProbeSpillFile(exec_state, probe_unmatched_spill->partition(idx),
+                                        probe_spec_.emit_unmatched_rows));
+    }
+    if (build_spec_.emit_unmatched_rows) {
+      PL_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
+    }
+  }
+  ClearBuildState();
+  return Status::OK();
+}
+
+void EquijoinNode::AddStreamingRow(std::shared_ptr<RowBatch> build_rb, int64_t build_row_idx,
+                                   std::shared_ptr<RowBatch> probe_rb, int64_t probe_row_idx) {
+  streaming_rows_.push_back(
+      StreamingRow{std::move(build_rb), build_row_idx, std::move(probe_rb), probe_row_idx});
+}
+
+Status EquijoinNode::ConsumeStreamingBatch(ExecState* exec_state,
+                                           const table_store::schema::RowBatch& rb,
+                                           size_t parent_index) {
+  bool is_probe = IsProbeTable(parent_index);
+  if (is_probe) {
+    DCHECK(!probe_eos_);
+    probe_eos_ = rb.eos();
+  } else {
+    DCHECK(!build_eos_);
+    build_eos_ = rb.eos();
+  }
+
+  if (rb.num_rows() > 0) {
+    const TableSpec& spec = is_probe ? probe_spec_ : build_spec_;
+    StreamingJoinBuffer* input_buffer = is_probe ? probe_stream_.get() : build_stream_.get();
+    StreamingJoinBuffer* other_buffer = is_probe ? build_stream_.get() : probe_stream_.get();
+
+    auto rb_ptr = std::make_shared<RowBatch>(rb);
+    input_buffer->HashKeys(rb, &streaming_hashes_);
+    std::vector<bool> matched(rb.num_rows(), false);
+    const arrow::Array* time_col = rb.ColumnAt(spec.time_col_index).get();
+    for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      int64_t time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col, row_idx);
+      other_buffer->ForEachMatch(
+          rb, spec.key_indices, row_idx, streaming_hashes_[row_idx], time, streaming_window_ns_,
+          [&](const std::shared_ptr<RowBatch>& other_rb, int64_t other_row_idx) {
+            matched[row_idx] = true;
+            if (is_probe) {
+              AddStreamingRow(other_rb, other_row_idx, rb_ptr, row_idx);
+            } else {
+              AddStreamingRow(rb_ptr, row_idx, other_rb, other_row_idx);
+            }
+          });
+    }
+    input_buffer->Add(std::move(rb_ptr), streaming_hashes_, std::move(matched));
+  }
+
+  EvictStreamingState();
+  return FlushStreamingRows(exec_state, build_eos_ && probe_eos_);
+}
+
+void EquijoinNode::EvictStreamingState() {
+  auto emit_unmatched_build = [this](const std::shared_ptr<RowBatch>& rb, int64_t row_idx) {
+    if (build_spec_.emit_unmatched_rows) {
+      AddStreamingRow(rb, row_idx, nullptr, 0);
+    }
+  };
+  auto emit_unmatched_probe = [this](const std::shared_ptr<RowBatch>& rb, int64_t row_idx) {
+    if (probe_spec_.emit_unmatched_rows) {
+      AddStreamingRow(nullptr, 0, rb, row_idx);
+    }
+  };
+
+  // Buffered rows only match rows that arrive on the other input later on, which are assumed to
+  // be (roughly) in time order. Once the other input's time_ is more than the window past a row,
+  // or the other input is done, the row can't match anymore.
+  if (probe_eos_) {
+    while (!build_stream_->empty()) {
+      build_stream_->EvictFront(emit_unmatched_build);
+    }
+  } else {
+    build_stream_->EvictOlderThan(
+        StreamingJoinBuffer::CutoffTime(probe_stream_->max_time(), streaming_window_ns_),
+        emit_unmatched_build);
+  }
+  if (build_eos_) {
+    while (!probe_stream_->empty()) {
+      probe_stream_->EvictFront(emit_unmatched_probe);
+    }
+  } else {
+    probe_stream_->EvictOlderThan(
+        StreamingJoinBuffer::CutoffTime(build_stream_->max_time(), streaming_window_ns_),
+        emit_unmatched_probe);
+  }
+
+  // Past the memory budget, drop the oldest buffered rows before the window passes them. Rows
+  // that arrive later on may miss matches with them.
+  int64_t num_evicted = 0;
+  while (!memory_reservation_.TryResize(build_stream_->bytes() + probe_stream_->bytes())) {
+    bool evict_build = !build_stream_->empty() &&
+                       (probe_stream_->empty() ||
+                        build_stream_->front_time() <= probe_stream_->front_time());
+    if (evict_build) {
+      num_evicted += build_stream_->EvictFront(emit_unmatched_build);
+    } else {
+      num_evicted += probe_stream_->EvictFront(emit_unmatched_probe);
+    }
+  }
+  if (num_evicted > 0) {
+    streaming_rows_evicted_early_ += num_evicted;
+    VLOG(1) << absl::Substitute(
+        "Streaming join exceeded the query memory budget, evicted $0 rows early ($1 in total)",
+        num_evicted, streaming_rows_evicted_early_);
+  }
+}
+
+template <types::DataType DT>
+Status EquijoinNode::AppendStreamingColumn(arrow::ArrayBuilder* builder, bool probe_side,
+                                           int64_t input_col_idx, size_t start, size_t end) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  for (size_t idx = start; idx < end; ++idx) {
+    const StreamingRow& row = streaming_rows_[idx];
+    const auto& rb = probe_side ? row.probe_rb : row.build_rb;
+    if (rb == nullptr) {
+      PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(builder, udf::UnWrap(ValueType())));
+      continue;
+    }
+    int64_t row_idx = probe_side ? row.probe_row_idx : row.build_row_idx;
+    PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+        builder, types::GetValueFromArrowArray<DT>(rb->ColumnAt(input_col_idx).get(), row_idx)));
+  }
+  return Status::OK();
+}
+
+Status EquijoinNode::FlushStreamingRows(ExecState* exec_state, bool eos) {
+  size_t num_rows = streaming_rows_.size();
+  for (size_t start = 0; start < num_rows; start += output_rows_per_batch_) {
+    size_t end = std::min(num_rows, start + output_rows_per_batch_);
+    for (const TableSpec* spec : {&build_spec_, &probe_spec_}) {
+      bool probe_side = spec == &probe_spec_;
+      for (size_t col = 0; col < spec->output_col_indices.size(); ++col) {
+        auto output_idx = spec->output_col_indices[col];
+        auto builder = column_builders_[output_idx].get();
+#define TYPE_CASE(_dt_)                                                                 \
+  PL_RETURN_IF_ERROR(AppendStreamingColumn<_dt_>(builder, probe_side,                   \
+                                                 spec->input_col_indices[col], start, end))
+        PL_SWITCH_FOREACH_DATATYPE(output_descriptor_->type(output_idx), TYPE_CASE);
+#undef TYPE_CASE
+      }
+    }
+    bool last_batch = eos && end == num_rows;
+    PL_ASSIGN_OR_RETURN(auto output_rb,
+                        RowBatch::FromColumnBuilders(*output_descriptor_, last_batch, last_batch,
+                                                     &column_builders_));
+    PL_RETURN_IF_ERROR(InitializeColumnBuilders());
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_rb));
+  }
+  streaming_rows_.clear();
+
+  if (eos && num_rows == 0) {
+    PL_ASSIGN_OR_RETURN(auto output_rb, RowBatch::WithZeroRows(*output_descriptor_, /* eow */ true,
+                                                               /* eos */ true));
+    PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, *output_rb));
+  }
+  return Status::OK();
+}
+
 Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                                      size_t parent_index) {
+  if (streaming_) {
+    return ConsumeStreamingBatch(exec_state, rb, parent_index);
+  }
+
   if (IsProbeTable(parent_index)) {
     DCHECK(!probe_eos_);
     PL_RETURN_IF_ERROR(ConsumeProbeBatch(exec_state, rb));
@@ -451,6 +798,9 @@ Status EquijoinNode::ConsumeNextImpl(ExecState* exec_state, const table_store::s
     if (build_spec_.emit_unmatched_rows) {
       PL_RETURN_IF_ERROR(EmitUnmatchedBuildRows(exec_state));
     }
+    if (build_spill_ != nullptr) {
+      PL_RETURN_IF_ERROR(JoinSpilledPartitions(exec_state));
+    }
 
     if (column_builders_[0]->length()) {
       PL_RETURN_IF_ERROR(NextOutputBatch(exec_state));
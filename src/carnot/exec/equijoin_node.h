@@ -30,7 +30,10 @@
 
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/memory_budget.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill_file.h"
+#include "src/carnot/exec/streaming_join_buffer.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/base/status.h"
@@ -58,6 +61,8 @@ class EquijoinNode : public ProcessingNode {
     // For each of the values in input_col_indices, the index in the output row batch
     // that column should be written to.
     std::vector<int64_t> output_col_indices;
+    // Index of the input's time_ column, only used by streaming joins.
+    int64_t time_col_index = -1;
   };
 
  public:
@@ -81,6 +86,18 @@ class EquijoinNode : public ProcessingNode {
   Status HashRowBatch(const table_store::schema::RowBatch& rb);
 
   Status DoProbe(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  // Probes the build buffer with the batch. Unmatched probe rows are only emitted if
+  // emit_unmatched is set. If spill_probe is set, rows of partitions whose build rows were spilled
+  // are also written to the probe spills, to be joined against those build rows later on.
+  Status ProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                    bool emit_unmatched, bool spill_probe);
+  Status SpillProbeRows(const table_store::schema::RowBatch& rb);
+  Status QueueProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
+  Status ProbeQueuedBatches(ExecState* exec_state);
+  // Joins each of the spilled build partitions with its spilled probe rows.
+  Status JoinSpilledPartitions(ExecState* exec_state);
+  Status ProbeSpillFile(ExecState* exec_state, SpillFile* spill_file, bool emit_unmatched);
+  void ClearBuildState();
   Status MatchBuildValuesAndFlush(ExecState* exec_state,
                                   std::vector<types::SharedColumnWrapper>* wrapper,
                                   std::shared_ptr<table_store::schema::RowBatch> probe_rb,
@@ -90,6 +107,22 @@ class EquijoinNode : public ProcessingNode {
   Status ConsumeBuildBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
   Status ConsumeProbeBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb);
 
+  // Streaming join. Each row batch is joined against the buffered rows of the other input, then
+  // buffered itself. The joined rows are emitted at the end of every row batch.
+  Status ConsumeStreamingBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                               size_t parent_index);
+  void AddStreamingRow(std::shared_ptr<table_store::schema::RowBatch> build_rb,
+                       int64_t build_row_idx,
+                       std::shared_ptr<table_store::schema::RowBatch> probe_rb,
+                       int64_t probe_row_idx);
+  // Evicts the buffered rows that can no longer match, and the oldest rows if the buffers don't
+  // fit in the memory budget.
+  void EvictStreamingState();
+  Status FlushStreamingRows(ExecState* exec_state, bool eos);
+  template <types::DataType DT>
+  Status AppendStreamingColumn(arrow::ArrayBuilder* builder, bool probe_side, int64_t input_col_idx,
+                               size_t start, size_t end);
+
   bool build_eos_ = false;
   bool probe_eos_ = false;
   // Note whether the left or the right table is the probe table.
@@ -155,6 +188,44 @@ class EquijoinNode : public ProcessingNode {
   std::unique_ptr<table_store::schema::RowBatch> pending_output_batch_;
 
   std::unique_ptr<plan::JoinOperator> plan_node_;
+
+  // Spilling state, used once the build buffer and the queued probe batches exceed the query
+  // memory budget.
+  MemoryReservation memory_reservation_;
+  int64_t build_bytes_ = 0;
+  int64_t queued_probe_bytes_ = 0;
+  // Probe batches that arrive before the build is done and don't fit in memory. They are always
+  // probed after the batches in probe_batches_.
+  std::unique_ptr<SpillFile> probe_queue_spill_;
+  // Build rows that arrive after the budget is exceeded, partitioned by key.
+  std::unique_ptr<PartitionedSpill> build_spill_;
+  // Probe rows that belong to spilled build partitions, split by whether they already matched
+  // build rows in memory (in which case they must not be emitted as unmatched later on).
+  std::unique_ptr<PartitionedSpill> probe_matched_spill_;
+  std::unique_ptr<PartitionedSpill> probe_unmatched_spill_;
+  // Scratch space for spilling probe rows.
+  std::vector<int> probe_row_partitions_;
+  std::vector<int64_t> probe_matched_rows_;
+  std::vector<int64_t> probe_unmatched_rows_;
+  std::vector<bool> probe_row_spilled_;
+
+  // Streaming join state, only used if the plan has a streaming window.
+  bool streaming_ = false;
+  int64_t streaming_window_ns_ = 0;
+  std::unique_ptr<StreamingJoinBuffer> build_stream_;
+  std::unique_ptr<StreamingJoinBuffer> probe_stream_;
+  // A joined row. For outer joins, the side that didn't match is null.
+  struct StreamingRow {
+    std::shared_ptr<table_store::schema::RowBatch> build_rb;
+    int64_t build_row_idx;
+    std::shared_ptr<table_store::schema::RowBatch> probe_rb;
+    int64_t probe_row_idx;
+  };
+  // The joined rows that haven't been written to an output row batch yet.
+  std::vector<StreamingRow> streaming_rows_;
+  std::vector<uint64_t> streaming_hashes_;
+  // Number of buffered rows dropped before the window passed them, to stay in the memory budget.
+  int64_t streaming_rows_evicted_early_ = 0;
 };
 
 }  // namespace exec
@@ -685,6 +685,180 @@ TEST_F(JoinNodeTest, unordered_many_matches) {
       .Close();
 }
 
+TEST_F(JoinNodeTest, unordered_full_outer_join_spill) {
+  // All batches from build first, with a memory budget that the first build batch exceeds.
+  // Left table input: [left_0:Int64, left_1:Int64]
+  // Right table input: [right_0:Int64, right_1:Int64]
+  // Output table: [left_0:Int64, left_1:Int64, right_1:Int64]
+  // Full outer join on left_0=right_0
+  const char* proto = R"(
+  type: FULL_OUTER
+  equality_conditions {
+    left_column_index: 0
+    right_column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 1
+  }
+  column_names: "left_0"
+  column_names: "left_1"
+  column_names: "right_1"
+  rows_per_batch: 100
+)";
+  FLAGS_carnot_spill_dir = ::testing::TempDir();
+  exec_state_->memory_budget()->set_budget_bytes(1);
+  // The spilled build rows all land in a single partition.
+  int64_t spilled_key = NextKeyInSpillPartition(1, 2);
+
+  RowDescriptor input_rd_0({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor input_rd_1({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd_0, input_rd_1}, exec_state_.get());
+
+  tester
+      // Build table, the second batch is spilled.
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2})
+                       .AddColumn<types::Int64Value>({10, 20})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd_0, 2, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, spilled_key})
+                       .AddColumn<types::Int64Value>({11, 30})
+                       .get(),
+                   0, 0)
+      // Probe table. Key 1 matches build rows both in memory and on disk, spilled_key only on disk.
+      .ConsumeNext(RowBatchBuilder(input_rd_1, 3, true, true)
+                       .AddColumn<types::Int64Value>({1, spilled_key, -1})
+                       .AddColumn<types::Int64Value>({100, 300, -100})
+                       .get(),
+                   1, 4)
+      .ExpectRowBatchesData(RowBatchBuilder(output_rd, 5, true, true)
+                                .AddColumn<types::Int64Value>({1, 0, 2, 1, spilled_key})
+                                .AddColumn<types::Int64Value>({10, 0, 20, 11, 30})
+                                .AddColumn<types::Int64Value>({100, -100, 0, 100, 300})
+                                .get(),
+                            4)
+      .Close();
+  EXPECT_EQ(0, exec_state_->memory_budget()->used_bytes());
+}
+
+TEST_F(JoinNodeTest, streaming_left_join) {
+  // Both inputs are streams, batches interleaved.
+  // Left table input: [time_:Time64NS, left_key:Int64, left_val:Int64]
+  // Right table input: [time_:Time64NS, right_key:Int64, right_val:Int64]
+  // Output table: [left_time:Time64NS, left_key:Int64, left_val:Int64, right_val:Int64]
+  // Left join on left_key=right_key, for rows at most 10ns apart.
+  const char* proto = R"(
+  type: LEFT_OUTER
+  equality_conditions {
+    left_column_index: 1
+    right_column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 0
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 1
+  }
+  output_columns: {
+    parent_index: 0
+    column_index: 2
+  }
+  output_columns: {
+    parent_index: 1
+    column_index: 2
+  }
+  column_names: "left_time"
+  column_names: "left_key"
+  column_names: "left_val"
+  column_names: "right_val"
+  rows_per_batch: 100
+  streaming_window {
+    window_ns: 10
+    left_time_column_index: 0
+    right_time_column_index: 0
+  }
+)";
+  RowDescriptor input_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                          types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::TIME64NS, types::DataType::INT64,
+                           types::DataType::INT64, types::DataType::INT64});
+
+  auto plan_node = PlanNodeFromPbtxt(proto);
+  auto tester = exec::ExecNodeTester<EquijoinNode, plan::JoinOperator>(
+      *plan_node, output_rd, {input_rd, input_rd}, exec_state_.get());
+
+  tester
+      // Nothing to join with yet, the rows are buffered.
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({100, 105, 110})
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({10, 20, 30})
+                       .get(),
+                   0, 0)
+      // Matches are emitted as soon as they are found.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({102, 108})
+                       .AddColumn<types::Int64Value>({1, 3})
+                       .AddColumn<types::Int64Value>({100, 300})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({100, 110})
+                          .AddColumn<types::Int64Value>({1, 3})
+                          .AddColumn<types::Int64Value>({10, 30})
+                          .AddColumn<types::Int64Value>({100, 300})
+                          .get())
+      // Key 1 is buffered on the right, but more than 10ns earlier. The right rows are evicted.
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Time64NSValue>({130})
+                       .AddColumn<types::Int64Value>({1})
+                       .AddColumn<types::Int64Value>({40})
+                       .get(),
+                   0, 0)
+      // Once the right table is done, the unmatched left rows are emitted.
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({135})
+                       .AddColumn<types::Int64Value>({2})
+                       .AddColumn<types::Int64Value>({200})
+                       .get(),
+                   1, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, false, false)
+                          .AddColumn<types::Time64NSValue>({105, 130})
+                          .AddColumn<types::Int64Value>({2, 1})
+                          .AddColumn<types::Int64Value>({20, 40})
+                          .AddColumn<types::Int64Value>({0, 0})
+                          .get())
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Time64NSValue>({140})
+                       .AddColumn<types::Int64Value>({2})
+                       .AddColumn<types::Int64Value>({50})
+                       .get(),
+                   0, 1)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Time64NSValue>({140})
+                          .AddColumn<types::Int64Value>({2})
+                          .AddColumn<types::Int64Value>({50})
+                          .AddColumn<types::Int64Value>({200})
+                          .get())
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 #include <unordered_map>
+#include <utility>
 
 #include "src/carnot/exec/agg_node.h"
 #include "src/carnot/exec/empty_source_node.h"
@@ -35,6 +36,7 @@
 #include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/memory_sink_node.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/parallel_pipeline.h"
 #include "src/carnot/exec/udtf_source_node.h"
 #include "src/carnot/exec/union_node.h"
 #include "src/carnot/plan/operators.h"
@@ -171,7 +173,56 @@ Status ExecutionGraph::CheckDownstreamGRPCConnectionsHealth() {
   return Status::OK();
 }
 
+std::unique_ptr<ParallelPipeline> ExecutionGraph::FindParallelPipeline() {
+  // Spilling isn't supported across the workers, so queries with a memory budget run serially.
+  if (FLAGS_carnot_exec_worker_threads <= 1 || pf_ == nullptr || sources_.size() != 1 ||
+      !exec_state_->memory_budget()->unlimited()) {
+    return nullptr;
+  }
+  int64_t source_id = sources_[0];
+  if (op_types_[source_id] != planpb::MEMORY_SOURCE_OPERATOR) {
+    return nullptr;
+  }
+  auto* source = static_cast<MemorySourceNode*>(nodes_.at(source_id));
+  if (source->infinite_stream()) {
+    return nullptr;
+  }
+
+  // Walk down the chain of single child nodes until the aggregate.
+  std::vector<ParallelPipeline::NodeFactory> node_factories;
+  int64_t id = source_id;
+  while (true) {
+    auto children = pf_->dag().DependenciesOf(id);
+    if (children.size() != 1 || pf_->dag().ParentsOf(children[0]).size() != 1) {
+      return nullptr;
+    }
+    id = children[0];
+    auto factory = node_factories_.find(id);
+    if (factory == node_factories_.end()) {
+      return nullptr;
+    }
+    node_factories.push_back(factory->second);
+    if (op_types_[id] == planpb::AGGREGATE_OPERATOR) {
+      break;
+    }
+  }
+
+  auto* agg = static_cast<AggNode*>(nodes_.at(id));
+  if (!agg->SupportsParallelMerge()) {
+    return nullptr;
+  }
+  return std::make_unique<ParallelPipeline>(source, std::move(node_factories), agg,
+                                            FLAGS_carnot_exec_worker_threads);
+}
+
 Status ExecutionGraph::ExecuteSources() {
+  // A parallel pipeline consumes all the batches of its source. The source then only has the end
+  // of stream left, which is sent by the loop below.
+  auto parallel_pipeline = FindParallelPipeline();
+  if (parallel_pipeline != nullptr) {
+    PL_RETURN_IF_ERROR(parallel_pipeline->Execute(exec_state_));
+  }
+
   absl::flat_hash_set<SourceNode*> running_sources;
 
   absl::flat_hash_map<SourceNode*, int64_t> source_to_id;
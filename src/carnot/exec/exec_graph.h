@@ -22,6 +22,7 @@
 #include <algorithm>
 #include <condition_variable>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -32,6 +33,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/exec/parallel_pipeline.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/common/base/base.h"
@@ -195,6 +197,17 @@ class ExecutionGraph {
     auto s = execNode->Init(node, output_descriptor, input_descriptors, collect_exec_node_stats_);
 
     AddNode(node.id(), execNode);
+    op_types_[node.id()] = node.op_type();
+    // Nodes that can run in a parallel pipeline need to be instantiated once per worker.
+    if (ParallelPipeline::IsPipelineOperator(node.op_type())) {
+      node_factories_[node.id()] = [this, node, output_descriptor,
+                                    input_descriptors]() -> StatusOr<ExecNode*> {
+        auto worker_node = pool_.Add(new TNode());
+        PL_RETURN_IF_ERROR(worker_node->Init(node, output_descriptor, input_descriptors,
+                                             collect_exec_node_stats_));
+        return worker_node;
+      };
+    }
 
     // Update parents' children.
     for (size_t i = 0; i < parents.size(); ++i) {
@@ -210,16 +223,25 @@ class ExecutionGraph {
 
   Status ExecuteSources();
 
+  /**
+   * Checks whether the plan fragment is a single MemorySource -> (Map | Filter)* -> Agg pipeline
+   * that can run on multiple workers (see ParallelPipeline).
+   * @return The pipeline, or nullptr if the fragment can't be run in parallel.
+   */
+  std::unique_ptr<ParallelPipeline> FindParallelPipeline();
+
   ExecState* exec_state_;
   ObjectPool pool_{"exec_graph_pool"};
   table_store::schema::Schema* schema_;
   plan::PlanState* plan_state_;
-  plan::PlanFragment* pf_;
+  plan::PlanFragment* pf_ = nullptr;
   std::vector<int64_t> sources_;
   std::vector<int64_t> sinks_;
   absl::flat_hash_set<int64_t> grpc_sources_;
   absl::flat_hash_set<int64_t> grpc_sinks_;
   std::unordered_map<int64_t, ExecNode*> nodes_;
+  std::unordered_map<int64_t, planpb::OperatorType> op_types_;
+  std::unordered_map<int64_t, ParallelPipeline::NodeFactory> node_factories_;
 
   SystemTimePoint query_start_time_;
 
@@ -20,6 +20,7 @@
 
 #include <arrow/array.h>
 #include <arrow/memory_pool.h>
+#include <map>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -30,6 +31,7 @@
 #include <sole.hpp>
 
 #include "src/carnot/exec/grpc_source_node.h"
+#include "src/carnot/exec/parallel_pipeline.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/plan/plan_fragment.h"
 #include "src/carnot/plan/plan_state.h"
@@ -290,6 +292,170 @@ TEST_F(ExecGraphTest, execute_time) {
           ->Equals(types::ToArrow(out_in2, arrow::default_memory_pool())));
 }
 
+class SumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg) { sum_ = sum_.val + arg.val; }
+  void Merge(udf::FunctionContext*, const SumUDA& other) { sum_ = sum_.val + other.sum_.val; }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+constexpr char kSourceAggSinkPlanFragment[] = R"(
+  id: 1,
+  dag {
+    nodes {
+      id: 1
+      sorted_children: 2
+    }
+    nodes {
+      id: 2
+      sorted_children: 3
+      sorted_parents: 1
+    }
+    nodes {
+      id: 3
+      sorted_parents: 2
+    }
+  }
+  nodes {
+    id: 1
+    op {
+      op_type: MEMORY_SOURCE_OPERATOR
+      mem_source_op {
+        name: "numbers"
+        column_idxs: 0
+        column_types: INT64
+        column_names: "group"
+        column_idxs: 1
+        column_types: INT64
+        column_names: "value"
+      }
+    }
+  }
+  nodes {
+    id: 2
+    op {
+      op_type: AGGREGATE_OPERATOR
+      agg_op {
+        windowed: false
+        values {
+          name: "sum"
+          id: 0
+          args {
+            column {
+              node: 1
+              index: 1
+            }
+          }
+          args_data_types: INT64
+        }
+        groups {
+          node: 1
+          index: 0
+        }
+        group_names: "group"
+        value_names: "sum"
+      }
+    }
+  }
+  nodes {
+    id: 3
+    op {
+      op_type: MEMORY_SINK_OPERATOR
+      mem_sink_op {
+        name: "output"
+        column_types: INT64
+        column_types: INT64
+        column_names: "group"
+        column_names: "sum"
+      }
+    }
+  }
+)";
+
+class ParallelExecGraphTest : public BaseExecGraphTest,
+                              public ::testing::WithParamInterface<int32_t> {
+ protected:
+  void SetUp() override { saved_worker_threads_ = FLAGS_carnot_exec_worker_threads; }
+  void TearDown() override { FLAGS_carnot_exec_worker_threads = saved_worker_threads_; }
+
+  int32_t saved_worker_threads_;
+};
+
+TEST_P(ParallelExecGraphTest, group_by_sum) {
+  FLAGS_carnot_exec_worker_threads = GetParam();
+
+  planpb::PlanFragment pf_pb;
+  ASSERT_TRUE(TextFormat::MergeFromString(kSourceAggSinkPlanFragment, &pf_pb));
+  ASSERT_OK(plan_fragment_->Init(pf_pb));
+
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  EXPECT_OK(func_registry->Register<SumUDA>("sum"));
+  auto plan_state = std::make_unique<plan::PlanState>(func_registry.get());
+  auto schema = std::make_shared<table_store::schema::Schema>();
+  schema->AddRelation(1, table_store::schema::Relation(
+                             std::vector<types::DataType>(
+                                 {types::DataType::INT64, types::DataType::INT64}),
+                             std::vector<std::string>({"group", "value"})));
+
+  // Enough batches that every worker gets several morsels.
+  constexpr int64_t kNumBatches = 64;
+  constexpr int64_t kRowsPerBatch = 50;
+  constexpr int64_t kNumGroups = 7;
+  table_store::schema::Relation rel({types::DataType::INT64, types::DataType::INT64},
+                                    {"group", "value"});
+  auto table = Table::Create("numbers", rel);
+  std::map<int64_t, int64_t> expected_sums;
+  for (int64_t batch_idx = 0; batch_idx < kNumBatches; ++batch_idx) {
+    std::vector<types::Int64Value> groups;
+    std::vector<types::Int64Value> values;
+    for (int64_t row_idx = 0; row_idx < kRowsPerBatch; ++row_idx) {
+      int64_t val = batch_idx * kRowsPerBatch + row_idx;
+      groups.emplace_back(val % kNumGroups);
+      values.emplace_back(val);
+      expected_sums[val % kNumGroups] += val;
+    }
+    auto rb = RowBatch(RowDescriptor(rel.col_types()), kRowsPerBatch);
+    EXPECT_OK(rb.AddColumn(types::ToArrow(groups, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(values, arrow::default_memory_pool())));
+    EXPECT_OK(table->WriteRowBatch(rb));
+  }
+
+  auto table_store = std::make_shared<table_store::TableStore>();
+  table_store->AddTable("numbers", table);
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  EXPECT_OK(exec_state->AddUDA(0, "sum", std::vector<types::DataType>({types::DataType::INT64})));
+
+  ExecutionGraph e;
+  ASSERT_OK(e.Init(schema.get(), plan_state.get(), exec_state.get(), plan_fragment_.get(),
+                   /* collect_exec_node_stats */ false));
+  EXPECT_OK(e.Execute());
+  EXPECT_EQ(kNumBatches * kRowsPerBatch, e.GetStats().rows_processed);
+
+  // The groups can come out in any order.
+  auto output_table = exec_state->table_store()->GetTable("output");
+  std::map<int64_t, int64_t> actual_sums;
+  for (auto slice = output_table->FirstBatch(); slice.IsValid();
+       slice = output_table->NextBatch(slice)) {
+    auto rb = output_table->GetRowBatchSlice(slice, {0, 1}, arrow::default_memory_pool())
+                  .ConsumeValueOrDie();
+    for (int64_t row_idx = 0; row_idx < rb->num_rows(); ++row_idx) {
+      actual_sums[types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(0).get(),
+                                                                         row_idx)
+                      .val] = types::GetValueFromArrowArray<types::DataType::INT64>(
+                                  rb->ColumnAt(1).get(), row_idx)
+                                  .val;
+    }
+  }
+  EXPECT_EQ(expected_sums, actual_sums);
+}
+
+INSTANTIATE_TEST_SUITE_P(ParallelExecGraphTestSuite, ParallelExecGraphTest,
+                         ::testing::Values(1, 2, 4, 16));
+
 TEST_F(ExecGraphTest, two_limits_dont_interfere) {
   planpb::PlanFragment pf_pb;
   ASSERT_TRUE(
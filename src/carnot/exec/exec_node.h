@@ -32,6 +32,11 @@ namespace px {
 namespace carnot {
 namespace exec {
 
+/**
+ * A selection vector holds the indices of the live rows of a row batch, in increasing order.
+ */
+using SelectionVector = std::vector<int64_t>;
+
 enum class ExecNodeType : int8_t {
   kSourceNode = 0,
   kSinkNode = 1,
@@ -41,21 +46,29 @@ enum class ExecNodeType : int8_t {
 struct ExecNodeStats {
   explicit ExecNodeStats(bool collect_stats) : collect_exec_stats(collect_stats) {}
   void AddOutputStats(const table_store::schema::RowBatch& rb) {
+    AddOutputStats(rb, rb.num_rows());
+  }
+
+  // Counts num_rows rows of the row batch, for row batches sent with a selection. Their bytes
+  // are estimated from the average size of a row.
+  void AddOutputStats(const table_store::schema::RowBatch& rb, int64_t num_rows) {
     if (!collect_exec_stats) {
       return;
     }
     ++batches_output;
-    bytes_output += rb.NumBytes();
-    rows_output += rb.num_rows();
+    bytes_output += SelectedBytes(rb, num_rows);
+    rows_output += num_rows;
   }
 
-  void AddInputStats(const table_store::schema::RowBatch& rb) {
+  void AddInputStats(const table_store::schema::RowBatch& rb) { AddInputStats(rb, rb.num_rows()); }
+
+  void AddInputStats(const table_store::schema::RowBatch& rb, int64_t num_rows) {
     if (!collect_exec_stats) {
       return;
     }
     ++batches_input;
-    bytes_input += rb.NumBytes();
-    rows_input += rb.num_rows();
+    bytes_input += SelectedBytes(rb, num_rows);
+    rows_input += num_rows;
   }
 
   void ResumeChildTimer() {
@@ -99,6 +112,13 @@ struct ExecNodeStats {
     extra_info[key] = value;
   }
 
+  static int64_t SelectedBytes(const table_store::schema::RowBatch& rb, int64_t num_rows) {
+    if (num_rows == rb.num_rows()) {
+      return rb.NumBytes();
+    }
+    return rb.NumBytes() * num_rows / rb.num_rows();
+  }
+
   int64_t ChildExecTime() const { return children_timer.ElapsedTime_us() * 1000; }
   int64_t TotalExecTime() const { return total_timer.ElapsedTime_us() * 1000; }
   int64_t SelfExecTime() const { return TotalExecTime() - ChildExecTime(); }
@@ -225,6 +245,37 @@ class ExecNode {
     return Status::OK();
   }
 
+  /**
+   * Consume the rows of the next row batch that are in the selection. The row batch is not
+   * compacted to the selected rows first, so a Filter node can pass the rows it keeps on to the
+   * Map and Filter nodes after it without copying them. This function is only valid for nodes
+   * whose ConsumesSelections() is true.
+   *
+   * @param exec_state The execution state.
+   * @param rb The input row batch.
+   * @param selection The rows of the input row batch to consume.
+   * @return The Status of consumption.
+   */
+  Status ConsumeNextSelected(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                             const SelectionVector& selection, size_t parent_index) {
+    DCHECK(is_initialized_);
+    DCHECK(ConsumesSelections());
+    if (rb.eos() && !rb.eow()) {
+      return error::Internal(
+          "ConsumeNextSelected received row batch with end of stream set but not end of window.");
+    }
+    stats_->AddInputStats(rb, selection.size());
+    stats_->ResumeTotalTimer();
+    PL_RETURN_IF_ERROR(ConsumeNextSelectedImpl(exec_state, rb, selection, parent_index));
+    stats_->StopTotalTimer();
+    return Status::OK();
+  }
+
+  /**
+   * Whether the node can consume row batches with a selection, see ConsumeNextSelected.
+   */
+  virtual bool ConsumesSelections() const { return false; }
+
   /**
    * Check if it's a source node.
    */
@@ -296,6 +347,43 @@ class ExecNode {
     return Status::OK();
   }
 
+  /**
+   * @return whether all of the children can consume row batches with a selection.
+   */
+  bool ChildrenConsumeSelections() const {
+    for (const ExecNode* child : children_) {
+      if (!child->ConsumesSelections()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Send the selected rows of a row batch to children, which must all consume selections.
+   * @param exec_state The exec state.
+   * @param rb The row batch to send.
+   * @param selection The rows of the row batch to send.
+   * @return Status of children execution.
+   */
+  Status SendSelectedRowBatchToChildren(ExecState* exec_state,
+                                        const table_store::schema::RowBatch& rb,
+                                        const SelectionVector& selection) {
+    DCHECK(ChildrenConsumeSelections());
+    stats_->ResumeChildTimer();
+    for (size_t i = 0; i < children_.size(); ++i) {
+      PL_RETURN_IF_ERROR(children_[i]->ConsumeNextSelected(exec_state, rb, selection,
+                                                           parent_ids_for_children_[i]));
+    }
+    stats_->StopChildTimer();
+    stats_->AddOutputStats(rb, selection.size());
+    if (rb.eos()) {
+      DCHECK(!sent_eos_);
+      sent_eos_ = true;
+    }
+    return Status::OK();
+  }
+
   explicit ExecNode(ExecNodeType type) : type_(type) {}
 
   // Defines the protected implementations of the non-virtual interface functions
@@ -313,6 +401,10 @@ class ExecNode {
   virtual Status ConsumeNextImpl(ExecState*, const table_store::schema::RowBatch&, size_t) {
     return error::Unimplemented("Implement in derived class (if sink or processing)");
   }
+  virtual Status ConsumeNextSelectedImpl(ExecState*, const table_store::schema::RowBatch&,
+                                         const SelectionVector&, size_t) {
+    return error::Unimplemented("Implement in derived class (if it consumes selections)");
+  }
   bool is_closed() { return is_closed_; }
 
   std::unique_ptr<table_store::schema::RowDescriptor> output_descriptor_;
@@ -20,9 +20,11 @@
 
 #include <arrow/memory_pool.h>
 
+#include <filesystem>
 #include <map>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -30,6 +32,8 @@
 
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/grpc_router.h"
+#include "src/carnot/exec/memory_budget.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/exec/ml/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
@@ -67,12 +71,19 @@ class ExecState {
         query_id_(query_id),
         model_pool_(model_pool),
         grpc_router_(grpc_router),
-        add_auth_to_grpc_client_context_func_(add_auth_func) {}
+        add_auth_to_grpc_client_context_func_(add_auth_func),
+        memory_budget_(FLAGS_carnot_query_memory_budget_bytes) {}
 
   ~ExecState() {
     if (grpc_router_ != nullptr) {
       grpc_router_->DeleteQuery(query_id_);
     }
+    // Spill files are removed by their owners, this only cleans up the query's directory. Most
+    // queries never spill, so there is nothing to remove unless an operator asked for it.
+    if (spill_dir_used_) {
+      std::error_code ec;
+      std::filesystem::remove_all(spill_dir(), ec);
+    }
   }
   arrow::MemoryPool* exec_mem_pool() {
     // TOOD(zasgar): Make this the correct pool.
@@ -87,6 +98,18 @@ class ExecState {
 
   ml::ModelPool* model_pool() { return model_pool_; }
 
+  // The memory budget shared by the blocking operators of the query.
+  QueryMemoryBudget* memory_budget() { return &memory_budget_; }
+
+  // The directory that operators of this query spill to once they exceed the memory budget.
+  std::string spill_dir() const {
+    return (std::filesystem::path(FLAGS_carnot_spill_dir) / query_id_.str()).string();
+  }
+
+  // Called by operators before they create spill files in spill_dir(), so that the directory is
+  // only cleaned up for the queries that may have created it.
+  void MarkSpilling() { spill_dir_used_ = true; }
+
   Status AddScalarUDF(int64_t id, const std::string& name,
                       const std::vector<types::DataType> arg_types) {
     PL_ASSIGN_OR_RETURN(auto def, func_registry_->GetScalarUDFDefinition(name, arg_types));
@@ -116,13 +139,21 @@ class ExecState {
     return raw;
   }
 
-  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) { return id_to_scalar_udf_map_[id]; }
+  // The definition lookups don't modify the maps, so they are safe to call from the workers of a
+  // parallel pipeline once the plan has been initialized.
+  udf::ScalarUDFDefinition* GetScalarUDFDefinition(int64_t id) {
+    auto it = id_to_scalar_udf_map_.find(id);
+    return it == id_to_scalar_udf_map_.end() ? nullptr : it->second;
+  }
 
   std::map<int64_t, udf::ScalarUDFDefinition*> id_to_scalar_udf_map() {
     return id_to_scalar_udf_map_;
   }
 
-  udf::UDADefinition* GetUDADefinition(int64_t id) { return id_to_uda_map_[id]; }
+  udf::UDADefinition* GetUDADefinition(int64_t id) {
+    auto it = id_to_uda_map_.find(id);
+    return it == id_to_uda_map_.end() ? nullptr : it->second;
+  }
 
   std::unique_ptr<udf::FunctionContext> CreateFunctionContext() {
     auto ctx = std::make_unique<udf::FunctionContext>(metadata_state_, model_pool_);
@@ -174,6 +205,8 @@ class ExecState {
   ml::ModelPool* model_pool_;
   GRPCRouter* grpc_router_ = nullptr;
   std::function<void(grpc::ClientContext*)> add_auth_to_grpc_client_context_func_;
+  QueryMemoryBudget memory_budget_;
+  bool spill_dir_used_ = false;
 
   int64_t current_source_ = 0;
   bool current_source_set_ = false;
@@ -32,6 +32,7 @@
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression_evaluator.h"
 #include "src/carnot/udf/udf_definition.h"
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/types.h"
@@ -65,6 +66,8 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
       return std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx);
     case ScalarExpressionEvaluatorType::kArrowNative:
       return std::make_unique<ArrowNativeScalarExpressionEvaluator>(expressions, function_ctx);
+    case ScalarExpressionEvaluatorType::kFused:
+      return std::make_unique<FusedScalarExpressionEvaluator>(expressions, function_ctx);
     default:
       CHECK(0) << "Unknown expression type";
   }
@@ -89,6 +89,7 @@ class ExpressionEvaluator {
 enum class ScalarExpressionEvaluatorType : uint8_t {
   kVectorNative = 0,
   kArrowNative = 1,
+  kFused = 2,
 };
 
 /**
@@ -21,14 +21,21 @@
 #include <benchmark/benchmark.h>
 #include <cstddef>
 #include <memory>
+#include <numeric>
 #include <vector>
 
+#include <absl/strings/substitute.h>
 #include <google/protobuf/text_format.h>
 #include <sole.hpp>
 
+#include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/filter_node.h"
+#include "src/carnot/exec/fused_expression_evaluator.h"
+#include "src/carnot/exec/map_node.h"
 #include "src/carnot/exec/test_utils.h"
+#include "src/carnot/plan/operators.h"
 #include "src/carnot/plan/plan_state.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
@@ -46,18 +53,26 @@
 using ScalarExpression = px::carnot::plan::ScalarExpression;
 using ScalarExpressionVector = std::vector<std::shared_ptr<ScalarExpression>>;
 using px::carnot::exec::ExecState;
+using px::carnot::exec::FilterNode;
+using px::carnot::exec::MapNode;
+using px::carnot::exec::FusedScalarExpressionEvaluator;
 using px::carnot::exec::MockResultSinkStubGenerator;
 using px::carnot::exec::ScalarExpressionEvaluator;
 using px::carnot::exec::ScalarExpressionEvaluatorType;
+using px::carnot::exec::SelectionVector;
+using px::carnot::exec::VectorNativeScalarExpressionEvaluator;
 using px::carnot::planpb::testutils::kAddScalarFuncNestedPbtxt;
 using px::carnot::planpb::testutils::kAddScalarFuncPbtxt;
 using px::carnot::planpb::testutils::kColumnReferencePbtxt;
+using px::carnot::planpb::testutils::kFilterOperatorTmpl;
+using px::carnot::planpb::testutils::kOperatorProtoTmpl;
 using px::carnot::planpb::testutils::kScalarInt64ValuePbtxt;
 using px::carnot::udf::FunctionContext;
 using px::carnot::udf::Registry;
 using px::carnot::udf::ScalarUDF;
 using px::table_store::schema::RowBatch;
 using px::table_store::schema::RowDescriptor;
+using px::types::BoolValue;
 using px::types::DataType;
 using px::types::Int64Value;
 using px::types::ToArrow;
@@ -65,8 +80,62 @@ using px::types::ToArrow;
 class AddUDF : public ScalarUDF {
  public:
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, int64_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] + v2[i];
+    }
+  }
+};
+
+class GreaterThanUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val > v2.val; }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] > v2[i];
+    }
+  }
 };
 
+class LogicalAndUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, BoolValue b1, BoolValue b2) { return b1.val && b2.val; }
+  static void ExecBatch(const bool* b1, const bool* b2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] && b2[i];
+    }
+  }
+};
+
+// col0 > 0 && col1 > 0. About half of the rows pass each side.
+constexpr char kFilterPredicatePbtxt[] = R"(
+func {
+  name: "logicalAnd"
+  id: 2
+  args {
+    func {
+      name: "gt"
+      id: 1
+      args { column { node: 0 index: 0 } }
+      args { constant { data_type: INT64 int64_value: 0 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args {
+    func {
+      name: "gt"
+      id: 1
+      args { column { node: 0 index: 1 } }
+      args { constant { data_type: INT64 int64_value: 0 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+})";
+
 // NOLINTNEXTLINE : runtime/references.
 void BM_ScalarExpressionTwoCols(benchmark::State& state,
                                 const ScalarExpressionEvaluatorType& eval_type, const char* pbtxt) {
@@ -83,6 +152,7 @@ void BM_ScalarExpressionTwoCols(benchmark::State& state,
   PL_CHECK_OK(func_registry->Register<AddUDF>("add"));
   auto exec_state = std::make_unique<ExecState>(
       func_registry.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "add", {DataType::INT64, DataType::INT64}));
 
   auto in1 = px::datagen::CreateLargeData<Int64Value>(data_size);
   auto in2 = px::datagen::CreateLargeData<Int64Value>(data_size);
@@ -143,3 +213,202 @@ BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_vector,
                   ScalarExpressionEvaluatorType::kVectorNative, kAddScalarFuncNestedPbtxt)
     ->RangeMultiplier(2)
     ->Range(1, 1 << 16);
+BENCHMARK_CAPTURE(BM_ScalarExpressionTwoCols, two_cols_simple_add_fused,
+                  ScalarExpressionEvaluatorType::kFused, kAddScalarFuncNestedPbtxt)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+
+// NOLINTNEXTLINE : runtime/references.
+void BM_FilterPredicate(benchmark::State& state, bool fused) {
+  px::carnot::planpb::ScalarExpression se_pb;
+  size_t data_size = state.range(0);
+
+  google::protobuf::TextFormat::MergeFromString(kFilterPredicatePbtxt, &se_pb);
+  auto s_or_se = px::carnot::plan::ScalarExpression::FromProto(se_pb);
+  CHECK(s_or_se.ok());
+  std::shared_ptr<ScalarExpression> se = s_or_se.ConsumeValueOrDie();
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  PL_CHECK_OK(func_registry->Register<GreaterThanUDF>("gt"));
+  PL_CHECK_OK(func_registry->Register<LogicalAndUDF>("logicalAnd"));
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  PL_CHECK_OK(exec_state->AddScalarUDF(1, "gt", {DataType::INT64, DataType::INT64}));
+  PL_CHECK_OK(
+      exec_state->AddScalarUDF(2, "logicalAnd", {DataType::BOOLEAN, DataType::BOOLEAN}));
+
+  std::vector<Int64Value> in1(data_size);
+  std::vector<Int64Value> in2(data_size);
+  for (size_t i = 0; i < data_size; ++i) {
+    in1[i] = (i % 2 == 0) ? 1 : -1;
+    in2[i] = (i % 3 == 0) ? -1 : 1;
+  }
+  RowDescriptor rd({DataType::INT64, DataType::INT64});
+  auto input_rb = std::make_unique<RowBatch>(rd, in1.size());
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+  PL_CHECK_OK(input_rb->AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+
+  auto function_ctx = std::make_unique<FunctionContext>(nullptr, nullptr);
+  FusedScalarExpressionEvaluator fused_evaluator({se}, function_ctx.get());
+  VectorNativeScalarExpressionEvaluator vector_evaluator({se}, function_ctx.get());
+  PL_CHECK_OK(fused_evaluator.Open(exec_state.get()));
+  PL_CHECK_OK(vector_evaluator.Open(exec_state.get()));
+  SelectionVector selection;
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    size_t num_selected = 0;
+    if (fused) {
+      selection.resize(data_size);
+      std::iota(selection.begin(), selection.end(), 0);
+      PL_CHECK_OK(fused_evaluator.EvaluateSelection(exec_state.get(), *input_rb, 0, &selection));
+      num_selected = selection.size();
+    } else {
+      auto pred_or = vector_evaluator.EvaluateSingleExpression(exec_state.get(), *input_rb, *se);
+      PL_CHECK_OK(pred_or);
+      const auto& pred =
+          *static_cast<px::types::BoolValueColumnWrapper*>(pred_or.ValueOrDie().get());
+      for (size_t i = 0; i < pred.Size(); ++i) {
+        num_selected += pred[i].val;
+      }
+    }
+    benchmark::DoNotOptimize(num_selected);
+  }
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * in1.size() * sizeof(int64_t));
+}
+
+BENCHMARK_CAPTURE(BM_FilterPredicate, vector, false)->RangeMultiplier(4)->Range(1 << 6, 1 << 16);
+BENCHMARK_CAPTURE(BM_FilterPredicate, fused, true)->RangeMultiplier(4)->Range(1 << 6, 1 << 16);
+
+// col$0 > 0.
+constexpr char kGreaterThanZeroPbtxt[] = R"(
+func {
+  name: "gt"
+  id: 1
+  args { column { node: 0 index: $0 } }
+  args { constant { data_type: INT64 int64_value: 0 } }
+  args_data_types: INT64
+  args_data_types: INT64
+})";
+
+// col0 + col2, col1.
+constexpr char kAddMapOperatorPbtxt[] = R"(
+expressions {
+  func {
+    name: "add"
+    id: 0
+    args { column { node: 0 index: 0 } }
+    args { column { node: 0 index: 2 } }
+    args_data_types: INT64
+    args_data_types: INT64
+  }
+}
+expressions { column { node: 0 index: 1 } }
+column_names: "sum"
+column_names: "col1"
+)";
+
+std::unique_ptr<px::carnot::plan::Operator> OperatorFromPbtxt(const char* op_type,
+                                                              const char* op_field,
+                                                              const std::string& op_pbtxt) {
+  px::carnot::planpb::Operator op_pb;
+  CHECK(google::protobuf::TextFormat::MergeFromString(
+      absl::Substitute(kOperatorProtoTmpl, op_type, op_field, op_pbtxt), &op_pb));
+  return px::carnot::plan::Operator::FromProto(op_pb, /*id*/ 1);
+}
+
+// Counts the rows that reach the end of the benchmarked chain of nodes.
+class RowCountSinkNode : public px::carnot::exec::SinkNode {
+ public:
+  int64_t num_rows() const { return num_rows_; }
+
+ protected:
+  std::string DebugStringImpl() override { return "RowCountSinkNode"; }
+  px::Status InitImpl(const px::carnot::plan::Operator&) override { return px::Status::OK(); }
+  px::Status PrepareImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status OpenImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status CloseImpl(ExecState*) override { return px::Status::OK(); }
+  px::Status ConsumeNextImpl(ExecState*, const RowBatch& rb, size_t) override {
+    num_rows_ += rb.num_rows();
+    return px::Status::OK();
+  }
+
+ private:
+  int64_t num_rows_ = 0;
+};
+
+// Runs col0 > 0, then col1 > 0, then a Map of col0 + col2 and col1 over the row batches. With the
+// fused evaluator the second filter and the map only evaluate the selected rows of the original
+// columns, without the rows being copied between the nodes.
+// NOLINTNEXTLINE : runtime/references.
+void BM_MapFilterChain(benchmark::State& state, bool fused) {
+  size_t data_size = state.range(0);
+  FLAGS_carnot_fused_expression_evaluator = fused;
+
+  auto func_registry = std::make_unique<Registry>("test_registry");
+  auto table_store = std::make_shared<px::table_store::TableStore>();
+  PL_CHECK_OK(func_registry->Register<AddUDF>("add"));
+  PL_CHECK_OK(func_registry->Register<GreaterThanUDF>("gt"));
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), table_store, MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+  PL_CHECK_OK(exec_state->AddScalarUDF(0, "add", {DataType::INT64, DataType::INT64}));
+  PL_CHECK_OK(exec_state->AddScalarUDF(1, "gt", {DataType::INT64, DataType::INT64}));
+
+  RowDescriptor rd({DataType::INT64, DataType::INT64, DataType::INT64});
+  RowDescriptor map_rd({DataType::INT64, DataType::INT64});
+  auto filter1_op =
+      OperatorFromPbtxt("FILTER_OPERATOR", "filter_op",
+                        absl::Substitute(kFilterOperatorTmpl,
+                                         absl::Substitute(kGreaterThanZeroPbtxt, 0)));
+  auto filter2_op =
+      OperatorFromPbtxt("FILTER_OPERATOR", "filter_op",
+                        absl::Substitute(kFilterOperatorTmpl,
+                                         absl::Substitute(kGreaterThanZeroPbtxt, 1)));
+  auto map_op = OperatorFromPbtxt("MAP_OPERATOR", "map_op", kAddMapOperatorPbtxt);
+
+  FilterNode filter1;
+  FilterNode filter2;
+  MapNode map;
+  RowCountSinkNode sink;
+  filter1.AddChild(&filter2, 0);
+  filter2.AddChild(&map, 0);
+  map.AddChild(&sink, 0);
+  PL_CHECK_OK(filter1.Init(*filter1_op, rd, {rd}));
+  PL_CHECK_OK(filter2.Init(*filter2_op, rd, {rd}));
+  PL_CHECK_OK(map.Init(*map_op, map_rd, {rd}));
+  PL_CHECK_OK(sink.Init(*map_op, RowDescriptor({}), {map_rd}));
+  for (px::carnot::exec::ExecNode* node :
+       std::vector<px::carnot::exec::ExecNode*>{&filter1, &filter2, &map, &sink}) {
+    PL_CHECK_OK(node->Prepare(exec_state.get()));
+    PL_CHECK_OK(node->Open(exec_state.get()));
+  }
+
+  // Half of the rows pass the first filter, and two thirds of those pass the second one.
+  std::vector<Int64Value> in1(data_size);
+  std::vector<Int64Value> in2(data_size);
+  std::vector<Int64Value> in3(data_size);
+  for (size_t i = 0; i < data_size; ++i) {
+    in1[i] = (i % 2 == 0) ? 1 : -1;
+    in2[i] = (i % 3 == 0) ? -1 : 1;
+    in3[i] = i;
+  }
+  RowBatch input_rb(rd, data_size);
+  PL_CHECK_OK(input_rb.AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+  PL_CHECK_OK(input_rb.AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+  PL_CHECK_OK(input_rb.AddColumn(ToArrow(in3, arrow::default_memory_pool())));
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    PL_CHECK_OK(filter1.ConsumeNext(exec_state.get(), input_rb, 0));
+  }
+  benchmark::DoNotOptimize(sink.num_rows());
+  for (px::carnot::exec::ExecNode* node :
+       std::vector<px::carnot::exec::ExecNode*>{&filter1, &filter2, &map, &sink}) {
+    PL_CHECK_OK(node->Close(exec_state.get()));
+  }
+  FLAGS_carnot_fused_expression_evaluator = false;
+  state.SetBytesProcessed(int64_t(state.iterations()) * 3 * data_size * sizeof(int64_t));
+}
+
+BENCHMARK_CAPTURE(BM_MapFilterChain, vector, false)->RangeMultiplier(4)->Range(1 << 6, 1 << 16);
+BENCHMARK_CAPTURE(BM_MapFilterChain, fused, true)->RangeMultiplier(4)->Range(1 << 6, 1 << 16);
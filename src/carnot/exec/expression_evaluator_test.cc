@@ -29,6 +29,7 @@
 #include <sole.hpp>
 
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_expression_evaluator.h"
 #include "src/carnot/exec/test_utils.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/planpb/plan.pb.h"
@@ -157,7 +158,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
 INSTANTIATE_TEST_SUITE_P(TestVecAndArrow, ScalarExpressionTest,
                          ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
-                                           ScalarExpressionEvaluatorType::kArrowNative));
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kFused));
 
 TEST_P(ScalarExpressionTest, basic_tests) {
   RowDescriptor rd_output({types::DataType::INT64});
@@ -269,6 +271,173 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+class BatchAddUDF : public udf::ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val + v2.val;
+  }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, int64_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] + v2[i];
+    }
+  }
+};
+
+class BatchGreaterThanUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val > v2.val;
+  }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] > v2[i];
+    }
+  }
+};
+
+class BatchLogicalAndUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::BoolValue b1, types::BoolValue b2) {
+    return b1.val && b2.val;
+  }
+  static void ExecBatch(const bool* b1, const bool* b2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] && b2[i];
+    }
+  }
+};
+
+// (col0 + col1) > 5 && col1 > col0 + 1. The add UDF has no batch Exec function, so this mixes the
+// two kinds of function nodes.
+constexpr char kFusedPredicatePbtxt[] = R"pb(
+func {
+  name: "logicalAnd"
+  id: 4
+  args {
+    func {
+      name: "gt"
+      id: 3
+      args {
+        func {
+          name: "batch_add"
+          id: 2
+          args { column { node: 0 index: 0 } }
+          args { column { node: 0 index: 1 } }
+          args_data_types: INT64
+          args_data_types: INT64
+        }
+      }
+      args { constant { data_type: INT64 int64_value: 5 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args {
+    func {
+      name: "gt"
+      id: 3
+      args { column { node: 0 index: 1 } }
+      args { func { name: "add" id: 0
+                    args { column { node: 0 index: 0 } }
+                    args { constant { data_type: INT64 int64_value: 1 } }
+                    args_data_types: INT64
+                    args_data_types: INT64 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+}
+)pb";
+
+class FusedScalarExpressionTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    func_registry_ = std::make_unique<udf::Registry>("test_registry");
+    auto table_store = std::make_shared<table_store::TableStore>();
+
+    EXPECT_OK(func_registry_->Register<AddUDF>("add"));
+    EXPECT_OK(func_registry_->Register<BatchAddUDF>("batch_add"));
+    EXPECT_OK(func_registry_->Register<BatchGreaterThanUDF>("gt"));
+    EXPECT_OK(func_registry_->Register<BatchLogicalAndUDF>("logicalAnd"));
+    exec_state_ = std::make_unique<ExecState>(func_registry_.get(), table_store,
+                                              MockResultSinkStubGenerator, sole::uuid4(), nullptr);
+    EXPECT_OK(exec_state_->AddScalarUDF(0, "add", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(2, "batch_add", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(3, "gt", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(4, "logicalAnd", {types::BOOLEAN, types::BOOLEAN}));
+
+    std::vector<types::Int64Value> in1 = {1, 2, 3, 4};
+    std::vector<types::Int64Value> in2 = {3, 4, 5, 4};
+    std::vector<types::StringValue> in3 = {"a", "b", "c", "d"};
+
+    RowDescriptor rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+    input_rb_ = std::make_unique<RowBatch>(rd, in1.size());
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in1, arrow::default_memory_pool())));
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in2, arrow::default_memory_pool())));
+    EXPECT_OK(input_rb_->AddColumn(ToArrow(in3, arrow::default_memory_pool())));
+    function_ctx_ = std::make_unique<udf::FunctionContext>(nullptr, nullptr);
+  }
+
+ protected:
+  std::unique_ptr<ExecState> exec_state_;
+  std::unique_ptr<RowBatch> input_rb_;
+  std::unique_ptr<udf::Registry> func_registry_;
+  std::unique_ptr<udf::FunctionContext> function_ctx_;
+};
+
+TEST_F(FusedScalarExpressionTest, evaluate_selection) {
+  FusedScalarExpressionEvaluator evaluator({ScalarExpressionOf(kFusedPredicatePbtxt)},
+                                           function_ctx_.get());
+  ASSERT_OK(evaluator.Open(exec_state_.get()));
+
+  // col0 + col1 > 5 keeps rows 1, 2 and 3, and col1 > col0 + 1 then drops row 3.
+  SelectionVector selection = {0, 1, 2, 3};
+  ASSERT_OK(evaluator.EvaluateSelection(exec_state_.get(), *input_rb_, 0, &selection));
+  EXPECT_EQ(SelectionVector({1, 2}), selection);
+
+  // Rows outside of the selection are never considered.
+  selection = {0, 2, 3};
+  ASSERT_OK(evaluator.EvaluateSelection(exec_state_.get(), *input_rb_, 0, &selection));
+  EXPECT_EQ(SelectionVector({2}), selection);
+
+  EXPECT_OK(evaluator.Close(exec_state_.get()));
+}
+
+TEST_F(FusedScalarExpressionTest, evaluate_selected) {
+  FusedScalarExpressionEvaluator evaluator(
+      {ScalarExpressionOf(kAddScalarFuncConstPbtxt), ScalarExpressionOf(kInitArgScalarFunc),
+       ScalarExpressionOf(kFusedPredicatePbtxt)},
+      function_ctx_.get());
+  EXPECT_OK(func_registry_->Register<InitArgUDF>("init_arg"));
+  EXPECT_OK(exec_state_->AddScalarUDF(1, "init_arg", {types::STRING, types::INT64,
+                                                      types::STRING}));
+  ASSERT_OK(evaluator.Open(exec_state_.get()));
+
+  SelectionVector selection = {1, 3};
+  RowBatch output_rb(RowDescriptor({types::INT64, types::STRING, types::BOOLEAN}),
+                     selection.size());
+  ASSERT_OK(evaluator.EvaluateSelected(exec_state_.get(), *input_rb_, selection, &output_rb));
+
+  auto sums = static_cast<arrow::Int64Array*>(output_rb.ColumnAt(0).get());
+  ASSERT_EQ(2, sums->length());
+  EXPECT_EQ(1339, sums->Value(0));
+  EXPECT_EQ(1341, sums->Value(1));
+
+  auto strs = static_cast<arrow::StringArray*>(output_rb.ColumnAt(1).get());
+  ASSERT_EQ(2, strs->length());
+  EXPECT_EQ("init_arg, 1234, b", strs->GetString(0));
+  EXPECT_EQ("init_arg, 1234, d", strs->GetString(1));
+
+  auto preds = static_cast<arrow::BooleanArray*>(output_rb.ColumnAt(2).get());
+  ASSERT_EQ(2, preds->length());
+  EXPECT_TRUE(preds->Value(0));
+  EXPECT_FALSE(preds->Value(1));
+
+  EXPECT_OK(evaluator.Close(exec_state_.get()));
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
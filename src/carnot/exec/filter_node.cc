@@ -22,6 +22,7 @@
 #include <arrow/array/builder_binary.h>
 #include <arrow/memory_pool.h>
 #include <arrow/status.h>
+#include <numeric>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -47,6 +48,9 @@ using table_store::schema::RowBatch;
 using table_store::schema::RowDescriptor;
 
 std::string FilterNode::DebugStringImpl() {
+  if (fused_evaluator_ != nullptr) {
+    return absl::Substitute("Exec::FilterNode<$0>", fused_evaluator_->DebugString());
+  }
   return absl::Substitute("Exec::FilterNode<$0>", evaluator_->DebugString());
 }
 
@@ -60,17 +64,28 @@ Status FilterNode::InitImpl(const plan::Operator& plan_node) {
 
 Status FilterNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
+  if (FLAGS_carnot_fused_expression_evaluator) {
+    fused_evaluator_ = std::make_unique<FusedScalarExpressionEvaluator>(
+        plan::ConstScalarExpressionVector{plan_node_->expression()}, function_ctx_.get());
+    return Status::OK();
+  }
   evaluator_ = std::make_unique<VectorNativeScalarExpressionEvaluator>(
       plan::ConstScalarExpressionVector{plan_node_->expression()}, function_ctx_.get());
   return Status::OK();
 }
 
 Status FilterNode::OpenImpl(ExecState* exec_state) {
+  if (fused_evaluator_ != nullptr) {
+    return fused_evaluator_->Open(exec_state);
+  }
   PL_RETURN_IF_ERROR(evaluator_->Open(exec_state));
   return Status::OK();
 }
 
 Status FilterNode::CloseImpl(ExecState* exec_state) {
+  if (fused_evaluator_ != nullptr) {
+    return fused_evaluator_->Close(exec_state);
+  }
   PL_RETURN_IF_ERROR(evaluator_->Close(exec_state));
   return Status::OK();
 }
@@ -129,7 +144,86 @@ Status PredicateCopyValues<types::STRING>(const types::BoolValueColumnWrapper& p
   return Status::OK();
 }
 
+template <types::DataType T>
+Status SelectionCopyValues(const SelectionVector& selection, const arrow::Array* input_col,
+                           RowBatch* output_rb) {
+  auto output_col_builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto* output_col_builder = static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(
+      output_col_builder_generic.get());
+  PL_RETURN_IF_ERROR(output_col_builder->Reserve(selection.size()));
+  if constexpr (T == types::STRING) {
+    // The selected rows are known up front, so the string data can be reserved exactly.
+    const auto* input_strings = static_cast<const arrow::StringArray*>(input_col);
+    int64_t total_size = 0;
+    for (int64_t idx : selection) {
+      total_size += input_strings->value_length(idx);
+    }
+    PL_RETURN_IF_ERROR(output_col_builder->ReserveData(total_size));
+  }
+  for (int64_t idx : selection) {
+    output_col_builder->UnsafeAppend(types::GetValueFromArrowArray<T>(input_col, idx));
+  }
+  std::shared_ptr<arrow::Array> output_array;
+  PL_RETURN_IF_ERROR(output_col_builder->Finish(&output_array));
+  PL_RETURN_IF_ERROR(output_rb->AddColumn(output_array));
+  return Status::OK();
+}
+
+Status FilterNode::ConsumeNextFused(ExecState* exec_state, const RowBatch& rb,
+                                    const SelectionVector* selection) {
+  size_t num_input_records = rb.num_rows();
+  if (selection != nullptr) {
+    selection_ = *selection;
+  } else {
+    selection_.resize(num_input_records);
+    std::iota(selection_.begin(), selection_.end(), 0);
+  }
+  PL_RETURN_IF_ERROR(fused_evaluator_->EvaluateSelection(exec_state, rb, 0, &selection_));
+  DCHECK_EQ(output_descriptor_->size(), plan_node_->selected_cols().size());
+
+  if (ChildrenConsumeSelections()) {
+    // Defer copying the selected rows to the children, which evaluate their expressions on the
+    // selected rows in place. Only the selected columns are passed on, without copying them.
+    RowBatch output_rb(*output_descriptor_, num_input_records);
+    for (int64_t input_col_idx : plan_node_->selected_cols()) {
+      PL_RETURN_IF_ERROR(output_rb.AddColumn(rb.ColumnAt(input_col_idx)));
+    }
+    output_rb.set_eow(rb.eow());
+    output_rb.set_eos(rb.eos());
+    return SendSelectedRowBatchToChildren(exec_state, output_rb, selection_);
+  }
+
+  RowBatch output_rb(*output_descriptor_, selection_.size());
+  // The input columns can be passed through untouched when every row passes the filter.
+  bool all_rows = selection_.size() == num_input_records;
+  for (const auto& [output_col_idx, input_col_idx] : Enumerate(plan_node_->selected_cols())) {
+    auto input_col = rb.ColumnAt(input_col_idx);
+    if (all_rows) {
+      PL_RETURN_IF_ERROR(output_rb.AddColumn(input_col));
+      continue;
+    }
+    auto col_type = output_descriptor_->type(output_col_idx);
+#define TYPE_CASE(_dt_) \
+  PL_RETURN_IF_ERROR(SelectionCopyValues<_dt_>(selection_, input_col.get(), &output_rb));
+    PL_SWITCH_FOREACH_DATATYPE(col_type, TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  output_rb.set_eow(rb.eow());
+  output_rb.set_eos(rb.eos());
+  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return Status::OK();
+}
+
+Status FilterNode::ConsumeNextSelectedImpl(ExecState* exec_state, const RowBatch& rb,
+                                           const SelectionVector& selection, size_t) {
+  return ConsumeNextFused(exec_state, rb, &selection);
+}
+
 Status FilterNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (fused_evaluator_ != nullptr) {
+    return ConsumeNextFused(exec_state, rb, /*selection*/ nullptr);
+  }
   // Current implementation does not merge across row batches, we should
   // consider this for cases where the filter has really low selectivity.
   PL_ASSIGN_OR_RETURN(auto pred_col, evaluator_->EvaluateSingleExpression(
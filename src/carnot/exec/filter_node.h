@@ -26,6 +26,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/fused_expression_evaluator.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
@@ -41,6 +42,8 @@ class FilterNode : public ProcessingNode {
   FilterNode() = default;
   virtual ~FilterNode() = default;
 
+  bool ConsumesSelections() const override { return fused_evaluator_ != nullptr; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -49,9 +52,20 @@ class FilterNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  Status ConsumeNextSelectedImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                                 const SelectionVector& selection, size_t parent_index) override;
 
  private:
+  // Evaluates the predicate on the selected rows of the row batch, or all of them if selection is
+  // null.
+  Status ConsumeNextFused(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                          const SelectionVector* selection);
+
+  // Only one of the evaluators is set, depending on FLAGS_carnot_fused_expression_evaluator.
   std::unique_ptr<VectorNativeScalarExpressionEvaluator> evaluator_;
+  std::unique_ptr<FusedScalarExpressionEvaluator> fused_evaluator_;
+  // The rows of the current batch that pass the predicate, reused across row batches.
+  SelectionVector selection_;
   std::unique_ptr<plan::FilterOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
 };
@@ -18,6 +18,7 @@
 
 #include "src/carnot/exec/filter_node.h"
 
+#include <google/protobuf/text_format.h>
 #include <sole.hpp>
 
 #include "src/carnot/exec/test_utils.h"
@@ -110,6 +111,130 @@ TEST_F(FilterNodeTest, basic) {
       .Close();
 }
 
+TEST_F(FilterNodeTest, fused_evaluator) {
+  FLAGS_carnot_fused_expression_evaluator = true;
+  auto op_proto = planpb::testutils::CreateTestFilterTwoCols();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd(
+      {types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 3})
+                       .AddColumn<types::Int64Value>({1, 4, 6})
+                       .AddColumn<types::StringValue>({"Hello", "world", "now"})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, true, true)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::StringValue>({"Hello"})
+                          .get())
+      .Close();
+  FLAGS_carnot_fused_expression_evaluator = false;
+}
+
+TEST_F(FilterNodeTest, fused_consume_selected) {
+  FLAGS_carnot_fused_expression_evaluator = true;
+  auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
+  plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<FilterNode, plan::FilterOperator>(
+      *plan_node_, output_rd, {input_rd}, exec_state_.get());
+  EXPECT_TRUE(tester.node()->ConsumesSelections());
+  // Rows 0, 1 and 3 pass the predicate, but row 0 is not selected.
+  tester
+      .ConsumeNextSelected(RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                               .AddColumn<types::Int64Value>({1, 1, 3, 1})
+                               .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                               .AddColumn<types::StringValue>({"ABC", "DEF", "HELLO", "WORLD"})
+                               .get(),
+                           {1, 2, 3}, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, true, true).AddColumn<types::Int64Value>({3, 9}).get())
+      .Close();
+  FLAGS_carnot_fused_expression_evaluator = false;
+}
+
+// col1 == 3, passing on col2.
+constexpr char kFilterCol1Eq3Pbtxt[] = R"(
+op_type: FILTER_OPERATOR
+filter_op {
+  expression {
+    func {
+      name: "eq"
+      args { column { node: 0 index: 1 } }
+      args { constant { data_type: INT64 int64_value: 3 } }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  columns { node: 0 index: 2 }
+})";
+
+TEST_F(FilterNodeTest, fused_chain) {
+  FLAGS_carnot_fused_expression_evaluator = true;
+  auto filter1_plan =
+      plan::FilterOperator::FromProto(planpb::testutils::CreateTestFilterTwoCols(), /*id*/ 1);
+  planpb::Operator filter2_pb;
+  ASSERT_TRUE(google::protobuf::TextFormat::MergeFromString(kFilterCol1Eq3Pbtxt, &filter2_pb));
+  auto filter2_plan = plan::FilterOperator::FromProto(filter2_pb, /*id*/ 2);
+
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64, types::DataType::STRING});
+  RowDescriptor output_rd({types::DataType::STRING});
+
+  // The first filter hands the rows it keeps to the second one as a selection, which only copies
+  // the rows that pass both filters.
+  FilterNode filter1;
+  FilterNode filter2;
+  MockExecNode sink;
+  filter1.AddChild(&filter2, 0);
+  filter2.AddChild(&sink, 0);
+  ASSERT_OK(filter1.Init(*filter1_plan, input_rd, {input_rd}));
+  ASSERT_OK(filter2.Init(*filter2_plan, output_rd, {input_rd}));
+  FakePlanNode fake_plan(123);
+  EXPECT_CALL(sink, InitImpl(_));
+  ASSERT_OK(sink.Init(fake_plan, RowDescriptor({}), {output_rd}));
+  ASSERT_OK(filter1.Prepare(exec_state_.get()));
+  ASSERT_OK(filter2.Prepare(exec_state_.get()));
+  ASSERT_OK(filter1.Open(exec_state_.get()));
+  ASSERT_OK(filter2.Open(exec_state_.get()));
+  EXPECT_TRUE(filter2.ConsumesSelections());
+
+  std::unique_ptr<RowBatch> output_rb;
+  EXPECT_CALL(sink, ConsumeNextImpl(_, _, _))
+      .WillOnce(::testing::DoAll(
+          ::testing::Invoke([&](ExecState*, const RowBatch& rb, size_t) {
+            output_rb = std::make_unique<RowBatch>(rb);
+          }),
+          ::testing::Return(Status::OK())));
+  ASSERT_OK(filter1.ConsumeNext(exec_state_.get(),
+                                RowBatchBuilder(input_rd, 5, /*eow*/ true, /*eos*/ true)
+                                    .AddColumn<types::Int64Value>({1, 1, 3, 1, 1})
+                                    .AddColumn<types::Int64Value>({3, 4, 3, 3, 6})
+                                    .AddColumn<types::StringValue>({"a", "b", "c", "d", "e"})
+                                    .get(),
+                                0));
+  ASSERT_NE(nullptr, output_rb);
+  EXPECT_TRUE(output_rb->eow());
+  EXPECT_TRUE(output_rb->eos());
+  ASSERT_EQ(2, output_rb->num_rows());
+  auto strs = static_cast<arrow::StringArray*>(output_rb->ColumnAt(0).get());
+  EXPECT_EQ("a", strs->GetString(0));
+  EXPECT_EQ("d", strs->GetString(1));
+
+  EXPECT_OK(filter1.Close(exec_state_.get()));
+  EXPECT_OK(filter2.Close(exec_state_.get()));
+  FLAGS_carnot_fused_expression_evaluator = false;
+}
+
 TEST_F(FilterNodeTest, column_selection) {
   auto op_proto = planpb::testutils::CreateTestFilterTwoColsColumnSelection();
   plan_node_ = plan::FilterOperator::FromProto(op_proto, /*id*/ 1);
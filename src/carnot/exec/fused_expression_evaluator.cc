@@ -0,0 +1,621 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_expression_evaluator.h"
+
+#include <arrow/array.h>
+#include <arrow/builder.h>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/udf/udf_definition.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/type_utils.h"
+#include "src/shared/types/types.h"
+
+DEFINE_bool(carnot_fused_expression_evaluator,
+            gflags::BoolFromEnv("PL_CARNOT_FUSED_EXPRESSION_EVALUATOR", false),
+            "Evaluate Map and Filter nodes over selection vectors. Each expression tree runs the "
+            "batch Exec functions of its UDFs on native arrays, and a Filter node hands the rows "
+            "it keeps to the Map and Filter nodes after it as a selection vector instead of "
+            "copying them into a new row batch.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using types::ColumnWrapper;
+using types::DataType;
+using types::DataTypeTraits;
+using types::SharedColumnWrapper;
+
+// The native arrays are passed to batch Exec functions as the native types of the UDF values.
+static_assert(sizeof(types::Int64Value) == sizeof(int64_t));
+static_assert(sizeof(types::Time64NSValue) == sizeof(int64_t));
+static_assert(sizeof(types::Float64Value) == sizeof(double));
+static_assert(sizeof(types::BoolValue) == sizeof(uint8_t));
+static_assert(sizeof(bool) == sizeof(uint8_t));
+
+/**
+ * The native representation used for the intermediate values of a type.
+ */
+enum class FusedLane : uint8_t {
+  // Not natively representable, the values are kept in a column wrapper.
+  kNone,
+  kInt64,
+  kFloat64,
+  // Booleans are kept as one byte per value, each 0 or 1, which is how batch Exec functions take
+  // them.
+  kBool,
+};
+
+namespace {
+
+FusedLane LaneForType(DataType type) {
+  switch (type) {
+    case DataType::INT64:
+    case DataType::TIME64NS:
+      return FusedLane::kInt64;
+    case DataType::FLOAT64:
+      return FusedLane::kFloat64;
+    case DataType::BOOLEAN:
+      return FusedLane::kBool;
+    default:
+      return FusedLane::kNone;
+  }
+}
+
+// The name that the planner gives the function of the `and` operator.
+constexpr char kLogicalAndName[] = "logicalAnd";
+
+}  // namespace
+
+/**
+ * A node of a compiled expression.
+ */
+struct FusedExpressionNode {
+  enum class Kind : uint8_t {
+    kConstant,
+    kColumn,
+    // A function run by its UDF's batch Exec function on native arrays.
+    kBatchUDF,
+    // A function run by its UDF on column wrappers.
+    kUDF,
+  };
+
+  Kind kind;
+  // The type of the node's values. Unknown for columns that are not a function argument, those
+  // are resolved from the input.
+  DataType type = DataType::DATA_TYPE_UNKNOWN;
+  const plan::ScalarValue* constant = nullptr;
+  int64_t column_idx = -1;
+  udf::ScalarUDFDefinition* def = nullptr;
+  udf::ScalarUDF* udf = nullptr;
+  // Whether this is a logicalAnd, whose right hand side only needs to be evaluated on the rows
+  // that its left hand side kept when it is used as a predicate.
+  bool logical_and = false;
+  std::vector<std::unique_ptr<FusedExpressionNode>> children;
+
+  // Space for the node's values, reused across row batches.
+  std::vector<int64_t> int64_values;
+  std::vector<double> float64_values;
+  std::vector<uint8_t> bool_values;
+};
+
+/**
+ * The values of a node for the selected rows. Exactly one of the data pointers is set unless the
+ * values are a constant.
+ */
+struct FusedValues {
+  DataType type = DataType::DATA_TYPE_UNKNOWN;
+  FusedLane lane = FusedLane::kNone;
+  size_t size = 0;
+
+  const plan::ScalarValue* constant = nullptr;
+  int64_t int64_constant = 0;
+  double float64_constant = 0;
+
+  const int64_t* int64_data = nullptr;
+  const double* float64_data = nullptr;
+  const uint8_t* bool_data = nullptr;
+  // Holds the values that have no native lane, and owns the data of UDF results.
+  SharedColumnWrapper wrapper;
+  // Set when the values are exactly an input column, so they can be passed through as is.
+  std::shared_ptr<arrow::Array> array;
+};
+
+namespace {
+
+// Returns the values as a native array, which batch Exec functions need for every argument.
+// Constants are repeated into the node's space for its values. The node's space is only written
+// when the number of values changes, since a constant node never changes its value.
+const void* NativeData(FusedExpressionNode* node, FusedValues* values) {
+  size_t n = values->size;
+  if (values->constant == nullptr) {
+    switch (values->lane) {
+      case FusedLane::kInt64:
+        return values->int64_data;
+      case FusedLane::kFloat64:
+        return values->float64_data;
+      case FusedLane::kBool:
+        return values->bool_data;
+      default:
+        return nullptr;
+    }
+  }
+  switch (values->lane) {
+    case FusedLane::kInt64:
+      if (node->int64_values.size() != n) {
+        node->int64_values.assign(n, values->int64_constant);
+      }
+      values->int64_data = node->int64_values.data();
+      return values->int64_data;
+    case FusedLane::kFloat64:
+      if (node->float64_values.size() != n) {
+        node->float64_values.assign(n, values->float64_constant);
+      }
+      values->float64_data = node->float64_values.data();
+      return values->float64_data;
+    case FusedLane::kBool:
+      if (node->bool_values.size() != n) {
+        node->bool_values.assign(n, values->int64_constant != 0);
+      }
+      values->bool_data = node->bool_values.data();
+      return values->bool_data;
+    default:
+      return nullptr;
+  }
+}
+
+// Points the lane of the values at the data of a column wrapper.
+void SetValuesFromColumnWrapper(SharedColumnWrapper wrapper, FusedValues* values) {
+  values->type = wrapper->data_type();
+  values->lane = LaneForType(values->type);
+  values->size = wrapper->Size();
+  const void* data = wrapper->UnsafeRawData();
+  switch (values->lane) {
+    case FusedLane::kInt64:
+      values->int64_data = static_cast<const int64_t*>(data);
+      break;
+    case FusedLane::kFloat64:
+      values->float64_data = static_cast<const double*>(data);
+      break;
+    case FusedLane::kBool:
+      values->bool_data = static_cast<const uint8_t*>(data);
+      break;
+    default:
+      break;
+  }
+  values->wrapper = std::move(wrapper);
+}
+
+template <DataType DT, typename TNative>
+SharedColumnWrapper NativeToColumnWrapper(const TNative* data, size_t n) {
+  using ValueType = typename DataTypeTraits<DT>::value_type;
+  auto wrapper = std::make_shared<types::ColumnWrapperTmpl<ValueType>>(n);
+  ValueType* out = wrapper->UnsafeRawData();
+  for (size_t i = 0; i < n; ++i) {
+    out[i] = static_cast<typename DataTypeTraits<DT>::native_type>(data[i]);
+  }
+  return wrapper;
+}
+
+// Converts the values into a column wrapper, for the UDFs that don't have a batch Exec function.
+SharedColumnWrapper ToColumnWrapper(ExecState* exec_state, const FusedValues& values) {
+  if (values.wrapper != nullptr) {
+    return values.wrapper;
+  }
+  if (values.constant != nullptr) {
+    return EvalScalarToColumnWrapper(exec_state, *values.constant, values.size);
+  }
+  if (values.array != nullptr && values.lane != FusedLane::kBool) {
+    return ColumnWrapper::FromArrow(values.array);
+  }
+  switch (values.type) {
+    case DataType::INT64:
+      return NativeToColumnWrapper<DataType::INT64>(values.int64_data, values.size);
+    case DataType::TIME64NS:
+      return NativeToColumnWrapper<DataType::TIME64NS>(values.int64_data, values.size);
+    case DataType::FLOAT64:
+      return NativeToColumnWrapper<DataType::FLOAT64>(values.float64_data, values.size);
+    case DataType::BOOLEAN:
+      return NativeToColumnWrapper<DataType::BOOLEAN>(values.bool_data, values.size);
+    default:
+      CHECK(0) << "Unexpected type: " << types::ToString(values.type);
+  }
+}
+
+template <DataType DT, typename TNative>
+StatusOr<std::shared_ptr<arrow::Array>> NativeToArrow(const TNative* data, size_t n,
+                                                      arrow::MemoryPool* mem_pool) {
+  typename DataTypeTraits<DT>::arrow_builder_type builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.AppendValues(data, n));
+  std::shared_ptr<arrow::Array> arr;
+  PL_RETURN_IF_ERROR(builder.Finish(&arr));
+  return arr;
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> ToArrow(ExecState* exec_state, const FusedValues& values) {
+  if (values.array != nullptr) {
+    return values.array;
+  }
+  if (values.constant != nullptr) {
+    return EvalScalarToArrow(exec_state, *values.constant, values.size);
+  }
+  auto mem_pool = exec_state->exec_mem_pool();
+  if (values.wrapper != nullptr) {
+    return values.wrapper->ConvertToArrow(mem_pool);
+  }
+  switch (values.type) {
+    case DataType::INT64:
+      return NativeToArrow<DataType::INT64>(values.int64_data, values.size, mem_pool);
+    case DataType::TIME64NS:
+      return NativeToArrow<DataType::TIME64NS>(values.int64_data, values.size, mem_pool);
+    case DataType::FLOAT64:
+      return NativeToArrow<DataType::FLOAT64>(values.float64_data, values.size, mem_pool);
+    case DataType::BOOLEAN:
+      return NativeToArrow<DataType::BOOLEAN>(values.bool_data, values.size, mem_pool);
+    default:
+      return error::Internal("Unexpected type: $0", types::ToString(values.type));
+  }
+}
+
+template <typename T>
+void CompactSelection(const T* pred, SelectionVector* selection) {
+  size_t num_selected = 0;
+  for (size_t i = 0; i < selection->size(); ++i) {
+    if (pred[i]) {
+      (*selection)[num_selected++] = (*selection)[i];
+    }
+  }
+  selection->resize(num_selected);
+}
+
+}  // namespace
+
+FusedScalarExpressionEvaluator::FusedScalarExpressionEvaluator(
+    const plan::ConstScalarExpressionVector& expressions, udf::FunctionContext* function_ctx)
+    : ScalarExpressionEvaluator(expressions, function_ctx) {}
+
+FusedScalarExpressionEvaluator::~FusedScalarExpressionEvaluator() = default;
+
+Status FusedScalarExpressionEvaluator::Open(ExecState* exec_state) {
+  for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
+    auto udf = kv.second->Make();
+    id_to_udf_map_[kv.first] = std::move(udf);
+  }
+  roots_.clear();
+  for (const auto& expr : expressions_) {
+    PL_RETURN_IF_ERROR(InitFuncsInExpression(exec_state, expr));
+    PL_ASSIGN_OR_RETURN(auto root,
+                        CompileNode(exec_state, *expr, DataType::DATA_TYPE_UNKNOWN));
+    roots_.push_back(std::move(root));
+  }
+  return Status::OK();
+}
+
+Status FusedScalarExpressionEvaluator::Close(ExecState*) {
+  roots_.clear();
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<FusedExpressionNode>> FusedScalarExpressionEvaluator::CompileNode(
+    ExecState* exec_state, const plan::ScalarExpression& expr, DataType expected_type) {
+  auto node = std::make_unique<FusedExpressionNode>();
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kConstant: {
+      node->kind = FusedExpressionNode::Kind::kConstant;
+      node->constant = static_cast<const plan::ScalarValue*>(&expr);
+      node->type = node->constant->DataType();
+      return node;
+    }
+    case plan::Expression::kColumn: {
+      node->kind = FusedExpressionNode::Kind::kColumn;
+      node->column_idx = static_cast<const plan::Column&>(expr).Index();
+      node->type = expected_type;
+      return node;
+    }
+    case plan::Expression::kFunc:
+      break;
+    default:
+      return error::InvalidArgument("Unsupported expression: $0", expr.DebugString());
+  }
+
+  const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+  node->def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+  if (node->def == nullptr) {
+    return error::NotFound("No scalar UDF with id $0", fn.udf_id());
+  }
+  node->udf = id_to_udf_map_[fn.udf_id()].get();
+  node->type = node->def->exec_return_type();
+
+  const auto& arg_types = node->def->exec_arguments();
+  if (arg_types.size() != fn.arg_deps().size()) {
+    return error::InvalidArgument("Expected $0 arguments for $1, got $2", arg_types.size(),
+                                  expr.DebugString(), fn.arg_deps().size());
+  }
+  for (size_t i = 0; i < arg_types.size(); ++i) {
+    PL_ASSIGN_OR_RETURN(auto child, CompileNode(exec_state, *fn.arg_deps()[i], arg_types[i]));
+    node->children.push_back(std::move(child));
+  }
+
+  // Run the function on native arrays if its UDF has a batch Exec function, which it only has if
+  // all of its arguments and its result are fixed size values.
+  node->kind = node->def->HasExecBatch() ? FusedExpressionNode::Kind::kBatchUDF
+                                         : FusedExpressionNode::Kind::kUDF;
+  node->logical_and = fn.name() == kLogicalAndName && arg_types.size() == 2;
+  return node;
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateNode(ExecState* exec_state,
+                                                    FusedExpressionNode* node,
+                                                    const RowBatch& input,
+                                                    const SelectionVector& selection,
+                                                    FusedValues* values) {
+  size_t n = selection.size();
+  values->size = n;
+  values->type = node->type;
+  values->lane = LaneForType(node->type);
+
+  switch (node->kind) {
+    case FusedExpressionNode::Kind::kConstant: {
+      const plan::ScalarValue& constant = *node->constant;
+      values->constant = node->constant;
+      switch (values->type) {
+        case DataType::BOOLEAN:
+          values->int64_constant = constant.BoolValue();
+          break;
+        case DataType::INT64:
+          values->int64_constant = constant.Int64Value();
+          break;
+        case DataType::TIME64NS:
+          values->int64_constant = constant.Time64NSValue();
+          break;
+        case DataType::FLOAT64:
+          values->float64_constant = constant.Float64Value();
+          break;
+        default:
+          break;
+      }
+      return Status::OK();
+    }
+    case FusedExpressionNode::Kind::kColumn: {
+      auto arr = input.ColumnAt(node->column_idx);
+      values->type = types::ArrowToDataType(arr->type_id());
+      values->lane = LaneForType(values->type);
+      // The selection is sorted and unique, so it covers every row exactly when it has as many
+      // entries as the batch has rows.
+      bool all_rows = n == static_cast<size_t>(arr->length());
+      if (all_rows) {
+        values->array = arr;
+      }
+      switch (values->lane) {
+        case FusedLane::kInt64: {
+          const int64_t* raw = static_cast<const arrow::Int64Array*>(arr.get())->raw_values();
+          if (all_rows) {
+            values->int64_data = raw;
+            break;
+          }
+          node->int64_values.resize(n);
+          for (size_t i = 0; i < n; ++i) {
+            node->int64_values[i] = raw[selection[i]];
+          }
+          values->int64_data = node->int64_values.data();
+          break;
+        }
+        case FusedLane::kFloat64: {
+          const double* raw = static_cast<const arrow::DoubleArray*>(arr.get())->raw_values();
+          if (all_rows) {
+            values->float64_data = raw;
+            break;
+          }
+          node->float64_values.resize(n);
+          for (size_t i = 0; i < n; ++i) {
+            node->float64_values[i] = raw[selection[i]];
+          }
+          values->float64_data = node->float64_values.data();
+          break;
+        }
+        case FusedLane::kBool: {
+          // Arrow packs booleans into bits, so they are always unpacked.
+          const auto* bool_arr = static_cast<const arrow::BooleanArray*>(arr.get());
+          node->bool_values.resize(n);
+          for (size_t i = 0; i < n; ++i) {
+            node->bool_values[i] = bool_arr->Value(selection[i]);
+          }
+          values->bool_data = node->bool_values.data();
+          break;
+        }
+        default: {
+          if (all_rows) {
+            values->wrapper = ColumnWrapper::FromArrow(arr);
+            break;
+          }
+          auto wrapper = ColumnWrapper::Make(values->type, 0);
+          wrapper->Reserve(n);
+#define TYPE_CASE(_dt_)                                                               \
+  for (int64_t row : selection) {                                                     \
+    types::ExtractValueToColumnWrapper<_dt_>(wrapper.get(), arr.get(), row);          \
+  }
+          PL_SWITCH_FOREACH_DATATYPE(values->type, TYPE_CASE);
+#undef TYPE_CASE
+          values->wrapper = std::move(wrapper);
+          break;
+        }
+      }
+      return Status::OK();
+    }
+    case FusedExpressionNode::Kind::kBatchUDF: {
+      std::vector<FusedValues> args(node->children.size());
+      std::vector<const void*> arg_data(node->children.size());
+      const auto& arg_types = node->def->exec_arguments();
+      for (size_t i = 0; i < node->children.size(); ++i) {
+        FusedExpressionNode* child = node->children[i].get();
+        PL_RETURN_IF_ERROR(EvaluateNode(exec_state, child, input, selection, &args[i]));
+        if (args[i].lane != LaneForType(arg_types[i])) {
+          return error::Internal("Argument $0 of $1 is a $2, expected a $3", i,
+                                 node->def->name(), types::ToString(args[i].type),
+                                 types::ToString(arg_types[i]));
+        }
+        arg_data[i] = NativeData(child, &args[i]);
+      }
+      void* out = nullptr;
+      switch (values->lane) {
+        case FusedLane::kInt64:
+          node->int64_values.resize(n);
+          values->int64_data = node->int64_values.data();
+          out = node->int64_values.data();
+          break;
+        case FusedLane::kFloat64:
+          node->float64_values.resize(n);
+          values->float64_data = node->float64_values.data();
+          out = node->float64_values.data();
+          break;
+        case FusedLane::kBool:
+          node->bool_values.resize(n);
+          values->bool_data = node->bool_values.data();
+          out = node->bool_values.data();
+          break;
+        default:
+          return error::Internal("Batch Exec result without a native lane");
+      }
+      node->def->ExecBatchNative(arg_data, out, n);
+      return Status::OK();
+    }
+    case FusedExpressionNode::Kind::kUDF: {
+      std::vector<SharedColumnWrapper> children;
+      std::vector<const ColumnWrapper*> raw_children;
+      children.reserve(node->children.size());
+      raw_children.reserve(node->children.size());
+      for (const auto& child : node->children) {
+        FusedValues child_values;
+        PL_RETURN_IF_ERROR(EvaluateNode(exec_state, child.get(), input, selection, &child_values));
+        children.push_back(ToColumnWrapper(exec_state, child_values));
+        raw_children.push_back(children.back().get());
+      }
+      auto output = ColumnWrapper::Make(node->type, n);
+      PL_RETURN_IF_ERROR(node->def->ExecBatch(node->udf, function_ctx_, raw_children,
+                                              output.get(), n));
+      SetValuesFromColumnWrapper(std::move(output), values);
+      return Status::OK();
+    }
+  }
+  return error::Internal("Unknown fused expression node");
+}
+
+Status FusedScalarExpressionEvaluator::NarrowSelection(ExecState* exec_state,
+                                                       FusedExpressionNode* node,
+                                                       const RowBatch& input,
+                                                       SelectionVector* selection) {
+  if (node->logical_and) {
+    // Evaluate the right hand side only on the rows that passed the left hand side.
+    PL_RETURN_IF_ERROR(NarrowSelection(exec_state, node->children[0].get(), input, selection));
+    if (selection->empty()) {
+      return Status::OK();
+    }
+    return NarrowSelection(exec_state, node->children[1].get(), input, selection);
+  }
+
+  FusedValues values;
+  PL_RETURN_IF_ERROR(EvaluateNode(exec_state, node, input, *selection, &values));
+  if (values.constant != nullptr) {
+    if (values.int64_constant == 0) {
+      selection->clear();
+    }
+    return Status::OK();
+  }
+  switch (values.lane) {
+    case FusedLane::kBool:
+      CompactSelection(values.bool_data, selection);
+      return Status::OK();
+    case FusedLane::kInt64:
+      CompactSelection(values.int64_data, selection);
+      return Status::OK();
+    default:
+      return error::InvalidArgument("Predicate expression must be a boolean, got $0",
+                                    types::ToString(values.type));
+  }
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateSelection(ExecState* exec_state,
+                                                         const RowBatch& input, size_t expr_idx,
+                                                         SelectionVector* selection) {
+  DCHECK_LT(expr_idx, roots_.size());
+  if (selection->empty()) {
+    return Status::OK();
+  }
+  return NarrowSelection(exec_state, roots_[expr_idx].get(), input, selection);
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateRoot(ExecState* exec_state, size_t expr_idx,
+                                                    const RowBatch& input,
+                                                    const SelectionVector& selection,
+                                                    RowBatch* output) {
+  FusedValues values;
+  PL_RETURN_IF_ERROR(
+      EvaluateNode(exec_state, roots_[expr_idx].get(), input, selection, &values));
+  PL_ASSIGN_OR_RETURN(auto arr, ToArrow(exec_state, values));
+  return output->AddColumn(arr);
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateSelected(ExecState* exec_state,
+                                                        const RowBatch& input,
+                                                        const SelectionVector& selection,
+                                                        RowBatch* output) {
+  CHECK(output != nullptr);
+  CHECK_EQ(static_cast<size_t>(output->num_rows()), selection.size());
+  for (size_t expr_idx = 0; expr_idx < roots_.size(); ++expr_idx) {
+    PL_RETURN_IF_ERROR(EvaluateRoot(exec_state, expr_idx, input, selection, output));
+  }
+  return Status::OK();
+}
+
+Status FusedScalarExpressionEvaluator::Evaluate(ExecState* exec_state, const RowBatch& input,
+                                                RowBatch* output) {
+  CHECK(exec_state != nullptr);
+  CHECK(output != nullptr);
+  CHECK_EQ(static_cast<size_t>(output->num_columns()), expressions_.size());
+  all_rows_.resize(input.num_rows());
+  std::iota(all_rows_.begin(), all_rows_.end(), 0);
+  return EvaluateSelected(exec_state, input, all_rows_, output);
+}
+
+Status FusedScalarExpressionEvaluator::EvaluateSingleExpression(ExecState* exec_state,
+                                                                const RowBatch& input,
+                                                                const plan::ScalarExpression& expr,
+                                                                RowBatch* output) {
+  for (size_t expr_idx = 0; expr_idx < expressions_.size(); ++expr_idx) {
+    if (expressions_[expr_idx].get() == &expr) {
+      all_rows_.resize(input.num_rows());
+      std::iota(all_rows_.begin(), all_rows_.end(), 0);
+      return EvaluateRoot(exec_state, expr_idx, input, all_rows_, output);
+    }
+  }
+  return error::InvalidArgument("Expression is not part of this evaluator: $0",
+                                expr.DebugString());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
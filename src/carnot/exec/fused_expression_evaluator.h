@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/carnot/udf/base.h"
+#include "src/common/base/base.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_bool(carnot_fused_expression_evaluator);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+struct FusedExpressionNode;
+struct FusedValues;
+
+/**
+ * A scalar expression evaluator that compiles each expression tree once on Open and evaluates it
+ * over a selection vector.
+ *
+ * Functions whose UDF has a batch Exec function run it on native C++ arrays that are reused across
+ * row batches, reading the input arrow arrays in place, so the intermediate values of an expression
+ * are never turned into arrow arrays or column wrappers. All other functions run through the UDF's
+ * ExecBatch on column wrappers. Predicates shrink the selection as they are evaluated, so the right
+ * hand side of a logicalAnd only sees the rows the left hand side kept.
+ *
+ * Because it evaluates the selected rows of a row batch in place, Filter nodes that use it can hand
+ * the rows they keep to the Map and Filter nodes after them without copying them, see
+ * ExecNode::ConsumeNextSelected.
+ */
+class FusedScalarExpressionEvaluator : public ScalarExpressionEvaluator {
+ public:
+  explicit FusedScalarExpressionEvaluator(const plan::ConstScalarExpressionVector& expressions,
+                                          udf::FunctionContext* function_ctx);
+  ~FusedScalarExpressionEvaluator() override;
+
+  Status Open(ExecState* exec_state) override;
+  Status Close(ExecState* exec_state) override;
+  Status Evaluate(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                  table_store::schema::RowBatch* output) override;
+
+  /**
+   * Narrows the selection down to the rows for which the boolean expression at expr_idx is true.
+   * @param exec_state The execution state.
+   * @param input The input RowBatch.
+   * @param expr_idx The index of the predicate in the expressions of this evaluator.
+   * @param selection The rows to evaluate the predicate on, updated in place.
+   * @return Status of the evaluation.
+   */
+  Status EvaluateSelection(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                           size_t expr_idx, SelectionVector* selection);
+
+  /**
+   * Evaluates all of the expressions on the selected rows of the input, adding one column per
+   * expression to the output. The output must have selection.size() rows.
+   */
+  Status EvaluateSelected(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                          const SelectionVector& selection, table_store::schema::RowBatch* output);
+
+ protected:
+  Status EvaluateSingleExpression(ExecState* exec_state, const table_store::schema::RowBatch& input,
+                                  const plan::ScalarExpression& expr,
+                                  table_store::schema::RowBatch* output) override;
+
+ private:
+  StatusOr<std::unique_ptr<FusedExpressionNode>> CompileNode(ExecState* exec_state,
+                                                             const plan::ScalarExpression& expr,
+                                                             types::DataType expected_type);
+  Status EvaluateNode(ExecState* exec_state, FusedExpressionNode* node,
+                      const table_store::schema::RowBatch& input, const SelectionVector& selection,
+                      FusedValues* values);
+  Status NarrowSelection(ExecState* exec_state, FusedExpressionNode* node,
+                         const table_store::schema::RowBatch& input, SelectionVector* selection);
+  Status EvaluateRoot(ExecState* exec_state, size_t expr_idx,
+                      const table_store::schema::RowBatch& input, const SelectionVector& selection,
+                      table_store::schema::RowBatch* output);
+
+  // The compiled expressions, in the same order as expressions_.
+  std::vector<std::unique_ptr<FusedExpressionNode>> roots_;
+  // Selection of every row of the current batch, reused across row batches.
+  SelectionVector all_rows_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
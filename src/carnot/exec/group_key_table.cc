@@ -0,0 +1,273 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/group_key_table.h"
+
+#include <farmhash.h>
+#include <string.h>
+
+#include <algorithm>
+
+#include "src/common/base/hash_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+namespace {
+
+// Must be a power of two, since slots are addressed by masking the hash.
+constexpr size_t kInitialSlotCapacity = 1024;
+
+inline uint64_t CombineColumnHash(bool first_col, uint64_t prev_hash, uint64_t col_hash) {
+  return first_col ? col_hash : ::px::HashCombine(prev_hash, col_hash);
+}
+
+/**
+ * The key operations for fixed size types. Values are compared and hashed on the bytes of the
+ * underlying value, which matches the semantics of RowTuple.
+ */
+template <types::DataType DT>
+struct GroupKeyOps {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  using ArrowBuilder = typename types::DataTypeTraits<DT>::arrow_builder_type;
+
+  static void HashColumn(const arrow::Array* arr, int64_t num_rows, bool first_col,
+                         uint64_t* hashes) {
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      ValueType val = types::GetValueFromArrowArray<DT>(arr, row_idx);
+      uint64_t hash = ::util::Hash64(reinterpret_cast<const char*>(&val.val), sizeof(val.val));
+      hashes[row_idx] = CombineColumnHash(first_col, hashes[row_idx], hash);
+    }
+  }
+
+  static bool KeyEq(const GroupKeyColumn& col, int64_t group_id, const arrow::Array* arr,
+                    int64_t row_idx) {
+    ValueType val = types::GetValueFromArrowArray<DT>(arr, row_idx);
+    const auto& stored = types::Get<ValueType>(col.fixed_values[group_id]);
+    return memcmp(&stored.val, &val.val, sizeof(val.val)) == 0;
+  }
+
+  static void AppendKey(GroupKeyColumn* col, const arrow::Array* arr, int64_t row_idx) {
+    auto& u = col->fixed_values.emplace_back();
+    // Zero the union so that smaller types don't leave garbage in the unused bytes.
+    memset(reinterpret_cast<uint8_t*>(&u), 0, sizeof(types::FixedSizeValueUnion));
+    types::SetValue<ValueType>(&u, types::GetValueFromArrowArray<DT>(arr, row_idx));
+  }
+
+  static Status AppendToBuilder(const GroupKeyColumn& col, int64_t num_groups,
+                                arrow::ArrayBuilder* builder) {
+    auto* typed_builder = static_cast<ArrowBuilder*>(builder);
+    PL_RETURN_IF_ERROR(typed_builder->Reserve(num_groups));
+    for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+      typed_builder->UnsafeAppend(types::Get<ValueType>(col.fixed_values[group_id]).val);
+    }
+    return Status::OK();
+  }
+};
+
+/**
+ * Strings are read straight from the arrow value buffer, without creating a std::string per row.
+ * PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+ */
+template <>
+struct GroupKeyOps<types::DataType::STRING> {
+  static void HashColumn(const arrow::Array* arr, int64_t num_rows, bool first_col,
+                         uint64_t* hashes) {
+    auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      int32_t len = 0;
+      const uint8_t* data = str_arr->GetValue(row_idx, &len);
+      uint64_t hash = ::util::Hash64(reinterpret_cast<const char*>(data), len);
+      hashes[row_idx] = CombineColumnHash(first_col, hashes[row_idx], hash);
+    }
+  }
+
+  static bool KeyEq(const GroupKeyColumn& col, int64_t group_id, const arrow::Array* arr,
+                    int64_t row_idx) {
+    auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    int32_t len = 0;
+    const uint8_t* data = str_arr->GetValue(row_idx, &len);
+    int64_t start = col.offsets[group_id];
+    if (col.offsets[group_id + 1] - start != len) {
+      return false;
+    }
+    return memcmp(col.arena.data() + start, data, len) == 0;
+  }
+
+  static void AppendKey(GroupKeyColumn* col, const arrow::Array* arr, int64_t row_idx) {
+    auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+    int32_t len = 0;
+    const uint8_t* data = str_arr->GetValue(row_idx, &len);
+    col->arena.append(reinterpret_cast<const char*>(data), len);
+    col->offsets.push_back(col->arena.size());
+  }
+
+  static Status AppendToBuilder(const GroupKeyColumn& col, int64_t num_groups,
+                                arrow::ArrayBuilder* builder) {
+    auto* typed_builder = static_cast<arrow::StringBuilder*>(builder);
+    PL_RETURN_IF_ERROR(typed_builder->Reserve(num_groups));
+    PL_RETURN_IF_ERROR(typed_builder->ReserveData(col.arena.size()));
+    for (int64_t group_id = 0; group_id < num_groups; ++group_id) {
+      int64_t start = col.offsets[group_id];
+      typed_builder->UnsafeAppend(col.arena.data() + start,
+                                  static_cast<int32_t>(col.offsets[group_id + 1] - start));
+    }
+    return Status::OK();
+  }
+};
+
+}  // namespace
+
+void HashKeyColumns(const std::vector<types::DataType>& key_types,
+                    const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    std::vector<uint64_t>* hashes) {
+  DCHECK_EQ(key_types.size(), key_cols.size());
+  hashes->resize(num_rows);
+  for (size_t key_idx = 0; key_idx < key_cols.size(); ++key_idx) {
+#define TYPE_CASE(_dt_) \
+  GroupKeyOps<_dt_>::HashColumn(key_cols[key_idx], num_rows, key_idx == 0, hashes->data());
+    PL_SWITCH_FOREACH_DATATYPE(key_types[key_idx], TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+GroupKeyTable::GroupKeyTable(const std::vector<types::DataType>& key_types) {
+  key_columns_.reserve(key_types.size());
+  for (const auto& key_type : key_types) {
+    key_columns_.emplace_back(key_type);
+#define TYPE_CASE(_dt_)                                                   \
+  hash_fns_.push_back(&GroupKeyOps<_dt_>::HashColumn);                    \
+  key_eq_fns_.push_back(&GroupKeyOps<_dt_>::KeyEq);                       \
+  append_key_fns_.push_back(&GroupKeyOps<_dt_>::AppendKey);               \
+  append_to_builder_fns_.push_back(&GroupKeyOps<_dt_>::AppendToBuilder);
+    PL_SWITCH_FOREACH_DATATYPE(key_type, TYPE_CASE);
+#undef TYPE_CASE
+  }
+  slots_.resize(kInitialSlotCapacity);
+}
+
+void GroupKeyTable::FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols,
+                                      int64_t num_rows, std::vector<int64_t>* group_ids) {
+  LookupBatch(key_cols, num_rows, /* insert */ true, group_ids);
+}
+
+void GroupKeyTable::FindBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                              std::vector<int64_t>* group_ids) {
+  LookupBatch(key_cols, num_rows, /* insert */ false, group_ids);
+}
+
+void GroupKeyTable::LookupBatch(const std::vector<const arrow::Array*>& key_cols,
+                                int64_t num_rows, bool insert, std::vector<int64_t>* group_ids) {
+  DCHECK_EQ(key_cols.size(), key_columns_.size());
+  DCHECK(group_ids != nullptr);
+  group_ids->resize(num_rows);
+  row_hashes_.resize(num_rows);
+
+  // Hash the whole batch a column at a time.
+  for (size_t key_idx = 0; key_idx < key_cols.size(); ++key_idx) {
+    hash_fns_[key_idx](key_cols[key_idx], num_rows, key_idx == 0, row_hashes_.data());
+  }
+
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    uint64_t hash = row_hashes_[row_idx];
+    size_t mask = slots_.size() - 1;
+    size_t slot_idx = hash & mask;
+    while (true) {
+      const Slot& slot = slots_[slot_idx];
+      if (slot.group_id < 0) {
+        (*group_ids)[row_idx] = insert ? InsertGroup(slot_idx, hash, key_cols, row_idx) : -1;
+        break;
+      }
+      if (slot.hash == hash && KeysEqual(slot.group_id, key_cols, row_idx)) {
+        (*group_ids)[row_idx] = slot.group_id;
+        break;
+      }
+      slot_idx = (slot_idx + 1) & mask;
+    }
+  }
+}
+
+bool GroupKeyTable::KeysEqual(int64_t group_id, const std::vector<const arrow::Array*>& key_cols,
+                              int64_t row_idx) const {
+  for (size_t key_idx = 0; key_idx < key_cols.size(); ++key_idx) {
+    if (!key_eq_fns_[key_idx](key_columns_[key_idx], group_id, key_cols[key_idx], row_idx)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int64_t GroupKeyTable::InsertGroup(size_t slot_idx, uint64_t hash,
+                                   const std::vector<const arrow::Array*>& key_cols,
+                                   int64_t row_idx) {
+  int64_t group_id = num_groups_++;
+  slots_[slot_idx] = Slot{hash, group_id};
+  group_hashes_.push_back(hash);
+  for (size_t key_idx = 0; key_idx < key_cols.size(); ++key_idx) {
+    append_key_fns_[key_idx](&key_columns_[key_idx], key_cols[key_idx], row_idx);
+  }
+  // Keep the load factor at or below 0.5 so that probe sequences stay short.
+  if (static_cast<size_t>(num_groups_) * 2 > slots_.size()) {
+    Rehash(slots_.size() * 2);
+  }
+  return group_id;
+}
+
+void GroupKeyTable::Rehash(size_t new_capacity) {
+  slots_.assign(new_capacity, Slot{});
+  size_t mask = new_capacity - 1;
+  for (int64_t group_id = 0; group_id < num_groups_; ++group_id) {
+    uint64_t hash = group_hashes_[group_id];
+    size_t slot_idx = hash & mask;
+    while (slots_[slot_idx].group_id >= 0) {
+      slot_idx = (slot_idx + 1) & mask;
+    }
+    slots_[slot_idx] = Slot{hash, group_id};
+  }
+}
+
+Status GroupKeyTable::AppendKeysToBuilder(size_t key_idx, arrow::ArrayBuilder* builder) const {
+  DCHECK_LT(key_idx, key_columns_.size());
+  DCHECK(builder != nullptr);
+  return append_to_builder_fns_[key_idx](key_columns_[key_idx], num_groups_, builder);
+}
+
+int64_t GroupKeyTable::NumBytes() const {
+  int64_t bytes = slots_.capacity() * sizeof(Slot) + group_hashes_.capacity() * sizeof(uint64_t);
+  for (const auto& col : key_columns_) {
+    bytes += col.fixed_values.capacity() * sizeof(types::FixedSizeValueUnion) +
+             col.arena.capacity() + col.offsets.capacity() * sizeof(int64_t);
+  }
+  return bytes;
+}
+
+void GroupKeyTable::Clear() {
+  for (auto& col : key_columns_) {
+    col.Clear();
+  }
+  std::fill(slots_.begin(), slots_.end(), Slot{});
+  group_hashes_.clear();
+  num_groups_ = 0;
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
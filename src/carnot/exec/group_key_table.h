@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/builder.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Column-wise storage for the keys of a GroupKeyTable. Fixed size keys are stored inline in
+ * fixed_values, string keys are appended to a single arena and addressed by offsets.
+ */
+struct GroupKeyColumn {
+  explicit GroupKeyColumn(types::DataType type) : type(type) { Clear(); }
+
+  void Clear() {
+    fixed_values.clear();
+    arena.clear();
+    offsets.assign(1, 0);
+  }
+
+  types::DataType type;
+  std::vector<types::FixedSizeValueUnion> fixed_values;
+  // Only used by variable sized types. The value of group i is arena[offsets[i], offsets[i+1]).
+  std::string arena;
+  std::vector<int64_t> offsets;
+};
+
+/**
+ * Computes the combined hash of the key columns for every row, the same hash that GroupKeyTable
+ * uses to place keys.
+ *
+ * @param key_types The data types of the key columns.
+ * @param key_cols The key columns.
+ * @param num_rows The number of rows in each of the key columns.
+ * @param hashes Output vector, resized to num_rows.
+ */
+void HashKeyColumns(const std::vector<types::DataType>& key_types,
+                    const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                    std::vector<uint64_t>* hashes);
+
+/**
+ * GroupKeyTable maps the group by keys of input rows to dense group ids [0, num_groups()).
+ *
+ * Unlike AbslRowTupleHashMap, keys are never materialized per row: the key columns of a row batch
+ * are hashed a column at a time straight out of the arrow arrays, and rows are only copied into
+ * the table when they introduce a new group. Lookups go through an open addressing (linear
+ * probing) table whose slots only hold the hash and the group id of the entry.
+ */
+class GroupKeyTable : public NotCopyable {
+ public:
+  explicit GroupKeyTable(const std::vector<types::DataType>& key_types);
+
+  /**
+   * Finds the group of every row in the passed in key columns, creating new groups for keys that
+   * have not been seen before.
+   *
+   * @param key_cols The key columns, in the same order as the key types of the table.
+   * @param num_rows The number of rows in each of the key columns.
+   * @param group_ids Output vector, resized to num_rows and filled with the group id of each row.
+   */
+  void FindOrInsertBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                         std::vector<int64_t>* group_ids);
+
+  /**
+   * Same as FindOrInsertBatch, except that keys that aren't in the table are not inserted and
+   * get a group id of -1.
+   */
+  void FindBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows,
+                 std::vector<int64_t>* group_ids);
+
+  /**
+   * Appends the value of the key at key_idx for every group (in group id order) to the builder.
+   * The builder must be of the arrow type matching the key type.
+   */
+  Status AppendKeysToBuilder(size_t key_idx, arrow::ArrayBuilder* builder) const;
+
+  /**
+   * Removes all the groups from the table, keeping the allocated memory around for reuse.
+   */
+  void Clear();
+
+  int64_t num_groups() const { return num_groups_; }
+
+  /**
+   * @return An estimate of the memory held by the table, in bytes.
+   */
+  int64_t NumBytes() const;
+
+ private:
+  using HashColumnFn = void (*)(const arrow::Array* arr, int64_t num_rows, bool first_col,
+                                uint64_t* hashes);
+  using KeyEqFn = bool (*)(const GroupKeyColumn& col, int64_t group_id, const arrow::Array* arr,
+                           int64_t row_idx);
+  using AppendKeyFn = void (*)(GroupKeyColumn* col, const arrow::Array* arr, int64_t row_idx);
+  using AppendToBuilderFn = Status (*)(const GroupKeyColumn& col, int64_t num_groups,
+                                       arrow::ArrayBuilder* builder);
+
+  struct Slot {
+    uint64_t hash = 0;
+    // -1 marks an empty slot.
+    int64_t group_id = -1;
+  };
+
+  void LookupBatch(const std::vector<const arrow::Array*>& key_cols, int64_t num_rows, bool insert,
+                   std::vector<int64_t>* group_ids);
+  bool KeysEqual(int64_t group_id, const std::vector<const arrow::Array*>& key_cols,
+                 int64_t row_idx) const;
+  int64_t InsertGroup(size_t slot_idx, uint64_t hash,
+                      const std::vector<const arrow::Array*>& key_cols, int64_t row_idx);
+  void Rehash(size_t new_capacity);
+
+  std::vector<GroupKeyColumn> key_columns_;
+
+  // Type specialized functions for each of the key columns, resolved once at construction so
+  // that the per row loops don't have to switch on the data type.
+  std::vector<HashColumnFn> hash_fns_;
+  std::vector<KeyEqFn> key_eq_fns_;
+  std::vector<AppendKeyFn> append_key_fns_;
+  std::vector<AppendToBuilderFn> append_to_builder_fns_;
+
+  std::vector<Slot> slots_;
+  // The hash of each group, used to rebuild the slots when the table grows.
+  std::vector<uint64_t> group_hashes_;
+  int64_t num_groups_ = 0;
+
+  // Scratch space for the row hashes of the batch being processed.
+  std::vector<uint64_t> row_hashes_;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using ::testing::ElementsAre;
+
+TEST(GroupKeyTableTest, single_int_key) {
+  GroupKeyTable table({types::DataType::INT64});
+  auto col = types::ToArrow(std::vector<types::Int64Value>{5, 3, 5, 7, 3},
+                            arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 0, 2, 1));
+  EXPECT_EQ(3, table.num_groups());
+
+  // Groups are stable across batches.
+  auto col2 =
+      types::ToArrow(std::vector<types::Int64Value>{7, 9, 5}, arrow::default_memory_pool());
+  table.FindOrInsertBatch({col2.get()}, col2->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(2, 3, 0));
+  EXPECT_EQ(4, table.num_groups());
+
+  arrow::Int64Builder builder;
+  EXPECT_OK(table.AppendKeysToBuilder(0, &builder));
+  std::shared_ptr<arrow::Array> out;
+  ASSERT_TRUE(builder.Finish(&out).ok());
+  auto* out_ints = static_cast<arrow::Int64Array*>(out.get());
+  ASSERT_EQ(4, out_ints->length());
+  EXPECT_EQ(5, out_ints->Value(0));
+  EXPECT_EQ(3, out_ints->Value(1));
+  EXPECT_EQ(7, out_ints->Value(2));
+  EXPECT_EQ(9, out_ints->Value(3));
+}
+
+TEST(GroupKeyTableTest, string_and_int_keys) {
+  GroupKeyTable table({types::DataType::STRING, types::DataType::INT64});
+  auto str_col = types::ToArrow(std::vector<types::StringValue>{"abc", "abc", "", "abc", ""},
+                                arrow::default_memory_pool());
+  auto int_col = types::ToArrow(std::vector<types::Int64Value>{1, 2, 1, 1, 1},
+                                arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({str_col.get(), int_col.get()}, str_col->length(), &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0, 1, 2, 0, 2));
+
+  arrow::StringBuilder builder;
+  EXPECT_OK(table.AppendKeysToBuilder(0, &builder));
+  std::shared_ptr<arrow::Array> out;
+  ASSERT_TRUE(builder.Finish(&out).ok());
+  auto* out_strs = static_cast<arrow::StringArray*>(out.get());
+  ASSERT_EQ(3, out_strs->length());
+  EXPECT_EQ("abc", out_strs->GetString(0));
+  EXPECT_EQ("abc", out_strs->GetString(1));
+  EXPECT_EQ("", out_strs->GetString(2));
+}
+
+TEST(GroupKeyTableTest, grows_past_initial_capacity) {
+  GroupKeyTable table({types::DataType::INT64});
+  constexpr int64_t kNumGroups = 10000;
+  std::vector<types::Int64Value> vals;
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    vals.emplace_back(i * 31);
+  }
+  auto col = types::ToArrow(vals, arrow::default_memory_pool());
+
+  std::vector<int64_t> group_ids;
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+  EXPECT_EQ(kNumGroups, table.num_groups());
+
+  // Looking the same keys up again must map them onto the same groups.
+  table.FindOrInsertBatch({col.get()}, col->length(), &group_ids);
+  EXPECT_EQ(kNumGroups, table.num_groups());
+  for (int64_t i = 0; i < kNumGroups; ++i) {
+    EXPECT_EQ(i, group_ids[i]);
+  }
+
+  table.Clear();
+  EXPECT_EQ(0, table.num_groups());
+  table.FindOrInsertBatch({col.get()}, 1, &group_ids);
+  EXPECT_THAT(group_ids, ElementsAre(0));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -46,8 +46,14 @@ Status MapNode::InitImpl(const plan::Operator& plan_node) {
 }
 Status MapNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
-  evaluator_ = ScalarExpressionEvaluator::Create(
-      plan_node_->expressions(), ScalarExpressionEvaluatorType::kArrowNative, function_ctx_.get());
+  auto evaluator_type = FLAGS_carnot_fused_expression_evaluator
+                            ? ScalarExpressionEvaluatorType::kFused
+                            : ScalarExpressionEvaluatorType::kArrowNative;
+  evaluator_ = ScalarExpressionEvaluator::Create(plan_node_->expressions(), evaluator_type,
+                                                 function_ctx_.get());
+  if (evaluator_type == ScalarExpressionEvaluatorType::kFused) {
+    fused_evaluator_ = static_cast<FusedScalarExpressionEvaluator*>(evaluator_.get());
+  }
   return Status::OK();
 }
 
@@ -70,6 +76,17 @@ Status MapNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
   return Status::OK();
 }
 
+Status MapNode::ConsumeNextSelectedImpl(ExecState* exec_state, const RowBatch& rb,
+                                        const SelectionVector& selection, size_t) {
+  // The expressions are only evaluated on the selected rows, which is where they get compacted.
+  RowBatch output_rb(*output_descriptor_, selection.size());
+  PL_RETURN_IF_ERROR(fused_evaluator_->EvaluateSelected(exec_state, rb, selection, &output_rb));
+  output_rb.set_eow(rb.eow());
+  output_rb.set_eos(rb.eos());
+  PL_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  return Status::OK();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
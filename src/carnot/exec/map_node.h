@@ -26,6 +26,7 @@
 #include "src/carnot/exec/exec_node.h"
 #include "src/carnot/exec/exec_state.h"
 #include "src/carnot/exec/expression_evaluator.h"
+#include "src/carnot/exec/fused_expression_evaluator.h"
 #include "src/carnot/plan/operators.h"
 #include "src/carnot/udf/base.h"
 #include "src/common/base/base.h"
@@ -41,6 +42,8 @@ class MapNode : public ProcessingNode {
   MapNode() = default;
   virtual ~MapNode() = default;
 
+  bool ConsumesSelections() const override { return fused_evaluator_ != nullptr; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -49,9 +52,13 @@ class MapNode : public ProcessingNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
+  Status ConsumeNextSelectedImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                                 const SelectionVector& selection, size_t parent_index) override;
 
  private:
   std::unique_ptr<ExpressionEvaluator> evaluator_;
+  // Set to evaluator_ when it is a fused evaluator.
+  FusedScalarExpressionEvaluator* fused_evaluator_ = nullptr;
   std::unique_ptr<plan::MapOperator> plan_node_;
   std::unique_ptr<udf::FunctionContext> function_ctx_;
 };
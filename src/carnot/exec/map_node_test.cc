@@ -98,6 +98,33 @@ TEST_F(MapNodeTest, basic) {
       .Close();
 }
 
+TEST_F(MapNodeTest, fused_consume_selected) {
+  FLAGS_carnot_fused_expression_evaluator = true;
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+  RowDescriptor output_rd({types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<MapNode, plan::MapOperator>(*plan_node_, output_rd, {},
+                                                                 exec_state_.get());
+  EXPECT_TRUE(tester.node()->ConsumesSelections());
+  tester
+      .ConsumeNextSelected(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                               .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                               .AddColumn<types::Int64Value>({1, 3, 6, 9})
+                               .get(),
+                           {1, 3}, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 2, false, false).AddColumn<types::Int64Value>({5, 13}).get())
+      .ConsumeNextSelected(RowBatchBuilder(input_rd, 3, true, true)
+                               .AddColumn<types::Int64Value>({1, 2, 3})
+                               .AddColumn<types::Int64Value>({1, 4, 6})
+                               .get(),
+                           {}, 0)
+      .ExpectRowBatch(
+          RowBatchBuilder(output_rd, 0, true, true).AddColumn<types::Int64Value>({}).get())
+      .Close();
+  FLAGS_carnot_fused_expression_evaluator = false;
+}
+
 TEST_F(MapNodeTest, zero_row_row_batch) {
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
   RowDescriptor output_rd({types::DataType::INT64});
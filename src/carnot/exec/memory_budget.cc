@@ -0,0 +1,28 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/memory_budget.h"
+
+DEFINE_int64(carnot_query_memory_budget_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_QUERY_MEMORY_BUDGET_BYTES", 0),
+             "The memory budget of the blocking operators (aggregates, joins) of a single query. "
+             "Operators spill their state to --carnot_spill_dir once the budget is exceeded. "
+             "Spilled state is split into 16 hash partitions, and each is read back whole, without "
+             "further partitioning, so a skewed partition can still exceed the budget. Joins "
+             "ordered by time never spill their build rows and may also exceed it. "
+             "0 means unlimited.");
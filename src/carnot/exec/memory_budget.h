@@ -0,0 +1,132 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "src/common/base/base.h"
+
+DECLARE_int64(carnot_query_memory_budget_bytes);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * QueryMemoryBudget tracks the memory held by the blocking operators (aggregates and joins) of a
+ * single query against a fixed budget. Operators that fail to reserve more memory switch to
+ * spilling their state to disk.
+ *
+ * A budget of zero (or less) means the query is unlimited and every reservation succeeds.
+ */
+class QueryMemoryBudget : public NotCopyable {
+ public:
+  explicit QueryMemoryBudget(int64_t budget_bytes) : budget_bytes_(budget_bytes) {}
+
+  /**
+   * Reserves bytes against the budget.
+   * @return false (and reserves nothing) if the reservation would exceed the budget.
+   */
+  bool TryReserve(int64_t bytes) {
+    int64_t used = used_bytes_.load();
+    do {
+      if (budget_bytes_ > 0 && used + bytes > budget_bytes_) {
+        return false;
+      }
+    } while (!used_bytes_.compare_exchange_weak(used, used + bytes));
+    UpdatePeak(used + bytes);
+    return true;
+  }
+
+  void Release(int64_t bytes) {
+    DCHECK_GE(used_bytes_.load(), bytes);
+    used_bytes_ -= bytes;
+  }
+
+  bool unlimited() const { return budget_bytes_ <= 0; }
+  int64_t budget_bytes() const { return budget_bytes_; }
+  void set_budget_bytes(int64_t budget_bytes) { budget_bytes_ = budget_bytes; }
+  int64_t used_bytes() const { return used_bytes_.load(); }
+  int64_t peak_bytes() const { return peak_bytes_.load(); }
+
+ private:
+  void UpdatePeak(int64_t used) {
+    int64_t peak = peak_bytes_.load();
+    while (used > peak && !peak_bytes_.compare_exchange_weak(peak, used)) {
+    }
+  }
+
+  int64_t budget_bytes_;
+  std::atomic<int64_t> used_bytes_ = 0;
+  std::atomic<int64_t> peak_bytes_ = 0;
+};
+
+/**
+ * MemoryReservation is an operator's share of a QueryMemoryBudget. The reservation is resized as
+ * the operator's state grows and shrinks, and is returned to the budget on destruction.
+ */
+class MemoryReservation : public NotCopyable {
+ public:
+  MemoryReservation() = default;
+  explicit MemoryReservation(QueryMemoryBudget* budget) : budget_(budget) {}
+  ~MemoryReservation() { Reset(); }
+
+  void set_budget(QueryMemoryBudget* budget) {
+    Reset();
+    budget_ = budget;
+  }
+
+  /**
+   * Resizes the reservation to the given number of bytes.
+   * @return false if growing the reservation would exceed the budget, in which case the
+   * reservation is left unchanged.
+   */
+  bool TryResize(int64_t bytes) {
+    if (budget_ == nullptr) {
+      return true;
+    }
+    if (bytes > reserved_bytes_) {
+      if (!budget_->TryReserve(bytes - reserved_bytes_)) {
+        return false;
+      }
+    } else {
+      budget_->Release(reserved_bytes_ - bytes);
+    }
+    reserved_bytes_ = bytes;
+    return true;
+  }
+
+  void Reset() {
+    if (budget_ != nullptr && reserved_bytes_ > 0) {
+      budget_->Release(reserved_bytes_);
+    }
+    reserved_bytes_ = 0;
+  }
+
+  int64_t reserved_bytes() const { return reserved_bytes_; }
+
+ private:
+  QueryMemoryBudget* budget_ = nullptr;
+  int64_t reserved_bytes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -20,17 +20,77 @@
 
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
+#include "src/shared/types/type_utils.h"
 
 namespace px {
 namespace carnot {
 namespace exec {
 
+namespace {
+
+StatusOr<table_store::ColumnPredicate> ConvertPredicate(const planpb::ColumnPredicate& pb) {
+  table_store::ColumnPredicate predicate;
+  predicate.col_idx = pb.column_idx();
+  switch (pb.op()) {
+    case planpb::ColumnPredicate::EQUAL:
+      predicate.op = table_store::ColumnPredicate::Op::kEqual;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN:
+      predicate.op = table_store::ColumnPredicate::Op::kLessThan;
+      break;
+    case planpb::ColumnPredicate::LESS_THAN_EQUAL:
+      predicate.op = table_store::ColumnPredicate::Op::kLessThanEqual;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN:
+      predicate.op = table_store::ColumnPredicate::Op::kGreaterThan;
+      break;
+    case planpb::ColumnPredicate::GREATER_THAN_EQUAL:
+      predicate.op = table_store::ColumnPredicate::Op::kGreaterThanEqual;
+      break;
+    default:
+      return error::InvalidArgument("Unknown column predicate op: $0",
+                                    planpb::ColumnPredicate::Op_Name(pb.op()));
+  }
+
+  const auto& value = pb.value();
+  predicate.type = value.data_type();
+  switch (value.data_type()) {
+    case types::DataType::BOOLEAN:
+      predicate.int64_value = value.bool_value();
+      break;
+    case types::DataType::INT64:
+      predicate.int64_value = value.int64_value();
+      break;
+    case types::DataType::TIME64NS:
+      predicate.int64_value = value.time64_ns_value();
+      break;
+    case types::DataType::FLOAT64:
+      predicate.float64_value = value.float64_value();
+      break;
+    case types::DataType::STRING:
+      predicate.string_value = value.string_value();
+      break;
+    case types::DataType::UINT128:
+      predicate.uint128_value =
+          absl::MakeUint128(value.uint128_value().high(), value.uint128_value().low());
+      break;
+    default:
+      return error::InvalidArgument("Unsupported column predicate type: $0",
+                                    types::ToString(value.data_type()));
+  }
+  return predicate;
+}
+
+}  // namespace
+
 std::string MemorySourceNode::DebugStringImpl() {
   return absl::Substitute("Exec::MemorySourceNode: <name: $0, output: $1>", plan_node_->TableName(),
                           output_descriptor_->DebugString());
@@ -42,6 +102,10 @@ Status MemorySourceNode::InitImpl(const plan::Operator& plan_node) {
   // copy the plan node to local object;
   plan_node_ = std::make_unique<plan::MemorySourceOperator>(*source_plan_node);
 
+  for (const auto& predicate_pb : plan_node_->predicates()) {
+    PL_ASSIGN_OR_RETURN(auto predicate, ConvertPredicate(predicate_pb));
+    predicates_.push_back(std::move(predicate));
+  }
   return Status::OK();
 }
 
@@ -72,15 +136,35 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
     stop_ = table_->End();
   }
   current_batch_ = table_->SliceIfPastStop(current_batch_, stop_);
+  SkipNonMatchingBatches();
 
   return Status::OK();
 }
 
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("infinite_stream", infinite_stream_ ? "true" : "false");
+  if (!predicates_.empty()) {
+    stats()->AddExtraInfo("batches_skipped", absl::StrCat(batches_skipped_));
+  }
   return Status::OK();
 }
 
+void MemorySourceNode::SkipNonMatchingBatches() {
+  if (predicates_.empty()) {
+    return;
+  }
+  while (current_batch_.IsValid() && !table_->BatchMayMatch(current_batch_, predicates_)) {
+    auto next_batch = table_->NextBatch(current_batch_, stop_);
+    // An infinite stream has to hold on to its last batch to find the batches written after it,
+    // so that batch is read (and filtered downstream) instead.
+    if (infinite_stream_ && !next_batch.IsValid()) {
+      return;
+    }
+    current_batch_ = next_batch;
+    ++batches_skipped_;
+  }
+}
+
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState* exec_state) {
   DCHECK(table_ != nullptr);
 
@@ -95,6 +179,7 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
     }
     current_batch_ = next_batch;
     wait_for_valid_next_ = false;
+    SkipNonMatchingBatches();
   }
 
   if (!current_batch_.IsValid()) {
@@ -113,6 +198,7 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
     wait_for_valid_next_ = true;
   } else {
     current_batch_ = next_batch;
+    SkipNonMatchingBatches();
   }
 
   // If infinite stream is set, we don't send Eow or Eos. Infinite streams therefore never cause
@@ -131,6 +217,26 @@ Status MemorySourceNode::GenerateNextImpl(ExecState* exec_state) {
   return Status::OK();
 }
 
+std::vector<table_store::BatchSlice> MemorySourceNode::TakeRemainingBatchSlices() {
+  DCHECK(table_ != nullptr);
+  DCHECK(!infinite_stream_);
+  std::vector<table_store::BatchSlice> slices;
+  for (; current_batch_.IsValid(); current_batch_ = table_->NextBatch(current_batch_, stop_)) {
+    if (!predicates_.empty() && !table_->BatchMayMatch(current_batch_, predicates_)) {
+      ++batches_skipped_;
+      continue;
+    }
+    slices.push_back(current_batch_);
+  }
+  return slices;
+}
+
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::ReadBatchSlice(
+    ExecState* exec_state, const table_store::BatchSlice& slice) const {
+  DCHECK(table_ != nullptr);
+  return table_->GetRowBatchSlice(slice, plan_node_->Columns(), exec_state->exec_mem_pool());
+}
+
 bool MemorySourceNode::InfiniteStreamNextBatchReady() {
   if (!wait_for_valid_next_) {
     return current_batch_.IsValid();
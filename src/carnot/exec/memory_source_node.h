@@ -44,6 +44,28 @@ class MemorySourceNode : public SourceNode {
 
   bool NextBatchReady() override;
 
+  bool infinite_stream() const { return infinite_stream_; }
+
+  /**
+   * Hands out all the batch slices that this source has left to read, for the parallel pipeline
+   * to read in morsels. Once this is called, the source itself has no more batches to produce
+   * besides the end of stream. Only valid on a finite stream, after Open.
+   */
+  std::vector<table_store::BatchSlice> TakeRemainingBatchSlices();
+
+  /**
+   * Reads the given batch slice of the table. Unlike GenerateNext, this is safe to call
+   * concurrently from multiple threads.
+   */
+  StatusOr<std::unique_ptr<RowBatch>> ReadBatchSlice(ExecState* exec_state,
+                                                     const table_store::BatchSlice& slice) const;
+
+  // Adds to the processed stats, for the rows that were read through ReadBatchSlice.
+  void AddProcessedStats(int64_t rows, int64_t bytes) {
+    rows_processed_ += rows;
+    bytes_processed_ += bytes;
+  }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -55,6 +77,9 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  // Moves current_batch_ past the batches that the table can tell hold no rows matching
+  // predicates_.
+  void SkipNonMatchingBatches();
   // Whether this memory source will stream infinitely. Can be stopped by the
   // exec_state_->keep_running() call in exec_graph.
   bool infinite_stream_ = false;
@@ -66,6 +91,10 @@ class MemorySourceNode : public SourceNode {
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
+
+  // Predicates pushed down from the filters that consume this source, used to skip batches.
+  std::vector<table_store::ColumnPredicate> predicates_;
+  int64_t batches_skipped_ = 0;
 };
 
 }  // namespace exec
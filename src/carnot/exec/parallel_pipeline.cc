@@ -0,0 +1,129 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/parallel_pipeline.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <absl/strings/substitute.h>
+
+DEFINE_int32(carnot_exec_worker_threads, gflags::Int32FromEnv("PL_CARNOT_EXEC_WORKER_THREADS", 1),
+             "The number of threads that execute a plan fragment of the form MemorySource -> "
+             "(Map | Filter)* -> Agg. The source table is split into morsels of batches, which are "
+             "processed in parallel and merged at the aggregate. 1 disables parallel execution.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+Status ParallelPipeline::Execute(ExecState* exec_state) {
+  std::vector<table_store::BatchSlice> slices = source_->TakeRemainingBatchSlices();
+  num_morsels_ = (static_cast<int64_t>(slices.size()) + kBatchSlicesPerMorsel - 1) /
+                 kBatchSlicesPerMorsel;
+  next_morsel_ = 0;
+  int num_workers = static_cast<int>(std::min<int64_t>(num_workers_, num_morsels_));
+  VLOG(1) << absl::Substitute("Executing $0 batches in $1 morsels on $2 workers", slices.size(),
+                              num_morsels_, num_workers);
+
+  std::vector<Worker> workers(num_workers);
+  Status status = Status::OK();
+  for (auto& worker : workers) {
+    status = CreateWorker(exec_state, &worker);
+    if (!status.ok()) {
+      break;
+    }
+  }
+
+  if (status.ok()) {
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size());
+    for (auto& worker : workers) {
+      threads.emplace_back(&ParallelPipeline::RunWorker, this, exec_state, std::cref(slices),
+                           &worker);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  for (auto& worker : workers) {
+    if (status.ok()) {
+      status = worker.status;
+    }
+    if (status.ok()) {
+      status = agg_->MergeFrom(exec_state, static_cast<AggNode*>(worker.nodes.back()));
+    }
+    source_->AddProcessedStats(worker.rows_processed, worker.bytes_processed);
+    // Close all the nodes of all the workers, even after an error.
+    for (ExecNode* node : worker.nodes) {
+      auto s = node->Close(exec_state);
+      LOG_IF(ERROR, !s.ok()) << absl::Substitute("Failed to close parallel pipeline node: $0",
+                                                 s.msg());
+    }
+  }
+  return status;
+}
+
+Status ParallelPipeline::CreateWorker(ExecState* exec_state, Worker* worker) {
+  for (const auto& factory : node_factories_) {
+    PL_ASSIGN_OR_RETURN(ExecNode * node, factory());
+    if (!worker->nodes.empty()) {
+      worker->nodes.back()->AddChild(node, 0);
+    }
+    worker->nodes.push_back(node);
+    PL_RETURN_IF_ERROR(node->Prepare(exec_state));
+    PL_RETURN_IF_ERROR(node->Open(exec_state));
+  }
+  return Status::OK();
+}
+
+void ParallelPipeline::RunWorker(ExecState* exec_state,
+                                 const std::vector<table_store::BatchSlice>& slices,
+                                 Worker* worker) {
+  while (true) {
+    int64_t morsel = next_morsel_.fetch_add(1);
+    if (morsel >= num_morsels_) {
+      return;
+    }
+    worker->status = ProcessMorsel(exec_state, slices, morsel, worker);
+    if (!worker->status.ok()) {
+      // Stop the other workers from claiming more morsels.
+      next_morsel_ = num_morsels_;
+      return;
+    }
+  }
+}
+
+Status ParallelPipeline::ProcessMorsel(ExecState* exec_state,
+                                       const std::vector<table_store::BatchSlice>& slices,
+                                       int64_t morsel, Worker* worker) {
+  int64_t begin = morsel * kBatchSlicesPerMorsel;
+  int64_t end = std::min<int64_t>(begin + kBatchSlicesPerMorsel, slices.size());
+  for (int64_t slice_idx = begin; slice_idx < end; ++slice_idx) {
+    PL_ASSIGN_OR_RETURN(auto rb, source_->ReadBatchSlice(exec_state, slices[slice_idx]));
+    worker->rows_processed += rb->num_rows();
+    worker->bytes_processed += rb->NumBytes();
+    PL_RETURN_IF_ERROR(worker->nodes.front()->ConsumeNext(exec_state, *rb, 0));
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/agg_node.h"
+#include "src/carnot/exec/exec_node.h"
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/memory_source_node.h"
+#include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/base.h"
+#include "src/table_store/table_store.h"
+
+DECLARE_int32(carnot_exec_worker_threads);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// The number of consecutive batch slices of the source table that a worker claims at a time.
+constexpr int64_t kBatchSlicesPerMorsel = 4;
+
+/**
+ * ParallelPipeline runs a MemorySource -> (Map | Filter)* -> Agg pipeline of a plan fragment on
+ * multiple threads.
+ *
+ * The remaining batch slices of the source are split into morsels of kBatchSlicesPerMorsel
+ * slices. Every worker has its own copy of the Map/Filter/Agg nodes and repeatedly claims the next
+ * unprocessed morsel, reads it straight from the table and pushes it through its nodes. Once all
+ * the morsels are consumed, the partial aggregate of each worker is merged into the aggregate of
+ * the execution graph with the UDA merge functions.
+ *
+ * The pipeline never sends end of stream. Afterwards the source has no batches left besides the
+ * end of stream, which the execution graph sends as usual and which makes the graph's aggregate
+ * emit the merged result.
+ */
+class ParallelPipeline : public NotCopyable {
+ public:
+  // Creates a new, initialized instance of a node of the pipeline for a worker.
+  using NodeFactory = std::function<StatusOr<ExecNode*>()>;
+
+  /**
+   * @param source The source node of the pipeline, must be open and not an infinite stream.
+   * @param node_factories The factories of the nodes after the source, in pipeline order. The last
+   * one creates the aggregate.
+   * @param agg The aggregate of the execution graph, which the worker aggregates are merged into.
+   * @param num_workers The number of worker threads.
+   */
+  ParallelPipeline(MemorySourceNode* source, std::vector<NodeFactory> node_factories, AggNode* agg,
+                   int num_workers)
+      : source_(source),
+        node_factories_(std::move(node_factories)),
+        agg_(agg),
+        num_workers_(num_workers) {}
+
+  /**
+   * @return Whether nodes of the given operator type can be part of a parallel pipeline (between
+   * the source and the aggregate, or as the aggregate).
+   */
+  static bool IsPipelineOperator(planpb::OperatorType op_type) {
+    return op_type == planpb::MAP_OPERATOR || op_type == planpb::FILTER_OPERATOR ||
+           op_type == planpb::AGGREGATE_OPERATOR;
+  }
+
+  Status Execute(ExecState* exec_state);
+
+ private:
+  struct Worker {
+    // The nodes of the worker, in pipeline order. The last one is the partial aggregate.
+    std::vector<ExecNode*> nodes;
+    Status status;
+    int64_t rows_processed = 0;
+    int64_t bytes_processed = 0;
+  };
+
+  Status CreateWorker(ExecState* exec_state, Worker* worker);
+  void RunWorker(ExecState* exec_state, const std::vector<table_store::BatchSlice>& slices,
+                 Worker* worker);
+  Status ProcessMorsel(ExecState* exec_state, const std::vector<table_store::BatchSlice>& slices,
+                       int64_t morsel, Worker* worker);
+
+  MemorySourceNode* source_;
+  std::vector<NodeFactory> node_factories_;
+  AggNode* agg_;
+  int num_workers_;
+
+  int64_t num_morsels_ = 0;
+  std::atomic<int64_t> next_morsel_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
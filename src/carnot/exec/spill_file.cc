@@ -0,0 +1,197 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/spill_file.h"
+
+#include <sole.hpp>
+
+#include <system_error>
+#include <utility>
+
+#include <absl/strings/substitute.h>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/schemapb/schema.pb.h"
+
+DEFINE_string(carnot_spill_dir, gflags::StringFromEnv("PL_CARNOT_SPILL_DIR", "/tmp/carnot_spill"),
+              "The directory that blocking operators spill their state to when a query exceeds "
+              "its memory budget.");
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+template <types::DataType DT>
+Status TakeColumnRows(const arrow::Array* input_col, const std::vector<int64_t>& rows,
+                      arrow::MemoryPool* mem_pool, RowBatch* output_rb) {
+  auto builder = types::MakeArrowBuilder(DT, mem_pool);
+  PL_RETURN_IF_ERROR(builder->Reserve(rows.size()));
+  for (int64_t row_idx : rows) {
+    PL_RETURN_IF_ERROR(table_store::schema::CopyValue<DT>(
+        builder.get(), types::GetValueFromArrowArray<DT>(input_col, row_idx)));
+  }
+  std::shared_ptr<arrow::Array> output_col;
+  PL_RETURN_IF_ERROR(builder->Finish(&output_col));
+  return output_rb->AddColumn(output_col);
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<RowBatch>> TakeRows(const RowBatch& rb, const std::vector<int64_t>& rows,
+                                             arrow::MemoryPool* mem_pool) {
+  auto output_rb = std::make_unique<RowBatch>(rb.desc(), rows.size());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+#define TYPE_CASE(_dt_)                                                                    \
+  PL_RETURN_IF_ERROR(                                                                      \
+      TakeColumnRows<_dt_>(rb.ColumnAt(col_idx).get(), rows, mem_pool, output_rb.get()));
+    PL_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  return output_rb;
+}
+
+StatusOr<std::unique_ptr<SpillFile>> SpillFile::Create(const std::string& dir) {
+  std::error_code ec;
+  std::filesystem::create_directories(dir, ec);
+  if (ec) {
+    return error::Internal("Failed to create spill directory $0: $1", dir, ec.message());
+  }
+  auto path = std::filesystem::path(dir) / absl::Substitute("$0.spill", sole::uuid4().str());
+  std::unique_ptr<SpillFile> spill_file(new SpillFile(path));
+  spill_file->file_.open(path, std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+  if (!spill_file->file_.is_open()) {
+    return error::Internal("Failed to open spill file $0", path.string());
+  }
+  return spill_file;
+}
+
+SpillFile::~SpillFile() {
+  file_.close();
+  std::error_code ec;
+  std::filesystem::remove(path_, ec);
+  LOG_IF(WARNING, ec) << absl::Substitute("Failed to remove spill file $0: $1", path_.string(),
+                                          ec.message());
+}
+
+Status SpillFile::Write(const RowBatch& rb) {
+  if (reading_) {
+    return error::Internal("Cannot write to spill file $0 after reading started", path_.string());
+  }
+  table_store::schemapb::RowBatchData rb_data;
+  PL_RETURN_IF_ERROR(rb.ToProto(&rb_data));
+  std::string buf = rb_data.SerializeAsString();
+  uint64_t len = buf.size();
+  file_.write(reinterpret_cast<const char*>(&len), sizeof(len));
+  file_.write(buf.data(), buf.size());
+  if (!file_.good()) {
+    return error::Internal("Failed to write to spill file $0", path_.string());
+  }
+  ++num_batches_;
+  num_rows_ += rb.num_rows();
+  bytes_written_ += sizeof(len) + buf.size();
+  return Status::OK();
+}
+
+Status SpillFile::StartRead() {
+  file_.flush();
+  file_.seekg(0);
+  if (!file_.good()) {
+    return error::Internal("Failed to rewind spill file $0", path_.string());
+  }
+  reading_ = true;
+  num_batches_read_ = 0;
+  return Status::OK();
+}
+
+StatusOr<std::unique_ptr<RowBatch>> SpillFile::ReadNext() {
+  if (!reading_) {
+    return error::Internal("StartRead must be called before reading spill file $0",
+                           path_.string());
+  }
+  if (num_batches_read_ == num_batches_) {
+    return std::unique_ptr<RowBatch>(nullptr);
+  }
+  uint64_t len = 0;
+  file_.read(reinterpret_cast<char*>(&len), sizeof(len));
+  std::string buf(len, '\0');
+  file_.read(buf.data(), len);
+  if (!file_.good()) {
+    return error::Internal("Failed to read from spill file $0", path_.string());
+  }
+  table_store::schemapb::RowBatchData rb_data;
+  if (!rb_data.ParseFromString(buf)) {
+    return error::Internal("Corrupt row batch in spill file $0", path_.string());
+  }
+  ++num_batches_read_;
+  return RowBatch::FromProto(rb_data);
+}
+
+void PartitionedSpill::ComputePartitions(const RowBatch& rb, std::vector<int>* partitions) {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(key_indices_.size());
+  for (int64_t key_idx : key_indices_) {
+    key_cols.push_back(rb.ColumnAt(key_idx).get());
+  }
+  HashKeyColumns(key_types_, key_cols, rb.num_rows(), &hashes_);
+  partitions->resize(rb.num_rows());
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    (*partitions)[row_idx] = PartitionForHash(hashes_[row_idx]);
+  }
+}
+
+Status PartitionedSpill::Write(const RowBatch& rb) {
+  ComputePartitions(rb, &row_partitions_);
+  all_rows_.resize(rb.num_rows());
+  for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+    all_rows_[row_idx] = row_idx;
+  }
+  return Write(rb, all_rows_, row_partitions_);
+}
+
+Status PartitionedSpill::Write(const RowBatch& rb, const std::vector<int64_t>& rows,
+                               const std::vector<int>& partitions) {
+  for (auto& partition_rows : partition_rows_) {
+    partition_rows.clear();
+  }
+  for (int64_t row_idx : rows) {
+    partition_rows_[partitions[row_idx]].push_back(row_idx);
+  }
+  for (int idx = 0; idx < kNumSpillPartitions; ++idx) {
+    if (partition_rows_[idx].empty()) {
+      continue;
+    }
+    if (partitions_[idx] == nullptr) {
+      PL_ASSIGN_OR_RETURN(partitions_[idx], SpillFile::Create(dir_));
+    }
+    PL_ASSIGN_OR_RETURN(auto partition_rb,
+                        TakeRows(rb, partition_rows_[idx], arrow::default_memory_pool()));
+    PL_RETURN_IF_ERROR(partitions_[idx]->Write(*partition_rb));
+    num_rows_ += partition_rows_[idx].size();
+  }
+  return Status::OK();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+DECLARE_string(carnot_spill_dir);
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// Spilled state is hash partitioned on the top kNumSpillPartitionBits bits of the key hash. The low
+// bits are left for the hash tables that later process each partition.
+constexpr int kNumSpillPartitionBits = 4;
+constexpr int kNumSpillPartitions = 1 << kNumSpillPartitionBits;
+
+/**
+ * Copies the given rows of a row batch into a new row batch. eow/eos are not set.
+ */
+StatusOr<std::unique_ptr<table_store::schema::RowBatch>> TakeRows(
+    const table_store::schema::RowBatch& rb, const std::vector<int64_t>& rows,
+    arrow::MemoryPool* mem_pool);
+
+/**
+ * SpillFile is a file of row batches on local disk, used by blocking operators to hold state that
+ * doesn't fit in the query memory budget. Row batches are stored as length prefixed RowBatchData
+ * protos (the same encoding used to send row batches between agents) and are read back in the
+ * order they were written. The file is deleted when the SpillFile is destroyed.
+ */
+class SpillFile : public NotCopyable {
+ public:
+  static StatusOr<std::unique_ptr<SpillFile>> Create(const std::string& dir);
+  ~SpillFile();
+
+  Status Write(const table_store::schema::RowBatch& rb);
+
+  /**
+   * Flushes all written row batches and rewinds the file to the first row batch. No more row
+   * batches can be written after this is called.
+   */
+  Status StartRead();
+
+  /**
+   * Reads the next row batch.
+   * @return The row batch, or nullptr once all the row batches have been read.
+   */
+  StatusOr<std::unique_ptr<table_store::schema::RowBatch>> ReadNext();
+
+  int64_t num_batches() const { return num_batches_; }
+  int64_t num_rows() const { return num_rows_; }
+  int64_t bytes_written() const { return bytes_written_; }
+  const std::filesystem::path& path() const { return path_; }
+
+ private:
+  explicit SpillFile(std::filesystem::path path) : path_(std::move(path)) {}
+
+  std::filesystem::path path_;
+  std::fstream file_;
+  bool reading_ = false;
+  int64_t num_batches_ = 0;
+  int64_t num_batches_read_ = 0;
+  int64_t num_rows_ = 0;
+  int64_t bytes_written_ = 0;
+};
+
+/**
+ * PartitionedSpill hash partitions rows by their key columns into kNumSpillPartitions spill files,
+ * so that each partition can later be processed on its own (as in a grace hash join). The files
+ * are only created for partitions that receive rows.
+ */
+class PartitionedSpill : public NotCopyable {
+ public:
+  PartitionedSpill(std::string dir, std::vector<int64_t> key_indices,
+                   std::vector<types::DataType> key_types)
+      : dir_(std::move(dir)),
+        key_indices_(std::move(key_indices)),
+        key_types_(std::move(key_types)),
+        partitions_(kNumSpillPartitions) {}
+
+  static int PartitionForHash(uint64_t hash) {
+    return static_cast<int>(hash >> (64 - kNumSpillPartitionBits));
+  }
+
+  /**
+   * Computes the partition of every row in the row batch.
+   */
+  void ComputePartitions(const table_store::schema::RowBatch& rb, std::vector<int>* partitions);
+
+  /**
+   * Writes all the rows of the row batch to their partitions.
+   */
+  Status Write(const table_store::schema::RowBatch& rb);
+
+  /**
+   * Writes the selected rows of the row batch to their partitions. partitions must hold the
+   * partition of each row in the row batch (see ComputePartitions).
+   */
+  Status Write(const table_store::schema::RowBatch& rb, const std::vector<int64_t>& rows,
+               const std::vector<int>& partitions);
+
+  /**
+   * @return The spill file of the partition, or nullptr if the partition has no rows.
+   */
+  SpillFile* partition(int idx) const { return partitions_[idx].get(); }
+
+  int64_t num_rows() const { return num_rows_; }
+
+ private:
+  std::string dir_;
+  std::vector<int64_t> key_indices_;
+  std::vector<types::DataType> key_types_;
+  std::vector<std::unique_ptr<SpillFile>> partitions_;
+  int64_t num_rows_ = 0;
+
+  // Scratch space reused across row batches.
+  std::vector<uint64_t> hashes_;
+  std::vector<int> row_partitions_;
+  std::vector<int64_t> all_rows_;
+  std::vector<std::vector<int64_t>> partition_rows_{kNumSpillPartitions};
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
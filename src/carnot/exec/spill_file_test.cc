@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/carnot/exec/memory_budget.h"
+#include "src/carnot/exec/spill_file.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+std::unique_ptr<RowBatch> MakeRowBatch(const std::vector<types::Int64Value>& ints,
+                                       const std::vector<types::StringValue>& strs) {
+  RowDescriptor rd({types::DataType::INT64, types::DataType::STRING});
+  auto rb = std::make_unique<RowBatch>(rd, ints.size());
+  EXPECT_OK(rb->AddColumn(types::ToArrow(ints, arrow::default_memory_pool())));
+  EXPECT_OK(rb->AddColumn(types::ToArrow(strs, arrow::default_memory_pool())));
+  return rb;
+}
+
+TEST(SpillFileTest, write_and_read_back) {
+  auto rb1 = MakeRowBatch({1, 2, 3}, {"a", "bc", ""});
+  auto rb2 = MakeRowBatch({4}, {"def"});
+  rb2->set_eow(true);
+  rb2->set_eos(true);
+
+  std::filesystem::path path;
+  {
+    ASSERT_OK_AND_ASSIGN(auto spill_file, SpillFile::Create(::testing::TempDir()));
+    path = spill_file->path();
+    EXPECT_OK(spill_file->Write(*rb1));
+    EXPECT_OK(spill_file->Write(*rb2));
+    EXPECT_EQ(2, spill_file->num_batches());
+    EXPECT_EQ(4, spill_file->num_rows());
+    EXPECT_TRUE(std::filesystem::exists(path));
+
+    EXPECT_OK(spill_file->StartRead());
+    EXPECT_NOT_OK(spill_file->Write(*rb1));
+
+    ASSERT_OK_AND_ASSIGN(auto out1, spill_file->ReadNext());
+    ASSERT_NE(nullptr, out1);
+    EXPECT_EQ(3, out1->num_rows());
+    EXPECT_TRUE(out1->ColumnAt(0)->Equals(rb1->ColumnAt(0)));
+    EXPECT_TRUE(out1->ColumnAt(1)->Equals(rb1->ColumnAt(1)));
+    EXPECT_FALSE(out1->eos());
+
+    ASSERT_OK_AND_ASSIGN(auto out2, spill_file->ReadNext());
+    ASSERT_NE(nullptr, out2);
+    EXPECT_TRUE(out2->ColumnAt(1)->Equals(rb2->ColumnAt(1)));
+    EXPECT_TRUE(out2->eow());
+    EXPECT_TRUE(out2->eos());
+
+    ASSERT_OK_AND_ASSIGN(auto out3, spill_file->ReadNext());
+    EXPECT_EQ(nullptr, out3);
+  }
+  // The file is removed along with the SpillFile.
+  EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(SpillFileTest, take_rows) {
+  auto rb = MakeRowBatch({1, 2, 3, 4}, {"a", "b", "c", "d"});
+  ASSERT_OK_AND_ASSIGN(auto out, TakeRows(*rb, {3, 1}, arrow::default_memory_pool()));
+  EXPECT_EQ(2, out->num_rows());
+  EXPECT_TRUE(out->ColumnAt(0)->Equals(
+      types::ToArrow(std::vector<types::Int64Value>{4, 2}, arrow::default_memory_pool())));
+  EXPECT_TRUE(out->ColumnAt(1)->Equals(
+      types::ToArrow(std::vector<types::StringValue>{"d", "b"}, arrow::default_memory_pool())));
+}
+
+TEST(SpillFileTest, partitioned_spill) {
+  std::vector<types::Int64Value> ints;
+  std::vector<types::StringValue> strs;
+  for (int64_t i = 0; i < 1000; ++i) {
+    ints.emplace_back(i % 100);
+    strs.emplace_back("val");
+  }
+  auto rb = MakeRowBatch(ints, strs);
+
+  PartitionedSpill spill(::testing::TempDir(), {0}, {types::DataType::INT64});
+  EXPECT_OK(spill.Write(*rb));
+  EXPECT_EQ(1000, spill.num_rows());
+
+  // Every row must have been written to the partition of its key, and equal keys always go to the
+  // same partition.
+  int64_t num_rows = 0;
+  for (int idx = 0; idx < kNumSpillPartitions; ++idx) {
+    SpillFile* partition = spill.partition(idx);
+    if (partition == nullptr) {
+      continue;
+    }
+    EXPECT_OK(partition->StartRead());
+    while (true) {
+      ASSERT_OK_AND_ASSIGN(auto part_rb, partition->ReadNext());
+      if (part_rb == nullptr) {
+        break;
+      }
+      num_rows += part_rb->num_rows();
+      std::vector<uint64_t> hashes;
+      HashKeyColumns({types::DataType::INT64}, {part_rb->ColumnAt(0).get()}, part_rb->num_rows(),
+                     &hashes);
+      for (auto hash : hashes) {
+        EXPECT_EQ(idx, PartitionedSpill::PartitionForHash(hash));
+      }
+    }
+  }
+  EXPECT_EQ(1000, num_rows);
+}
+
+TEST(MemoryBudgetTest, reservations) {
+  QueryMemoryBudget budget(100);
+  MemoryReservation r1(&budget);
+  MemoryReservation r2(&budget);
+  EXPECT_TRUE(r1.TryResize(60));
+  EXPECT_FALSE(r2.TryResize(50));
+  EXPECT_EQ(0, r2.reserved_bytes());
+  EXPECT_TRUE(r2.TryResize(40));
+  EXPECT_TRUE(r1.TryResize(10));
+  EXPECT_EQ(50, budget.used_bytes());
+  EXPECT_EQ(100, budget.peak_bytes());
+  r1.Reset();
+  EXPECT_EQ(40, budget.used_bytes());
+
+  QueryMemoryBudget unlimited(0);
+  MemoryReservation r3(&unlimited);
+  EXPECT_TRUE(r3.TryResize(1L << 40));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
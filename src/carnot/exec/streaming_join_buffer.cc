@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/streaming_join_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "src/carnot/exec/group_key_table.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+
+namespace {
+
+// Compacts the row ids of a key once at least this many (and half of them) have been evicted.
+constexpr size_t kMinKeyRowsCompaction = 64;
+
+/**
+ * Compares keys on the bytes of the underlying value, which matches the semantics of RowTuple.
+ */
+template <types::DataType DT>
+bool KeyValuesEqual(const arrow::Array* arr, int64_t row_idx, const arrow::Array* other_arr,
+                    int64_t other_row_idx) {
+  using ValueType = typename types::DataTypeTraits<DT>::value_type;
+  ValueType val = types::GetValueFromArrowArray<DT>(arr, row_idx);
+  ValueType other_val = types::GetValueFromArrowArray<DT>(other_arr, other_row_idx);
+  return memcmp(&val.val, &other_val.val, sizeof(val.val)) == 0;
+}
+
+// PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+template <>
+bool KeyValuesEqual<types::DataType::STRING>(const arrow::Array* arr, int64_t row_idx,
+                                             const arrow::Array* other_arr,
+                                             int64_t other_row_idx) {
+  int32_t len = 0;
+  int32_t other_len = 0;
+  const uint8_t* data = static_cast<const arrow::StringArray*>(arr)->GetValue(row_idx, &len);
+  const uint8_t* other_data =
+      static_cast<const arrow::StringArray*>(other_arr)->GetValue(other_row_idx, &other_len);
+  return len == other_len && memcmp(data, other_data, len) == 0;
+}
+
+}  // namespace
+
+StreamingJoinBuffer::StreamingJoinBuffer(std::vector<int64_t> key_indices,
+                                         std::vector<types::DataType> key_types,
+                                         int64_t time_col_idx)
+    : key_indices_(std::move(key_indices)),
+      key_types_(std::move(key_types)),
+      time_col_idx_(time_col_idx) {
+  DCHECK_EQ(key_indices_.size(), key_types_.size());
+  for (const auto& key_type : key_types_) {
+#define TYPE_CASE(_dt_) key_eq_fns_.push_back(&KeyValuesEqual<_dt_>);
+    PL_SWITCH_FOREACH_DATATYPE(key_type, TYPE_CASE);
+#undef TYPE_CASE
+  }
+}
+
+void StreamingJoinBuffer::HashKeys(const RowBatch& rb, std::vector<uint64_t>* hashes) const {
+  std::vector<const arrow::Array*> key_cols;
+  key_cols.reserve(key_indices_.size());
+  for (int64_t key_idx : key_indices_) {
+    key_cols.push_back(rb.ColumnAt(key_idx).get());
+  }
+  HashKeyColumns(key_types_, key_cols, rb.num_rows(), hashes);
+}
+
+void StreamingJoinBuffer::Add(std::shared_ptr<RowBatch> rb, const std::vector<uint64_t>& hashes,
+                              std::vector<bool> matched) {
+  int64_t num_rows = rb->num_rows();
+  DCHECK_EQ(num_rows, static_cast<int64_t>(hashes.size()));
+  DCHECK_EQ(num_rows, static_cast<int64_t>(matched.size()));
+  if (num_rows == 0) {
+    return;
+  }
+
+  int64_t batch_max_time = std::numeric_limits<int64_t>::min();
+  for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+    batch_max_time = std::max(batch_max_time, TimeAt(*rb, row_idx));
+    rows_by_hash_[hashes[row_idx]].row_ids.push_back(next_row_id_ + row_idx);
+  }
+  max_time_ = std::max(max_time_, batch_max_time);
+
+  int64_t bytes = rb->NumBytes() + num_rows * (sizeof(uint64_t) + sizeof(int64_t));
+  bytes_ += bytes;
+  batches_.push_back(BufferedBatch{std::move(rb), next_row_id_, batch_max_time, bytes, hashes,
+                                   std::move(matched)});
+  next_row_id_ += num_rows;
+}
+
+StreamingJoinBuffer::BufferedBatch* StreamingJoinBuffer::BatchForRowID(int64_t row_id) {
+  DCHECK(!batches_.empty());
+  DCHECK_GE(row_id, batches_.front().first_row_id);
+  // The first batch that starts after the row, the row is in the batch before it.
+  auto it = std::upper_bound(
+      batches_.begin(), batches_.end(), row_id,
+      [](int64_t id, const BufferedBatch& batch) { return id < batch.first_row_id; });
+  return &*std::prev(it);
+}
+
+int64_t StreamingJoinBuffer::TimeAt(const RowBatch& rb, int64_t row_idx) const {
+  return types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb.ColumnAt(time_col_idx_).get(),
+                                                                  row_idx);
+}
+
+bool StreamingJoinBuffer::KeysEqual(const RowBatch& rb, int64_t row_idx, const RowBatch& other_rb,
+                                    const std::vector<int64_t>& other_key_indices,
+                                    int64_t other_row_idx) const {
+  for (size_t i = 0; i < key_indices_.size(); ++i) {
+    if (!key_eq_fns_[i](rb.ColumnAt(key_indices_[i]).get(), row_idx,
+                        other_rb.ColumnAt(other_key_indices[i]).get(), other_row_idx)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void StreamingJoinBuffer::RemoveOldestRow(uint64_t hash, int64_t row_id) {
+  auto it = rows_by_hash_.find(hash);
+  DCHECK(it != rows_by_hash_.end());
+  KeyRows& key_rows = it->second;
+  DCHECK_EQ(key_rows.row_ids[key_rows.start], row_id);
+  ++key_rows.start;
+  if (key_rows.start == key_rows.row_ids.size()) {
+    rows_by_hash_.erase(it);
+    return;
+  }
+  if (key_rows.start >= kMinKeyRowsCompaction && key_rows.start * 2 >= key_rows.row_ids.size()) {
+    key_rows.row_ids.erase(key_rows.row_ids.begin(), key_rows.row_ids.begin() + key_rows.start);
+    key_rows.start = 0;
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
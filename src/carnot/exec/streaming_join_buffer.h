@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * StreamingJoinBuffer holds the rows of one input of a streaming (symmetric hash) join, so that
+ * rows that later arrive on the other input can be joined against them.
+ *
+ * Rows are kept a row batch at a time and indexed by the hash of their join key. Batches are
+ * evicted oldest first, once the time_ of every row in the batch falls behind a cutoff. Since both
+ * row batches and rows within a key are kept in arrival order, evicting a batch only ever removes
+ * the oldest row ids of each key.
+ */
+class StreamingJoinBuffer : public NotCopyable {
+ public:
+  StreamingJoinBuffer(std::vector<int64_t> key_indices, std::vector<types::DataType> key_types,
+                      int64_t time_col_idx);
+
+  /**
+   * Computes the key hash of every row of a row batch from this buffer's input.
+   */
+  void HashKeys(const table_store::schema::RowBatch& rb, std::vector<uint64_t>* hashes) const;
+
+  /**
+   * Adds all the rows of a row batch.
+   *
+   * @param rb The row batch, which is kept until it is evicted.
+   * @param hashes The key hash of each row, see HashKeys.
+   * @param matched Whether each row already matched a row of the other input. Unmatched rows are
+   * passed to the eviction callback once they are evicted, for outer joins.
+   */
+  void Add(std::shared_ptr<table_store::schema::RowBatch> rb, const std::vector<uint64_t>& hashes,
+           std::vector<bool> matched);
+
+  /**
+   * Calls fn(rb, row_idx) for every buffered row whose key equals the key of a row from the other
+   * input and whose time_ is within window_ns of its time. The buffered rows are marked matched.
+   *
+   * @param other_rb The row batch of the other input's row.
+   * @param other_key_indices The indices of the key columns in other_rb.
+   * @param other_row_idx The row in other_rb.
+   * @param hash The key hash of the row.
+   * @param time The time_ of the row.
+   * @param window_ns The max difference between the times of two joined rows.
+   */
+  template <typename TFn>
+  void ForEachMatch(const table_store::schema::RowBatch& other_rb,
+                    const std::vector<int64_t>& other_key_indices, int64_t other_row_idx,
+                    uint64_t hash, int64_t time, int64_t window_ns, TFn fn) {
+    auto it = rows_by_hash_.find(hash);
+    if (it == rows_by_hash_.end()) {
+      return;
+    }
+    const KeyRows& key_rows = it->second;
+    for (size_t i = key_rows.start; i < key_rows.row_ids.size(); ++i) {
+      int64_t row_id = key_rows.row_ids[i];
+      BufferedBatch* batch = BatchForRowID(row_id);
+      int64_t row_idx = row_id - batch->first_row_id;
+      int64_t row_time = TimeAt(*batch->rb, row_idx);
+      if (row_time < time - window_ns || row_time > time + window_ns) {
+        continue;
+      }
+      if (!KeysEqual(*batch->rb, row_idx, other_rb, other_key_indices, other_row_idx)) {
+        continue;
+      }
+      batch->matched[row_idx] = true;
+      fn(batch->rb, row_idx);
+    }
+  }
+
+  /**
+   * Evicts the oldest row batches whose rows are all older than cutoff_time. Calls
+   * unmatched_fn(rb, row_idx) for each evicted row that never matched.
+   * @return The number of evicted rows.
+   */
+  template <typename TFn>
+  int64_t EvictOlderThan(int64_t cutoff_time, TFn unmatched_fn) {
+    int64_t num_rows = 0;
+    while (!batches_.empty() && batches_.front().max_time < cutoff_time) {
+      num_rows += EvictFront(unmatched_fn);
+    }
+    return num_rows;
+  }
+
+  /**
+   * Evicts the oldest row batch, regardless of its time. Calls unmatched_fn(rb, row_idx) for each
+   * evicted row that never matched.
+   * @return The number of evicted rows.
+   */
+  template <typename TFn>
+  int64_t EvictFront(TFn unmatched_fn) {
+    DCHECK(!batches_.empty());
+    BufferedBatch& batch = batches_.front();
+    int64_t num_rows = batch.rb->num_rows();
+    for (int64_t row_idx = 0; row_idx < num_rows; ++row_idx) {
+      RemoveOldestRow(batch.hashes[row_idx], batch.first_row_id + row_idx);
+      if (!batch.matched[row_idx]) {
+        unmatched_fn(batch.rb, row_idx);
+      }
+    }
+    bytes_ -= batch.bytes;
+    batches_.pop_front();
+    return num_rows;
+  }
+
+  /**
+   * Computes the cutoff below which this input's rows can no longer match rows that arrive on the
+   * other input, given the max time seen on the other input.
+   */
+  static int64_t CutoffTime(int64_t other_max_time, int64_t window_ns) {
+    if (other_max_time < std::numeric_limits<int64_t>::min() + window_ns) {
+      return std::numeric_limits<int64_t>::min();
+    }
+    return other_max_time - window_ns;
+  }
+
+  bool empty() const { return batches_.empty(); }
+  int64_t num_batches() const { return batches_.size(); }
+  int64_t num_rows() const { return next_row_id_ - first_row_id(); }
+  // The time of the oldest buffered row batch, or the max int64 if the buffer is empty.
+  int64_t front_time() const {
+    return batches_.empty() ? std::numeric_limits<int64_t>::max() : batches_.front().max_time;
+  }
+  // The max time_ of all the rows ever added, including the evicted ones.
+  int64_t max_time() const { return max_time_; }
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  struct BufferedBatch {
+    std::shared_ptr<table_store::schema::RowBatch> rb;
+    int64_t first_row_id;
+    int64_t max_time;
+    int64_t bytes;
+    std::vector<uint64_t> hashes;
+    std::vector<bool> matched;
+  };
+
+  // The row ids of all the buffered rows with a given key hash, oldest first. Evicted rows are
+  // dropped from the front by moving start, the vector is compacted once half of it is dropped.
+  struct KeyRows {
+    std::vector<int64_t> row_ids;
+    size_t start = 0;
+  };
+
+  using KeyEqFn = bool (*)(const arrow::Array* arr, int64_t row_idx,
+                           const arrow::Array* other_arr, int64_t other_row_idx);
+
+  int64_t first_row_id() const {
+    return batches_.empty() ? next_row_id_ : batches_.front().first_row_id;
+  }
+  BufferedBatch* BatchForRowID(int64_t row_id);
+  int64_t TimeAt(const table_store::schema::RowBatch& rb, int64_t row_idx) const;
+  bool KeysEqual(const table_store::schema::RowBatch& rb, int64_t row_idx,
+                 const table_store::schema::RowBatch& other_rb,
+                 const std::vector<int64_t>& other_key_indices, int64_t other_row_idx) const;
+  void RemoveOldestRow(uint64_t hash, int64_t row_id);
+
+  const std::vector<int64_t> key_indices_;
+  const std::vector<types::DataType> key_types_;
+  const int64_t time_col_idx_;
+  std::vector<KeyEqFn> key_eq_fns_;
+
+  std::deque<BufferedBatch> batches_;
+  absl::flat_hash_map<uint64_t, KeyRows> rows_by_hash_;
+  int64_t next_row_id_ = 0;
+  int64_t max_time_ = std::numeric_limits<int64_t>::min();
+  int64_t bytes_ = 0;
+};
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/exec/streaming_join_buffer.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+// Row batches of [time_:Time64NS, key:String].
+std::shared_ptr<RowBatch> MakeTimeKeyBatch(const std::vector<types::Time64NSValue>& times,
+                                           const std::vector<types::StringValue>& keys) {
+  RowDescriptor rd({types::DataType::TIME64NS, types::DataType::STRING});
+  auto rb = std::make_shared<RowBatch>(rd, times.size());
+  EXPECT_OK(rb->AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+  EXPECT_OK(rb->AddColumn(types::ToArrow(keys, arrow::default_memory_pool())));
+  return rb;
+}
+
+class StreamingJoinBufferTest : public ::testing::Test {
+ protected:
+  void Add(std::shared_ptr<RowBatch> rb) {
+    std::vector<uint64_t> hashes;
+    buffer_.HashKeys(*rb, &hashes);
+    std::vector<bool> matched(rb->num_rows(), false);
+    buffer_.Add(std::move(rb), hashes, std::move(matched));
+  }
+
+  // Returns the (time, row_idx) of the buffered rows that match row row_idx of rb.
+  std::vector<std::pair<int64_t, int64_t>> Matches(const RowBatch& rb, int64_t row_idx,
+                                                   int64_t window_ns) {
+    std::vector<uint64_t> hashes;
+    buffer_.HashKeys(rb, &hashes);
+    int64_t time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+        rb.ColumnAt(0).get(), row_idx);
+    std::vector<std::pair<int64_t, int64_t>> matches;
+    buffer_.ForEachMatch(rb, {1}, row_idx, hashes[row_idx], time, window_ns,
+                         [&](const std::shared_ptr<RowBatch>& match_rb, int64_t match_row_idx) {
+                           matches.emplace_back(
+                               types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+                                   match_rb->ColumnAt(0).get(), match_row_idx),
+                               match_row_idx);
+                         });
+    return matches;
+  }
+
+  StreamingJoinBuffer buffer_{{1}, {types::DataType::STRING}, 0};
+};
+
+TEST_F(StreamingJoinBufferTest, matches_within_window) {
+  Add(MakeTimeKeyBatch({10, 20, 30}, {"a", "b", "a"}));
+  Add(MakeTimeKeyBatch({40, 50}, {"a", "c"}));
+  EXPECT_EQ(5, buffer_.num_rows());
+  EXPECT_EQ(2, buffer_.num_batches());
+  EXPECT_EQ(50, buffer_.max_time());
+
+  auto probe = MakeTimeKeyBatch({35, 35, 100}, {"a", "d", "a"});
+  EXPECT_THAT(Matches(*probe, 0, 100), ElementsAre(Pair(10, 0), Pair(30, 2), Pair(40, 0)));
+  EXPECT_THAT(Matches(*probe, 0, 5), ElementsAre(Pair(30, 2), Pair(40, 0)));
+  EXPECT_THAT(Matches(*probe, 1, 100), ElementsAre());
+  EXPECT_THAT(Matches(*probe, 2, 60), ElementsAre(Pair(40, 0)));
+}
+
+TEST_F(StreamingJoinBufferTest, evicts_old_batches) {
+  Add(MakeTimeKeyBatch({10, 20, 30}, {"a", "b", "a"}));
+  Add(MakeTimeKeyBatch({40, 50}, {"a", "c"}));
+  int64_t bytes = buffer_.bytes();
+  auto probe = MakeTimeKeyBatch({20}, {"b"});
+  EXPECT_THAT(Matches(*probe, 0, 100), ElementsAre(Pair(20, 1)));
+
+  // The first batch is only evicted once all of its rows are older than the cutoff.
+  std::vector<int64_t> unmatched;
+  auto collect_unmatched = [&](const std::shared_ptr<RowBatch>& rb, int64_t row_idx) {
+    unmatched.push_back(types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+        rb->ColumnAt(0).get(), row_idx));
+  };
+  EXPECT_EQ(0, buffer_.EvictOlderThan(30, collect_unmatched));
+  EXPECT_EQ(3, buffer_.EvictOlderThan(31, collect_unmatched));
+  EXPECT_THAT(unmatched, ElementsAre(10, 30));
+  EXPECT_EQ(1, buffer_.num_batches());
+  EXPECT_LT(buffer_.bytes(), bytes);
+  EXPECT_EQ(40, buffer_.front_time());
+
+  auto probe2 = MakeTimeKeyBatch({45}, {"a"});
+  EXPECT_THAT(Matches(*probe2, 0, 100), ElementsAre(Pair(40, 0)));
+
+  unmatched.clear();
+  EXPECT_EQ(2, buffer_.EvictFront(collect_unmatched));
+  EXPECT_THAT(unmatched, ElementsAre(50));
+  EXPECT_TRUE(buffer_.empty());
+  EXPECT_EQ(0, buffer_.bytes());
+  EXPECT_THAT(Matches(*probe2, 0, 100), ElementsAre());
+  // The max time outlives the evicted rows.
+  EXPECT_EQ(50, buffer_.max_time());
+}
+
+TEST_F(StreamingJoinBufferTest, many_rows_per_key) {
+  for (int64_t batch = 0; batch < 100; ++batch) {
+    Add(MakeTimeKeyBatch({batch * 10, batch * 10 + 5}, {"a", "a"}));
+    buffer_.EvictOlderThan(batch * 10 - 20, [](const std::shared_ptr<RowBatch>&, int64_t) {});
+  }
+  // Only the batches within 20ns of the last one are left.
+  EXPECT_EQ(3, buffer_.num_batches());
+  auto probe = MakeTimeKeyBatch({995}, {"a"});
+  EXPECT_THAT(Matches(*probe, 0, 1000),
+              ElementsAre(Pair(970, 0), Pair(975, 1), Pair(980, 0), Pair(985, 1), Pair(990, 0),
+                          Pair(995, 1)));
+}
+
+TEST(StreamingJoinBufferCutoffTest, cutoff_time) {
+  EXPECT_EQ(90, StreamingJoinBuffer::CutoffTime(100, 10));
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(),
+            StreamingJoinBuffer::CutoffTime(std::numeric_limits<int64_t>::min(), 10));
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
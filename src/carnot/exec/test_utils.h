@@ -29,7 +29,9 @@
 #include "src/carnot/carnotpb/carnot.pb.h"
 #include "src/carnot/exec/exec_node_mock.h"
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/group_key_table.h"
 #include "src/carnot/exec/row_tuple.h"
+#include "src/carnot/exec/spill_file.h"
 #include "src/carnot/plan/operators.h"
 #include "src/common/base/base.h"
 #include "src/common/testing/testing.h"
@@ -98,6 +100,25 @@ table_store::schema::RowBatch ConcatRowBatches(
   return *(rb_ptr.ConsumeValueOrDie());
 }
 
+// Returns the spill partition that an INT64 key is written to by PartitionedSpill.
+int SpillPartitionForKey(int64_t key) {
+  auto col = types::ToArrow(std::vector<types::Int64Value>{key}, arrow::default_memory_pool());
+  std::vector<uint64_t> hashes;
+  HashKeyColumns({types::DataType::INT64}, {col.get()}, 1, &hashes);
+  return PartitionedSpill::PartitionForHash(hashes[0]);
+}
+
+// Returns the smallest INT64 key greater than start that spills to the same partition as key.
+// Spill tests use this to get a predictable number of spill partitions, and so of output batches.
+int64_t NextKeyInSpillPartition(int64_t key, int64_t start) {
+  int partition = SpillPartitionForKey(key);
+  int64_t next = start + 1;
+  while (SpillPartitionForKey(next) != partition) {
+    ++next;
+  }
+  return next;
+}
+
 class CarnotTestUtils {
  public:
   CarnotTestUtils() = default;
@@ -418,6 +439,30 @@ class ExecNodeTester {
     return *this;
   }
 
+  /**
+   * Calls ConsumeNextSelected on the execution node.
+   * @param rb The input rowbatch to ConsumeNextSelected.
+   * @param selection The rows of the input rowbatch to consume.
+   * @return the ExecNodeTester, to allow for chaining.
+   */
+  ExecNodeTester& ConsumeNextSelected(const table_store::schema::RowBatch& rb,
+                                      const SelectionVector& selection, int64_t parent_id) {
+    auto check_result_batch = [&](ExecState*, const table_store::schema::RowBatch& child_rb,
+                                  int64_t) {
+      current_row_batches_.push(std::make_unique<table_store::schema::RowBatch>(child_rb));
+    };
+
+    EXPECT_CALL(mock_child_, ConsumeNextImpl(::testing::_, ::testing::_, ::testing::_))
+        .Times(1)
+        .WillOnce(::testing::DoAll(::testing::Invoke(check_result_batch),
+                                   ::testing::Return(Status::OK())))
+        .RetiresOnSaturation();
+    auto s = exec_node_->ConsumeNextSelected(exec_state_, rb, selection, parent_id);
+    EXPECT_OK(s) << s.msg();
+
+    return *this;
+  }
+
   /**
    * Checks that the row batch matches the last rowbatch output by ConsumeNext/GenerateNext.
    * @param expected_rb Row batch that should match the last rowbatch output by
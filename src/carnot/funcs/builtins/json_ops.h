@@ -47,10 +47,13 @@ class PluckUDF : public udf::ScalarUDF {
     if (!d.IsObject()) {
       return "";
     }
-    if (!d.HasMember(key.data())) {
+    // Look the key up once, by its size rather than as a C string.
+    rapidjson::Value key_name(rapidjson::StringRef(key.data(), key.size()));
+    auto member = d.FindMember(key_name);
+    if (member == d.MemberEnd()) {
       return "";
     }
-    const auto& plucked_value = d[key.data()];
+    const auto& plucked_value = member->value;
     if (plucked_value.IsNull()) {
       return "";
     }
@@ -64,6 +67,7 @@ class PluckUDF : public udf::ScalarUDF {
     plucked_value.Accept(writer);
     return sb.GetString();
   }
+  static constexpr bool Deterministic() { return true; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key value the serialized JSON string and returns as a "
@@ -99,6 +103,7 @@ class PluckAsInt64UDF : public udf::ScalarUDF {
     const auto& plucked_value = d[key.data()];
     return plucked_value.GetInt64();
   }
+  static constexpr bool Deterministic() { return true; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key from the serialized JSON string and returns as an int.")
@@ -134,6 +139,7 @@ class PluckAsFloat64UDF : public udf::ScalarUDF {
     const auto& plucked_value = d[key.data()];
     return plucked_value.GetDouble();
   }
+  static constexpr bool Deterministic() { return true; }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Grabs the value for the key from the serialized JSON string and returns as a "
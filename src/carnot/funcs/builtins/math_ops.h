@@ -34,6 +34,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class AddUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val + b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, udf::NativeType<TReturn>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] + b2[i];
+    }
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<AddUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -59,6 +65,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class SubtractUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val - b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, udf::NativeType<TReturn>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] - b2[i];
+    }
+  }
   static udf::InfRuleVec SemanticInferenceRules() {
     return {
         udf::InheritTypeFromArgs<SubtractUDF>::Create({types::ST_BYTES, types::ST_THROUGHPUT_PER_NS,
@@ -89,6 +101,12 @@ class DivideUDF : public udf::ScalarUDF {
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) {
     return ReturnValueType(b1.val) / ReturnValueType(b2.val);
   }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, udf::NativeType<TReturn>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = ReturnValueType(b1[i]) / ReturnValueType(b2[i]);
+    }
+  }
 
   static udf::InfRuleVec SemanticInferenceRules() {
     return {udf::ExplicitRule::Create<DivideUDF>(types::ST_THROUGHPUT_PER_NS,
@@ -114,6 +132,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class MultiplyUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val * b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, udf::NativeType<TReturn>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] * b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Multiplies the arguments.")
         .Details("Multiplies the two values together. Accessible using the `*` operator syntax.")
@@ -240,6 +264,12 @@ template <typename TReturn, typename TArg1, typename TArg2>
 class ModuloUDF : public udf::ScalarUDF {
  public:
   TReturn Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val % b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, udf::NativeType<TReturn>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] % b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Calculates the remainder of the division of the two numbers")
         .Details(
@@ -261,6 +291,12 @@ template <typename TArg1, typename TArg2>
 class LogicalOrUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val || b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] || b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ORs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -280,6 +316,12 @@ template <typename TArg1, typename TArg2>
 class LogicalAndUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1.val && b2.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] && b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean ANDs the passed in values.")
         .Example(R"doc(# Implicit call.
@@ -297,6 +339,11 @@ template <typename TArg1>
 class LogicalNotUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1) { return !b1.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = !b1[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Boolean NOTs the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -313,6 +360,11 @@ template <typename TArg1>
 class NegateUDF : public udf::ScalarUDF {
  public:
   TArg1 Exec(FunctionContext*, TArg1 b1) { return -b1.val; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, size_t n, udf::NativeType<TArg1>* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = -b1[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Negates the passed in value.")
         .Example(R"doc(# Implicit call.
@@ -369,6 +421,12 @@ template <typename TArg1, typename TArg2>
 class EqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 == b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] == b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are equal.")
         .Details(
@@ -389,6 +447,12 @@ template <typename TArg1, typename TArg2>
 class NotEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 != b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] != b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns whether the values are not equal.")
         .Details(
@@ -436,6 +500,12 @@ template <typename TArg1, typename TArg2>
 class GreaterThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 > b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] > b2[i];
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -455,6 +525,12 @@ template <typename TArg1, typename TArg2>
 class GreaterThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 >= b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] >= b2[i];
+    }
+  }
 
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
@@ -475,6 +551,12 @@ template <typename TArg1, typename TArg2>
 class LessThanUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 < b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] < b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than the other.")
         .Example(R"doc(# Implict call.
@@ -491,6 +573,12 @@ template <typename TArg1, typename TArg2>
 class LessThanEqualUDF : public udf::ScalarUDF {
  public:
   BoolValue Exec(FunctionContext*, TArg1 b1, TArg2 b2) { return b1 <= b2; }
+  static void ExecBatch(const udf::NativeType<TArg1>* b1, const udf::NativeType<TArg2>* b2,
+                        size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] <= b2[i];
+    }
+  }
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder("Returns which value is less than or equal to the the other.")
         .Example(R"doc(
@@ -17,6 +17,7 @@
  */
 
 #include <gtest/gtest.h>
+#include <memory>
 #include <numeric>
 #include <type_traits>
 #include <vector>
@@ -30,6 +31,47 @@ namespace px {
 namespace carnot {
 namespace builtins {
 
+// Checks that the batch Exec function of a binary UDF computes the same values as its Exec.
+template <typename TUDF, typename TNative1, typename TNative2>
+void ExpectExecBatchMatchesExec(const std::vector<TNative1>& b1, const std::vector<TNative2>& b2) {
+  static_assert(udf::ScalarUDFTraits<TUDF>::HasExecBatch());
+  ASSERT_EQ(b1.size(), b2.size());
+
+  TUDF udf;
+  using TNativeReturn = decltype(udf.Exec(nullptr, b1[0], b2[0]).val);
+  auto out = std::make_unique<TNativeReturn[]>(b1.size());
+  TUDF::ExecBatch(b1.data(), b2.data(), b1.size(), out.get());
+  for (size_t i = 0; i < b1.size(); ++i) {
+    EXPECT_EQ(udf.Exec(nullptr, b1[i], b2[i]).val, out[i]) << i;
+  }
+}
+
+TEST(MathOps, exec_batch_matches_exec) {
+  const std::vector<int64_t> ints = {-3, 0, 2, 7, 7};
+  const std::vector<int64_t> nonzero_ints = {2, -5, 2, 3, 7};
+  const std::vector<double> floats = {-2.5, 0.0, 2.0, 7.5, 6.9};
+
+  ExpectExecBatchMatchesExec<AddUDF<types::Float64Value, types::Int64Value, types::Float64Value>>(
+      ints, floats);
+  ExpectExecBatchMatchesExec<
+      SubtractUDF<types::Int64Value, types::Int64Value, types::Int64Value>>(ints, nonzero_ints);
+  ExpectExecBatchMatchesExec<
+      MultiplyUDF<types::Float64Value, types::Float64Value, types::Int64Value>>(floats, ints);
+  ExpectExecBatchMatchesExec<
+      DivideUDF<types::Float64Value, types::Int64Value, types::Int64Value>>(ints, nonzero_ints);
+  ExpectExecBatchMatchesExec<
+      ModuloUDF<types::Int64Value, types::Int64Value, types::Int64Value>>(ints, nonzero_ints);
+  ExpectExecBatchMatchesExec<LogicalAndUDF<types::Int64Value, types::Int64Value>>(ints,
+                                                                                   nonzero_ints);
+  ExpectExecBatchMatchesExec<LogicalOrUDF<types::Int64Value, types::Int64Value>>(ints,
+                                                                                  nonzero_ints);
+  ExpectExecBatchMatchesExec<EqualUDF<types::Int64Value, types::Float64Value>>(ints, floats);
+  ExpectExecBatchMatchesExec<GreaterThanUDF<types::Int64Value, types::Int64Value>>(ints,
+                                                                                    nonzero_ints);
+  ExpectExecBatchMatchesExec<LessThanEqualUDF<types::Float64Value, types::Float64Value>>(floats,
+                                                                                          floats);
+}
+
 TEST(MathOps, basic_int64_add_test) {
   auto udf_tester =
       udf::UDFTester<AddUDF<types::Int64Value, types::Int64Value, types::Int64Value>>();
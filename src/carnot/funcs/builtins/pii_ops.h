@@ -62,6 +62,8 @@ class RedactPIIUDF : public udf::ScalarUDF {
   Status Init(FunctionContext*);
   StringValue Exec(FunctionContext*, StringValue input);
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Make a best effort to redact Personally Identifiable Information (PII).")
@@ -17,7 +17,10 @@
  */
 #include <benchmark/benchmark.h>
 
+#include <vector>
+
 #include "src/carnot/funcs/builtins/pii_ops.h"
+#include "src/carnot/udf/udf_wrapper.h"
 
 namespace px {
 namespace carnot {
@@ -49,7 +52,41 @@ static void BM_RedactPII(benchmark::State& state) {
                           static_cast<int64_t>(state.iterations()));
 }
 
+// Redacts a column of records with the given number of distinct values, such as repeated log
+// lines, through the UDF wrapper with and without memoizing the results.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RedactPIIColumn(benchmark::State& state, bool memoize) {
+  constexpr int64_t kNumRecords = 1024;
+  FLAGS_carnot_udf_exec_result_cache_bytes = memoize ? 4 * 1024 * 1024 : 0;
+
+  std::vector<types::StringValue> records;
+  int64_t bytes = 0;
+  for (int64_t i = 0; i < kNumRecords; ++i) {
+    records.push_back(absl::StrCat(i % state.range(0), input_chunk));
+    bytes += records.back().size();
+  }
+  types::StringValueColumnWrapper column(records);
+  udf::FunctionContext ctx(nullptr, nullptr);
+
+  for (auto _ : state) {
+    // Every iteration uses a new instance, so that results are only memoized within it, as they
+    // would be within a query.
+    state.PauseTiming();
+    auto udf = udf::ScalarUDFWrapper<RedactPIIUDF>::Make();
+    PL_CHECK_OK(static_cast<RedactPIIUDF*>(udf.get())->Init(&ctx));
+    types::StringValueColumnWrapper out(kNumRecords);
+    state.ResumeTiming();
+
+    PL_CHECK_OK(udf::ScalarUDFWrapper<RedactPIIUDF>::ExecBatch(udf.get(), &ctx, {&column}, &out,
+                                                                kNumRecords));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetBytesProcessed(bytes * static_cast<int64_t>(state.iterations()));
+}
+
 BENCHMARK(BM_RedactPII)->RangeMultiplier(2)->Range(1, 12);
+BENCHMARK_CAPTURE(BM_RedactPIIColumn, exec, false)->RangeMultiplier(8)->Range(1, 1024);
+BENCHMARK_CAPTURE(BM_RedactPIIColumn, memoized, true)->RangeMultiplier(8)->Range(1, 1024);
 
 }  // namespace builtins
 }  // namespace carnot
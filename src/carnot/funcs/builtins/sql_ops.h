@@ -40,6 +40,8 @@ class NormalizePostgresSQLUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue sql_str, StringValue cmd_code);
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Normalizes PostgresSQL queries by replacing constants with placeholders.")
@@ -65,6 +67,8 @@ class NormalizeMySQLUDF : public udf::ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue sql_str, Int64Value cmd_code);
 
+  static constexpr bool Deterministic() { return true; }
+
   static udf::ScalarUDFDocBuilder Doc() {
     return udf::ScalarUDFDocBuilder(
                "Normalizes MySQL queries by replacing constants with placeholders.")
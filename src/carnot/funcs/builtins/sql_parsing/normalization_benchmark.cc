@@ -19,7 +19,12 @@
 #include <gflags/gflags.h>
 
 #include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "src/carnot/funcs/builtins/sql_ops.h"
 #include "src/carnot/funcs/builtins/sql_parsing/normalization.h"
+#include "src/carnot/udf/udf_wrapper.h"
 #include "src/common/perf/perf.h"
 
 // NOLINTNEXTLINE : runtime/references.
@@ -36,6 +41,38 @@ static void BM_NormalizeMySQL(benchmark::State& state, std::string query) {
   }
 }
 
+// Normalizes a column of queries with the given number of distinct values through the UDF wrapper,
+// with and without memoizing the results. Applications usually send the same few queries over and
+// over.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_NormalizeMySQLColumn(benchmark::State& state, bool memoize) {
+  using px::carnot::builtins::NormalizeMySQLUDF;
+  using px::carnot::udf::ScalarUDFWrapper;
+  constexpr int64_t kNumRecords = 1024;
+  FLAGS_carnot_udf_exec_result_cache_bytes = memoize ? 4 * 1024 * 1024 : 0;
+
+  std::vector<px::types::StringValue> queries;
+  for (int64_t i = 0; i < kNumRecords; ++i) {
+    queries.push_back(absl::Substitute(
+        "SELECT * FROM test WHERE property=$0 AND property2='abcd'", i % state.range(0)));
+  }
+  px::types::StringValueColumnWrapper query_column(queries);
+  px::types::Int64ValueColumnWrapper cmd_code_column(kNumRecords,
+                                                     px::carnot::builtins::kMySQLQueryCmdCode);
+  px::carnot::udf::FunctionContext ctx(nullptr, nullptr);
+
+  for (auto _ : state) {
+    // Every iteration uses a new instance, so that results are only memoized within it, as they
+    // would be within a query.
+    auto udf = ScalarUDFWrapper<NormalizeMySQLUDF>::Make();
+    px::types::StringValueColumnWrapper out(kNumRecords);
+    PL_CHECK_OK(ScalarUDFWrapper<NormalizeMySQLUDF>::ExecBatch(
+        udf.get(), &ctx, {&query_column, &cmd_code_column}, &out, kNumRecords));
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(kNumRecords * static_cast<int64_t>(state.iterations()));
+}
+
 BENCHMARK_CAPTURE(BM_NormalizePgSQL, select,
                   "SELECT * FROM test WHERE property=1234 AND property2='abcd'");
 BENCHMARK_CAPTURE(BM_NormalizePgSQL, select_1, "SELECT 1");
@@ -72,3 +109,6 @@ BENCHMARK_CAPTURE(BM_NormalizeMySQL, sock_shop,
                   "JOIN sock_tag ON sock.sock_id=sock_tag.sock_id JOIN tag ON "
                   "sock_tag.tag_id=tag.tag_id "
                   "WHERE sock.sock_id =abcde GROUP BY sock.sock_id;");
+
+BENCHMARK_CAPTURE(BM_NormalizeMySQLColumn, exec, false)->RangeMultiplier(8)->Range(1, 1024);
+BENCHMARK_CAPTURE(BM_NormalizeMySQLColumn, memoized, true)->RangeMultiplier(8)->Range(1, 1024);
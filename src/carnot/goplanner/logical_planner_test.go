@@ -32,6 +32,7 @@ import (
 	"px.dev/pixie/src/carnot/planner/distributedpb"
 	logical "px.dev/pixie/src/carnot/planner/dynamic_tracing/ir/logicalpb"
 	"px.dev/pixie/src/carnot/planner/plannerpb"
+	"px.dev/pixie/src/carnot/planpb"
 	"px.dev/pixie/src/carnot/udfspb"
 	"px.dev/pixie/src/common/base/statuspb"
 	funcs "px.dev/pixie/src/vizier/funcs/go"
@@ -179,6 +180,46 @@ func TestPlanner_Simple(t *testing.T) {
 		[]uint64{kelvinGRPCSourceParentNode2.Id, kelvinGRPCSourceParentNode1.Id})
 }
 
+// TestPlanner_MemorySourcePredicates makes sure that the column predicates the C++ planner
+// pushes into memory sources come back intact in the Go plan.
+func TestPlanner_MemorySourcePredicates(t *testing.T) {
+	var udfInfoPb udfspb.UDFInfo
+	b, err := funcs.Asset("src/vizier/funcs/data/udf.pb")
+	require.NoError(t, err)
+
+	err = proto.Unmarshal(b, &udfInfoPb)
+	require.NoError(t, err)
+
+	c, err := goplanner.New(&udfInfoPb)
+	require.NoError(t, err)
+	defer c.Free()
+
+	query := "import px\ndf = px.DataFrame(table='table1')\ndf = df[df.cpu_cycles > 10]\npx.display(df, 'out')"
+	plannerStatePB := new(distributedpb.LogicalPlannerState)
+	err = proto.UnmarshalText(plannerStatePBStr, plannerStatePB)
+	require.NoError(t, err)
+
+	queryRequestPB := &plannerpb.QueryRequest{
+		QueryStr: query,
+	}
+	plannerResultPB, err := c.Plan(plannerStatePB, queryRequestPB)
+	require.NoError(t, err)
+	assert.Equal(t, statuspb.OK, plannerResultPB.Status.ErrCode)
+
+	for _, pem := range []string{"pem1", "pem2"} {
+		pemPlan := plannerResultPB.Plan.QbAddressToPlan[pem]
+		require.NotNil(t, pemPlan)
+		memSrc := pemPlan.Nodes[0].Nodes[0].Op.GetMemSourceOp()
+		require.NotNil(t, memSrc)
+		require.Equal(t, 1, len(memSrc.Predicates))
+		predicate := memSrc.Predicates[0]
+		// cpu_cycles is the second column of table1.
+		assert.Equal(t, int64(1), predicate.ColumnIdx)
+		assert.Equal(t, planpb.ColumnPredicate_GREATER_THAN, predicate.Op)
+		assert.Equal(t, int64(10), predicate.Value.GetInt64Value())
+	}
+}
+
 func TestPlanner_MissingTable(t *testing.T) {
 	// Create the compiler.
 	c, err := goplanner.New(&udfspb.UDFInfo{})
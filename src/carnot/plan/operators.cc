@@ -588,6 +588,15 @@ Status JoinOperator::Init(const planpb::JoinOperator& pb) {
     equality_conditions_.emplace_back(pb_.equality_conditions(i));
   }
 
+  if (streaming()) {
+    if (streaming_window().window_ns() <= 0) {
+      return error::InvalidArgument("Streaming joins must have a positive window, got $0.",
+                                    streaming_window().window_ns());
+    }
+    // Streaming joins emit rows in arrival order, they are never ordered by time.
+    return Status::OK();
+  }
+
   if (order_by_time()) {
     // Only support inner joins and left joins where the time_ column comes from the left table.
     // We need a time_ value for every output row in the ordered case to preserve time ordering.
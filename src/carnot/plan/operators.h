@@ -96,6 +96,9 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool infinite_stream() const { return pb_.streaming(); }
+  const google::protobuf::RepeatedPtrField<planpb::ColumnPredicate>& predicates() const {
+    return pb_.predicates();
+  }
 
  private:
   planpb::MemorySourceOperator pb_;
@@ -316,6 +319,11 @@ class JoinOperator : public Operator {
   bool order_by_time() const;
   planpb::JoinOperator::ParentColumn time_column() const;
 
+  bool streaming() const { return pb_.has_streaming_window(); }
+  const planpb::JoinOperator::StreamingWindow& streaming_window() const {
+    return pb_.streaming_window();
+  }
+
  private:
   std::vector<std::string> column_names_;
   std::vector<planpb::JoinOperator::EqualityCondition> equality_conditions_;
@@ -19,6 +19,7 @@
 #include <queue>
 
 #include "src/carnot/planner/compiler/analyzer/resolve_stream_rule.h"
+#include "src/carnot/planner/ir/join_ir.h"
 #include "src/carnot/planner/ir/stream_ir.h"
 
 namespace px {
@@ -44,7 +45,10 @@ StatusOr<bool> ResolveStreamRule::Apply(IRNode* ir_node) {
     auto node = nodes.front();
     nodes.pop();
 
-    if (node->IsBlocking()) {
+    // Joins of two streams run as windowed joins, so they don't block on their inputs.
+    if (Match(node, Join())) {
+      static_cast<JoinIR*>(node)->set_streaming(true);
+    } else if (node->IsBlocking()) {
       return error::Unimplemented("df.stream() not yet supported with blocking operator %s",
                                   node->DebugString());
     }
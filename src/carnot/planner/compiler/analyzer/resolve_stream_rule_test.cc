@@ -47,6 +47,23 @@ TEST_F(RulesTest, resolve_stream) {
   EXPECT_THAT(sink->parents(), ElementsAre(filter));
 }
 
+TEST_F(RulesTest, resolve_stream_join) {
+  Relation relation = MakeTimeRelation();
+  MemorySourceIR* left = MakeMemSource(relation);
+  MemorySourceIR* right = MakeMemSource(relation);
+  JoinIR* join = MakeJoin({left, right}, "inner", relation, relation, {"cpu0"}, {"cpu0"});
+  StreamIR* stream = graph->CreateNode<StreamIR>(ast, join).ValueOrDie();
+  MakeMemSink(stream, "");
+
+  ResolveStreamRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ValueOrDie());
+  EXPECT_TRUE(join->streaming());
+  EXPECT_TRUE(left->streaming());
+  EXPECT_TRUE(right->streaming());
+}
+
 TEST_F(RulesTest, resolve_stream_no_stream) {
   MemorySourceIR* mem_source = MakeMemSource();
   GroupByIR* group_by = MakeGroupBy(mem_source, {MakeColumn("col1", 0), MakeColumn("col2", 0)});
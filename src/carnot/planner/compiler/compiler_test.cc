@@ -3255,6 +3255,79 @@ TEST_F(CompilerTest, crash) {
               HasCompilerError(R"err(Expected 'string', received 'data_type_unknown')err"));
 }
 
+constexpr char kStreamingJoinQuery[] = R"pxl(
+import px
+src1 = px.DataFrame(table='http_table', select=['time_', 'upid', 'resp_status'])
+src2 = px.DataFrame(table='process_stats', select=['upid', 'time_', 'num_threads'])
+df = src1.merge(src2, how='inner', left_on=['upid'], right_on=['upid'], suffixes=['', '_x'],
+                window='5s')
+px.display(df.stream())
+)pxl";
+
+TEST_F(CompilerTest, streaming_join) {
+  auto graph_or_s = compiler_.CompileToIR(kStreamingJoinQuery, compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  for (IRNode* src : graph->FindNodesOfType(IRNodeType::kMemorySource)) {
+    EXPECT_TRUE(static_cast<MemorySourceIR*>(src)->streaming());
+  }
+  std::vector<IRNode*> joins = graph->FindNodesOfType(IRNodeType::kJoin);
+  ASSERT_EQ(1, joins.size());
+  auto join = static_cast<JoinIR*>(joins[0]);
+  EXPECT_TRUE(join->streaming());
+
+  planpb::Operator pb;
+  ASSERT_OK(join->ToProto(&pb));
+  ASSERT_TRUE(pb.join_op().has_streaming_window());
+  EXPECT_EQ(5 * 1000 * 1000 * 1000LL, pb.join_op().streaming_window().window_ns());
+  EXPECT_EQ(0, pb.join_op().streaming_window().left_time_column_index());
+  EXPECT_EQ(1, pb.join_op().streaming_window().right_time_column_index());
+}
+
+TEST_F(CompilerTest, batch_join_has_no_streaming_window) {
+  auto graph_or_s = compiler_.CompileToIR(absl::Substitute(kJoinQueryTypeTpl, "inner"),
+                                          compiler_state_.get());
+  ASSERT_OK(graph_or_s);
+  auto graph = graph_or_s.ConsumeValueOrDie();
+
+  std::vector<IRNode*> joins = graph->FindNodesOfType(IRNodeType::kJoin);
+  ASSERT_EQ(1, joins.size());
+  planpb::Operator pb;
+  ASSERT_OK(static_cast<JoinIR*>(joins[0])->ToProto(&pb));
+  EXPECT_FALSE(pb.join_op().has_streaming_window());
+}
+
+constexpr char kStreamingJoinNoTimeQuery[] = R"pxl(
+import px
+src1 = px.DataFrame(table='http_table', select=['time_', 'upid', 'resp_status'])
+src2 = px.DataFrame(table='network', select=['upid', 'bytes_in'])
+df = src1.merge(src2, how='inner', left_on=['upid'], right_on=['upid'], suffixes=['', '_x'])
+px.display(df.stream())
+)pxl";
+
+TEST_F(CompilerTest, streaming_join_requires_time_column) {
+  auto graph_or_s = compiler_.CompileToIR(kStreamingJoinNoTimeQuery, compiler_state_.get());
+  ASSERT_NOT_OK(graph_or_s);
+  EXPECT_THAT(graph_or_s.status(),
+              HasCompilerError("Streaming merge requires a 'time_' column in both DataFrames"));
+}
+
+constexpr char kStreamingJoinBadWindowQuery[] = R"pxl(
+import px
+src1 = px.DataFrame(table='http_table', select=['time_', 'upid', 'resp_status'])
+src2 = px.DataFrame(table='process_stats', select=['upid', 'time_', 'num_threads'])
+df = src1.merge(src2, how='inner', left_on=['upid'], right_on=['upid'], suffixes=['', '_x'],
+                window='0s')
+px.display(df.stream())
+)pxl";
+
+TEST_F(CompilerTest, streaming_join_bad_window) {
+  auto graph_or_s = compiler_.CompileToIR(kStreamingJoinBadWindowQuery, compiler_state_.get());
+  ASSERT_NOT_OK(graph_or_s);
+  EXPECT_THAT(graph_or_s.status(), HasCompilerError("'window' must be a positive duration"));
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
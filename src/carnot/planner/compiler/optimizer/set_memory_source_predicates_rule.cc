@@ -0,0 +1,158 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/compiler/optimizer/set_memory_source_predicates_rule.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+namespace {
+
+// Returns the predicate op for `column <opcode> literal`, or false if the opcode can't be pushed
+// down. If the literal is on the left hand side, the comparison is flipped.
+bool ToPredicateOp(FuncIR::Opcode opcode, bool literal_on_left, planpb::ColumnPredicate::Op* op) {
+  switch (opcode) {
+    case FuncIR::Opcode::eq:
+      *op = planpb::ColumnPredicate::EQUAL;
+      return true;
+    case FuncIR::Opcode::lt:
+      *op = literal_on_left ? planpb::ColumnPredicate::GREATER_THAN
+                            : planpb::ColumnPredicate::LESS_THAN;
+      return true;
+    case FuncIR::Opcode::lteq:
+      *op = literal_on_left ? planpb::ColumnPredicate::GREATER_THAN_EQUAL
+                            : planpb::ColumnPredicate::LESS_THAN_EQUAL;
+      return true;
+    case FuncIR::Opcode::gt:
+      *op = literal_on_left ? planpb::ColumnPredicate::LESS_THAN
+                            : planpb::ColumnPredicate::GREATER_THAN;
+      return true;
+    case FuncIR::Opcode::gteq:
+      *op = literal_on_left ? planpb::ColumnPredicate::LESS_THAN_EQUAL
+                            : planpb::ColumnPredicate::GREATER_THAN_EQUAL;
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool SamePredicates(const std::vector<planpb::ColumnPredicate>& a,
+                    const std::vector<planpb::ColumnPredicate>& b) {
+  return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+                    [](const planpb::ColumnPredicate& lhs, const planpb::ColumnPredicate& rhs) {
+                      return lhs.SerializeAsString() == rhs.SerializeAsString();
+                    });
+}
+
+}  // namespace
+
+void SetMemorySourcePredicatesRule::AddPredicates(
+    const MemorySourceIR* mem_src, ExpressionIR* expr,
+    std::vector<planpb::ColumnPredicate>* predicates) {
+  if (!Match(expr, Func())) {
+    return;
+  }
+  auto func = static_cast<FuncIR*>(expr);
+  if (func->all_args().size() != 2) {
+    return;
+  }
+  if (func->opcode() == FuncIR::Opcode::logand) {
+    AddPredicates(mem_src, func->all_args()[0], predicates);
+    AddPredicates(mem_src, func->all_args()[1], predicates);
+    return;
+  }
+
+  ExpressionIR* lhs = func->all_args()[0];
+  ExpressionIR* rhs = func->all_args()[1];
+  bool literal_on_left = Match(lhs, DataNode()) && Match(rhs, ColumnNode());
+  if (!literal_on_left && !(Match(lhs, ColumnNode()) && Match(rhs, DataNode()))) {
+    return;
+  }
+  auto col = static_cast<ColumnIR*>(literal_on_left ? rhs : lhs);
+  auto data = static_cast<DataIR*>(literal_on_left ? lhs : rhs);
+
+  planpb::ColumnPredicate::Op op;
+  if (!ToPredicateOp(func->opcode(), literal_on_left, &op)) {
+    return;
+  }
+
+  // The filter columns come straight from the source, so they can be mapped back to the table.
+  const auto& col_names = mem_src->resolved_table_type()->ColumnNames();
+  auto it = std::find(col_names.begin(), col_names.end(), col->col_name());
+  if (it == col_names.end()) {
+    return;
+  }
+  auto col_type = mem_src->resolved_table_type()->GetColumnType(col->col_name());
+  if (!col_type.ok()) {
+    return;
+  }
+  auto col_data_type =
+      std::static_pointer_cast<ValueType>(col_type.ConsumeValueOrDie())->data_type();
+
+  planpb::ColumnPredicate predicate;
+  predicate.set_column_idx(mem_src->column_index_map()[std::distance(col_names.begin(), it)]);
+  predicate.set_op(op);
+  if (!data->ToProto(predicate.mutable_value()).ok()) {
+    return;
+  }
+  // Time columns are usually compared to plain ints.
+  if (col_data_type == types::DataType::TIME64NS &&
+      predicate.value().data_type() == types::DataType::INT64) {
+    int64_t value = predicate.value().int64_value();
+    predicate.mutable_value()->set_data_type(types::DataType::TIME64NS);
+    predicate.mutable_value()->set_time64_ns_value(value);
+  }
+  if (predicate.value().data_type() != col_data_type) {
+    return;
+  }
+  predicates->push_back(std::move(predicate));
+}
+
+StatusOr<bool> SetMemorySourcePredicatesRule::Apply(IRNode* ir_node) {
+  if (!Match(ir_node, MemorySource())) {
+    return false;
+  }
+  auto mem_src = static_cast<MemorySourceIR*>(ir_node);
+  if (!mem_src->is_type_resolved() || !mem_src->column_index_map_set()) {
+    return false;
+  }
+
+  std::vector<planpb::ColumnPredicate> predicates;
+  OperatorIR* op = mem_src;
+  while (op->Children().size() == 1 && Match(op->Children()[0], Filter())) {
+    auto filter = static_cast<FilterIR*>(op->Children()[0]);
+    AddPredicates(mem_src, filter->filter_expr(), &predicates);
+    op = filter;
+  }
+
+  if (SamePredicates(predicates, mem_src->predicates())) {
+    return false;
+  }
+  mem_src->SetPredicates(predicates);
+  return true;
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+/**
+ * @brief SetMemorySourcePredicatesRule pushes the simple comparisons of the filters that directly
+ * follow a memory source into the source, so that the source can skip the batches of the table
+ * whose zone maps show that no row can pass the filters.
+ *
+ * Only the conjuncts of the form `column <op> literal` (or `literal <op> column`) where op is one
+ * of ==, <, <=, >, >= are pushed down. The filters are left in place, since the source only skips
+ * whole batches and never filters rows.
+ */
+class SetMemorySourcePredicatesRule : public Rule {
+ public:
+  SetMemorySourcePredicatesRule()
+      : Rule(nullptr, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override;
+
+ private:
+  static void AddPredicates(const MemorySourceIR* mem_src, ExpressionIR* expr,
+                            std::vector<planpb::ColumnPredicate>* predicates);
+};
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
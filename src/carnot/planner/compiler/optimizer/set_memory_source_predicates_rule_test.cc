@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/planner/compiler/optimizer/set_memory_source_predicates_rule.h"
+#include "src/carnot/planner/compiler/test_utils.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace compiler {
+
+using SetMemorySourcePredicatesRuleTest = RulesTest;
+
+TEST_F(SetMemorySourcePredicatesRuleTest, pushes_comparisons_with_literals) {
+  auto relation = MakeRelation();
+  compiler_state_->relation_map()->emplace("table", relation);
+  // Only select some of the columns, so that output and table column indices differ.
+  MemorySourceIR* mem_src = MakeMemSource("table", relation, {"cpu1", "count"});
+  ASSERT_OK(mem_src->ResolveType(compiler_state_.get()));
+
+  // count == 10 and 5 < count
+  auto eq = MakeEqualsFunc(MakeColumn("count", 0), MakeInt(10));
+  std::vector<ExpressionIR*> lt_args{MakeInt(5), MakeColumn("count", 0)};
+  auto lt = graph->CreateNode<FuncIR>(ast, FuncIR::op_map.find("<")->second, lt_args)
+                .ConsumeValueOrDie();
+  auto filter1 = MakeFilter(mem_src, MakeAndFunc(eq, lt));
+  // cpu1 > 1 can't be pushed down, since the literal type doesn't match the column.
+  std::vector<ExpressionIR*> gt_args{MakeColumn("cpu1", 0), MakeInt(1)};
+  auto gt = graph->CreateNode<FuncIR>(ast, FuncIR::op_map.find(">")->second, gt_args)
+                .ConsumeValueOrDie();
+  auto filter2 = MakeFilter(filter1, gt);
+  MakeMemSink(filter2, "out");
+
+  SetMemorySourcePredicatesRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_TRUE(result.ConsumeValueOrDie());
+
+  ASSERT_EQ(2, mem_src->predicates().size());
+  EXPECT_EQ(0, mem_src->predicates()[0].column_idx());
+  EXPECT_EQ(planpb::ColumnPredicate::EQUAL, mem_src->predicates()[0].op());
+  EXPECT_EQ(10, mem_src->predicates()[0].value().int64_value());
+  EXPECT_EQ(0, mem_src->predicates()[1].column_idx());
+  EXPECT_EQ(planpb::ColumnPredicate::GREATER_THAN, mem_src->predicates()[1].op());
+  EXPECT_EQ(5, mem_src->predicates()[1].value().int64_value());
+
+  // The filters stay in place, and running the rule again doesn't change anything.
+  EXPECT_TRUE(graph->HasNode(filter1->id()));
+  EXPECT_TRUE(graph->HasNode(filter2->id()));
+  result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+
+  planpb::Operator op;
+  ASSERT_OK(mem_src->ToProto(&op));
+  EXPECT_EQ(2, op.mem_source_op().predicates_size());
+}
+
+TEST_F(SetMemorySourcePredicatesRuleTest, no_filter) {
+  auto relation = MakeRelation();
+  compiler_state_->relation_map()->emplace("table", relation);
+  MemorySourceIR* mem_src = MakeMemSource("table", relation);
+  ASSERT_OK(mem_src->ResolveType(compiler_state_.get()));
+  auto map = MakeMap(mem_src, {{"count", MakeColumn("count", 0)}});
+  MakeFilter(map, MakeEqualsFunc(MakeColumn("count", 0), MakeInt(10)));
+
+  SetMemorySourcePredicatesRule rule;
+  auto result = rule.Execute(graph.get());
+  ASSERT_OK(result);
+  EXPECT_FALSE(result.ConsumeValueOrDie());
+  EXPECT_TRUE(mem_src->predicates().empty());
+}
+
+}  // namespace compiler
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -51,6 +51,8 @@ Status JoinIR::CopyFromNodeImpl(const IRNode* node,
 
   PL_RETURN_IF_ERROR(SetJoinColumns(new_left_columns, new_right_columns));
   suffix_strs_ = join_node->suffix_strs_;
+  streaming_ = join_node->streaming_;
+  streaming_window_ns_ = join_node->streaming_window_ns_;
   return Status::OK();
 }
 
@@ -111,6 +113,19 @@ Status JoinIR::ToProto(planpb::Operator* op) const {
   for (const auto& col_name : column_names_) {
     *(pb->add_column_names()) = col_name;
   }
+  if (streaming_) {
+    auto window_pb = pb->mutable_streaming_window();
+    window_pb->set_window_ns(streaming_window_ns_);
+    int64_t left_time_idx = parents()[0]->resolved_table_type()->GetColumnIndex(kTimeColumnName);
+    int64_t right_time_idx = parents()[1]->resolved_table_type()->GetColumnIndex(kTimeColumnName);
+    if (left_time_idx == -1 || right_time_idx == -1) {
+      return CreateIRNodeError("Streaming merge requires a '$0' column in both DataFrames",
+                               kTimeColumnName);
+    }
+    window_pb->set_left_time_column_index(left_time_idx);
+    window_pb->set_right_time_column_index(right_time_idx);
+  }
+
   // NOTE: not setting value as this is set in the execution engine. Keeping this here in case it
   // needs to be modified in the future.
   // pb->set_rows_per_batch(1024);
@@ -174,6 +189,11 @@ StatusOr<std::vector<absl::flat_hash_set<std::string>>> JoinIR::RequiredInputCol
     DCHECK(col->container_op_parent_idx_set());
     ret[col->container_op_parent_idx()].insert(col->col_name());
   }
+  // Streaming joins window the rows of both inputs on their time_ column.
+  if (streaming_) {
+    ret[0].insert(kTimeColumnName);
+    ret[1].insert(kTimeColumnName);
+  }
 
   return ret;
 }
@@ -217,6 +237,11 @@ Status JoinIR::UpdateOpAfterParentTypesResolvedImpl() {
   DCHECK_EQ(2UL, parents().size());
   const auto& [left_type, right_type] = left_right_table_types();
   const auto& [left_suffix, right_suffix] = left_right_suffixs();
+  if (streaming_ && (!left_type->HasColumn(kTimeColumnName) ||
+                     !right_type->HasColumn(kTimeColumnName))) {
+    return CreateIRNodeError("Streaming merge requires a '$0' column in both DataFrames",
+                             kTimeColumnName);
+  }
 
   absl::flat_hash_set<std::string> left_column_names(left_type->ColumnNames().begin(),
                                                      left_type->ColumnNames().end());
@@ -42,6 +42,7 @@ namespace planner {
 class JoinIR : public OperatorIR {
  public:
   enum class JoinType { kLeft, kRight, kOuter, kInner };
+  inline static constexpr char kTimeColumnName[] = "time_";
 
   JoinIR() = delete;
   explicit JoinIR(int64_t id) : OperatorIR(id, IRNodeType::kJoin) {}
@@ -90,6 +91,15 @@ class JoinIR : public OperatorIR {
                           const std::vector<ColumnIR*>& columns);
   bool specified_as_right() const { return specified_as_right_; }
 
+  /**
+   * @brief Whether this join is fed by df.stream() inputs. Streaming joins are planned as a
+   * windowed (symmetric hash) join keyed on the time_ column of both inputs.
+   */
+  bool streaming() const { return streaming_; }
+  void set_streaming(bool streaming) { streaming_ = streaming; }
+  int64_t streaming_window_ns() const { return streaming_window_ns_; }
+  void SetStreamingWindowNS(int64_t window_ns) { streaming_window_ns_ = window_ns; }
+
   StatusOr<std::vector<absl::flat_hash_set<std::string>>> RequiredInputColumns() const override;
 
   const std::tuple<std::shared_ptr<TableType>, std::shared_ptr<TableType>> left_right_table_types()
@@ -161,6 +171,11 @@ class JoinIR : public OperatorIR {
   // Whether this join was originally specified as a right join.
   // Used because we transform left joins into right joins but need to do some back transform.
   bool specified_as_right_ = false;
+
+  // Whether the inputs of this join are infinite streams.
+  bool streaming_ = false;
+  // How far apart the time_ values of two rows can be for them to match when streaming.
+  int64_t streaming_window_ns_ = 0;
 };
 
 }  // namespace planner
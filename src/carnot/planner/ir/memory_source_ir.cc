@@ -61,6 +61,9 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+  for (const auto& predicate : predicates_) {
+    *pb->add_predicates() = predicate;
+  }
   return Status::OK();
 }
 
@@ -135,6 +138,7 @@ Status MemorySourceIR::CopyFromNodeImpl(
   column_index_map_ = source_ir->column_index_map_;
   has_time_expressions_ = source_ir->has_time_expressions_;
   streaming_ = source_ir->streaming_;
+  predicates_ = source_ir->predicates_;
 
   if (has_time_expressions_) {
     PL_ASSIGN_OR_RETURN(ExpressionIR * new_start_expr,
@@ -119,6 +119,13 @@ class MemorySourceIR : public OperatorIR {
 
   bool IsSource() const override { return true; }
 
+  // Predicates on the table columns that are used to skip batches of the table that can't hold
+  // any rows passing the filters downstream of this source.
+  const std::vector<planpb::ColumnPredicate>& predicates() const { return predicates_; }
+  void SetPredicates(const std::vector<planpb::ColumnPredicate>& predicates) {
+    predicates_ = predicates;
+  }
+
   Status ResolveType(CompilerState* compiler_state);
 
  protected:
@@ -146,6 +153,8 @@ class MemorySourceIR : public OperatorIR {
 
   types::TabletID tablet_value_;
   bool has_tablet_value_ = false;
+
+  std::vector<planpb::ColumnPredicate> predicates_;
 };
 
 }  // namespace planner
@@ -136,9 +136,21 @@ StatusOr<QLObjectPtr> JoinHandler(IR* graph, OperatorIR* op, const pypa::AstPtr&
                                       suffix_strs.size());
   }
 
+  PL_ASSIGN_OR_RETURN(StringIR * window, GetArgAs<StringIR>(ast, args, "window"));
+  auto window_ns_or_s = StringToTimeInt(window->str());
+  if (!window_ns_or_s.ok()) {
+    return WrapAstError(window->ast(), window_ns_or_s.status());
+  }
+  int64_t window_ns = window_ns_or_s.ConsumeValueOrDie();
+  if (window_ns <= 0) {
+    return window->CreateIRNodeError("'window' must be a positive duration. Received '$0'",
+                                     window->str());
+  }
+
   PL_ASSIGN_OR_RETURN(JoinIR * join_op,
                       graph->CreateNode<JoinIR>(ast, std::vector<OperatorIR*>{op, right}, how_type,
                                                 left_on_cols, right_on_cols, suffix_strs));
+  join_op->SetStreamingWindowNS(window_ns);
   return Dataframe::Create(join_op, visitor);
 }
 
@@ -386,13 +398,13 @@ Status Dataframe::Init() {
 
   /**
    * # Equivalent to the python method method syntax:
-   * def merge(self, right, how, left_on, right_on, suffixes=['_x', '_y']):
+   * def merge(self, right, how, left_on, right_on, suffixes=['_x', '_y'], window='10s'):
    *     ...
    */
   PL_ASSIGN_OR_RETURN(
       std::shared_ptr<FuncObject> mergefn,
-      FuncObject::Create(kMergeOpID, {"right", "how", "left_on", "right_on", "suffixes"},
-                         {{"suffixes", "['_x', '_y']"}},
+      FuncObject::Create(kMergeOpID, {"right", "how", "left_on", "right_on", "suffixes", "window"},
+                         {{"suffixes", "['_x', '_y']"}, {"window", "'10s'"}},
                          /* has_variable_len_args */ false,
                          /* has_variable_len_kwargs */ false,
                          std::bind(&JoinHandler, graph(), op(), std::placeholders::_1,
@@ -307,6 +307,9 @@ class Dataframe : public QLObject {
     left_on (Union[string, List[string]]): Column name from this DataFrame, either as a string or a list of strings.
     right_on (Union[string, List[string]]): Column name from the right DataFarme to join on. Must be the same type as the `left_on` column.
     suffixes (Tuple[string, string], default ['_x', '_y']): The suffixes to apply to duplicate columns.
+    window (string, default '10s'): Only used when the result is streamed with `df.stream()`. Rows from the
+      two streams only match if their `time_` values are at most this far apart, and buffered rows are
+      dropped once the other stream has moved past them by more than the window.
 
   Returns:
     px.DataFrame: Merged DataFrame with the relation
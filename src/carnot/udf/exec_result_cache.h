@@ -0,0 +1,188 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/hash/hash.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+DECLARE_int64(carnot_udf_exec_result_cache_bytes);
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+// The number of lookups over which the hit rate of an exec result cache is measured.
+constexpr int64_t kExecResultCacheHitRateWindow = 1024;
+// A cache that hits on fewer than 1 in this many lookups of a window is disabled.
+constexpr int64_t kExecResultCacheMinHitRateInverse = 8;
+
+/**
+ * ExecResultCacheBase is the untyped base of ExecResultCache, so that the cache can be owned by
+ * the ScalarUDF instance.
+ */
+class ExecResultCacheBase {
+ public:
+  virtual ~ExecResultCacheBase() = default;
+};
+
+/**
+ * The type under which an argument value is stored in the keys of an ExecResultCache, and the
+ * type under which it is looked up without copying it.
+ */
+template <typename TValue>
+struct ExecResultCacheKeyTraits {
+  using type = decltype(TValue::val);
+  using view_type = type;
+  static view_type View(const TValue& v) { return v.val; }
+  static size_t DynamicBytes(const TValue&) { return 0; }
+};
+
+template <>
+struct ExecResultCacheKeyTraits<types::StringValue> {
+  using type = std::string;
+  using view_type = std::string_view;
+  static view_type View(std::string_view v) { return v; }
+  static size_t DynamicBytes(std::string_view v) { return v.size(); }
+};
+
+/**
+ * ExecResultCache memoizes the results of the Exec function of a deterministic ScalarUDF, keyed
+ * on the values of its arguments.
+ *
+ * The cache is bounded by the bytes held by its keys and results, and is cleared once it's full.
+ * Caching costs a hash and a copy of the arguments on every miss, so a cache that rarely hits
+ * (ie. the arguments are mostly distinct) disables itself after a window of lookups.
+ */
+template <typename TReturn, typename... TArgs>
+class ExecResultCache : public ExecResultCacheBase {
+ public:
+  explicit ExecResultCache(int64_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /**
+   * Returns the result of Exec on the given arguments, calling compute to get it if it's not
+   * cached yet. The arguments may also be the native values of the argument types.
+   */
+  template <typename TComputeFn, typename... Args>
+  TReturn GetOrCompute(TComputeFn compute, const Args&... args) {
+    static_assert(sizeof...(Args) == sizeof...(TArgs), "wrong number of arguments");
+    if (!enabled_) {
+      return compute();
+    }
+    KeyView key(ExecResultCacheKeyTraits<TArgs>::View(args)...);
+    auto it = results_.find(key);
+    if (it != results_.end()) {
+      TReturn result = it->second;
+      UpdateHitRate(/* hit */ true);
+      return result;
+    }
+    UpdateHitRate(/* hit */ false);
+
+    TReturn result = compute();
+    if (enabled_) {
+      Insert(result, args...);
+    }
+    return result;
+  }
+
+  bool enabled() const { return enabled_; }
+  size_t size() const { return results_.size(); }
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  using Key = std::tuple<typename ExecResultCacheKeyTraits<TArgs>::type...>;
+  using KeyView = std::tuple<typename ExecResultCacheKeyTraits<TArgs>::view_type...>;
+
+  template <typename T>
+  static KeyView ToView(const T& key) {
+    if constexpr (std::is_same_v<T, KeyView>) {
+      return key;
+    } else {
+      return std::apply([](const auto&... v) { return KeyView(v...); }, key);
+    }
+  }
+
+  // Strings are hashed as string_views, so that keys can be looked up without copying them.
+  struct KeyHash {
+    using is_transparent = void;
+    template <typename T>
+    size_t operator()(const T& key) const {
+      return absl::Hash<KeyView>{}(ToView(key));
+    }
+  };
+
+  struct KeyEq {
+    using is_transparent = void;
+    template <typename T, typename U>
+    bool operator()(const T& lhs, const U& rhs) const {
+      return ToView(lhs) == ToView(rhs);
+    }
+  };
+
+  void UpdateHitRate(bool hit) {
+    window_hits_ += hit;
+    if (++window_lookups_ < kExecResultCacheHitRateWindow) {
+      return;
+    }
+    if (window_hits_ * kExecResultCacheMinHitRateInverse < window_lookups_) {
+      enabled_ = false;
+      results_.clear();
+      bytes_ = 0;
+    }
+    window_lookups_ = 0;
+    window_hits_ = 0;
+  }
+
+  template <typename... Args>
+  void Insert(const TReturn& result, const Args&... args) {
+    int64_t entry_bytes = sizeof(Key) + sizeof(TReturn) +
+                          ExecResultCacheKeyTraits<TReturn>::DynamicBytes(result) +
+                          (ExecResultCacheKeyTraits<TArgs>::DynamicBytes(args) + ... + 0);
+    if (entry_bytes > max_bytes_) {
+      return;
+    }
+    if (bytes_ + entry_bytes > max_bytes_) {
+      results_.clear();
+      bytes_ = 0;
+    }
+    results_.emplace(Key(typename ExecResultCacheKeyTraits<TArgs>::type(
+                         ExecResultCacheKeyTraits<TArgs>::View(args))...),
+                     result);
+    bytes_ += entry_bytes;
+  }
+
+  const int64_t max_bytes_;
+  int64_t bytes_ = 0;
+  bool enabled_ = true;
+  int64_t window_lookups_ = 0;
+  int64_t window_hits_ = 0;
+  absl::flat_hash_map<Key, TReturn, KeyHash, KeyEq> results_;
+};
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
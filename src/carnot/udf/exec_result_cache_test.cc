@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/carnot/udf/exec_result_cache.h"
+
+namespace px {
+namespace carnot {
+namespace udf {
+
+using StringConcatCache =
+    ExecResultCache<types::StringValue, types::StringValue, types::Int64Value>;
+
+TEST(ExecResultCache, memoizes_results) {
+  StringConcatCache cache(1024 * 1024);
+  int num_computed = 0;
+  auto get = [&](const std::string& s, int64_t i) {
+    return cache.GetOrCompute(
+        [&]() {
+          ++num_computed;
+          return types::StringValue(s + std::to_string(i));
+        },
+        types::StringValue(s), types::Int64Value(i));
+  };
+
+  EXPECT_EQ("a1", get("a", 1));
+  EXPECT_EQ("a2", get("a", 2));
+  EXPECT_EQ("b1", get("b", 1));
+  EXPECT_EQ(3, num_computed);
+
+  EXPECT_EQ("a1", get("a", 1));
+  EXPECT_EQ("b1", get("b", 1));
+  EXPECT_EQ(3, num_computed);
+  EXPECT_EQ(3, cache.size());
+}
+
+TEST(ExecResultCache, native_arguments) {
+  StringConcatCache cache(1024 * 1024);
+  int num_computed = 0;
+  auto compute = [&]() {
+    ++num_computed;
+    return types::StringValue("res");
+  };
+
+  cache.GetOrCompute(compute, types::StringValue("abc"), types::Int64Value(1));
+  // The values of arrow arrays are passed as their native type.
+  cache.GetOrCompute(compute, std::string("abc"), int64_t{1});
+  EXPECT_EQ(1, num_computed);
+}
+
+TEST(ExecResultCache, cleared_when_full) {
+  // Room for two entries with 10 byte strings.
+  constexpr int64_t kEntryBytes = sizeof(std::tuple<std::string, int64_t>) +
+                                  sizeof(types::StringValue) + 2 * 10;
+  StringConcatCache cache(2 * kEntryBytes);
+  auto compute = []() { return types::StringValue("0123456789"); };
+
+  cache.GetOrCompute(compute, types::StringValue("abcdefghi0"), types::Int64Value(1));
+  cache.GetOrCompute(compute, types::StringValue("abcdefghi1"), types::Int64Value(1));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(2 * kEntryBytes, cache.bytes());
+
+  cache.GetOrCompute(compute, types::StringValue("abcdefghi2"), types::Int64Value(1));
+  EXPECT_EQ(1, cache.size());
+  EXPECT_EQ(kEntryBytes, cache.bytes());
+
+  // Entries that are larger than the whole cache are not cached.
+  cache.GetOrCompute(compute, types::StringValue(std::string(3 * kEntryBytes, 'a')),
+                     types::Int64Value(1));
+  EXPECT_EQ(1, cache.size());
+}
+
+TEST(ExecResultCache, disabled_when_rarely_hit) {
+  StringConcatCache cache(1024 * 1024);
+  int num_computed = 0;
+  auto compute = [&]() {
+    ++num_computed;
+    return types::StringValue("res");
+  };
+
+  for (int64_t i = 0; i < kExecResultCacheHitRateWindow; ++i) {
+    cache.GetOrCompute(compute, types::StringValue("abc"), types::Int64Value(i));
+  }
+  EXPECT_FALSE(cache.enabled());
+  EXPECT_EQ(0, cache.size());
+
+  // Every lookup computes the result once the cache is disabled.
+  cache.GetOrCompute(compute, types::StringValue("abc"), types::Int64Value(0));
+  cache.GetOrCompute(compute, types::StringValue("abc"), types::Int64Value(0));
+  EXPECT_EQ(kExecResultCacheHitRateWindow + 2, num_computed);
+}
+
+TEST(ExecResultCache, stays_enabled_when_hit) {
+  StringConcatCache cache(1024 * 1024);
+  auto compute = []() { return types::StringValue("res"); };
+
+  for (int64_t i = 0; i < 4 * kExecResultCacheHitRateWindow; ++i) {
+    cache.GetOrCompute(compute, types::StringValue("abc"), types::Int64Value(i % 16));
+  }
+  EXPECT_TRUE(cache.enabled());
+  EXPECT_EQ(16, cache.size());
+}
+
+}  // namespace udf
+}  // namespace carnot
+}  // namespace px
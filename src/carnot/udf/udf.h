@@ -25,12 +25,14 @@
 #include <iostream>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <functional>
 
 #include "src/carnot/udf/base.h"
+#include "src/carnot/udf/exec_result_cache.h"
 #include "src/carnot/udfspb/udfs.pb.h"
 #include "src/common/base/base.h"
 #include "src/shared/metadata/metadata_state.h"
@@ -74,10 +76,30 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * UDFs over fixed size values (booleans, integers, floats and times) can _optionally_ implement:
+ *      static void ExecBatch(const NativeType<Arg>*... args, size_t n, NativeType<Ret>* out) {}
+ *  This function computes Exec for n records at once, from spans of the native argument values,
+ *  and is preferred over calling Exec for each record. Simple loops over the spans can be
+ *  auto-vectorized by the compiler.
+ *
+ * UDFs whose Exec is expensive compared to hashing their arguments can _optionally_ implement:
+ *      static constexpr bool Deterministic() { return true; }
+ *  This promises that Exec always returns the same result for the same arguments, so the results
+ *  are memoized by each instance for the rest of the query. See ExecResultCache.
  */
 class ScalarUDF : public AnyUDF {
  public:
   ~ScalarUDF() override = default;
+
+  // The memoized results of Exec, which are only kept for deterministic UDFs.
+  ExecResultCacheBase* exec_result_cache() const { return exec_result_cache_.get(); }
+  void set_exec_result_cache(std::unique_ptr<ExecResultCacheBase> cache) {
+    exec_result_cache_ = std::move(cache);
+  }
+
+ private:
+  std::unique_ptr<ExecResultCacheBase> exec_result_cache_;
 };
 
 /**
@@ -170,6 +192,53 @@ struct has_udf_executor_fn<T, std::void_t<decltype(&T::Executor)>> : std::true_t
 template <typename T, typename = void>
 struct check_executor_fn {};
 
+// SFINAE test for Deterministic fn.
+template <typename T, typename = void>
+struct has_udf_deterministic_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_deterministic_fn<T, std::void_t<decltype(&T::Deterministic)>> : std::true_type {
+  static_assert(std::is_same_v<decltype(&T::Deterministic), bool (*)()>,
+                "If a deterministic function exists, it must have the form: bool Deterministic()");
+};
+
+/**
+ * The native type of a UDF value type. Batch Exec functions take spans of these.
+ */
+template <typename TValue>
+using NativeType = typename types::ValueTypeTraits<TValue>::native_type;
+
+/**
+ * Gives the type of the batch Exec function that matches an Exec function. For example, the batch
+ * Exec function of
+ *      Float64Value Exec(FunctionContext*, Int64Value arg1, Float64Value arg2)
+ * is
+ *      static void ExecBatch(const int64_t* arg1, const double* arg2, size_t n, double* out)
+ */
+template <typename ReturnType, typename TUDF, typename... Types>
+auto ExecBatchFnTypeHelper(ReturnType (TUDF::*)(FunctionContext*, Types...))
+    -> void (*)(const NativeType<Types>*..., size_t, NativeType<ReturnType>*);
+
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {
+  static_assert(std::is_same_v<decltype(&T::ExecBatch), decltype(ExecBatchFnTypeHelper(&T::Exec))>,
+                "If a batch exec function exists, it must have the form: static void "
+                "ExecBatch(const NativeType<Arg>*..., size_t n, NativeType<Ret>* out)");
+};
+
+/**
+ * Whether values of the data type can be passed to batch Exec functions as spans of their native
+ * type, ie. whether their column wrappers store the values as an array of the native type.
+ */
+constexpr bool IsBatchExecDataType(types::DataType type) {
+  return type == types::BOOLEAN || type == types::INT64 || type == types::FLOAT64 ||
+         type == types::TIME64NS;
+}
+
 template <typename T>
 struct check_executor_fn<T, typename std::enable_if_t<has_udf_executor_fn<T>::value>> {
   static_assert(IsValidExecutorFn(&T::Executor),
@@ -228,6 +297,32 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF has a batch Exec function that can be used in place of Exec, which requires
+   * all the arguments and the return value to be fixed size values.
+   */
+  static constexpr bool HasExecBatch() {
+    if constexpr (has_udf_exec_batch_fn<T>::value) {
+      for (types::DataType type : ExecArguments()) {
+        if (!IsBatchExecDataType(type)) {
+          return false;
+        }
+      }
+      return IsBatchExecDataType(ReturnType());
+    }
+    return false;
+  }
+
+  /**
+   * Checks if the UDF promises that Exec is deterministic, in which case its results are memoized.
+   */
+  static constexpr bool IsDeterministic() {
+    if constexpr (has_udf_deterministic_fn<T>::value) {
+      return T::Deterministic();
+    }
+    return false;
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
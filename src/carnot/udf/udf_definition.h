@@ -112,6 +112,10 @@ class ScalarUDFDefinition : public UDFDefinition {
       executor_ = udfspb::UDFSourceExecutor::UDF_ALL;
     }
 
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      exec_batch_native_fn_ = ScalarUDFWrapper<TUDF>::ExecBatchNative;
+    }
+
     return Status::OK();
   }
 
@@ -131,6 +135,19 @@ class ScalarUDFDefinition : public UDFDefinition {
     return exec_wrapper_arrow_fn_(udf, ctx, inputs, output, count);
   }
 
+  /**
+   * Runs the UDF's batch Exec function on spans of native values, see ScalarUDF. Only valid if
+   * HasExecBatch() is true.
+   *
+   * @param inputs The native values of each argument, count of each.
+   * @param output Space for count native values of the return type.
+   * @param count The number of records.
+   */
+  void ExecBatchNative(const std::vector<const void*>& inputs, void* output, size_t count) {
+    DCHECK(HasExecBatch());
+    exec_batch_native_fn_(inputs, output, count);
+  }
+
   Status ExecInit(ScalarUDF* udf, FunctionContext* ctx,
                   const std::vector<std::shared_ptr<types::BaseValueType>>& inputs) {
     return init_wrapper_fn_(udf, ctx, inputs);
@@ -144,6 +161,7 @@ class ScalarUDFDefinition : public UDFDefinition {
   const std::vector<types::DataType>& exec_arguments() const { return exec_arguments_; }
   const std::vector<types::DataType>& init_arguments() const { return init_arguments_; }
   udfspb::UDFSourceExecutor executor() const { return executor_; }
+  bool HasExecBatch() const { return exec_batch_native_fn_ != nullptr; }
 
   const std::vector<types::DataType>& RegistryArgTypes() override { return registry_arguments_; }
   size_t Arity() const { return exec_arguments_.size(); }
@@ -166,6 +184,10 @@ class ScalarUDFDefinition : public UDFDefinition {
                        int count)>
       exec_wrapper_arrow_fn_;
 
+  // Only set for UDFs that have a batch Exec function.
+  std::function<void(const std::vector<const void*>& inputs, void* output, size_t count)>
+      exec_batch_native_fn_;
+
   std::function<Status(ScalarUDF* udf, FunctionContext* ctx,
                        const std::vector<std::shared_ptr<types::BaseValueType>>& inputs)>
       init_wrapper_fn_;
@@ -196,6 +218,7 @@ class UDADefinition : public UDFDefinition {
     make_fn_ = UDAWrapper<T>::Make;
     exec_batch_update_fn_ = UDAWrapper<T>::ExecBatchUpdate;
     exec_batch_update_arrow_fn_ = UDAWrapper<T>::ExecBatchUpdateArrow;
+    exec_batch_update_arrow_selection_fn_ = UDAWrapper<T>::ExecBatchUpdateArrowSelection;
     init_wrapper_fn_ = UDAWrapper<T>::ExecInit;
 
     auto init_arguments_array = UDATraits<T>::InitArguments();
@@ -232,6 +255,11 @@ class UDADefinition : public UDFDefinition {
                               const std::vector<const arrow::Array*>& inputs) {
     return exec_batch_update_arrow_fn_(uda, ctx, inputs);
   }
+  Status ExecBatchUpdateArrowSelection(UDA* uda, FunctionContext* ctx,
+                                       const std::vector<const arrow::Array*>& inputs,
+                                       const int64_t* selection, size_t count) {
+    return exec_batch_update_arrow_selection_fn_(uda, ctx, inputs, selection, count);
+  }
 
   Status ExecInit(UDA* uda, FunctionContext* ctx,
                   const std::vector<std::shared_ptr<types::BaseValueType>>& inputs) {
@@ -262,6 +290,11 @@ class UDADefinition : public UDFDefinition {
                        const std::vector<const arrow::Array*>& inputs)>
       exec_batch_update_arrow_fn_;
 
+  std::function<Status(UDA* uda, FunctionContext* ctx,
+                       const std::vector<const arrow::Array*>& inputs, const int64_t* selection,
+                       size_t count)>
+      exec_batch_update_arrow_selection_fn_;
+
   std::function<Status(UDA* uda, FunctionContext* ctx, arrow::ArrayBuilder* output)>
       finalize_arrow_fn_;
   std::function<Status(UDA* uda, FunctionContext* ctx, types::BaseValueType* output)>
@@ -51,6 +51,47 @@ class AddUDF : public ScalarUDF {
   }
 };
 
+class GreaterThanBatchUDF : public ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Float64Value v2) {
+    ++num_exec_calls;
+    return v1.val > v2.val;
+  }
+  static void ExecBatch(const int64_t* v1, const double* v2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] > v2[i];
+    }
+  }
+
+  static inline int num_exec_calls = 0;
+};
+
+class LogicalAndBatchUDF : public ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::BoolValue b1, types::BoolValue b2) {
+    ++num_exec_calls;
+    return b1.val && b2.val;
+  }
+  static void ExecBatch(const bool* b1, const bool* b2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = b1[i] && b2[i];
+    }
+  }
+
+  static inline int num_exec_calls = 0;
+};
+
+class DeterministicSubStrUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue str, types::Int64Value pos) {
+    ++num_exec_calls;
+    return str.substr(pos.val);
+  }
+  static constexpr bool Deterministic() { return true; }
+
+  static inline int num_exec_calls = 0;
+};
+
 class InitArgUDF : public ScalarUDF {
  public:
   Status Init(FunctionContext*, types::StringValue str, types::Int64Value i) {
@@ -136,6 +177,103 @@ TEST(UDFDefinition, arrow_write) {
   EXPECT_EQ(6, resArr->Value(1));
 }
 
+TEST(UDFDefinition, exec_batch) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("greaterThan");
+  EXPECT_OK(def.Init<GreaterThanBatchUDF>());
+
+  types::Int64ValueColumnWrapper v1({1, 2, 3});
+  types::Float64ValueColumnWrapper v2({0.5, 2.5, 2.5});
+
+  types::BoolValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_TRUE(out[0].val);
+  EXPECT_FALSE(out[1].val);
+  EXPECT_TRUE(out[2].val);
+
+  // The batch Exec function is used instead of Exec.
+  EXPECT_EQ(0, GreaterThanBatchUDF::num_exec_calls);
+}
+
+TEST(UDFDefinition, exec_batch_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::BoolValue> v1 = {true, true, false, false};
+  std::vector<types::BoolValue> v2 = {true, false, true, false};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::BooleanBuilder>();
+  auto u = std::make_shared<LogicalAndBatchUDF>();
+  EXPECT_OK(ScalarUDFWrapper<LogicalAndBatchUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 4));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* resArr = static_cast<arrow::BooleanArray*>(res.get());
+  ASSERT_EQ(4, resArr->length());
+  EXPECT_TRUE(resArr->Value(0));
+  EXPECT_FALSE(resArr->Value(1));
+  EXPECT_FALSE(resArr->Value(2));
+  EXPECT_FALSE(resArr->Value(3));
+
+  EXPECT_EQ(0, LogicalAndBatchUDF::num_exec_calls);
+}
+
+TEST(UDFDefinition, exec_memoized) {
+  DeterministicSubStrUDF::num_exec_calls = 0;
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("substr");
+  EXPECT_OK(def.Init<DeterministicSubStrUDF>());
+
+  types::StringValueColumnWrapper v1({"abcd", "defg", "abcd", "abcd", "defg"});
+  types::Int64ValueColumnWrapper v2({1, 1, 1, 2, 1});
+
+  types::StringValueColumnWrapper out(v1.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ("bcd", out[0]);
+  EXPECT_EQ("efg", out[1]);
+  EXPECT_EQ("bcd", out[2]);
+  EXPECT_EQ("cd", out[3]);
+  EXPECT_EQ("efg", out[4]);
+  EXPECT_EQ(3, DeterministicSubStrUDF::num_exec_calls);
+
+  // The results are kept across batches of the same instance, but not across instances.
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(3, DeterministicSubStrUDF::num_exec_calls);
+  auto u2 = def.Make();
+  EXPECT_OK(def.ExecBatch(u2.get(), &ctx, {&v1, &v2}, &out, v1.Size()));
+  EXPECT_EQ(6, DeterministicSubStrUDF::num_exec_calls);
+}
+
+TEST(UDFDefinition, exec_memoized_arrow) {
+  DeterministicSubStrUDF::num_exec_calls = 0;
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::StringValue> v1 = {"abcd", "abcd", "defg", "abcd"};
+  std::vector<types::Int64Value> v2 = {1, 1, 1, 1};
+
+  auto v1a = ToArrow(v1, arrow::default_memory_pool());
+  auto v2a = ToArrow(v2, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::StringBuilder>();
+  auto u = std::make_shared<DeterministicSubStrUDF>();
+  EXPECT_OK(ScalarUDFWrapper<DeterministicSubStrUDF>::ExecBatchArrow(
+      u.get(), &ctx, {v1a.get(), v2a.get()}, output_builder.get(), 4));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* resArr = static_cast<arrow::StringArray*>(res.get());
+  ASSERT_EQ(4, resArr->length());
+  EXPECT_EQ("bcd", resArr->GetString(0));
+  EXPECT_EQ("bcd", resArr->GetString(1));
+  EXPECT_EQ("efg", resArr->GetString(2));
+  EXPECT_EQ("bcd", resArr->GetString(3));
+
+  EXPECT_EQ(2, DeterministicSubStrUDF::num_exec_calls);
+}
+
 TEST(UDFDefinition, init_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("initargudf");
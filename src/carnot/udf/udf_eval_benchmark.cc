@@ -36,6 +36,8 @@ using px::carnot::udf::ScalarUDF;
 using px::carnot::udf::ScalarUDFDefinition;
 using px::carnot::udf::ScalarUDFWrapper;
 using px::types::BaseValueType;
+using px::types::BoolValue;
+using px::types::BoolValueColumnWrapper;
 using px::types::Int64Value;
 using px::types::Int64ValueColumnWrapper;
 using px::types::StringValue;
@@ -57,12 +59,39 @@ class AddUDF : public ScalarUDF {
   Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
 };
 
+// The same as AddUDF, but computes batches of records at once from spans of their values.
+class BatchAddUDF : public ScalarUDF {
+ public:
+  Int64Value Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val + v2.val; }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, int64_t* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] + v2[i];
+    }
+  }
+};
+
+class GreaterThanUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val > v2.val; }
+};
+
+class BatchGreaterThanUDF : public ScalarUDF {
+ public:
+  BoolValue Exec(FunctionContext*, Int64Value v1, Int64Value v2) { return v1.val > v2.val; }
+  static void ExecBatch(const int64_t* v1, const int64_t* v2, size_t n, bool* out) {
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = v1[i] > v2[i];
+    }
+  }
+};
+
 class SubStrUDF : public ScalarUDF {
  public:
   StringValue Exec(FunctionContext*, StringValue v1) { return v1.substr(1, 2); }
 };
 
 // This benchmark add two columns using Int64ValueVectors.
+template <typename TUDF>
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddInt64Values(benchmark::State& state) {
   auto vec1 = CreateLargeData<Int64Value>(state.range(0));
@@ -75,7 +104,7 @@ static void BM_AddInt64Values(benchmark::State& state) {
 
   // Create the UDF.
   ScalarUDFDefinition def("add");
-  CHECK(def.template Init<AddUDF>().ok());
+  CHECK(def.template Init<TUDF>().ok());
   auto u = def.Make();
 
   // Loop the test.
@@ -96,6 +125,36 @@ static void BM_AddInt64Values(benchmark::State& state) {
   state.SetBytesProcessed(int64_t(state.iterations()) * 2 * vec1.size() * sizeof(int64_t));
 }
 
+// This benchmark compares two columns using Int64ValueVectors.
+template <typename TUDF>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_GreaterThanInt64Values(benchmark::State& state) {
+  auto vec1 = CreateLargeData<Int64Value>(state.range(0));
+  auto vec2 = CreateLargeData<Int64Value>(state.range(0));
+  BoolValueColumnWrapper out(vec2.size());
+
+  auto wrapped_vec1 = Int64ValueColumnWrapper(vec1);
+  auto wrapped_vec2 = Int64ValueColumnWrapper(vec2);
+
+  ScalarUDFDefinition def("greaterThan");
+  CHECK(def.template Init<TUDF>().ok());
+  auto u = def.Make();
+
+  // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
+  for (auto _ : state) {
+    auto res = def.ExecBatch(u.get(), nullptr, {&wrapped_vec1, &wrapped_vec2}, &out, vec1.size());
+    CHECK(res.ok());
+    benchmark::DoNotOptimize(out);
+  }
+
+  // Check results.
+  for (size_t idx = 0; idx < vec2.size(); ++idx) {
+    CHECK((vec1[idx].val > vec2[idx].val) == out[idx].val);
+  }
+
+  state.SetBytesProcessed(int64_t(state.iterations()) * 2 * vec1.size() * sizeof(int64_t));
+}
+
 // This benchmark performs a substring on 10 char wide strings,
 // selects two characters.
 // NOLINTNEXTLINE : runtime/references.
@@ -127,13 +186,14 @@ static void BM_SubStr(benchmark::State& state) {
 }
 
 // Benchmark adding two integers using arrow as the interface.
+template <typename TUDF>
 // NOLINTNEXTLINE : runtime/references.
 static void BM_AddTwoInt64sArrow(benchmark::State& state) {
   size_t size = state.range(0);
   auto arr1 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
   auto arr2 = ToArrow(CreateLargeData<Int64Value>(size), arrow::default_memory_pool());
 
-  auto u = std::make_shared<AddUDF>();
+  auto u = std::make_shared<TUDF>();
   std::shared_ptr<arrow::Array> out;
   // NOLINTNEXTLINE : clang-analyzer-deadcode.DeadStores.
   for (auto _ : state) {
@@ -141,8 +201,8 @@ static void BM_AddTwoInt64sArrow(benchmark::State& state) {
       out.reset();
     }
     auto output_builder = std::make_shared<arrow::Int64Builder>();
-    auto res = ScalarUDFWrapper<AddUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
-                                                        output_builder.get(), size);
+    auto res = ScalarUDFWrapper<TUDF>::ExecBatchArrow(u.get(), nullptr, {arr1.get(), arr2.get()},
+                                                      output_builder.get(), size);
     CHECK(res.ok());
     CHECK(output_builder->Finish(&out).ok());
     benchmark::DoNotOptimize(out);
@@ -245,8 +305,16 @@ static void BM_SubStrArrow(benchmark::State& state) {
 }
 
 BENCHMARK(BM_AddInt64ValueToArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
-BENCHMARK(BM_AddTwoInt64sArrow)->RangeMultiplier(2)->Range(1, 1 << 16);
-BENCHMARK(BM_AddInt64Values)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, AddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddTwoInt64sArrow, BatchAddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddInt64Values, AddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_AddInt64Values, BatchAddUDF)->RangeMultiplier(2)->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_GreaterThanInt64Values, GreaterThanUDF)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
+BENCHMARK_TEMPLATE(BM_GreaterThanInt64Values, BatchGreaterThanUDF)
+    ->RangeMultiplier(2)
+    ->Range(1, 1 << 16);
 
 BENCHMARK(BM_ConvertToArrowString)->RangeMultiplier(2)->Range(1, 1 << 16);
 BENCHMARK(BM_ConvertToArrowInt64)->RangeMultiplier(2)->Range(1, 1 << 16);
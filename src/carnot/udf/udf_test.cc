@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <string>
 #include <type_traits>
 
 #include "src/carnot/udf/udf_wrapper.h"
@@ -51,6 +52,25 @@ TEST(ScalarUDF, basic_tests) {
   EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithInit>::HasInit());
 }
 
+class ScalarUDF1WithExecBatch : ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::BoolValue, types::Int64Value) { return 0; }
+  static void ExecBatch(const bool*, const int64_t*, size_t, int64_t*) {}
+};
+
+class StringUDFWithExecBatch : ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::StringValue s) { return s; }
+  static void ExecBatch(const std::string*, size_t, std::string*) {}
+};
+
+TEST(ScalarUDF, exec_batch_tests) {
+  EXPECT_FALSE(ScalarUDFTraits<ScalarUDF1>::HasExecBatch());
+  EXPECT_TRUE(ScalarUDFTraits<ScalarUDF1WithExecBatch>::HasExecBatch());
+  // Strings are not stored as arrays of their native type, so they can't be batched.
+  EXPECT_FALSE(ScalarUDFTraits<StringUDFWithExecBatch>::HasExecBatch());
+}
+
 TEST(UDFDataTypes, valid_tests) {
   EXPECT_TRUE((true == types::IsValidValueType<types::BoolValue>::value));
   EXPECT_TRUE((true == types::IsValidValueType<types::Int64Value>::value));
@@ -20,6 +20,7 @@
 
 #include <arrow/array.h>
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
@@ -48,6 +49,47 @@ constexpr auto CastToUDFValueType(const types::BaseValueType* arg) {
   // return static_cast<types::Int64Value*>(arg);
   return static_cast<const typename types::DataTypeTraits<TExecArgType>::value_type*>(arg);
 }
+/**
+ * Gives the type of the ExecResultCache that memoizes an Exec function.
+ */
+template <typename ReturnType, typename TUDF, typename... Types>
+auto ExecResultCacheTypeHelper(ReturnType (TUDF::*)(FunctionContext*, Types...))
+    -> ExecResultCache<ReturnType, Types...>;
+
+template <typename TUDF>
+using ExecResultCacheType = decltype(ExecResultCacheTypeHelper(&TUDF::Exec));
+
+// Returns the exec result cache of a deterministic UDF instance, creating it on first use. Returns
+// nullptr if the UDF isn't deterministic, or if memoization is disabled or has disabled itself.
+template <typename TUDF>
+auto* ExecResultCacheOf(TUDF* udf) {
+  if constexpr (ScalarUDFTraits<TUDF>::IsDeterministic()) {
+    using cache_type = ExecResultCacheType<TUDF>;
+    if (udf->exec_result_cache() == nullptr) {
+      if (FLAGS_carnot_udf_exec_result_cache_bytes <= 0) {
+        return static_cast<cache_type*>(nullptr);
+      }
+      udf->set_exec_result_cache(
+          std::make_unique<cache_type>(FLAGS_carnot_udf_exec_result_cache_bytes));
+    }
+    auto* cache = static_cast<cache_type*>(udf->exec_result_cache());
+    return cache->enabled() ? cache : nullptr;
+  } else {
+    return static_cast<ExecResultCacheBase*>(nullptr);
+  }
+}
+
+// Calls Exec, going through the exec result cache if the UDF has one.
+template <typename TUDF, typename TCache, typename... Args>
+auto MemoizedExec(TUDF* udf, FunctionContext* ctx, TCache* cache, const Args&... args) {
+  if constexpr (ScalarUDFTraits<TUDF>::IsDeterministic()) {
+    if (cache != nullptr) {
+      return cache->GetOrCompute([&]() { return udf->Exec(ctx, args...); }, args...);
+    }
+  }
+  return udf->Exec(ctx, args...);
+}
+
 /**
  * This is the inner wrapper which expands the arguments an performs type casts
  * based on the type and arity of the input arguments.
@@ -62,12 +104,60 @@ Status ExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
                    const std::vector<const types::BaseValueType*>& args,
                    std::index_sequence<I...>) {
   [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  auto* cache = ExecResultCacheOf(udf);
   for (size_t idx = 0; idx < count; ++idx) {
-    out[idx] = udf->Exec(ctx, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
+    out[idx] =
+        MemoizedExec(udf, ctx, cache, CastToUDFValueType<exec_argument_types[I]>(args[I])[idx]...);
   }
   return Status::OK();
 }
 
+// Returns the values of a fixed size column as an array of their native type, which is how the
+// column wrappers store them.
+template <types::DataType TDataType>
+constexpr auto CastToNativeType(const types::BaseValueType* arg) {
+  using value_type = typename types::DataTypeTraits<TDataType>::value_type;
+  using native_type = typename types::DataTypeTraits<TDataType>::native_type;
+  static_assert(sizeof(value_type) == sizeof(native_type), "value type must wrap a native type");
+  return reinterpret_cast<const native_type*>(arg);
+}
+
+/**
+ * This is the inner wrapper for UDFs that have a batch Exec function.
+ *
+ * The input columns are passed to ExecBatch as spans of native values, and it writes
+ * all of the results at once.
+ *
+ * @return Status of execution.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapper(size_t count, TOutput* out,
+                        const std::vector<const types::BaseValueType*>& args,
+                        std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename types::DataTypeTraits<return_type>::native_type;
+  static_assert(sizeof(TOutput) == sizeof(native_type), "value type must wrap a native type");
+  TUDF::ExecBatch(CastToNativeType<exec_argument_types[I]>(args[I])..., count,
+                  reinterpret_cast<native_type*>(out));
+  return Status::OK();
+}
+
+/**
+ * This is the inner wrapper for callers that already hold the arguments as spans of native
+ * values, like the fused expression evaluator.
+ */
+template <typename TUDF, std::size_t... I>
+void ExecBatchNativeWrapper(size_t count, void* out, const std::vector<const void*>& args,
+                            std::index_sequence<I...>) {
+  [[maybe_unused]] constexpr auto exec_argument_types = ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  TUDF::ExecBatch(
+      static_cast<const typename types::DataTypeTraits<exec_argument_types[I]>::native_type*>(
+          args[I])...,
+      count, static_cast<typename types::DataTypeTraits<return_type>::native_type*>(out));
+}
+
 template <typename TUDF, std::size_t... I>
 Status InitWrapper(TUDF* udf, FunctionContext* ctx,
                    const std::vector<std::shared_ptr<types::BaseValueType>>& args,
@@ -113,9 +203,10 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
     CHECK(out->ReserveData(reserved).ok());
   }
+  auto* cache = ExecResultCacheOf(udf);
   for (size_t idx = 0; idx < count; ++idx) {
-    auto res = UnWrap(
-        udf->Exec(ctx, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
+    auto res = UnWrap(MemoizedExec(
+        udf, ctx, cache, types::GetValueFromArrowArray<exec_argument_types[I]>(args[I], idx)...));
 
     // We use doubling to make sure we minimize the number of allocations.
     // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
@@ -132,6 +223,50 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+// Returns the values of a fixed size arrow array as an array of their native type. Arrow packs
+// booleans into bits, so those are unpacked into the given scratch space first.
+template <types::DataType TDataType>
+const auto* ArrowNativeValues(const arrow::Array* arr, size_t count,
+                              std::unique_ptr<bool[]>* unpacked) {
+  using arrow_array_type = typename types::DataTypeTraits<TDataType>::arrow_array_type;
+  const auto* casted = static_cast<const arrow_array_type*>(arr);
+  if constexpr (TDataType == types::BOOLEAN) {
+    *unpacked = std::make_unique<bool[]>(count);
+    for (size_t idx = 0; idx < count; ++idx) {
+      (*unpacked)[idx] = casted->Value(idx);
+    }
+    return static_cast<const bool*>(unpacked->get());
+  } else {
+    return casted->raw_values();
+  }
+}
+
+/**
+ * This is the inner wrapper for the arrow type, for UDFs that have a batch Exec function.
+ * The results are computed into a scratch span, and then appended to the output builder at once.
+ */
+template <typename TUDF, typename TOutput, std::size_t... I>
+Status ExecBatchWrapperArrow(size_t count, TOutput* out, const std::vector<arrow::Array*>& args,
+                             std::index_sequence<I...>) {
+  [[maybe_unused]] static constexpr auto exec_argument_types =
+      ScalarUDFTraits<TUDF>::ExecArguments();
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using native_type = typename types::DataTypeTraits<return_type>::native_type;
+
+  [[maybe_unused]] std::array<std::unique_ptr<bool[]>, sizeof...(I)> unpacked;
+  auto results = std::make_unique<native_type[]>(count);
+  TUDF::ExecBatch(ArrowNativeValues<exec_argument_types[I]>(args[I], count, &unpacked[I])...,
+                  count, results.get());
+
+  // PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+  if constexpr (return_type == types::BOOLEAN) {
+    PL_RETURN_IF_ERROR(out->AppendValues(reinterpret_cast<const uint8_t*>(results.get()), count));
+  } else {
+    PL_RETURN_IF_ERROR(out->AppendValues(results.get(), count));
+  }
+  return Status::OK();
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -197,6 +332,13 @@ struct ScalarUDFWrapper {
     // Check that the arity is correct.
     DCHECK(inputs.size() == ScalarUDFTraits<TUDF>::ExecArguments().size());
 
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapperArrow<TUDF>(
+          count,
+          static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
+          inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    }
+
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
@@ -238,6 +380,12 @@ struct ScalarUDFWrapper {
 
     using output_type = typename types::DataTypeTraits<return_type>::value_type;
     auto* casted_output = static_cast<output_type*>(output->UnsafeRawData());
+
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return ExecBatchWrapper<TUDF>(count, casted_output, input_as_base_value,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    }
+
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
@@ -246,6 +394,23 @@ struct ScalarUDFWrapper {
                              std::make_index_sequence<exec_argument_types.size()>{});
   }
 
+  /**
+   * Executes the UDF's batch Exec function on spans of native values. Only valid for UDFs that
+   * have one, see ScalarUDFTraits::HasExecBatch().
+   *
+   * @param inputs The native values of each argument, count of each.
+   * @param output Space for count native values of the return type.
+   * @param count The number of records.
+   */
+  static void ExecBatchNative(const std::vector<const void*>& inputs, void* output,
+                              size_t count) {
+    static_assert(ScalarUDFTraits<TUDF>::HasExecBatch(), "UDF must have a batch Exec function");
+    DCHECK(inputs.size() == ScalarUDFTraits<TUDF>::ExecArguments().size());
+    ExecBatchNativeWrapper<TUDF>(
+        count, output, inputs,
+        std::make_index_sequence<ScalarUDFTraits<TUDF>::ExecArguments().size()>{});
+  }
+
   /**
    * Call the UDF's init method.
    *
@@ -309,6 +474,23 @@ Status UpdateWrapperArrow(TUDA* uda, FunctionContext* ctx, size_t count,
   return Status::OK();
 }
 
+/**
+ * Performs an update on the rows of a batch (arrow) that are picked out by a selection vector.
+ * This lets callers feed a subset of a batch (ie. the rows of a single group) to a UDA without
+ * copying the rows out first.
+ */
+template <typename TUDA, std::size_t... I>
+Status UpdateWrapperArrowSelection(TUDA* uda, FunctionContext* ctx, const int64_t* selection,
+                                   size_t count, const std::vector<const arrow::Array*>& args,
+                                   std::index_sequence<I...>) {
+  constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+  for (size_t idx = 0; idx < count; ++idx) {
+    uda->Update(ctx, types::GetValueFromArrowArray<update_argument_types[I]>(
+                         args[I], selection[idx])...);
+  }
+  return Status::OK();
+}
+
 /**
  * Provides a set of static methods that wrap UDAs and allow vectorized execution (for update).
  * @tparam TUDA The UDA class.
@@ -361,6 +543,26 @@ struct UDAWrapper {
                                     std::make_index_sequence<update_argument_types.size()>{});
   }
 
+  /**
+   * Perform a batch update of the passed in UDA using only the rows in the selection vector.
+   * @param uda The UDA instances.
+   * @param ctx The function context.
+   * @param inputs A vector of pointers to arrow arrays.
+   * @param selection The indices of the rows in inputs to update with.
+   * @param count The number of entries in selection.
+   * @return Status of update.
+   */
+  static Status ExecBatchUpdateArrowSelection(UDA* uda, FunctionContext* ctx,
+                                              const std::vector<const arrow::Array*>& inputs,
+                                              const int64_t* selection, size_t count) {
+    constexpr auto update_argument_types = UDATraits<TUDA>::UpdateArgumentTypes();
+    DCHECK(inputs.size() == update_argument_types.size());
+
+    return UpdateWrapperArrowSelection<TUDA>(
+        static_cast<TUDA*>(uda), ctx, selection, count, inputs,
+        std::make_index_sequence<update_argument_types.size()>{});
+  }
+
   /**
    * Call the UDA's init method.
    *
@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -58,6 +59,7 @@ class ColumnWrapper {
   virtual const BaseValueType* UnsafeRawData() const = 0;
   virtual DataType data_type() const = 0;
   virtual size_t Size() const = 0;
+  virtual size_t Capacity() const = 0;
   virtual bool Empty() const = 0;
   virtual int64_t Bytes() const = 0;
 
@@ -112,6 +114,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
   DataType data_type() const override { return ValueTypeTraits<T>::data_type; }
 
   size_t Size() const override { return data_.size(); }
+  size_t Capacity() const override { return data_.capacity(); }
   bool Empty() const override { return data_.empty(); }
 
   std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) override {
@@ -122,7 +125,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
 
   T& operator[](size_t idx) { return data_[idx]; }
 
-  void Append(T val) { data_.push_back(val); }
+  void Append(T val) { data_.push_back(std::move(val)); }
 
   void Reserve(size_t size) override { data_.reserve(size); }
 
@@ -190,6 +193,52 @@ using Float64ValueColumnWrapper = ColumnWrapperTmpl<Float64Value>;
 using StringValueColumnWrapper = ColumnWrapperTmpl<StringValue>;
 using Time64NSValueColumnWrapper = ColumnWrapperTmpl<Time64NSValue>;
 
+/**
+ * An arrow buffer that points into the storage of a column wrapper, and keeps the column wrapper
+ * alive for as long as the buffer is.
+ */
+class ColumnWrapperBuffer : public arrow::Buffer {
+ public:
+  ColumnWrapperBuffer(SharedColumnWrapper col, const uint8_t* data, int64_t size)
+      : arrow::Buffer(data, size), col_(std::move(col)) {}
+
+ private:
+  SharedColumnWrapper col_;
+};
+
+template <typename T>
+inline std::shared_ptr<arrow::Array> ConvertToArrowZeroCopyImpl(const SharedColumnWrapper& col) {
+  using ArrowArrayType = typename ValueTypeTraits<T>::arrow_array_type;
+  using ArrowCType = typename ValueTypeTraits<T>::arrow_type::c_type;
+  static_assert(sizeof(T) == sizeof(ArrowCType) && std::is_standard_layout_v<T>,
+                "Value type must have the same layout as the arrow value type");
+  const auto* data = static_cast<const ColumnWrapperTmpl<T>*>(col.get())->UnsafeRawData();
+  auto buffer = std::make_shared<ColumnWrapperBuffer>(
+      col, reinterpret_cast<const uint8_t*>(data), col->Size() * sizeof(T));
+  return std::make_shared<ArrowArrayType>(col->Size(), buffer);
+}
+
+/**
+ * Converts the column to an arrow array. Columns of 64 bit values (INT64, TIME64NS and FLOAT64)
+ * are not copied: the arrow array points straight at the storage of the column, and shares
+ * ownership of the column, which must not be modified afterwards. Other columns are copied with
+ * ConvertToArrow.
+ * PL_CARNOT_UPDATE_FOR_NEW_TYPES.
+ */
+inline std::shared_ptr<arrow::Array> ConvertToArrowZeroCopy(const SharedColumnWrapper& col,
+                                                            arrow::MemoryPool* mem_pool) {
+  switch (col->data_type()) {
+    case DataType::INT64:
+      return ConvertToArrowZeroCopyImpl<Int64Value>(col);
+    case DataType::TIME64NS:
+      return ConvertToArrowZeroCopyImpl<Time64NSValue>(col);
+    case DataType::FLOAT64:
+      return ConvertToArrowZeroCopyImpl<Float64Value>(col);
+    default:
+      return col->ConvertToArrow(mem_pool);
+  }
+}
+
 template <typename TColumnWrapper, types::DataType DType>
 inline SharedColumnWrapper FromArrowImpl(const std::shared_ptr<arrow::Array>& arr) {
   CHECK_EQ(arr->type_id(), DataTypeTraits<DType>::arrow_type_id);
@@ -293,7 +342,7 @@ inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
       << "Expect " << ToString(data_type()) << " got "
       << ToString(ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(std::move(val));
 }
 
 template <class TValueType>
@@ -311,7 +360,7 @@ inline TValueType ColumnWrapper::Get(size_t idx) const {
 template <class TValueType>
 inline void ColumnWrapper::AppendNoTypeCheck(TValueType val) {
   DCHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(std::move(val));
 }
 
 template <class TValueType>
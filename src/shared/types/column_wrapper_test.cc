@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include <memory>
+#include <vector>
 
 #include "src/shared/types/column_wrapper.h"
 #include "src/shared/types/types.h"
@@ -283,5 +284,37 @@ TEST(ColumnWrapperTest, MoveIndexes) {
   }
 }
 
+TEST(ColumnWrapperTest, ConvertToArrowZeroCopy) {
+  std::shared_ptr<arrow::Array> arr;
+  const void* col_data;
+  {
+    auto col = ColumnWrapper::Make(DataType::TIME64NS, 0);
+    col->AppendFromVector(std::vector<Time64NSValue>{5, 8, 1});
+    col_data = col->UnsafeRawData();
+    arr = ConvertToArrowZeroCopy(col, arrow::default_memory_pool());
+  }
+  // The array points at the storage of the column, which it keeps alive.
+  auto int_arr = std::static_pointer_cast<arrow::Int64Array>(arr);
+  EXPECT_EQ(col_data, int_arr->raw_values());
+  ASSERT_EQ(3, int_arr->length());
+  EXPECT_EQ(5, int_arr->Value(0));
+  EXPECT_EQ(8, int_arr->Value(1));
+  EXPECT_EQ(1, int_arr->Value(2));
+
+  auto float_col = ColumnWrapper::Make(DataType::FLOAT64, 0);
+  float_col->AppendFromVector(std::vector<Float64Value>{1.5, 2.5});
+  auto float_arr = std::static_pointer_cast<arrow::DoubleArray>(
+      ConvertToArrowZeroCopy(float_col, arrow::default_memory_pool()));
+  EXPECT_EQ(static_cast<const void*>(float_col->UnsafeRawData()), float_arr->raw_values());
+  EXPECT_EQ(2.5, float_arr->Value(1));
+
+  // Strings are copied.
+  auto str_col = ColumnWrapper::Make(DataType::STRING, 0);
+  str_col->AppendFromVector(std::vector<StringValue>{"abc", "de"});
+  auto str_arr = std::static_pointer_cast<arrow::StringArray>(
+      ConvertToArrowZeroCopy(str_col, arrow::default_memory_pool()));
+  EXPECT_EQ("de", str_arr->GetString(1));
+}
+
 }  // namespace types
 }  // namespace px
@@ -52,9 +52,15 @@ struct Args {
 Stirling* g_stirling = nullptr;
 ProcessStatsMonitor* g_process_stats_monitor = nullptr;
 absl::flat_hash_map<uint64_t, InfoClass> g_table_info_map;
-std::atomic<bool> g_data_received = false;
+std::atomic<bool> g_stack_traces_received = false;
+std::atomic<bool> g_stack_trace_strings_received = false;
 Args g_args;
 
+// Stack trace counts of the target process, and the strings of all stack trace IDs, by ID.
+// Written by the data push callback, and only read after Stirling has stopped.
+absl::flat_hash_map<int64_t, int64_t> g_stack_trace_counts;
+absl::flat_hash_map<int64_t, std::string> g_stack_trace_strs;
+
 Status ParseArgs(int argc, char** argv) {
   if (argc != 2) {
     return ::px::error::Internal("Usage: ./stirling_profiler <pid>");
@@ -76,29 +82,48 @@ Status StirlingWrapperCallback(uint64_t table_id, TabletID /* tablet_id */,
   auto iter = g_table_info_map.find(table_id);
   CHECK(iter != g_table_info_map.end());
   const InfoClass& table_info = iter->second;
+
+  if (table_info.schema().name() == "stack_trace_strings.beta") {
+    auto& id_col = (*record_batch)[px::stirling::kStackTraceStringsStackTraceIDIdx];
+    auto& stack_trace_str_col = (*record_batch)[px::stirling::kStackTraceStringsStackTraceStrIdx];
+    for (size_t i = 0; i < id_col->Size(); ++i) {
+      g_stack_trace_strs[id_col->Get<px::types::Int64Value>(i).val] =
+          stack_trace_str_col->Get<px::types::StringValue>(i);
+    }
+    g_stack_trace_strings_received = true;
+    return Status::OK();
+  }
+
   CHECK_EQ(table_info.schema().name(), "stack_traces.beta");
 
   auto& upid_col = (*record_batch)[px::stirling::kStackTraceUPIDIdx];
-  auto& stack_trace_str_col = (*record_batch)[px::stirling::kStackTraceStackTraceStrIdx];
+  auto& id_col = (*record_batch)[px::stirling::kStackTraceStackTraceIDIdx];
   auto& count_col = (*record_batch)[px::stirling::kStackTraceCountIdx];
 
-  std::string out;
-  for (size_t i = 0; i < stack_trace_str_col->Size(); ++i) {
+  for (size_t i = 0; i < id_col->Size(); ++i) {
     UPID upid(upid_col->Get<px::types::UInt128Value>(i).val);
 
     if (g_args.pid == upid.pid()) {
-      std::cout << stack_trace_str_col->Get<px::types::StringValue>(i);
-      std::cout << " ";
-      std::cout << count_col->Get<px::types::Int64Value>(i).val;
-      std::cout << "\n";
+      g_stack_trace_counts[id_col->Get<px::types::Int64Value>(i).val] +=
+          count_col->Get<px::types::Int64Value>(i).val;
     }
   }
 
-  g_data_received = true;
+  g_stack_traces_received = true;
 
   return Status::OK();
 }
 
+void PrintStackTraces() {
+  for (const auto& [id, count] : g_stack_trace_counts) {
+    auto iter = g_stack_trace_strs.find(id);
+    std::cout << (iter != g_stack_trace_strs.end() ? iter->second : "<unknown>");
+    std::cout << " ";
+    std::cout << count;
+    std::cout << "\n";
+  }
+}
+
 void SignalHandler(int signum) {
   std::cerr << "\n\nStopping, might take a few seconds ..." << std::endl;
   // Important to call Stop(), because it releases BPF resources,
@@ -148,7 +173,7 @@ int main(int argc, char** argv) {
   // Run for the specified amount of time, then terminate.
   for (int i = 0; i < 100; ++i) {
     std::this_thread::sleep_for(std::chrono::seconds(1));
-    if (g_data_received) {
+    if (g_stack_traces_received && g_stack_trace_strings_received) {
       break;
     }
   }
@@ -157,5 +182,7 @@ int main(int argc, char** argv) {
   // Wait for the thread to return.
   run_thread.join();
 
+  PrintStackTraces();
+
   return 0;
 }
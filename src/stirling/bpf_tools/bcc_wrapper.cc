@@ -322,12 +322,17 @@ void BCCWrapper::DetachTracepoints() {
   tracepoints_.clear();
 }
 
-Status BCCWrapper::OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie) {
+int BCCWrapper::BufferNumPages(int size_bytes) {
   const int kPageSizeBytes = system::Config::GetInstance().PageSize();
-  int num_pages = IntRoundUpDivide(perf_buffer.size_bytes, kPageSizeBytes);
+  int num_pages = IntRoundUpDivide(size_bytes, kPageSizeBytes);
+
+  // Perf buffers and ring buffers must be sized to a power of 2.
+  return IntRoundUpToPow2(num_pages);
+}
 
-  // Perf buffers must be sized to a power of 2.
-  num_pages = IntRoundUpToPow2(num_pages);
+Status BCCWrapper::OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie) {
+  const int kPageSizeBytes = system::Config::GetInstance().PageSize();
+  const int num_pages = BufferNumPages(perf_buffer.size_bytes);
 
   VLOG(1) << absl::Substitute("Opening perf buffer: $0 [requested_size=$1 num_pages=$2 size=$3]",
                               perf_buffer.name, perf_buffer.size_bytes, num_pages,
@@ -362,6 +367,47 @@ void BCCWrapper::ClosePerfBuffers() {
   perf_buffers_.clear();
 }
 
+namespace {
+
+// BCC does not expose the file descriptor of a map, but its tables keep it in their TableDesc.
+class TableFD : public ebpf::BPFTable {
+ public:
+  explicit TableFD(const ebpf::BPFTable& table) : ebpf::BPFTable(table) {}
+  int fd() const { return static_cast<int>(desc.fd); }
+};
+
+}  // namespace
+
+bool BCCWrapper::KernelSupportsRingBuffers() {
+  constexpr uint32_t kLinux5p8VersionCode = 329728;
+  StatusOr<utils::KernelVersion> kernel_version = utils::GetKernelVersion();
+  return kernel_version.ok() && kernel_version.ValueOrDie().code() >= kLinux5p8VersionCode;
+}
+
+Status BCCWrapper::OpenRingBuffer(const PerfBufferSpec& ring_buffer, void* cb_cookie) {
+  const int kPageSizeBytes = system::Config::GetInstance().PageSize();
+  const int num_pages = BufferNumPages(ring_buffer.size_bytes);
+
+  VLOG(1) << absl::Substitute("Opening ring buffer: $0 [requested_size=$1 num_pages=$2 size=$3]",
+                              ring_buffer.name, ring_buffer.size_bytes, num_pages,
+                              num_pages * kPageSizeBytes);
+  TableFD table(bpf_.get_table(ring_buffer.name));
+  if (table.fd() < 0) {
+    return error::NotFound("Could not find ring buffer $0.", ring_buffer.name);
+  }
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<RingBufferReader> reader,
+                      RingBufferReader::Create(table.fd(), num_pages * kPageSizeBytes,
+                                               ring_buffer.probe_output_fn, cb_cookie));
+  ring_buffers_.push_back(std::move(reader));
+  ++num_open_ring_buffers_;
+  return Status::OK();
+}
+
+void BCCWrapper::CloseRingBuffers() {
+  num_open_ring_buffers_ -= ring_buffers_.size();
+  ring_buffers_.clear();
+}
+
 Status BCCWrapper::AttachPerfEvent(const PerfEventSpec& perf_event) {
   VLOG(1) << absl::Substitute("Attaching perf event:\n   type=$0\n   probe_fn=$1",
                               magic_enum::enum_name(perf_event.type), perf_event.probe_fn);
@@ -415,11 +461,15 @@ void BCCWrapper::PollPerfBuffers(int timeout_ms) {
   for (const auto& spec : perf_buffers_) {
     PollPerfBuffer(spec.name, timeout_ms);
   }
+  for (auto& ring_buffer : ring_buffers_) {
+    ring_buffer->Poll(timeout_ms);
+  }
 }
 
 void BCCWrapper::Close() {
   DetachPerfEvents();
   ClosePerfBuffers();
+  CloseRingBuffers();
   DetachKProbes();
   DetachUProbes();
   DetachTracepoints();
@@ -43,6 +43,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/stirling/bpf_tools/ring_buffer_reader.h"
 #include "src/stirling/obj_tools/elf_reader.h"
 
 namespace px {
@@ -253,6 +254,30 @@ class BCCWrapper {
    */
   Status OpenPerfBuffer(const PerfBufferSpec& perf_buffer, void* cb_cookie = nullptr);
 
+  /**
+   * Open a BPF ring buffer (declared with BPF_RINGBUF_OUTPUT) for reading events.
+   * Unlike a perf buffer, there is one ring shared by all CPUs, so events are read in the order
+   * they were committed, and only size_bytes of memory is used in total.
+   * @param ring_buffer Specifications of the ring buffer. size_bytes must match the size declared
+   * in the BPF code (see BufferNumPages()). probe_loss_fn is never called, because the kernel does
+   * not report dropped events to the reader.
+   * @param cb_cookie A pointer that is sent to the callback function when triggered by
+   * PollPerfBuffers().
+   * @return Error if the ring buffer cannot be opened.
+   */
+  Status OpenRingBuffer(const PerfBufferSpec& ring_buffer, void* cb_cookie = nullptr);
+
+  /**
+   * Returns true if the running kernel supports BPF ring buffers (Linux 5.8+).
+   */
+  static bool KernelSupportsRingBuffers();
+
+  /**
+   * Returns the number of pages of a perf buffer or ring buffer of the given size.
+   * Buffers are sized to a power of 2 number of pages.
+   */
+  static int BufferNumPages(int size_bytes);
+
   /**
    * Attach a perf event, which runs a probe every time a perf counter reaches a threshold
    * condition.
@@ -319,8 +344,8 @@ class BCCWrapper {
   }
 
   /**
-   * Drains all of the opened perf buffers, calling the handle function that was
-   * specified in the PerfBufferSpec when OpenPerfBuffer was called.
+   * Drains all of the opened perf buffers and ring buffers, calling the handle function that was
+   * specified in the PerfBufferSpec when OpenPerfBuffer or OpenRingBuffer was called.
    *
    * @param timeout_ms If there's no event in the perf buffer, then timeout_ms specifies the
    *                   amount of time to wait for an event to arrive before returning.
@@ -361,6 +386,7 @@ class BCCWrapper {
   // It is meant for verification that we have cleaned-up all resources in tests.
   static size_t num_attached_probes() { return num_attached_kprobes_ + num_attached_uprobes_; }
   static size_t num_open_perf_buffers() { return num_open_perf_buffers_; }
+  static size_t num_open_ring_buffers() { return num_open_ring_buffers_; }
   static size_t num_attached_perf_events() { return num_attached_perf_events_; }
 
  private:
@@ -379,6 +405,7 @@ class BCCWrapper {
   void DetachUProbes();
   void DetachTracepoints();
   void ClosePerfBuffers();
+  void CloseRingBuffers();
   void DetachPerfEvents();
 
   // Returns the name that identifies the target to attach this k-probe.
@@ -388,6 +415,7 @@ class BCCWrapper {
   std::vector<UProbeSpec> uprobes_;
   std::vector<TracepointSpec> tracepoints_;
   std::vector<PerfBufferSpec> perf_buffers_;
+  std::vector<std::unique_ptr<RingBufferReader>> ring_buffers_;
   std::vector<PerfEventSpec> perf_events_;
 
   std::string system_headers_include_dir_;
@@ -412,6 +440,7 @@ class BCCWrapper {
   inline static size_t num_attached_uprobes_;
   inline static size_t num_attached_tracepoints_;
   inline static size_t num_open_perf_buffers_;
+  inline static size_t num_open_ring_buffers_;
   inline static size_t num_attached_perf_events_;
 };
 
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/bpf_tools/ring_buffer_reader.h"
+
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+
+#include "src/common/system/config.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+StatusOr<std::unique_ptr<RingBufferReader>> RingBufferReader::Create(int map_fd,
+                                                                     size_t size_bytes,
+                                                                     EventCallback callback,
+                                                                     void* cb_cookie) {
+  const size_t page_size = system::Config::GetInstance().PageSize();
+
+  // The first page holds the consumer position, and is the only one writable by user-space.
+  void* consumer_page = mmap(nullptr, page_size, PROT_READ | PROT_WRITE, MAP_SHARED, map_fd, 0);
+  if (consumer_page == MAP_FAILED) {
+    return error::Internal("Failed to mmap ring buffer consumer page: $0", std::strerror(errno));
+  }
+
+  // The next page holds the producer position, and is followed by the data pages, mapped twice.
+  const size_t producer_pages_size = page_size + 2 * size_bytes;
+  void* producer_pages =
+      mmap(nullptr, producer_pages_size, PROT_READ, MAP_SHARED, map_fd, page_size);
+  if (producer_pages == MAP_FAILED) {
+    munmap(consumer_page, page_size);
+    return error::Internal("Failed to mmap ring buffer data pages: $0", std::strerror(errno));
+  }
+
+  auto reader = std::make_unique<RingBufferReader>(
+      static_cast<uint64_t*>(consumer_page), static_cast<const uint64_t*>(producer_pages),
+      static_cast<const uint8_t*>(producer_pages) + page_size, size_bytes, callback, cb_cookie);
+  reader->consumer_page_ = consumer_page;
+  reader->producer_pages_ = producer_pages;
+  reader->producer_pages_size_ = producer_pages_size;
+
+  reader->epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  if (reader->epoll_fd_ < 0) {
+    return error::Internal("Failed to create epoll instance: $0", std::strerror(errno));
+  }
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  if (epoll_ctl(reader->epoll_fd_, EPOLL_CTL_ADD, map_fd, &event) < 0) {
+    return error::Internal("Failed to add ring buffer to epoll: $0", std::strerror(errno));
+  }
+
+  return reader;
+}
+
+RingBufferReader::RingBufferReader(uint64_t* consumer_pos, const uint64_t* producer_pos,
+                                   const uint8_t* data, size_t size_bytes, EventCallback callback,
+                                   void* cb_cookie)
+    : consumer_pos_(consumer_pos),
+      producer_pos_(producer_pos),
+      data_(data),
+      mask_(size_bytes - 1),
+      callback_(callback),
+      cb_cookie_(cb_cookie) {
+  DCHECK_EQ(size_bytes & mask_, 0U) << "Ring buffer size must be a power of 2.";
+}
+
+RingBufferReader::~RingBufferReader() {
+  if (epoll_fd_ >= 0) {
+    close(epoll_fd_);
+  }
+  if (producer_pages_ != nullptr) {
+    munmap(producer_pages_, producer_pages_size_);
+  }
+  if (consumer_page_ != nullptr) {
+    munmap(consumer_page_, system::Config::GetInstance().PageSize());
+  }
+}
+
+namespace {
+
+// The space taken by an event in the ring: the header and the data, rounded up to 8 bytes.
+uint64_t EventSpace(uint32_t len) {
+  len &= ~(RingBufferReader::kBusyBit | RingBufferReader::kDiscardBit);
+  return (len + RingBufferReader::kHeaderSize + 7) / 8 * 8;
+}
+
+}  // namespace
+
+int RingBufferReader::Consume() {
+  int num_events = 0;
+  uint64_t consumer_pos = __atomic_load_n(consumer_pos_, __ATOMIC_ACQUIRE);
+
+  // The producer position is read again after draining, to pick up events committed meanwhile.
+  bool got_new_data = true;
+  while (got_new_data) {
+    got_new_data = false;
+    uint64_t producer_pos = __atomic_load_n(producer_pos_, __ATOMIC_ACQUIRE);
+    while (consumer_pos < producer_pos) {
+      const uint8_t* header = data_ + (consumer_pos & mask_);
+      uint32_t len = __atomic_load_n(reinterpret_cast<const uint32_t*>(header), __ATOMIC_ACQUIRE);
+
+      // Reserved, but not committed yet. Events after it may be committed, but are held back to
+      // preserve the order.
+      if (len & kBusyBit) {
+        return num_events;
+      }
+
+      got_new_data = true;
+      consumer_pos += EventSpace(len);
+
+      if ((len & kDiscardBit) == 0) {
+        callback_(cb_cookie_, const_cast<uint8_t*>(header + kHeaderSize), static_cast<int>(len));
+        ++num_events;
+      }
+
+      // Release the space as soon as possible, so the producers can reuse it.
+      __atomic_store_n(consumer_pos_, consumer_pos, __ATOMIC_RELEASE);
+    }
+  }
+
+  return num_events;
+}
+
+int RingBufferReader::Poll(int timeout_ms) {
+  int num_events = Consume();
+  if (num_events > 0 || timeout_ms == 0 || epoll_fd_ < 0) {
+    return num_events;
+  }
+
+  struct epoll_event event;
+  if (epoll_wait(epoll_fd_, &event, 1, timeout_ms) <= 0) {
+    return 0;
+  }
+  return Consume();
+}
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+/**
+ * Reads events from a BPF ring buffer (BPF_MAP_TYPE_RINGBUF, Linux 5.8+).
+ *
+ * Unlike perf buffers, a ring buffer is shared by all CPUs. BPF code reserves space for an event,
+ * writes it in place and commits (or discards) it, and the reader sees the committed events in
+ * the order in which they were reserved. This is the consumer side of libbpf's ring buffer.
+ *
+ * The kernel maps the data pages twice back to back, so an event that wraps around the end of
+ * the ring can be read as one contiguous block.
+ */
+class RingBufferReader : public NotCopyable {
+ public:
+  // Same signature as perf_reader_raw_cb, so perf buffer handlers can be reused as is.
+  using EventCallback = void (*)(void* cb_cookie, void* data, int data_size);
+
+  /**
+   * Maps the ring buffer map with the given file descriptor into memory.
+   * The file descriptor must remain open for the lifetime of the reader.
+   *
+   * @param size_bytes The size of the ring buffer (max_entries of the map).
+   */
+  static StatusOr<std::unique_ptr<RingBufferReader>> Create(int map_fd, size_t size_bytes,
+                                                            EventCallback callback,
+                                                            void* cb_cookie);
+
+  /**
+   * Reads from an already mapped ring buffer. The data region must be 2 * size_bytes long, with
+   * the second half mirroring the first.
+   */
+  RingBufferReader(uint64_t* consumer_pos, const uint64_t* producer_pos, const uint8_t* data,
+                   size_t size_bytes, EventCallback callback, void* cb_cookie);
+
+  ~RingBufferReader();
+
+  /**
+   * Calls the callback on every committed event, in order, and releases their space to the
+   * producers. Stops at the first event that is reserved but not committed yet.
+   *
+   * @return The number of events passed to the callback.
+   */
+  int Consume();
+
+  /**
+   * Like Consume(), but if the ring buffer is empty, first waits up to timeout_ms for an event.
+   */
+  int Poll(int timeout_ms);
+
+  // Bits of the length field of the 8-byte header that precedes every event.
+  static constexpr uint32_t kBusyBit = 1U << 31;
+  static constexpr uint32_t kDiscardBit = 1U << 30;
+  static constexpr size_t kHeaderSize = 8;
+
+ private:
+  uint64_t* consumer_pos_;
+  const uint64_t* producer_pos_;
+  const uint8_t* data_;
+  uint64_t mask_;
+
+  EventCallback callback_;
+  void* cb_cookie_;
+
+  // Only set if the memory was mapped by Create().
+  void* consumer_page_ = nullptr;
+  void* producer_pages_ = nullptr;
+  size_t producer_pages_size_ = 0;
+  int epoll_fd_ = -1;
+};
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/bpf_tools/ring_buffer_reader.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace bpf_tools {
+
+using ::testing::ElementsAre;
+
+// Emulates the producer side of a kernel ring buffer in plain memory.
+class RingBufferReaderTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kSize = 64;
+
+  RingBufferReaderTest()
+      : data_(2 * kSize),
+        reader_(&consumer_pos_, &producer_pos_, data_.data(), kSize, &RingBufferReaderTest::Collect,
+                this) {}
+
+  // Writes an event, and returns the offset of its header.
+  uint64_t Produce(std::string_view msg, uint32_t flags = 0) {
+    uint64_t pos = producer_pos_;
+    uint32_t header[2] = {static_cast<uint32_t>(msg.size()) | flags, 0};
+    Write(pos, reinterpret_cast<const char*>(header), sizeof(header));
+    Write(pos + sizeof(header), msg.data(), msg.size());
+    producer_pos_ += (sizeof(header) + msg.size() + 7) / 8 * 8;
+    return pos;
+  }
+
+  // Commits an event produced with the busy bit.
+  void Commit(uint64_t pos) {
+    uint32_t len;
+    std::memcpy(&len, &data_[pos % kSize], sizeof(len));
+    len &= ~RingBufferReader::kBusyBit;
+    Write(pos, reinterpret_cast<const char*>(&len), sizeof(len));
+  }
+
+  static void Collect(void* cb_cookie, void* data, int data_size) {
+    auto* test = static_cast<RingBufferReaderTest*>(cb_cookie);
+    test->events_.emplace_back(static_cast<const char*>(data), data_size);
+  }
+
+  uint64_t consumer_pos_ = 0;
+  uint64_t producer_pos_ = 0;
+  std::vector<uint8_t> data_;
+  RingBufferReader reader_;
+  std::vector<std::string> events_;
+
+ private:
+  // Writes to the ring, and to its mirror, like the double mapping of the kernel.
+  void Write(uint64_t pos, const char* buf, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+      uint64_t offset = (pos + i) % kSize;
+      data_[offset] = buf[i];
+      data_[offset + kSize] = buf[i];
+    }
+  }
+};
+
+TEST_F(RingBufferReaderTest, ReadsEventsInOrder) {
+  EXPECT_EQ(reader_.Consume(), 0);
+
+  Produce("abc");
+  Produce("defghijk");
+  EXPECT_EQ(reader_.Consume(), 2);
+  EXPECT_THAT(events_, ElementsAre("abc", "defghijk"));
+  EXPECT_EQ(consumer_pos_, producer_pos_);
+
+  EXPECT_EQ(reader_.Consume(), 0);
+}
+
+TEST_F(RingBufferReaderTest, SkipsDiscardedEvents) {
+  Produce("abc");
+  Produce("dropped", RingBufferReader::kDiscardBit);
+  Produce("def");
+  EXPECT_EQ(reader_.Consume(), 2);
+  EXPECT_THAT(events_, ElementsAre("abc", "def"));
+  EXPECT_EQ(consumer_pos_, producer_pos_);
+}
+
+TEST_F(RingBufferReaderTest, StopsAtUncommittedEvent) {
+  Produce("abc");
+  uint64_t busy_pos = Produce("def", RingBufferReader::kBusyBit);
+  Produce("ghi");
+  EXPECT_EQ(reader_.Consume(), 1);
+  EXPECT_THAT(events_, ElementsAre("abc"));
+  EXPECT_EQ(consumer_pos_, busy_pos);
+
+  Commit(busy_pos);
+  EXPECT_EQ(reader_.Consume(), 2);
+  EXPECT_THAT(events_, ElementsAre("abc", "def", "ghi"));
+}
+
+TEST_F(RingBufferReaderTest, WrapsAround) {
+  std::vector<std::string> expected;
+  for (int i = 0; i < 20; ++i) {
+    // 8 + 13 bytes per event, so the events do not line up with the end of the ring.
+    std::string msg = absl::StrCat("event-", 1000000 + i);
+    Produce(msg);
+    expected.push_back(msg);
+    if (i % 2 == 1) {
+      EXPECT_EQ(reader_.Consume(), 2);
+    }
+  }
+  EXPECT_EQ(events_, expected);
+  EXPECT_GT(consumer_pos_, 4 * kSize);
+}
+
+}  // namespace bpf_tools
+}  // namespace stirling
+}  // namespace px
@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -35,7 +36,7 @@ using types::DataType;
 
 DataTable::DataTable(uint64_t id, const DataTableSchema& schema) : id_(id), table_schema_(schema) {}
 
-void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
+void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr, size_t capacity) {
   DCHECK(record_batch_ptr != nullptr);
   DCHECK(record_batch_ptr->empty());
 
@@ -44,7 +45,7 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
 
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
-  col->Reserve(kTargetCapacity);                  \
+  col->Reserve(capacity);                         \
   record_batch_ptr->push_back(col);
     PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
 #undef TYPE_CASE
@@ -54,26 +55,102 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
 Tablet* DataTable::GetTablet(types::TabletIDView tablet_id) {
   auto& tablet = tablets_[tablet_id];
   if (tablet.records.empty()) {
-    InitBuffers(&tablet.records);
+    InitBuffers(&tablet.records, tablet.capacity);
+    tablet.times.reserve(tablet.capacity);
   }
   return &tablet;
 }
 
+namespace {
+
+template <types::DataType DT>
+void MoveColumnValues(ColumnWrapper* src, ColumnWrapper* dst) {
+  using TValueType = typename types::DataTypeTraits<DT>::value_type;
+  auto* typed_src = static_cast<types::ColumnWrapperTmpl<TValueType>*>(src);
+  auto* typed_dst = static_cast<types::ColumnWrapperTmpl<TValueType>*>(dst);
+  typed_dst->Reserve(typed_dst->Size() + typed_src->Size());
+  for (size_t i = 0; i < typed_src->Size(); ++i) {
+    typed_dst->Append(std::move((*typed_src)[i]));
+  }
+  typed_src->Clear();
+}
+
+}  // namespace
+
+void DataTable::MoveRecordsFrom(DataTable* other) {
+  DCHECK_EQ(table_schema_.elements().size(), other->table_schema_.elements().size());
+
+  for (auto& [tablet_id, src_tablet] : other->tablets_) {
+    if (src_tablet.times.empty()) {
+      continue;
+    }
+
+    Tablet* dst_tablet = GetTablet(tablet_id);
+    for (uint64_t time : src_tablet.times) {
+      dst_tablet->AppendTime(time);
+    }
+    src_tablet.times.clear();
+    src_tablet.times_sorted = true;
+
+    for (size_t i = 0; i < src_tablet.records.size(); ++i) {
+      ColumnWrapper* src = src_tablet.records[i].get();
+      ColumnWrapper* dst = dst_tablet->records[i].get();
+#define TYPE_CASE(_dt_) MoveColumnValues<_dt_>(src, dst);
+      PL_SWITCH_FOREACH_DATATYPE(table_schema_.elements()[i].type(), TYPE_CASE);
+#undef TYPE_CASE
+    }
+  }
+}
+
 std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   std::vector<TaggedRecordBatch> tablets_out;
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
 
+  // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
+  // classification: which classified according to:
+  //   expired < start_time
+  //   pushable <= end_time
+  uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
+                                               : std::numeric_limits<uint64_t>::max();
+
   for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
+    // Tablets that received no records since the last call are dropped.
+    if (tablet.times.empty()) {
+      continue;
+    }
 
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
-    //   expired < start_time
-    //   pushable <= end_time
-    uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
-                                                 : std::numeric_limits<uint64_t>::max();
+    // Size the next buffers of the tablet for as many records as arrived this time.
+    // The capacity decays slowly, so a short lull does not cause reallocations on the next burst.
+    Tablet& next_tablet = carryover_tablets[tablet_id];
+    next_tablet.tablet_id = tablet_id;
+    next_tablet.capacity = std::max(tablet.times.size(), tablet.capacity / 2);
+
+    // Fast path: the records were built in time order, and are all pushable.
+    // Push the buffers out as they are; new ones are allocated on the next append.
+    if (tablet.times_sorted && tablet.times.front() >= start_time_ &&
+        tablet.times.back() < end_time) {
+      next_start_time = std::max(next_start_time, tablet.times.back());
+      // The table store keeps these buffers, but only counts the bytes of the records towards its
+      // size limit. So don't hand over much more room than the records use (e.g. a few records
+      // in buffers reserved for the previous burst).
+      for (auto& col : tablet.records) {
+        if (col->Capacity() - col->Size() > col->Size() / Tablet::kMaxUnusedCapacityDivisor) {
+          col->ShrinkToFit();
+        }
+      }
+      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(tablet.records)});
+      continue;
+    }
+
+    // Sort based on times.
+    std::vector<size_t> sort_indexes;
+    if (tablet.times_sorted) {
+      sort_indexes.resize(tablet.times.size());
+      std::iota(sort_indexes.begin(), sort_indexes.end(), size_t{0});
+    } else {
+      sort_indexes = utils::SortedIndexes(tablet.times);
+    }
 
     // Split the indexes into three groups:
     // 1) Expired indexes: these are too old to return.
@@ -108,19 +185,19 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
     // Case 3: Carryover records.
     if (num_carryover > 0) {
       // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
+      std::vector<size_t> carryover_indexes(sort_indexes.begin() + positions[1],
                                             sort_indexes.end());
-      types::ColumnWrapperRecordBatch carryover_records;
       for (auto& col : tablet.records) {
-        carryover_records.push_back(col->MoveIndexes(carryover_indexes));
+        auto carryover_col = col->MoveIndexes(carryover_indexes);
+        carryover_col->Reserve(next_tablet.capacity);
+        next_tablet.records.push_back(std::move(carryover_col));
       }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+      // The carryover records are in sorted order, so next_tablet.times_sorted remains true.
+      next_tablet.times.reserve(next_tablet.capacity);
+      for (size_t idx : carryover_indexes) {
+        next_tablet.times.push_back(tablet.times[idx]);
       }
-      carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
     }
   }
   tablets_ = std::move(carryover_tablets);
@@ -42,10 +42,26 @@ struct TaggedRecordBatch {
 };
 
 struct Tablet {
+  static constexpr size_t kInitialCapacity = 1024;
+  // Buffers that are handed over as they are may have up to 1/kMaxUnusedCapacityDivisor of their
+  // size in unused capacity. Larger buffers are shrunk first.
+  static constexpr size_t kMaxUnusedCapacityDivisor = 8;
+
   types::TabletID tablet_id;
   // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
+  // True while the times were appended in non-decreasing order.
+  // Records are usually built in time order, in which case they need not be sorted when consumed.
+  bool times_sorted = true;
+  // Number of records that the buffers reserve room for when they are (re)initialized.
+  // Adjusted on every DataTable::ConsumeRecords() to the number of records that arrived.
+  size_t capacity = kInitialCapacity;
   types::ColumnWrapperRecordBatch records;
+
+  void AppendTime(uint64_t time) {
+    times_sorted = times_sorted && (times.empty() || times.back() <= time);
+    times.push_back(time);
+  }
 };
 
 class DataTable : public NotCopyable {
@@ -64,6 +80,9 @@ class DataTable : public NotCopyable {
    * A warning message is printed in such cases.
    *
    * @param end_time Threshold time up until which records are pushed out.
+   * When the records of a tablet were built in time order and can all be pushed out, the
+   * tablet's buffers are handed over as is, without being copied.
+   *
    * @return vector of Tablets (without tabletization, vector size is <=1).
    *         Empty record batches are not pushed into the vector, so all
    *         TaggedRecordBatch objects will have at least one record.
@@ -84,6 +103,16 @@ class DataTable : public NotCopyable {
     cutoff_time_ = cutoff_time;
   }
 
+  /**
+   * Moves all the records buffered in another table with the same schema to the end of this
+   * table. The other table is left empty, but keeps its buffers for reuse.
+   *
+   * Used to merge records that were built concurrently in separate tables.
+   *
+   * @param other The table whose records are moved.
+   */
+  void MoveRecordsFrom(DataTable* other);
+
   /**
    * Return current occupancy of the Data Table.
    *
@@ -165,7 +194,8 @@ class DataTable : public NotCopyable {
         }
       }
 
-      tablet_.records[TIndex]->Append(std::move(val));
+      // The column type is known from the schema at compile-time, so skip the run-time type check.
+      tablet_.records[TIndex]->AppendNoTypeCheck(std::move(val));
       DCHECK(!signature_[TIndex]) << absl::Substitute(
           "Attempt to Append() to column $0 (name=$1) multiple times", TIndex,
           schema->ColName(TIndex));
@@ -191,7 +221,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema->elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
     }
 
     Tablet& tablet_;
@@ -247,7 +277,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
     }
@@ -268,8 +298,8 @@ class DataTable : public NotCopyable {
   // Unique ID set by InfoClassManager.
   const uint64_t id_;
 
-  // Initialize a new Active record batch.
-  void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr);
+  // Initialize a new Active record batch, with room for the given number of records.
+  void InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr, size_t capacity);
 
   // Get a pointer to the Tablet, for appending. Used by RecordBuilder.
   Tablet* GetTablet(types::TabletIDView tablet_id);
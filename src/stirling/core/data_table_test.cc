@@ -16,6 +16,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <gmock/gmock.h>
 #include <gtest/gtest.h>
 #include <random>
 #include <string>
@@ -314,6 +315,144 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+TEST_F(DataTableTest, MoveRecordsFrom) {
+  DataTable other(/*id*/ 0, kSchema);
+
+  auto append = [](DataTable* data_table, int time, std::string s) {
+    DataTable::RecordBuilder<&kSchema> r(data_table, time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(time / 10);
+    r.Append<r.ColIndex("s")>(std::move(s));
+  };
+
+  append(data_table_.get(), 10, "b");
+  append(&other, 0, "a");
+  append(&other, 20, "c");
+  data_table_->MoveRecordsFrom(&other);
+  EXPECT_EQ(data_table_->Occupancy(), 3);
+  EXPECT_EQ(other.Occupancy(), 0);
+
+  // The other table can be reused.
+  append(&other, 30, "d");
+  data_table_->MoveRecordsFrom(&other);
+
+  std::vector<TaggedRecordBatch> record_batches = data_table_->ConsumeRecords();
+  ASSERT_EQ(record_batches.size(), 1);
+  types::ColumnWrapperRecordBatch& rb = record_batches[0].records;
+  ASSERT_EQ(rb[0]->Size(), 4);
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(i), 10 * static_cast<int>(i));
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(i), static_cast<int>(i));
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(i), std::string(1, 'a' + i));
+  }
+  EXPECT_TRUE(other.ConsumeRecords().empty());
+}
+
+// Records built in time order take a faster path through ConsumeRecords() than scrambled ones.
+// Check that it classifies them the same way.
+TEST_F(DataTableTest, InOrderRecords) {
+  auto append = [this](int time) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(time / 10);
+    r.Append<r.ColIndex("s")>(std::string(1, 'a' + time / 10));
+  };
+
+  auto times = [](const TaggedRecordBatch& record_batch) {
+    std::vector<int64_t> out;
+    for (size_t i = 0; i < record_batch.records[0]->Size(); ++i) {
+      out.push_back(record_batch.records[0]->Get<types::Time64NSValue>(i).val);
+      EXPECT_EQ(record_batch.records[1]->Get<types::Int64Value>(i), out.back() / 10);
+      EXPECT_EQ(record_batch.records[2]->Get<types::StringValue>(i),
+                std::string(1, 'a' + out.back() / 10));
+    }
+    return out;
+  };
+
+  // All records are pushed out.
+  append(10);
+  append(20);
+  std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  EXPECT_THAT(times(tablets[0]), ::testing::ElementsAre(10, 20));
+  EXPECT_EQ(data_table_->Occupancy(), 0);
+
+  // Expired, pushable and carryover records all at once.
+  append(5);
+  append(30);
+  append(40);
+  append(50);
+  data_table_->SetConsumeRecordsCutoffTime(40);
+  tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  EXPECT_THAT(times(tablets[0]), ::testing::ElementsAre(30, 40));
+  EXPECT_EQ(data_table_->Occupancy(), 1);
+
+  append(60);
+  data_table_->SetConsumeRecordsCutoffTime(100);
+  tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  EXPECT_THAT(times(tablets[0]), ::testing::ElementsAre(50, 60));
+  EXPECT_TRUE(data_table_->ConsumeRecords().empty());
+}
+
+// Carryover records are the ones after the pushable records. When some records had expired,
+// the last pushable records used to be carried over as well, and pushed out a second time.
+TEST_F(DataTableTest, CarryoverAfterExpiredRecords) {
+  auto append = [this](int time) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(time / 10);
+    r.Append<r.ColIndex("s")>(std::string(1, 'a' + time / 10));
+  };
+
+  auto times = [](const TaggedRecordBatch& record_batch) {
+    std::vector<int64_t> out;
+    for (size_t i = 0; i < record_batch.records[0]->Size(); ++i) {
+      out.push_back(record_batch.records[0]->Get<types::Time64NSValue>(i).val);
+    }
+    return out;
+  };
+
+  append(10);
+  ASSERT_EQ(data_table_->ConsumeRecords().size(), 1);
+
+  // Out of order, so that the records are sorted: 5 expires, 30 and 40 are pushable and 50 is
+  // carried over.
+  append(50);
+  append(5);
+  append(40);
+  append(30);
+  data_table_->SetConsumeRecordsCutoffTime(40);
+  std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  EXPECT_THAT(times(tablets[0]), ::testing::ElementsAre(30, 40));
+  EXPECT_EQ(data_table_->Occupancy(), 1);
+
+  data_table_->SetConsumeRecordsCutoffTime(100);
+  tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  EXPECT_THAT(times(tablets[0]), ::testing::ElementsAre(50));
+}
+
+// Buffers that are handed over without copying must not hold on to much more memory than their
+// records use, since the table store only counts the bytes of the records.
+TEST_F(DataTableTest, InOrderRecordsShrinkToFit) {
+  for (int time = 10; time <= 30; time += 10) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(time / 10);
+    r.Append<r.ColIndex("s")>(std::string(1, 'a' + time / 10));
+  }
+
+  std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  for (const auto& col : tablets[0].records) {
+    EXPECT_EQ(col->Size(), 3);
+    EXPECT_EQ(col->Capacity(), 3);
+  }
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
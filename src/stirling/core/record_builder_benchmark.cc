@@ -0,0 +1,128 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/data_table.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// A schema shaped like the http_events table: a few numbers, and a few strings.
+constexpr DataElement kElements[] = {
+    {"time_", "", types::DataType::TIME64NS, types::SemanticType::ST_NONE,
+     types::PatternType::METRIC_COUNTER},
+    {"upid", "", types::DataType::UINT128, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"remote_port", "", types::DataType::INT64, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"req_path", "", types::DataType::STRING, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"req_headers", "", types::DataType::STRING, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"resp_body", "", types::DataType::STRING, types::SemanticType::ST_NONE,
+     types::PatternType::GENERAL},
+    {"latency", "", types::DataType::INT64, types::SemanticType::ST_NONE,
+     types::PatternType::METRIC_GAUGE},
+};
+constexpr auto kTableSchema = DataTableSchema("bench_table", "A table for benchmarks", kElements);
+
+std::vector<uint64_t> RecordTimes(size_t num_records, bool in_order) {
+  std::vector<uint64_t> times(num_records);
+  for (size_t i = 0; i < num_records; ++i) {
+    times[i] = 1000 + i;
+  }
+  if (!in_order) {
+    std::mt19937 rng(37);
+    std::shuffle(times.begin(), times.end(), rng);
+  }
+  return times;
+}
+
+void BuildRecords(DataTable* data_table, const std::vector<uint64_t>& times,
+                  const std::string& str) {
+  for (uint64_t time : times) {
+    DataTable::RecordBuilder<&kTableSchema> r(data_table, time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("upid")>(absl::MakeUint128(1, 2));
+    r.Append<r.ColIndex("remote_port")>(8080);
+    r.Append<r.ColIndex("req_path")>("/index.html");
+    r.Append<r.ColIndex("req_headers")>(str);
+    r.Append<r.ColIndex("resp_body")>(str);
+    r.Append<r.ColIndex("latency")>(time % 100);
+  }
+}
+
+}  // namespace
+
+// Builds records into a DataTable, and consumes them, as a source connector does every iteration.
+// Args: {number of records per iteration, string size, records built in time order}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_BuildAndConsumeRecords(benchmark::State& state) {
+  const size_t num_records = state.range(0);
+  const std::string str(state.range(1), 'x');
+  const std::vector<uint64_t> times = RecordTimes(num_records, state.range(2));
+
+  DataTable data_table(/*id*/ 0, kTableSchema);
+  for (auto _ : state) {
+    BuildRecords(&data_table, times, str);
+    std::vector<TaggedRecordBatch> record_batches = data_table.ConsumeRecords();
+    benchmark::DoNotOptimize(record_batches);
+  }
+  state.SetItemsProcessed(state.iterations() * num_records);
+}
+
+// Only the ConsumeRecords() part of the above.
+// Args: {number of records per iteration, records built in time order}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ConsumeRecords(benchmark::State& state) {
+  const size_t num_records = state.range(0);
+  const std::string str(16, 'x');
+  const std::vector<uint64_t> times = RecordTimes(num_records, state.range(1));
+
+  DataTable data_table(/*id*/ 0, kTableSchema);
+  for (auto _ : state) {
+    state.PauseTiming();
+    BuildRecords(&data_table, times, str);
+    state.ResumeTiming();
+
+    std::vector<TaggedRecordBatch> record_batches = data_table.ConsumeRecords();
+    benchmark::DoNotOptimize(record_batches);
+  }
+  state.SetItemsProcessed(state.iterations() * num_records);
+}
+
+BENCHMARK(BM_BuildAndConsumeRecords)
+    ->Args({1024, 16, 1})
+    ->Args({1024, 256, 1})
+    ->Args({16384, 16, 1})
+    ->Args({16384, 256, 1})
+    ->Args({16384, 256, 0});
+BENCHMARK(BM_ConsumeRecords)->Args({1024, 1})->Args({1024, 0})->Args({16384, 1})->Args({16384, 0});
+
+}  // namespace stirling
+}  // namespace px
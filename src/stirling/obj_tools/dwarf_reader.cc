@@ -19,6 +19,8 @@
 #include "src/stirling/obj_tools/dwarf_reader.h"
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
@@ -105,6 +107,13 @@ StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateWithSelectiveIndexing(
   return dwarf_reader;
 }
 
+StatusOr<std::unique_ptr<DwarfReader>> DwarfReader::CreateIndexingAllLazily(
+    const std::filesystem::path& path, int num_threads) {
+  PL_ASSIGN_OR_RETURN(auto dwarf_reader, CreateWithoutIndexing(path));
+  PL_RETURN_IF_ERROR(dwarf_reader->IndexDIEsLazily(num_threads));
+  return dwarf_reader;
+}
+
 DwarfReader::DwarfReader(std::unique_ptr<llvm::MemoryBuffer> buffer,
                          std::unique_ptr<llvm::DWARFContext> dwarf_context)
     : memory_buffer_(std::move(buffer)), dwarf_context_(std::move(dwarf_context)) {
@@ -172,76 +181,100 @@ Status DwarfReader::DetectSourceLanguage() {
       "any compilation unit.");
 }
 
-void DwarfReader::IndexDIEs(
+struct DwarfReader::UnitIndex {
+  struct Entry {
+    llvm::dwarf::Tag tag;
+    std::string name;
+    uint64_t die_offset;
+  };
+  std::vector<Entry> entries;
+
+  // Pairs of DW_AT_specification and the offset of the DIE that has the attribute.
+  // Only DW_TAG_subprogram can have this attribute. Also only applies to CPP binaries.
+  std::vector<std::pair<uint64_t, uint64_t>> fn_specs;
+};
+
+DwarfReader::UnitIndex DwarfReader::IndexUnit(
+    llvm::DWARFUnit* unit,
     const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
-  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
+  UnitIndex unit_index;
 
-  // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
-  // Also only applies to CPP binaries.
-  absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
+  // A parent DIE is always in the same unit as its children, so the names are per-unit.
+  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
 
-  DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
-  for (const std::unique_ptr<llvm::DWARFUnit>& unit : units) {
-    for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
-      DWARFDie die = {unit.get(), &entry};
+  for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
+    DWARFDie die = {unit, &entry};
 
-      if (die.isSubprogramDIE()) {
-        auto spec_or =
-            AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
-                              "Could not find attribute DW_AT_specification");
-        if (spec_or.ok()) {
-          fn_spec_offsets[spec_or.ValueOrDie()] = die;
-        }
+    if (die.isSubprogramDIE()) {
+      auto spec_or =
+          AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
+                            "Could not find attribute DW_AT_specification");
+      if (spec_or.ok()) {
+        unit_index.fn_specs.emplace_back(spec_or.ValueOrDie(), die.getOffset());
       }
+    }
 
-      // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
-      // index the function DIE. That removes the need of using manually-assembled names (through
-      // parent DIE).
+    // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
+    // index the function DIE. That removes the need of using manually-assembled names (through
+    // parent DIE).
 
-      auto name = std::string(GetShortName(die));
+    auto name = std::string(GetShortName(die));
 
-      if (name.empty()) {
-        continue;
-      }
+    if (name.empty()) {
+      continue;
+    }
 
-      // Only check matching if patterns are provided.
-      if (symbol_search_patterns_opt.has_value() &&
-          !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
-        continue;
-      }
+    // Only check matching if patterns are provided.
+    if (symbol_search_patterns_opt.has_value() &&
+        !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
+      continue;
+    }
 
-      llvm::dwarf::Tag tag = die.getTag();
+    llvm::dwarf::Tag tag = die.getTag();
 
-      if (IsIndexedType(tag) ||
-          // Namespace entry is processed here so that the name components can be generated.
-          IsNamespace(tag)) {
-        llvm::DWARFDie parent_die = die.getParent();
+    if (IsIndexedType(tag) ||
+        // Namespace entry is processed here so that the name components can be generated.
+        IsNamespace(tag)) {
+      llvm::DWARFDie parent_die = die.getParent();
 
-        if (parent_die.isValid()) {
-          const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+      if (parent_die.isValid()) {
+        const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
 
-          if (entry != nullptr) {
-            auto iter = dwarf_entry_names.find(entry);
-            if (iter != dwarf_entry_names.end()) {
-              std::string_view parent_name = iter->second;
-              name = absl::StrCat(parent_name, "::", name);
-            }
+        if (entry != nullptr) {
+          auto iter = dwarf_entry_names.find(entry);
+          if (iter != dwarf_entry_names.end()) {
+            std::string_view parent_name = iter->second;
+            name = absl::StrCat(parent_name, "::", name);
           }
-          dwarf_entry_names[die.getDebugInfoEntry()] = name;
         }
+        dwarf_entry_names[die.getDebugInfoEntry()] = name;
+      }
 
-        if (IsIndexedType(tag)) {
-          InsertToDIEMap(std::move(name), tag, die);
-        }
+      if (IsIndexedType(tag)) {
+        unit_index.entries.push_back({tag, std::move(name), die.getOffset()});
       }
     }
   }
 
+  return unit_index;
+}
+
+void DwarfReader::AddToDIEMap(UnitIndex* unit_index,
+                              absl::flat_hash_map<uint64_t, uint64_t>* fn_spec_offsets) {
+  for (UnitIndex::Entry& entry : unit_index->entries) {
+    InsertToDIEMap(std::move(entry.name), entry.tag, entry.die_offset);
+  }
+  for (const auto& [spec_offset, die_offset] : unit_index->fn_specs) {
+    (*fn_spec_offsets)[spec_offset] = die_offset;
+  }
+}
+
+void DwarfReader::ApplyFnSpecifications(
+    const absl::flat_hash_map<uint64_t, uint64_t>& fn_spec_offsets) {
   auto& fn_dies = die_map_[llvm::dwarf::DW_TAG_subprogram];
 
   for (auto iter = fn_dies.begin(); iter != fn_dies.end(); ++iter) {
-    uint64_t offset = iter->second.getOffset();
-    auto spec_iter = fn_spec_offsets.find(offset);
+    auto spec_iter = fn_spec_offsets.find(iter->second);
     if (spec_iter == fn_spec_offsets.end()) {
       continue;
     }
@@ -250,6 +283,89 @@ void DwarfReader::IndexDIEs(
   }
 }
 
+void DwarfReader::IndexDIEs(
+    const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
+  // Map from DW_AT_specification to the offset of the DIE.
+  absl::flat_hash_map<uint64_t, uint64_t> fn_spec_offsets;
+
+  DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
+  for (const std::unique_ptr<llvm::DWARFUnit>& unit : units) {
+    UnitIndex unit_index = IndexUnit(unit.get(), symbol_search_patterns_opt);
+    AddToDIEMap(&unit_index, &fn_spec_offsets);
+  }
+
+  ApplyFnSpecifications(fn_spec_offsets);
+}
+
+namespace {
+
+// A worker of IndexDIEsLazily() discards its DWARFContext, and with it the DIEs it has parsed,
+// after parsing this many bytes of compile units. This bounds the memory used by each worker.
+constexpr uint64_t kMaxParsedUnitBytesPerContext = 64 * 1024 * 1024;
+
+}  // namespace
+
+Status DwarfReader::IndexDIEsLazily(int num_threads) {
+  DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
+  const size_t num_units = std::distance(units.begin(), units.end());
+
+  // Each unit is indexed independently, into its own slot, so the workers share no state other
+  // than the counter handing out units, and the input buffer, which is only read.
+  std::vector<UnitIndex> unit_indexes(num_units);
+  std::atomic<size_t> next_unit = 0;
+
+  auto index_units = [&](Status* status) {
+    // The DWARFContext keeps a pointer to the object file, so it must be destroyed first.
+    std::unique_ptr<llvm::object::ObjectFile> obj_file;
+    std::unique_ptr<DWARFContext> context;
+    uint64_t parsed_bytes = 0;
+
+    for (size_t i = next_unit++; i < num_units; i = next_unit++) {
+      if (context == nullptr || parsed_bytes > kMaxParsedUnitBytesPerContext) {
+        context.reset();
+        llvm::Expected<std::unique_ptr<llvm::object::ObjectFile>> obj_or_err =
+            llvm::object::ObjectFile::createObjectFile(memory_buffer_->getMemBufferRef());
+        std::error_code ec = errorToErrorCode(obj_or_err.takeError());
+        if (ec) {
+          *status = error::Internal("DwarfReader $0: $1", ec.message(),
+                                    memory_buffer_->getBufferIdentifier().str());
+          return;
+        }
+        obj_file = std::move(obj_or_err.get());
+        context = DWARFContext::create(*obj_file);
+        parsed_bytes = 0;
+      }
+
+      llvm::DWARFUnit* unit = context->normal_units().begin()[i].get();
+      unit_indexes[i] = IndexUnit(unit, std::nullopt);
+      parsed_bytes += unit->getLength();
+    }
+  };
+
+  num_threads = std::max(num_threads, 1);
+  std::vector<Status> statuses(num_threads);
+  std::vector<std::thread> threads;
+  for (int i = 1; i < num_threads; ++i) {
+    threads.emplace_back(index_units, &statuses[i]);
+  }
+  index_units(&statuses[0]);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& status : statuses) {
+    PL_RETURN_IF_ERROR(status);
+  }
+
+  absl::flat_hash_map<uint64_t, uint64_t> fn_spec_offsets;
+  for (UnitIndex& unit_index : unit_indexes) {
+    AddToDIEMap(&unit_index, &fn_spec_offsets);
+    unit_index = {};
+  }
+  ApplyFnSpecifications(fn_spec_offsets);
+
+  return Status::OK();
+}
+
 StatusOr<std::vector<DWARFDie>> DwarfReader::GetMatchingDIEs(
     std::string_view name, std::optional<llvm::dwarf::Tag> type_opt) {
   DCHECK(dwarf_context_ != nullptr);
@@ -717,7 +833,7 @@ Status DwarfReader::FlattenedStructSpec(const llvm::DWARFDie& struct_die,
   return Status::OK();
 }
 
-void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::DWARFDie die) {
+void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, uint64_t die_offset) {
   auto& die_type_map = die_map_[tag];
   // TODO(oazizi): What's the right way to deal with duplicate names?
   // Only appears to happen with structs like the following:
@@ -726,7 +842,7 @@ void DwarfReader::InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::D
   if (die_type_map.find(name) != die_type_map.end()) {
     return;
   }
-  die_type_map[name] = die;
+  die_type_map[name] = die_offset;
 }
 
 std::optional<llvm::DWARFDie> DwarfReader::FindInDIEMap(const std::string& name,
@@ -740,7 +856,12 @@ std::optional<llvm::DWARFDie> DwarfReader::FindInDIEMap(const std::string& name,
   if (die_iter == die_type_map.end()) {
     return std::nullopt;
   }
-  return die_iter->second;
+  // Parses the DIEs of the containing compile unit, if that hasn't been done yet.
+  DWARFDie die = dwarf_context_->getDIEForOffset(die_iter->second);
+  if (!die.isValid()) {
+    return std::nullopt;
+  }
+  return die;
 }
 
 StatusOr<TypeInfo> DwarfReader::DereferencePointerType(std::string type_name) {
@@ -161,6 +161,16 @@ class DwarfReader {
   static StatusOr<std::unique_ptr<DwarfReader>> CreateWithSelectiveIndexing(
       const std::filesystem::path& path, const std::vector<SymbolSearchPattern>& symbol_patterns);
 
+  /**
+   * Like CreateIndexingAll(), but meant for large binaries: the compile units are indexed
+   * on num_threads threads, each with its own short-lived DWARFContext. Only the offsets of the
+   * DIEs are kept in the index, and the DIEs of a compile unit are parsed when a lookup first
+   * lands in it. Memory use therefore grows with what is looked up, rather than with the size of
+   * the debug information.
+   */
+  static StatusOr<std::unique_ptr<DwarfReader>> CreateIndexingAllLazily(
+      const std::filesystem::path& path, int num_threads);
+
   /**
    * Searches the debug information for Debugging information entries (DIEs)
    * that match the name.
@@ -308,13 +318,31 @@ class DwarfReader {
   // Otherwise, only the ones whose names match are indexed.
   void IndexDIEs(const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt);
 
+  // Builds the same index as IndexDIEs(std::nullopt), using num_threads threads, each of which
+  // parses compile units with a DWARFContext of its own. The DIEs of dwarf_context_ are left
+  // unparsed.
+  Status IndexDIEsLazily(int num_threads);
+
+  // The indexed DIEs of a single compile unit.
+  struct UnitIndex;
+  static UnitIndex IndexUnit(
+      llvm::DWARFUnit* unit,
+      const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt);
+
+  // Adds the DIEs of unit_index to die_map_. Units must be added in order, so that the first of
+  // duplicate names wins, like in a serial walk of the DIEs.
+  void AddToDIEMap(UnitIndex* unit_index, absl::flat_hash_map<uint64_t, uint64_t>* fn_spec_offsets);
+
+  // Replaces indexed function declarations with their definitions (DW_AT_specification).
+  void ApplyFnSpecifications(const absl::flat_hash_map<uint64_t, uint64_t>& fn_spec_offsets);
+
   // Walks the struct_die for all members, recursively visiting any members which are also structs,
   // to capture information of all base type members of the struct in a flattened form.
   // See GetStructSpec() for the public interface, and the output format.
   Status FlattenedStructSpec(const llvm::DWARFDie& struct_die, std::vector<StructSpecEntry>* output,
                              const std::string& path_prefix, int offset);
 
-  void InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, llvm::DWARFDie die);
+  void InsertToDIEMap(std::string name, llvm::dwarf::Tag tag, uint64_t die_offset);
   std::optional<llvm::DWARFDie> FindInDIEMap(const std::string& name, llvm::dwarf::Tag tag) const;
 
   // Records the source language of the DWARF information.
@@ -324,8 +352,10 @@ class DwarfReader {
   std::unique_ptr<llvm::MemoryBuffer> memory_buffer_;
   std::unique_ptr<llvm::DWARFContext> dwarf_context_;
 
-  // Nested map: [tag][symbol_name] -> DWARFDie
-  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, llvm::DWARFDie>> die_map_;
+  // Nested map: [tag][symbol_name] -> DIE offset
+  // Offsets, rather than DWARFDie objects, are kept so the index does not pin the parsed DIEs of
+  // every compile unit; see CreateIndexingAllLazily().
+  absl::flat_hash_map<llvm::dwarf::Tag, absl::flat_hash_map<std::string, uint64_t>> die_map_;
 };
 
 }  // namespace obj_tools
@@ -16,6 +16,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <sys/resource.h>
+
 #include <benchmark/benchmark.h>
 
 #include "src/common/base/base.h"
@@ -105,5 +107,60 @@ static void BM_indexed(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_indexed_lazily(benchmark::State& state) {
+  size_t num_lookup_iterations = state.range(0);
+  int num_threads = state.range(1);
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateIndexingAllLazily(kBinary, num_threads));
+
+    for (size_t i = 0; i < num_lookup_iterations; ++i) {
+      GetSymAddrs(dwarf_reader.get(), &symaddrs);
+      benchmark::DoNotOptimize(symaddrs);
+    }
+  }
+}
+
+// Returns the peak resident set size of this process.
+int64_t PeakRSSBytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss * 1024;
+}
+
+// Measures the time to build the index (plus one round of lookups, so that the units parsed on
+// demand are accounted for), eagerly if the argument is 0, or lazily with that many threads.
+//
+// peak_rss is the high-water mark of the whole process, so to compare the memory of the modes,
+// run them one at a time, e.g. --benchmark_filter=BM_index_build/4.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_index_build(benchmark::State& state) {
+  int num_threads = state.range(0);
+
+  for (auto _ : state) {
+    SymAddrs symaddrs;
+
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<DwarfReader> dwarf_reader,
+                      num_threads == 0
+                          ? DwarfReader::CreateIndexingAll(kBinary)
+                          : DwarfReader::CreateIndexingAllLazily(kBinary, num_threads));
+
+    GetSymAddrs(dwarf_reader.get(), &symaddrs);
+    benchmark::DoNotOptimize(symaddrs);
+  }
+
+  state.counters["peak_rss"] = benchmark::Counter(PeakRSSBytes(), benchmark::Counter::kDefaults,
+                                                  benchmark::Counter::OneK::kIs1024);
+}
+
 BENCHMARK(BM_noindex)->RangeMultiplier(2)->Range(1, 16);
 BENCHMARK(BM_indexed)->RangeMultiplier(2)->Range(1, 16);
+BENCHMARK(BM_indexed_lazily)
+    ->RangeMultiplier(2)
+    ->Ranges({{1, 16}, {4, 4}})
+    ->UseRealTime();
+BENCHMARK(BM_index_build)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
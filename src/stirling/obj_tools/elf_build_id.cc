@@ -0,0 +1,173 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/elf_build_id.h"
+
+#include <elf.h>
+
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "src/common/base/utils.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+namespace {
+
+// The note type that the Go linker uses for its build ID, with owner name "Go".
+// See cmd/link/internal/ld/elf.go in the Go source tree.
+constexpr uint32_t kNTGoBuildID = 4;
+
+// Note segments are small. This bounds what is read from a corrupt or unusual file.
+constexpr uint64_t kMaxNoteSegmentSize = 64 * 1024;
+
+struct LowercaseHex {
+  static inline constexpr std::string_view kCharFormat = "%02x";
+  static inline constexpr int kSizePerByte = 2;
+  static inline constexpr bool kKeepPrintableChars = false;
+};
+
+// Returns the descriptor of the first note with the specified owner name and type,
+// from the PT_NOTE segments of an ELF file.
+StatusOr<std::string> ReadNote(const std::filesystem::path& binary, std::string_view name,
+                               uint32_t type) {
+  std::ifstream ifs(binary, std::ios::binary);
+  if (!ifs) {
+    return error::Internal("Could not open $0", binary.string());
+  }
+
+  Elf64_Ehdr ehdr;
+  if (!ifs.read(reinterpret_cast<char*>(&ehdr), sizeof(ehdr)) ||
+      std::memcmp(ehdr.e_ident, ELFMAG, SELFMAG) != 0) {
+    return error::InvalidArgument("$0 is not an ELF file", binary.string());
+  }
+  if (ehdr.e_ident[EI_CLASS] != ELFCLASS64 || ehdr.e_phentsize != sizeof(Elf64_Phdr)) {
+    return error::Unimplemented("Only 64-bit ELF files are supported [binary=$0]",
+                                binary.string());
+  }
+
+  for (int i = 0; i < ehdr.e_phnum; ++i) {
+    Elf64_Phdr phdr;
+    ifs.seekg(ehdr.e_phoff + i * sizeof(Elf64_Phdr));
+    if (!ifs.read(reinterpret_cast<char*>(&phdr), sizeof(phdr))) {
+      return error::Internal("Could not read program header $0 of $1", i, binary.string());
+    }
+    if (phdr.p_type != PT_NOTE || phdr.p_filesz > kMaxNoteSegmentSize) {
+      continue;
+    }
+
+    std::string notes(phdr.p_filesz, '\0');
+    ifs.seekg(phdr.p_offset);
+    if (!ifs.read(notes.data(), notes.size())) {
+      return error::Internal("Could not read note segment $0 of $1", i, binary.string());
+    }
+
+    // Each note is a header, followed by the name and the descriptor.
+    // The name and the descriptor are each padded to the alignment of the segment.
+    const uint64_t align = phdr.p_align == 8 ? 8 : 4;
+    std::string_view buf = notes;
+    while (buf.size() >= sizeof(Elf64_Nhdr)) {
+      Elf64_Nhdr nhdr;
+      std::memcpy(&nhdr, buf.data(), sizeof(nhdr));
+      buf.remove_prefix(sizeof(nhdr));
+
+      const uint64_t name_size = SnapUpToMultiple<uint64_t>(nhdr.n_namesz, align);
+      const uint64_t desc_size = SnapUpToMultiple<uint64_t>(nhdr.n_descsz, align);
+      if (buf.size() < name_size + desc_size) {
+        break;
+      }
+
+      // The name is null-terminated, and may have extra padding nulls (e.g. "Go\0\0").
+      std::string_view note_name = buf.substr(0, nhdr.n_namesz);
+      while (!note_name.empty() && note_name.back() == '\0') {
+        note_name.remove_suffix(1);
+      }
+
+      if (nhdr.n_type == type && note_name == name) {
+        return std::string(buf.substr(name_size, nhdr.n_descsz));
+      }
+      buf.remove_prefix(name_size + desc_size);
+    }
+  }
+
+  return error::NotFound("$0 has no note [name=$1 type=$2]", binary.string(), name, type);
+}
+
+// Returns a key from a hash of the whole file.
+// Uses FNV-1a, because unlike std::hash, it is stable across processes.
+StatusOr<std::string> FileHashKey(const std::filesystem::path& binary) {
+  constexpr uint64_t kFNVOffsetBasis = 14695981039346656037ULL;
+  constexpr uint64_t kFNVPrime = 1099511628211ULL;
+  constexpr size_t kReadSize = 1024 * 1024;
+
+  std::ifstream ifs(binary, std::ios::binary);
+  if (!ifs) {
+    return error::Internal("Could not open $0", binary.string());
+  }
+
+  uint64_t hash = kFNVOffsetBasis;
+  uint64_t file_size = 0;
+  std::vector<char> buf(kReadSize);
+  while (ifs) {
+    ifs.read(buf.data(), buf.size());
+    const size_t bytes_read = ifs.gcount();
+    for (size_t i = 0; i < bytes_read; ++i) {
+      hash ^= static_cast<uint8_t>(buf[i]);
+      hash *= kFNVPrime;
+    }
+    file_size += bytes_read;
+  }
+  if (ifs.bad()) {
+    return error::Internal("Could not read $0", binary.string());
+  }
+
+  return absl::StrCat("file-", file_size, "-", absl::Hex(hash, absl::kZeroPad16));
+}
+
+}  // namespace
+
+StatusOr<std::string> ReadGNUBuildID(const std::filesystem::path& binary) {
+  PL_ASSIGN_OR_RETURN(std::string desc, ReadNote(binary, "GNU", NT_GNU_BUILD_ID));
+  return BytesToString<LowercaseHex>(desc);
+}
+
+StatusOr<std::string> ReadGoBuildID(const std::filesystem::path& binary) {
+  return ReadNote(binary, "Go", kNTGoBuildID);
+}
+
+StatusOr<std::string> BinaryContentKey(const std::filesystem::path& binary) {
+  StatusOr<std::string> gnu_build_id = ReadGNUBuildID(binary);
+  if (gnu_build_id.ok()) {
+    return absl::StrCat("gnu-", gnu_build_id.ValueOrDie());
+  }
+
+  // Go build IDs contain '/', so they are hex encoded to be usable in file names.
+  StatusOr<std::string> go_build_id = ReadGoBuildID(binary);
+  if (go_build_id.ok()) {
+    return absl::StrCat("go-", BytesToString<LowercaseHex>(go_build_id.ValueOrDie()));
+  }
+
+  return FileHashKey(binary);
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * Returns a key that identifies the contents of a binary, such that copies of the same binary
+ * (e.g. the same executable in the containers of different pods) have the same key.
+ *
+ * The key is derived from the build ID of the binary, which is read from the ELF notes without
+ * loading the rest of the file. A GNU build ID is preferred, then a Go build ID. For binaries
+ * without either, the key is a hash of the whole file.
+ *
+ * The key only contains characters that are valid in file names.
+ */
+StatusOr<std::string> BinaryContentKey(const std::filesystem::path& binary);
+
+/**
+ * Returns the GNU build ID (NT_GNU_BUILD_ID note) of an ELF file, as a hex string.
+ */
+StatusOr<std::string> ReadGNUBuildID(const std::filesystem::path& binary);
+
+/**
+ * Returns the Go build ID (the note that the Go linker adds to ELF executables).
+ */
+StatusOr<std::string> ReadGoBuildID(const std::filesystem::path& binary);
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
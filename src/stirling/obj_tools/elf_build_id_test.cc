@@ -0,0 +1,68 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/obj_tools/elf_build_id.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+constexpr std::string_view kStrippedExe = "src/stirling/obj_tools/testdata/cc/stripped_test_exe";
+constexpr std::string_view kPrebuiltExe = "src/stirling/obj_tools/testdata/cc/prebuilt_test_exe";
+constexpr std::string_view kGoBinary = "src/stirling/obj_tools/testdata/go/test_go_1_16_binary";
+
+TEST(ElfBuildIDTest, GNUBuildID) {
+  const std::filesystem::path path = px::testing::TestFilePath(kStrippedExe);
+  EXPECT_OK_AND_EQ(ReadGNUBuildID(path), "7deb0e3f89deba61");
+  EXPECT_NOT_OK(ReadGoBuildID(path));
+  EXPECT_OK_AND_EQ(BinaryContentKey(path), "gnu-7deb0e3f89deba61");
+}
+
+TEST(ElfBuildIDTest, GoBuildID) {
+  const std::filesystem::path path = px::testing::TestFilePath(kGoBinary);
+  EXPECT_NOT_OK(ReadGNUBuildID(path));
+  EXPECT_OK_AND_EQ(ReadGoBuildID(path),
+                   "dFcePuw7dDYwj11OZzmq/UKfX80Tu_Wn5QhKg7-ml/yVQY8EJXhjK7ugZZAeyM/"
+                   "POf6a2Kz2v2rf5f7LoyR");
+  ASSERT_OK_AND_ASSIGN(std::string key, BinaryContentKey(path));
+  EXPECT_THAT(key, StartsWith("go-"));
+  EXPECT_THAT(key, Not(HasSubstr("/")));
+}
+
+TEST(ElfBuildIDTest, NoBuildID) {
+  const std::filesystem::path path = px::testing::TestFilePath(kPrebuiltExe);
+  EXPECT_NOT_OK(ReadGNUBuildID(path));
+  EXPECT_NOT_OK(ReadGoBuildID(path));
+
+  // Falls back to a hash of the file, which is stable across calls.
+  ASSERT_OK_AND_ASSIGN(std::string key, BinaryContentKey(path));
+  EXPECT_THAT(key, StartsWith("file-"));
+  EXPECT_OK_AND_EQ(BinaryContentKey(path), key);
+}
+
+TEST(ElfBuildIDTest, NonExistentPath) { EXPECT_NOT_OK(BinaryContentKey("/bogus")); }
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
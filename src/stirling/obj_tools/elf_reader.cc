@@ -24,6 +24,8 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <algorithm>
+#include <iterator>
 #include <set>
 #include <utility>
 
@@ -398,6 +400,46 @@ std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
   return symbol_str;
 }
 
+void ElfReader::Symbolizer::LookupBatch(
+    const std::vector<uintptr_t>& addrs,
+    const std::function<void(size_t, std::string_view)>& symbol_fn) const {
+  DCHECK(std::is_sorted(addrs.begin(), addrs.end()));
+
+  // Beyond this many symbols between consecutive addresses, searching is cheaper than stepping.
+  constexpr int kMaxSteps = 8;
+
+  std::string symbol_str;
+
+  // Invariant: iter is the first symbol for which the address_range_start > addr,
+  // i.e. what upper_bound(addr) would return. Since the addresses are sorted, it only moves
+  // forward, and nearby addresses (often in the same function) take few or no steps.
+  auto iter = symbols_.begin();
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    const uintptr_t addr = addrs[i];
+
+    int steps = 0;
+    while (iter != symbols_.end() && iter->first <= addr && steps < kMaxSteps) {
+      ++iter;
+      ++steps;
+    }
+    if (iter != symbols_.end() && iter->first <= addr) {
+      iter = symbols_.upper_bound(addr);
+    }
+
+    if (iter != symbols_.begin()) {
+      auto match = std::prev(iter);
+      if (addr < match->first + match->second.size) {
+        symbol_fn(i, match->second.name);
+        continue;
+      }
+    }
+
+    // Couldn't find the address.
+    symbol_str = absl::StrFormat("0x%016llx", addr);
+    symbol_fn(i, symbol_str);
+  }
+}
+
 namespace {
 
 /**
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <filesystem>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -129,6 +130,15 @@ class ElfReader {
      */
     std::string_view Lookup(uintptr_t addr) const;
 
+    /**
+     * Lookup the symbols for a batch of addresses, which must be sorted in ascending order.
+     * The addresses are resolved in one sweep over the symbol table, instead of a search each.
+     * The symbol for addrs[i] is passed to symbol_fn(i, symbol); the symbol is only valid
+     * for the duration of that call.
+     */
+    void LookupBatch(const std::vector<uintptr_t>& addrs,
+                     const std::function<void(size_t, std::string_view)>& symbol_fn) const;
+
    private:
     struct SymbolAddrInfo {
       size_t size;
@@ -182,6 +182,40 @@ TEST(ElfReaderTest, InstrAddrToSymbol) {
   }
 }
 
+// Tests that a batch lookup resolves the same symbols as individual lookups,
+// for addresses that are dense in some places and sparse in others.
+TEST(ElfReaderTest, SymbolizerLookupBatch) {
+  const std::string path = kTestExeFixture.Path().string();
+  const std::string kSymbolName = "CanYouFindThis";
+  ASSERT_OK_AND_ASSIGN(const int64_t symbol_addr, NmSymbolNameToAddr(path, kSymbolName));
+
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader::Symbolizer> symbolizer,
+                       elf_reader->GetSymbolizer());
+
+  std::vector<uintptr_t> addrs = {0, 1};
+  for (uintptr_t addr = symbol_addr - 4096; addr < symbol_addr + 4096; addr += 3) {
+    addrs.push_back(addr);
+  }
+  for (uintptr_t addr = symbol_addr + 4096; addr < symbol_addr + (1 << 20); addr += 4093) {
+    addrs.push_back(addr);
+  }
+  addrs.push_back(0x1234123412341234ULL);
+
+  std::vector<std::string> expected_symbols;
+  for (const uintptr_t addr : addrs) {
+    expected_symbols.emplace_back(symbolizer->Lookup(addr));
+  }
+
+  std::vector<std::string> symbols(addrs.size());
+  symbolizer->LookupBatch(addrs, [&symbols](size_t i, std::string_view symbol) {
+    symbols[i] = std::string(symbol);
+  });
+
+  EXPECT_EQ(symbols, expected_symbols);
+  EXPECT_THAT(symbols, ::testing::Contains(kSymbolName));
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
   const std::string stripped_bin =
       px::testing::TestFilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
@@ -89,17 +89,27 @@ BPF_STACK_TRACE(stack_traces_b, kNumMapEntries);
 // See comments in shared header file "stack_event.h".
 BPF_ARRAY(profiler_state, uint64_t, kProfilerStateVectorSize);
 
+// sampling_phase: counts the sampling events on each CPU, so that only one in every
+// "sampling stride" events is recorded. User space raises the stride (from its default of 1)
+// to lower the sampling rate, when the profiler needs to stay within its overhead budget.
+BPF_PERCPU_ARRAY(sampling_phase, uint64_t, 1);
+
 int sample_call_stack(struct bpf_perf_event_data* ctx) {
   int transfer_count_idx = kTransferCountIdx;
   int sample_count_a_idx = kSampleCountAIdx;
   int sample_count_b_idx = kSampleCountAIdx;
   int error_status_idx = kErrorStatusIdx;
+  int sampling_stride_idx = kSamplingStrideIdx;
+  int sampling_phase_idx = 0;
 
   uint64_t* transfer_count_ptr = profiler_state.lookup(&transfer_count_idx);
   uint64_t* sample_count_a_ptr = profiler_state.lookup(&sample_count_a_idx);
   uint64_t* sample_count_b_ptr = profiler_state.lookup(&sample_count_b_idx);
+  uint64_t* sampling_stride_ptr = profiler_state.lookup(&sampling_stride_idx);
+  uint64_t* sampling_phase_ptr = sampling_phase.lookup(&sampling_phase_idx);
 
-  if (transfer_count_ptr == NULL || sample_count_a_ptr == NULL || sample_count_b_ptr == NULL) {
+  if (transfer_count_ptr == NULL || sample_count_a_ptr == NULL || sample_count_b_ptr == NULL ||
+      sampling_stride_ptr == NULL || sampling_phase_ptr == NULL) {
     // One of the map lookups failed.
     // Set the appropriate error bit in the error bitfield:
     uint64_t rd_fail_status_code = kMapReadFailureError;
@@ -107,6 +117,16 @@ int sample_call_stack(struct bpf_perf_event_data* ctx) {
     return 0;
   }
 
+  // Skip all but one in every sampling_stride events on this CPU, before doing any of the
+  // (comparatively expensive) stack walking. A stride of 0 (unset) or 1 records every event.
+  uint64_t sampling_stride = *sampling_stride_ptr;
+  if (sampling_stride > 1) {
+    *sampling_phase_ptr += 1;
+    if (*sampling_phase_ptr % sampling_stride != 0) {
+      return 0;
+    }
+  }
+
   uint64_t transfer_count = *transfer_count_ptr;
 
   // Create map key.
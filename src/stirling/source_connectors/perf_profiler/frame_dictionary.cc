@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
+
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/perf_profiler/stringifier.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+void AppendVarint(uint64_t value, std::string* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<char>(value));
+}
+
+// Removes a varint from the front of buf and returns it.
+// Returns false if buf does not start with a complete varint.
+bool ConsumeVarint(std::string_view* buf, uint64_t* value) {
+  *value = 0;
+  for (int shift = 0; shift < 64 && !buf->empty(); shift += 7) {
+    const uint8_t byte = buf->front();
+    buf->remove_prefix(1);
+    *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+FrameDictionary::FrameID FrameDictionary::Intern(std::string_view frame) {
+  // Case 1: Frame is in the current generation.
+  const auto it = frame_ids_.find(frame);
+  if (it != frame_ids_.end()) {
+    return it->second;
+  }
+
+  // Case 2: Frame is in the previous generation. Move it to the current generation.
+  const auto it2 = prev_frame_ids_.find(frame);
+  if (it2 != prev_frame_ids_.end()) {
+    const FrameID id = it2->second;
+    frame_ids_.insert(prev_frame_ids_.extract(it2));
+    frames_[id] = prev_frames_[id];
+    prev_frames_.erase(id);
+    return id;
+  }
+
+  // Case 3: New frame.
+  const FrameID id = next_frame_id_++;
+  const auto [it3, inserted] = frame_ids_.emplace(frame, id);
+  DCHECK(inserted);
+  frames_[id] = it3->first;
+  return id;
+}
+
+void FrameDictionary::AppendFrame(std::string_view frame, std::string* encoded_stack_trace) {
+  AppendFrameID(Intern(frame), encoded_stack_trace);
+}
+
+void FrameDictionary::AppendFrameID(FrameID id, std::string* encoded_stack_trace) {
+  AppendVarint(id, encoded_stack_trace);
+}
+
+std::string_view FrameDictionary::Frame(FrameID id) const {
+  auto it = frames_.find(id);
+  if (it != frames_.end()) {
+    return it->second;
+  }
+  auto it2 = prev_frames_.find(id);
+  if (it2 != prev_frames_.end()) {
+    return it2->second;
+  }
+  DCHECK(false) << "Frame " << id << " is not in the dictionary.";
+  return "<unknown>";
+}
+
+std::string FrameDictionary::FoldedStackTraceString(std::string_view encoded_stack_trace) const {
+  std::string stack_trace_str;
+  stack_trace_str.reserve(128);
+
+  FrameID id;
+  while (ConsumeVarint(&encoded_stack_trace, &id)) {
+    stack_trace_str += Frame(id);
+    stack_trace_str += stringifier::kSeparator;
+  }
+  DCHECK(encoded_stack_trace.empty()) << "Truncated encoded stack trace.";
+
+  if (!stack_trace_str.empty()) {
+    // Remove trailing separator.
+    stack_trace_str.pop_back();
+  }
+
+  return stack_trace_str;
+}
+
+void FrameDictionary::AgeTick() {
+  prev_frame_ids_ = std::move(frame_ids_);
+  prev_frames_ = std::move(frames_);
+  frame_ids_.clear();
+  frames_.clear();
+}
+
+}  // namespace stirling
+}  // namespace px
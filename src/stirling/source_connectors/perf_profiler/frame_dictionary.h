@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/node_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+// The FrameDictionary interns the frames (symbols) of stack traces: each distinct frame string
+// is assigned an integer ID, so that a stack trace can be encoded as the sequence of the IDs of
+// its frames. An encoded stack trace is typically more than an order of magnitude smaller than
+// the folded stack trace string, and correspondingly cheaper to hash and compare; the folded
+// string is rebuilt, by FoldedStackTraceString(), only where it is output.
+//
+// The encoding is a string of LEB128 varints, one per frame, ordered like the folded string
+// (i.e. root first). Encoded stack traces can be concatenated like folded strings.
+//
+// Like the StackTraceIDCache, the dictionary ages its contents to bound its memory: a frame that
+// has not been used for a full generation (see AgeTick()) is forgotten. Frame IDs are never
+// reused, so a forgotten frame that shows up again is simply assigned a new ID.
+class FrameDictionary {
+ public:
+  using FrameID = uint64_t;
+
+  /**
+   * Returns the ID of the frame, assigning one if the frame is not in the dictionary.
+   */
+  FrameID Intern(std::string_view frame);
+
+  /**
+   * Interns the frame, and appends its encoding to encoded_stack_trace.
+   */
+  void AppendFrame(std::string_view frame, std::string* encoded_stack_trace);
+
+  /**
+   * Appends the encoding of an already interned frame to encoded_stack_trace.
+   */
+  static void AppendFrameID(FrameID id, std::string* encoded_stack_trace);
+
+  /**
+   * Rebuilds the folded stack trace string from an encoded stack trace.
+   * The frames must have been interned in the current or previous generation.
+   */
+  std::string FoldedStackTraceString(std::string_view encoded_stack_trace) const;
+
+  void AgeTick();
+
+  size_t size() const { return frame_ids_.size() + prev_frame_ids_.size(); }
+
+ private:
+  std::string_view Frame(FrameID id) const;
+
+  // The frame strings are keys of node maps, so that they have stable addresses,
+  // which are referenced by the frames_ maps; nodes move between generations as a whole.
+  absl::node_hash_map<std::string, FrameID> frame_ids_;
+  absl::node_hash_map<std::string, FrameID> prev_frame_ids_;
+  absl::flat_hash_map<FrameID, std::string_view> frames_;
+  absl::flat_hash_map<FrameID, std::string_view> prev_frames_;
+
+  FrameID next_frame_id_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
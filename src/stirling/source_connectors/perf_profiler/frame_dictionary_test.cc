@@ -0,0 +1,90 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
+
+namespace px {
+namespace stirling {
+
+TEST(FrameDictionary, EncodeAndFold) {
+  FrameDictionary frames;
+
+  std::string encoded;
+  frames.AppendFrame("main", &encoded);
+  frames.AppendFrame("foo()", &encoded);
+  frames.AppendFrame("bar()", &encoded);
+  frames.AppendFrame("foo()", &encoded);
+
+  // One byte per frame, and repeated frames are interned only once.
+  EXPECT_EQ(encoded.size(), 4);
+  EXPECT_EQ(frames.size(), 3);
+  EXPECT_EQ(frames.FoldedStackTraceString(encoded), "main;foo();bar();foo()");
+
+  // Encoded stack traces concatenate like folded strings.
+  std::string kernel_encoded;
+  frames.AppendFrame("sys_getpid_[k]", &kernel_encoded);
+  EXPECT_EQ(frames.FoldedStackTraceString(encoded + kernel_encoded),
+            "main;foo();bar();foo();sys_getpid_[k]");
+
+  EXPECT_EQ(frames.FoldedStackTraceString(""), "");
+}
+
+TEST(FrameDictionary, MultiByteFrameIDs) {
+  FrameDictionary frames;
+
+  std::string encoded;
+  std::string expected;
+  for (int i = 0; i < 1000; ++i) {
+    const std::string frame = absl::StrCat("f", i);
+    frames.AppendFrame(frame, &encoded);
+    absl::StrAppend(&expected, expected.empty() ? "" : ";", frame);
+  }
+
+  EXPECT_EQ(frames.FoldedStackTraceString(encoded), expected);
+}
+
+TEST(FrameDictionary, Aging) {
+  FrameDictionary frames;
+
+  const FrameDictionary::FrameID main_id = frames.Intern("main");
+  const FrameDictionary::FrameID foo_id = frames.Intern("foo()");
+
+  frames.AgeTick();
+
+  // Maintain IDs across one generation.
+  EXPECT_EQ(frames.Intern("main"), main_id);
+  EXPECT_EQ(frames.size(), 2);
+
+  frames.AgeTick();
+  frames.AgeTick();
+
+  // Expect new IDs if too many generations have passed since last use.
+  EXPECT_EQ(frames.size(), 0);
+  EXPECT_NE(frames.Intern("main"), main_id);
+  EXPECT_NE(frames.Intern("foo()"), foo_id);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -19,7 +19,9 @@
 #include "src/stirling/source_connectors/perf_profiler/perf_profile_connector.h"
 
 #include <sys/sysinfo.h>
+#include <time.h>
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <utility>
@@ -33,6 +35,10 @@ DEFINE_string(stirling_profiler_symbolizer, "bcc",
               "Choice of which symbolizer to use. Options: bcc, elf");
 DEFINE_bool(stirling_profiler_cache_symbols, true, "Whether to cache symbols");
 
+DEFINE_double(stirling_profiler_overhead_budget_pct, 1.0,
+              "The share of the node's CPU capacity (in percent) that the profiler aims to stay "
+              "within, by lowering its sampling rate as needed. Zero disables the adjustment.");
+
 DEFINE_uint32(stirling_perf_profiler_stats_logging_ratio,
               std::chrono::minutes(10) / px::stirling::PerfProfileConnector::kSamplingPeriod,
               "Sets the frequency of printing perf profiler stats.");
@@ -40,8 +46,20 @@ DEFINE_uint32(stirling_perf_profiler_stats_logging_ratio,
 namespace px {
 namespace stirling {
 
+namespace {
+
+std::chrono::nanoseconds ThreadCPUTime() {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+}
+
+}  // namespace
+
 PerfProfileConnector::PerfProfileConnector(std::string_view source_name)
-    : SourceConnector(source_name, kTables) {}
+    : SourceConnector(source_name, kTables),
+      sampling_rate_controller_(FLAGS_stirling_profiler_overhead_budget_pct / 100,
+                                kMaxSamplingStride) {}
 
 Status PerfProfileConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
@@ -49,6 +67,7 @@ Status PerfProfileConnector::InitImpl() {
 
   const size_t ncpus = get_nprocs_conf();
   VLOG(1) << "PerfProfiler: get_nprocs_conf(): " << ncpus;
+  ncpus_ = ncpus;
 
   const std::vector<std::string> defines = {
       absl::Substitute("-DNCPUS=$0", ncpus),
@@ -69,6 +88,7 @@ Status PerfProfileConnector::InitImpl() {
       std::make_unique<ebpf::BPFArrayTable<uint64_t>>(GetArrayTable<uint64_t>("profiler_state"));
 
   LOG(INFO) << "PerfProfiler: Stack trace profiling sampling probe successfully deployed.";
+  last_transfer_time_ = std::chrono::steady_clock::now();
 
   // Create a symbolizer for user symbols.
   if (FLAGS_stirling_profiler_symbolizer == "bcc") {
@@ -150,12 +170,23 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
   const absl::flat_hash_set<md::UPID>& upids_for_symbolization = ctx->GetUPIDs();
 
   // Create a new stringifier for this iteration of the continuous perf profiler.
-  Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), stack_traces);
+  Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), stack_traces, &frames_);
+
+  // Symbolize all the stack traces of this iteration up front, so that the addresses of
+  // each process are symbolized as one batch, rather than one at a time.
+  std::vector<stack_trace_key_t> keys_to_symbolize;
+  for (const auto& stack_trace_key : raw_histo_data_) {
+    const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
+    if (upids_for_symbolization.contains(upid)) {
+      keys_to_symbolize.push_back(stack_trace_key);
+    }
+  }
+  stringifier.SymbolizeStackTraces(keys_to_symbolize);
 
   absl::flat_hash_set<int> k_stack_ids_to_remove;
 
   for (const auto& stack_trace_key : raw_histo_data_) {
-    std::string stack_trace_str;
+    std::string encoded_stack_trace;
 
     const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
     const bool symbolize = upids_for_symbolization.contains(upid);
@@ -166,7 +197,7 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
       // the stringifier returns its memoized stack trace string. Because the stack-ids
       // are not stable across profiler iterations, we create and destroy a stringifer
       // on each profiler iteration.
-      stack_trace_str = stringifier.FoldedStackTraceString(stack_trace_key);
+      encoded_stack_trace = stringifier.EncodedStackTrace(stack_trace_key);
     } else {
       // If we do not stringifiy this stack trace, we still need to clear
       // its entry from the stack traces table. It is safe to do so immediately
@@ -179,10 +210,10 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
       if (stack_trace_key.kernel_stack_id >= 0) {
         k_stack_ids_to_remove.insert(stack_trace_key.kernel_stack_id);
       }
-      stack_trace_str = std::string(profiler::kNotSymbolizedMessage);
+      frames_.AppendFrame(profiler::kNotSymbolizedMessage, &encoded_stack_trace);
     }
 
-    SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
+    SymbolicStackTrace symbolic_stack_trace = {upid, std::move(encoded_stack_trace)};
 
     ++symbolic_histogram[symbolic_stack_trace];
     ++cum_sum_count;
@@ -213,13 +244,18 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
 }
 
 void PerfProfileConnector::CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
-                                         DataTable* data_table) {
+                                         DataTable* data_table, DataTable* strings_table) {
   constexpr size_t kMaxSymbolSize = 512;
   constexpr size_t kMaxStackDepth = 64;
   constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
 
   const uint64_t timestamp_ns = AdjustedSteadyClockNowNS();
 
+  // The stride was last updated at the end of the previous iteration, i.e. right when
+  // the samples being read out here started to be collected.
+  const int64_t sampling_stride = sampling_rate_controller_.stride();
+  const int64_t sampling_period_ms = kBPFSamplingPeriod.count() * sampling_stride;
+
   // Stack traces from kernel/BPF are ordered lists of instruction pointers (addresses).
   // AggregateStackTraces() will collapse some of those into identical symbolic stack traces;
   // for example, consider the following two stack traces from BPF:
@@ -231,20 +267,40 @@ void PerfProfileConnector::CreateRecords(ebpf::BPFStackTable* stack_traces, Conn
   constexpr auto age_tick_period = std::chrono::minutes(5);
   if (sampling_freq_mgr_.count() % (age_tick_period / kSamplingPeriod) == 0) {
     stack_trace_ids_.AgeTick();
+    frames_.AgeTick();
   }
 
   for (const auto& [key, count] : stack_trace_histogram) {
-    DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
+    bool new_in_generation = false;
+    const uint64_t stack_trace_id = stack_trace_ids_.Lookup(key, &new_in_generation);
+
+    {
+      DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
+
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(key.upid.value());
+      r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+      r.Append<r.ColIndex("count")>(count);
+      r.Append<r.ColIndex("sampling_period_ms")>(sampling_period_ms);
+      r.Append<r.ColIndex("sampling_stride")>(sampling_stride);
+    }
+
+    // The folded string is only materialized when the ID is (re-)introduced;
+    // see kStackTraceStringsTable.
+    if (new_in_generation && strings_table != nullptr) {
+      DataTable::RecordBuilder<&kStackTraceStringsTable> r(strings_table, timestamp_ns);
 
-    r.Append<r.ColIndex("time_")>(timestamp_ns);
-    r.Append<r.ColIndex("upid")>(key.upid.value());
-    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
-    r.Append<r.ColIndex("stack_trace"), kMaxStackTraceSize>(key.stack_trace_str);
-    r.Append<r.ColIndex("count")>(count);
+      r.Append<r.ColIndex("time_")>(timestamp_ns);
+      r.Append<r.ColIndex("upid")>(key.upid.value());
+      r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+      r.Append<r.ColIndex("stack_trace"), kMaxStackTraceSize>(
+          frames_.FoldedStackTraceString(key.encoded_stack_trace));
+    }
   }
 }
 
-void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table) {
+void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                                                 DataTable* strings_table) {
   // Choose the maps to consume.
   const bool using_map_set_a = transfer_count_ % 2 == 0;
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
@@ -263,28 +319,53 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   LOG_IF(ERROR, !s.ok()) << "Error writing transfer_count_";
 
   // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  CreateRecords(stack_traces.get(), ctx, data_table, strings_table);
 
   // Now that we've consumed the data, reset the sample count in BPF.
   profiler_state_->update_value(sample_count_idx, 0);
 }
 
+void PerfProfileConnector::UpdateSamplingRate(std::chrono::nanoseconds cpu_time) {
+  const auto now = std::chrono::steady_clock::now();
+  const auto cpu_capacity = (now - last_transfer_time_) * ncpus_;
+  last_transfer_time_ = now;
+
+  const uint32_t prev_stride = sampling_rate_controller_.stride();
+  const uint32_t stride = sampling_rate_controller_.Update(cpu_time, cpu_capacity);
+  if (stride == prev_stride) {
+    return;
+  }
+
+  LOG(INFO) << absl::Substitute(
+      "PerfProfiler: Overhead was $0% of CPU capacity (budget: $1%). "
+      "Sampling period is now $2 ms.",
+      100 * sampling_rate_controller_.overhead(), FLAGS_stirling_profiler_overhead_budget_pct,
+      kBPFSamplingPeriod.count() * stride);
+  const ebpf::StatusTuple s = profiler_state_->update_value(kSamplingStrideIdx, stride);
+  LOG_IF(ERROR, !s.ok()) << "Error writing sampling stride";
+}
+
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx,
                                             const std::vector<DataTable*>& data_tables) {
-  DCHECK_EQ(data_tables.size(), 1);
+  DCHECK_EQ(data_tables.size(), kTables.size());
 
-  auto* data_table = data_tables[0];
+  auto* data_table = data_tables[kPerfProfileTableNum];
+  auto* strings_table = data_tables[kStackTraceStringsTableNum];
 
   if (data_table == nullptr) {
     return;
   }
 
-  ProcessBPFStackTraces(ctx, data_table);
+  const std::chrono::nanoseconds cpu_time_start = ThreadCPUTime();
+
+  ProcessBPFStackTraces(ctx, data_table, strings_table);
 
   // Cleanup the symbolizer so we don't leak memory.
   proc_tracker_.Update(ctx->GetUPIDs());
   CleanupSymbolizers(proc_tracker_.deleted_upids());
 
+  UpdateSamplingRate(ThreadCPUTime() - cpu_time_start);
+
   stats_.Increment(StatKey::kBPFMapSwitchoverEvent, 1);
 
   if (sampling_freq_mgr_.count() % FLAGS_stirling_perf_profiler_stats_logging_ratio == 0) {
@@ -29,6 +29,8 @@
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/types.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
+#include "src/stirling/source_connectors/perf_profiler/sampling_rate_controller.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_trace_id_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_traces_table.h"
 #include "src/stirling/source_connectors/perf_profiler/stringifier.h"
@@ -46,8 +48,10 @@ static constexpr std::string_view kNotSymbolizedMessage = "<not symbolized>";
 class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrapper {
  public:
   static constexpr std::string_view kName = "perf_profiler";
-  static constexpr auto kTables = MakeArray(kStackTraceTable);
+  static constexpr auto kTables = MakeArray(kStackTraceTable, kStackTraceStringsTable);
   static constexpr uint32_t kPerfProfileTableNum = TableNum(kTables, kStackTraceTable);
+  static constexpr uint32_t kStackTraceStringsTableNum =
+      TableNum(kTables, kStackTraceStringsTable);
 
   // kBPFSamplingPeriod: the time interval in between stack trace samples.
   static constexpr auto kBPFSamplingPeriod = std::chrono::milliseconds{11};
@@ -58,6 +62,10 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   static constexpr auto kSamplingPeriod = std::chrono::milliseconds{30000};
   static constexpr auto kPushPeriod = std::chrono::milliseconds{15000};
 
+  // To stay within its overhead budget, the profiler may record only one in every so many
+  // BPF sampling events (see SamplingRateController); this bounds how many.
+  static constexpr uint32_t kMaxSamplingStride = 16;
+
   static std::unique_ptr<SourceConnector> Create(std::string_view name) {
     return std::unique_ptr<SourceConnector>(new PerfProfileConnector(name));
   }
@@ -75,16 +83,22 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   explicit PerfProfileConnector(std::string_view source_name);
 
-  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
+  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table,
+                             DataTable* strings_table);
 
-  // Read BPF data structures, build & incorporate records to the table.
+  // Read BPF data structures, build & incorporate records to the tables.
+  // strings_table may be null, if it is not subscribed to.
   void CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+                     DataTable* data_table, DataTable* strings_table);
 
   StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces);
 
   void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
+  // Accounts for the CPU time of the last iteration, and adjusts the sampling rate in BPF
+  // if the profiler is over (or well under) its overhead budget.
+  void UpdateSamplingRate(std::chrono::nanoseconds cpu_time);
+
   // data structures shared with BPF:
   std::unique_ptr<ebpf::BPFStackTable> stack_traces_a_;
   std::unique_ptr<ebpf::BPFStackTable> stack_traces_b_;
@@ -97,6 +111,10 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Tracks unique stack trace ids, for the lifetime of Stirling:
   StackTraceIDCache stack_trace_ids_;
 
+  // Interns the frames of the stack traces, which are held encoded, across iterations;
+  // aged along with stack_trace_ids_.
+  FrameDictionary frames_;
+
   // The raw histogram from BPF; it is populated on each iteration by a call to PollPerfBuffer().
   RawHistoData raw_histo_data_;
 
@@ -104,6 +122,12 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   std::unique_ptr<Symbolizer> k_symbolizer_;
   std::unique_ptr<Symbolizer> u_symbolizer_;
 
+  // Keeps the CPU time spent by the profiler within FLAGS_stirling_profiler_overhead_budget_pct
+  // of the node's CPU capacity.
+  SamplingRateController sampling_rate_controller_;
+  std::chrono::steady_clock::time_point last_transfer_time_;
+  size_t ncpus_ = 0;
+
   // Keeps track of processes. Used to find destroyed processes on which to perform clean-up.
   // TODO(oazizi): Investigate ways of sharing across source_connectors.
   ProcTracker proc_tracker_;
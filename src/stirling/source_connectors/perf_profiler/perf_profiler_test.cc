@@ -56,7 +56,9 @@ class CPUPinnedBinaryRunner {
 
 class PerfProfileBPFTest : public ::testing::Test {
  public:
-  PerfProfileBPFTest() : data_table_(/*id*/ 0, kStackTraceTable) {}
+  PerfProfileBPFTest()
+      : data_table_(/*id*/ 0, kStackTraceTable),
+        strings_table_(/*id*/ 1, kStackTraceStringsTable) {}
 
  protected:
   void SetUp() override {
@@ -113,7 +115,9 @@ class PerfProfileBPFTest : public ::testing::Test {
     for (const auto row_idx : target_row_idxs) {
       // Build the histogram of observed stack traces here:
       // Also, track the cumulative sum (or total number of samples).
-      const std::string stack_trace_str = stack_traces_column_->Get<types::StringValue>(row_idx);
+      const int64_t stack_trace_id = trace_ids_column_->Get<types::Int64Value>(row_idx).val;
+      ASSERT_TRUE(stack_trace_strs_.contains(stack_trace_id)) << stack_trace_id;
+      const std::string& stack_trace_str = stack_trace_strs_[stack_trace_id];
       const int64_t count = counts_column_->Get<types::Int64Value>(row_idx).val;
       observed_stack_traces_[stack_trace_str] += count;
     }
@@ -200,11 +204,21 @@ class PerfProfileBPFTest : public ::testing::Test {
     columns_ = tablets[0].records;
 
     PopulateColumnPtrs(columns_);
+
+    // Every stack trace ID is introduced, with its string, in the strings table.
+    const std::vector<TaggedRecordBatch> strings_tablets = strings_table_.ConsumeRecords();
+    ASSERT_EQ(strings_tablets.size(), 1);
+    const types::ColumnWrapperRecordBatch& strings_columns = strings_tablets[0].records;
+    for (size_t i = 0; i < strings_columns[kStackTraceStringsStackTraceIDIdx]->Size(); ++i) {
+      const int64_t stack_trace_id =
+          strings_columns[kStackTraceStringsStackTraceIDIdx]->Get<types::Int64Value>(i).val;
+      stack_trace_strs_[stack_trace_id] =
+          strings_columns[kStackTraceStringsStackTraceStrIdx]->Get<types::StringValue>(i);
+    }
   }
 
   void PopulateColumnPtrs(const types::ColumnWrapperRecordBatch& columns) {
     trace_ids_column_ = columns[kStackTraceStackTraceIDIdx];
-    stack_traces_column_ = columns[kStackTraceStackTraceStrIdx];
     counts_column_ = columns[kStackTraceCountIdx];
     column_ptrs_populated_ = true;
   }
@@ -230,15 +244,16 @@ class PerfProfileBPFTest : public ::testing::Test {
   std::unique_ptr<SourceConnector> source_;
   std::unique_ptr<StandaloneContext> ctx_;
   DataTable data_table_;
-  const std::vector<DataTable*> data_tables_{&data_table_};
+  DataTable strings_table_;
+  const std::vector<DataTable*> data_tables_{&data_table_, &strings_table_};
 
   bool column_ptrs_populated_ = false;
   std::shared_ptr<types::ColumnWrapper> trace_ids_column_;
-  std::shared_ptr<types::ColumnWrapper> stack_traces_column_;
   std::shared_ptr<types::ColumnWrapper> counts_column_;
 
   uint64_t cumulative_sum_ = 0;
   absl::flat_hash_map<std::string, uint64_t> observed_stack_traces_;
+  absl::flat_hash_map<int64_t, std::string> stack_trace_strs_;
 
   types::ColumnWrapperRecordBatch columns_;
 
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/perf_profiler/sampling_rate_controller.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace px {
+namespace stirling {
+
+uint32_t SamplingRateController::Update(std::chrono::nanoseconds cpu_time,
+                                        std::chrono::nanoseconds cpu_capacity) {
+  if (budget_ <= 0 || cpu_capacity.count() <= 0) {
+    return stride_;
+  }
+
+  overhead_ = static_cast<double>(cpu_time.count()) / static_cast<double>(cpu_capacity.count());
+
+  // The stride at which the overhead would have been on target.
+  const double target = kTargetFractionOfBudget * budget_;
+  const double ideal_stride = stride_ * overhead_ / target;
+
+  if (ideal_stride > stride_) {
+    stride_ = static_cast<uint32_t>(std::min<double>(std::ceil(ideal_stride), max_stride_));
+  } else if (2 * ideal_stride <= stride_) {
+    stride_ = std::max<uint32_t>(
+        {1, stride_ / 2, static_cast<uint32_t>(std::ceil(ideal_stride))});
+  }
+
+  return stride_;
+}
+
+}  // namespace stirling
+}  // namespace px
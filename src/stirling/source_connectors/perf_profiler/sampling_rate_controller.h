@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+namespace px {
+namespace stirling {
+
+// The SamplingRateController keeps the CPU overhead of the profiler within a budget, by
+// adjusting the sampling stride: the number of BPF sampling events per sample that is recorded.
+//
+// The cost of the profiler (reading out and symbolizing the stack traces, mostly) grows with
+// the number of samples, so it is modeled as inversely proportional to the stride. On each
+// iteration, the controller is given the CPU time that the profiler spent, and derives the
+// stride at which that time would have been on target (a margin below the budget):
+// * If the stride has to grow, it does so right away.
+// * If the stride could shrink by half or more, it is halved, and the profiler then waits
+//   for the effect before shrinking it further. This avoids oscillating around the target.
+class SamplingRateController {
+ public:
+  // The target is this fraction of the budget, to leave room for variation between iterations.
+  static constexpr double kTargetFractionOfBudget = 0.8;
+
+  /**
+   * @param budget The CPU time that the profiler may use, as a fraction of the CPU capacity
+   *               (elapsed time times the number of CPUs). Zero disables the controller.
+   * @param max_stride The stride is not raised above this, to keep a minimum sampling rate.
+   */
+  SamplingRateController(double budget, uint32_t max_stride)
+      : budget_(budget), max_stride_(max_stride) {}
+
+  /**
+   * Accounts for the CPU time that the profiler spent over one iteration, out of the given CPU
+   * capacity, and returns the sampling stride for the next iteration.
+   */
+  uint32_t Update(std::chrono::nanoseconds cpu_time, std::chrono::nanoseconds cpu_capacity);
+
+  uint32_t stride() const { return stride_; }
+
+  // The overhead (CPU time over CPU capacity) measured on the last Update().
+  double overhead() const { return overhead_; }
+
+ private:
+  const double budget_;
+  const uint32_t max_stride_;
+
+  uint32_t stride_ = 1;
+  double overhead_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
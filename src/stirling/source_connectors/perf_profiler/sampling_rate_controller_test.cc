@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "src/stirling/source_connectors/perf_profiler/sampling_rate_controller.h"
+
+namespace px {
+namespace stirling {
+
+using std::chrono::milliseconds;
+using std::chrono::seconds;
+
+// 10 seconds on 10 CPUs, which makes a 1% budget 1 second of CPU time.
+constexpr auto kCapacity = seconds(100);
+constexpr double kBudget = 0.01;
+constexpr uint32_t kMaxStride = 16;
+
+TEST(SamplingRateControllerTest, StaysPutWithinBudget) {
+  SamplingRateController controller(kBudget, kMaxStride);
+
+  EXPECT_EQ(controller.Update(milliseconds(100), kCapacity), 1);
+  EXPECT_EQ(controller.Update(milliseconds(790), kCapacity), 1);
+  EXPECT_DOUBLE_EQ(controller.overhead(), 0.0079);
+}
+
+TEST(SamplingRateControllerTest, BacksOffWhenOverBudget) {
+  SamplingRateController controller(kBudget, kMaxStride);
+
+  // 2.4s is three times the 0.8s target.
+  EXPECT_EQ(controller.Update(milliseconds(2400), kCapacity), 3);
+
+  // With a third of the samples, the cost is on target.
+  EXPECT_EQ(controller.Update(milliseconds(800), kCapacity), 3);
+
+  // Slightly over target rounds up.
+  EXPECT_EQ(controller.Update(milliseconds(900), kCapacity), 4);
+
+  // The stride is capped.
+  EXPECT_EQ(controller.Update(seconds(50), kCapacity), kMaxStride);
+}
+
+TEST(SamplingRateControllerTest, RecoversGradually) {
+  SamplingRateController controller(kBudget, kMaxStride);
+
+  ASSERT_EQ(controller.Update(milliseconds(6400), kCapacity), 8);
+
+  // The load went away; the stride is halved on each iteration, rather than reset at once.
+  EXPECT_EQ(controller.Update(milliseconds(10), kCapacity), 4);
+  EXPECT_EQ(controller.Update(milliseconds(10), kCapacity), 2);
+  EXPECT_EQ(controller.Update(milliseconds(10), kCapacity), 1);
+  EXPECT_EQ(controller.Update(milliseconds(10), kCapacity), 1);
+}
+
+TEST(SamplingRateControllerTest, HoldsWithinDeadband) {
+  SamplingRateController controller(kBudget, kMaxStride);
+
+  ASSERT_EQ(controller.Update(milliseconds(3200), kCapacity), 4);
+
+  // 0.5s at stride 4 would be on target at stride 2.5, which is not room enough to halve the
+  // stride, so it holds. At 0.4s, it is.
+  EXPECT_EQ(controller.Update(milliseconds(500), kCapacity), 4);
+  EXPECT_EQ(controller.Update(milliseconds(400), kCapacity), 2);
+}
+
+TEST(SamplingRateControllerTest, Disabled) {
+  SamplingRateController controller(0, kMaxStride);
+
+  EXPECT_EQ(controller.Update(seconds(50), kCapacity), 1);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -23,11 +23,19 @@
 namespace px {
 namespace stirling {
 
-uint64_t StackTraceIDCache::Lookup(const SymbolicStackTrace& stack_trace) {
+uint64_t StackTraceIDCache::Lookup(const SymbolicStackTrace& stack_trace,
+                                   bool* new_in_generation) {
+  if (new_in_generation != nullptr) {
+    *new_in_generation = true;
+  }
+
   // Case 1: Stack trace ID is in the current set. Just return it.
   const auto it = stack_trace_ids_.find(stack_trace);
   if (it != stack_trace_ids_.end()) {
     const uint64_t stack_trace_id = it->second;
+    if (new_in_generation != nullptr) {
+      *new_in_generation = false;
+    }
     return stack_trace_id;
   }
 
@@ -46,7 +46,10 @@ namespace stirling {
 // the UI will aggregate the identical stack traces for us in the visualization.
 class StackTraceIDCache {
  public:
-  uint64_t Lookup(const SymbolicStackTrace& stack_trace);
+  // Returns the ID of the stack trace. If new_in_generation is not null, it is set to whether this
+  // is the first lookup of the stack trace since the last AgeTick(), in which case the ID is
+  // either new, or new to the current generation.
+  uint64_t Lookup(const SymbolicStackTrace& stack_trace, bool* new_in_generation = nullptr);
   void AgeTick();
 
  private:
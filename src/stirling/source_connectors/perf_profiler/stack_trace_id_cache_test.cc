@@ -51,5 +51,28 @@ TEST(StackTraceIDCache, Basic) {
   EXPECT_NE(stack_trace_ids.Lookup(kStackTrace2), id2);
 }
 
+TEST(StackTraceIDCache, NewInGeneration) {
+  StackTraceIDCache stack_trace_ids;
+
+  const md::UPID kUPID(1, 1, 1);
+  const SymbolicStackTrace kStackTrace{kUPID, "a();b();c();"};
+
+  bool new_in_generation = false;
+  uint64_t id = stack_trace_ids.Lookup(kStackTrace, &new_in_generation);
+  EXPECT_TRUE(new_in_generation);
+
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace, &new_in_generation), id);
+  EXPECT_FALSE(new_in_generation);
+
+  stack_trace_ids.AgeTick();
+
+  // Same ID, but the ID is new to this generation.
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace, &new_in_generation), id);
+  EXPECT_TRUE(new_in_generation);
+
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace, &new_in_generation), id);
+  EXPECT_FALSE(new_in_generation);
+}
+
 }  // namespace stirling
 }  // namespace px
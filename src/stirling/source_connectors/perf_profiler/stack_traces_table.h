@@ -32,32 +32,67 @@ static constexpr DataElement kElements[] = {
     canonical_data_elements::kUPID,
     {"stack_trace_id",
      "A unique identifier of the stack trace, for script-writing convenience. "
-     "String representation is in the `stack_trace` column.",
+     "String representation is in the `stack_trace` column of stack_trace_strings.beta.",
      types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
-    {"stack_trace",
-     "A stack trace within the sampled process, in folded format. "
-     "The call stack symbols are separated by semicolons. "
-     "If symbols cannot be resolved, addresses are populated instead.",
-     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
      "Number of times the stack trace has been sampled.",
-     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE}
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::METRIC_GAUGE},
+    {"sampling_period_ms",
+     "The sampling period in effect when the stack trace was sampled. The profiler lengthens "
+     "the period from its base period to stay within its CPU overhead budget.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"sampling_stride",
+     "The number of base sampling periods that each sample stands for, i.e. sampling_period_ms "
+     "over the base period. Multiply count by it when aggregating counts from different nodes "
+     "or times.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL}
 };
 
 constexpr auto kStackTraceTable = DataTableSchema(
         "stack_traces.beta",
         "Sampled stack traces of applications that identify hot-spots in application code. "
-        "Executable symbols are required for human-readable function names to be displayed.",
+        "The stack traces are identified by ID; join with stack_trace_strings.beta "
+        "on upid and stack_trace_id for their symbols.",
         kElements
 );
+
+// The folded stack trace strings are kept out of stack_traces.beta, which would otherwise hold
+// the same long strings over and over, once per sampling period. A string is recorded when its
+// ID is assigned, and again in each generation of the stack trace ID cache in which it is used,
+// i.e. at least every few minutes while the stack trace keeps being sampled.
+static constexpr DataElement kStringsElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"stack_trace_id",
+     "A unique identifier of the stack trace; matches stack_trace_id of stack_traces.beta.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"stack_trace",
+     "A stack trace within the sampled process, in folded format. "
+     "The call stack symbols are separated by semicolons. "
+     "If symbols cannot be resolved, addresses are populated instead.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackTraceStringsTable = DataTableSchema(
+        "stack_trace_strings.beta",
+        "The folded stack trace strings of the stack trace IDs in stack_traces.beta.",
+        kStringsElements
+);
 // clang-format on
 DEFINE_PRINT_TABLE(StackTrace)
+DEFINE_PRINT_TABLE(StackTraceStrings)
 
 constexpr int kStackTraceTimeIdx = kStackTraceTable.ColIndex("time_");
 constexpr int kStackTraceUPIDIdx = kStackTraceTable.ColIndex("upid");
 constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trace_id");
-constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
+constexpr int kStackTraceSamplingPeriodIdx = kStackTraceTable.ColIndex("sampling_period_ms");
+constexpr int kStackTraceSamplingStrideIdx = kStackTraceTable.ColIndex("sampling_stride");
+
+constexpr int kStackTraceStringsUPIDIdx = kStackTraceStringsTable.ColIndex("upid");
+constexpr int kStackTraceStringsStackTraceIDIdx =
+    kStackTraceStringsTable.ColIndex("stack_trace_id");
+constexpr int kStackTraceStringsStackTraceStrIdx = kStackTraceStringsTable.ColIndex("stack_trace");
 
 }  // namespace stirling
 }  // namespace px
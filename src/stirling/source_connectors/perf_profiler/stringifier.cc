@@ -19,28 +19,112 @@
 #include "src/stirling/source_connectors/perf_profiler/stringifier.h"
 #include <stdint.h>
 
+#include <algorithm>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 namespace px {
 namespace stirling {
 
 Stringifier::Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
-                         ebpf::BPFStackTable* stack_traces)
-    : u_symbolizer_(u_symbolizer), k_symbolizer_(k_symbolizer), stack_traces_(stack_traces) {}
+                         ebpf::BPFStackTable* stack_traces, FrameDictionary* frames)
+    : u_symbolizer_(u_symbolizer),
+      k_symbolizer_(k_symbolizer),
+      stack_traces_(stack_traces),
+      frames_(frames) {}
+
+const std::vector<uintptr_t>& Stringifier::ReadStackAddrs(const int stack_id) {
+  auto [iter, inserted] = stack_addrs_.try_emplace(stack_id);
+  if (inserted) {
+    // Clear the stack-traces map as we go along here; this has lower overhead
+    // compared to first reading the stack-traces map, then using clear_table_non_atomic().
+    constexpr bool kClearStackId = true;
+
+    // Get the stack trace (as a vector of addresses) from the shared BPF stack trace table.
+    iter->second = stack_traces_->get_stack_addr(stack_id, kClearStackId);
+    VLOG_IF(1, iter->second.empty())
+        << absl::Substitute("[empty_stack_trace] stack_id: $0", stack_id);
+  }
+  return iter->second;
+}
 
-std::string Stringifier::BuildStackTraceString(const std::vector<uintptr_t>& addrs,
-                                               SymbolizerFn symbolize_fn,
-                                               const std::string_view& suffix) {
-  // TODO(jps): re-evaluate the correct amount to reserve here.
-  std::string stack_trace_str;
-  stack_trace_str.reserve(128);
+void Stringifier::SymbolizeBatch(Symbolizer* symbolizer, const struct upid_t& upid,
+                                 const std::string_view& suffix, std::vector<uintptr_t>* addrs) {
+  std::sort(addrs->begin(), addrs->end());
+  addrs->erase(std::unique(addrs->begin(), addrs->end()), addrs->end());
+  if (addrs->empty()) {
+    return;
+  }
+
+  auto& upid_frame_ids = frame_ids_[upid];
+  upid_frame_ids.reserve(upid_frame_ids.size() + addrs->size());
+
+  std::string frame;
+  symbolizer->SymbolizeBatch(upid, *addrs, [&](size_t i, std::string_view symbol) {
+    FrameDictionary::FrameID id;
+    if (suffix.empty()) {
+      id = frames_->Intern(symbol);
+    } else {
+      frame.assign(symbol);
+      frame += suffix;
+      id = frames_->Intern(frame);
+    }
+    upid_frame_ids.try_emplace((*addrs)[i], id);
+  });
+}
+
+void Stringifier::SymbolizeStackTraces(const std::vector<stack_trace_key_t>& keys) {
+  using stringifier::kKernSuffix;
+  using stringifier::kUserSuffix;
+
+  // Gather the addresses to symbolize: per process for user stacks, and all together
+  // for kernel stacks. Kernel stack-ids are commonly shared by many keys, so each is added once.
+  absl::flat_hash_map<struct upid_t, std::vector<uintptr_t>> u_addrs;
+  std::vector<uintptr_t> k_addrs;
+  absl::flat_hash_set<int> k_stack_ids;
+
+  for (const auto& key : keys) {
+    if (key.user_stack_id >= 0) {
+      const std::vector<uintptr_t>& addrs = ReadStackAddrs(key.user_stack_id);
+      std::vector<uintptr_t>& upid_addrs = u_addrs[key.upid];
+      upid_addrs.insert(upid_addrs.end(), addrs.begin(), addrs.end());
+    }
+    if (key.kernel_stack_id >= 0 && k_stack_ids.insert(key.kernel_stack_id).second) {
+      const std::vector<uintptr_t>& addrs = ReadStackAddrs(key.kernel_stack_id);
+      k_addrs.insert(k_addrs.end(), addrs.begin(), addrs.end());
+    }
+  }
+
+  for (auto& [upid, addrs] : u_addrs) {
+    SymbolizeBatch(u_symbolizer_, upid, kUserSuffix, &addrs);
+  }
+  SymbolizeBatch(k_symbolizer_, profiler::kKernelUPID, kKernSuffix, &k_addrs);
+}
+
+std::string Stringifier::BuildEncodedStackTrace(const std::vector<uintptr_t>& addrs,
+                                                const struct upid_t& upid,
+                                                Symbolizer* symbolizer,
+                                                const std::string_view& suffix) {
+  // Frame IDs mostly fit in one or two bytes.
+  std::string encoded_stack_trace;
+  encoded_stack_trace.reserve(2 * addrs.size());
+  std::string frame;
+
+  // The frames of the addresses that were symbolized up front, if any.
+  const auto frame_ids_iter = frame_ids_.find(upid);
+  const auto* upid_frame_ids = frame_ids_iter != frame_ids_.end() ? &frame_ids_iter->second
+                                                                   : nullptr;
+
+  // Only created if some address was not symbolized up front.
+  SymbolizerFn symbolize_fn;
 
   // Some stack-traces have the address 0xcccccccccccccccc where one might
   // otherwise expect to find "main" or "start_thread". Given that this address
   // is not a "real" address, we filter it out below.
   constexpr uint64_t kSentinelAddr = 0xcccccccccccccccc;
 
-  // Build the folded stack trace string.
+  // Build the encoded folded stack trace.
   for (auto iter = addrs.rbegin(); iter != addrs.rend(); ++iter) {
     const auto& addr = *iter;
     if (addr == kSentinelAddr && iter == addrs.rbegin()) {
@@ -48,39 +132,42 @@ std::string Stringifier::BuildStackTraceString(const std::vector<uintptr_t>& add
       // Sentinel values can occur in other spots (though it's rare); leave those ones in.
       continue;
     }
-    stack_trace_str += symbolize_fn(addr);
-    stack_trace_str += suffix;
-    stack_trace_str += stringifier::kSeparator;
-  }
-
-  if (!stack_trace_str.empty()) {
-    // Remove trailing separator.
-    stack_trace_str.pop_back();
+    if (upid_frame_ids != nullptr) {
+      const auto frame_id_iter = upid_frame_ids->find(addr);
+      if (frame_id_iter != upid_frame_ids->end()) {
+        FrameDictionary::AppendFrameID(frame_id_iter->second, &encoded_stack_trace);
+        continue;
+      }
+    }
+    if (symbolize_fn == nullptr) {
+      symbolize_fn = symbolizer->GetSymbolizerFn(upid);
+    }
+    if (suffix.empty()) {
+      frames_->AppendFrame(symbolize_fn(addr), &encoded_stack_trace);
+    } else {
+      frame.assign(symbolize_fn(addr));
+      frame += suffix;
+      frames_->AppendFrame(frame, &encoded_stack_trace);
+    }
   }
 
-  return stack_trace_str;
+  return encoded_stack_trace;
 }
 
-std::string Stringifier::FindOrBuildStackTraceString(const int stack_id, SymbolizerFn symbolize_fn,
-                                                     const std::string_view& suffix) {
-  // First try to find the memoized result in the stack_trace_strs_ map,
-  // if no memoized result is available, build the folded stack trace string.
-  auto [iter, inserted] = stack_trace_strs_.try_emplace(stack_id, "");
+std::string Stringifier::FindOrBuildEncodedStackTrace(const int stack_id,
+                                                      const struct upid_t& upid,
+                                                      Symbolizer* symbolizer,
+                                                      const std::string_view& suffix) {
+  // First try to find the memoized result in the encoded_stack_traces_ map,
+  // if no memoized result is available, build the encoded folded stack trace.
+  auto [iter, inserted] = encoded_stack_traces_.try_emplace(stack_id, "");
   if (inserted) {
-    // Clear the stack-traces map as we go along here; this has lower overhead
-    // compared to first reading the stack-traces map, then using clear_table_non_atomic().
-    constexpr bool kClearStackId = true;
-
-    // Get the stack trace (as a vector of addresses) from the shared BPF stack trace table.
-    const std::vector<uintptr_t> addrs = stack_traces_->get_stack_addr(stack_id, kClearStackId);
-    VLOG_IF(1, addrs.empty()) << absl::Substitute("[empty_stack_trace] stack_id: $0", stack_id);
-
-    iter->second = BuildStackTraceString(addrs, symbolize_fn, suffix);
+    iter->second = BuildEncodedStackTrace(ReadStackAddrs(stack_id), upid, symbolizer, suffix);
   }
   return iter->second;
 }
 
-std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
+std::string Stringifier::EncodedStackTrace(const stack_trace_key_t& key) {
   using stringifier::kKernSuffix;
   using stringifier::kUserSuffix;
 
@@ -90,32 +177,28 @@ std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
   const struct upid_t& u_upid = key.upid;
   const struct upid_t& k_upid = profiler::kKernelUPID;
 
-  auto u_symbolizer_fn = u_symbolizer_->GetSymbolizerFn(u_upid);
-  auto k_symbolizer_fn = k_symbolizer_->GetSymbolizerFn(k_upid);
-
   // Using bind because it helps the reduce redundant information in the if/else chain below.
   // Also, it is easier to read, e.g.:
-  // stack_trace_str = u_stack_str_fn() + ";" + k_stack_str_fn();
-  auto fn_addr = &Stringifier::FindOrBuildStackTraceString;
-  auto u_stack_str_fn = std::bind(fn_addr, this, u_stack_id, u_symbolizer_fn, kUserSuffix);
-  auto k_stack_str_fn = std::bind(fn_addr, this, k_stack_id, k_symbolizer_fn, kKernSuffix);
+  // encoded_stack_trace = u_stack_str_fn() + k_stack_str_fn();
+  auto fn_addr = &Stringifier::FindOrBuildEncodedStackTrace;
+  auto u_stack_str_fn = std::bind(fn_addr, this, u_stack_id, u_upid, u_symbolizer_, kUserSuffix);
+  auto k_stack_str_fn = std::bind(fn_addr, this, k_stack_id, k_upid, k_symbolizer_, kKernSuffix);
 
-  std::string stack_trace_str;
-  stack_trace_str.reserve(128);
+  std::string encoded_stack_trace;
 
   // TODO(jps/oazizi): question... should we use the "drop message" for -EEXIST,
   // if only one of two stack-ids indicates a hash table collision?
   // vs. the current logic which shows the "drop message" only if both stack-ids are -EEXIST.
 
   if (u_stack_id >= 0 && k_stack_id >= 0) {
-    stack_trace_str = u_stack_str_fn();
-    stack_trace_str += stringifier::kSeparator;
-    stack_trace_str += k_stack_str_fn();
+    // Encoded stack traces are concatenated without a separator.
+    encoded_stack_trace = u_stack_str_fn();
+    encoded_stack_trace += k_stack_str_fn();
   } else if (u_stack_id >= 0) {
-    stack_trace_str = u_stack_str_fn();
+    encoded_stack_trace = u_stack_str_fn();
     DCHECK(k_stack_id == -EEXIST || k_stack_id == -EFAULT) << "ustack_id: " << u_stack_id;
   } else if (k_stack_id >= 0) {
-    stack_trace_str = k_stack_str_fn();
+    encoded_stack_trace = k_stack_str_fn();
     DCHECK(u_stack_id == -EEXIST || u_stack_id == -EFAULT) << "kstack_id: " << k_stack_id;
   } else {
     // The kernel can indicate "not valid" for a stack-id in two different ways:
@@ -124,13 +207,13 @@ std::string Stringifier::FoldedStackTraceString(const stack_trace_key_t& key) {
     // 2. -EEXIST: hash bucket collision in the stack traces table
     // We can reach this branch if one, or both, of the stack-ids had a hash table collision,
     // but we should not get here with both stack-ids set to "invalid" i.e. -EFAULT.
-    stack_trace_str = stringifier::kDropMessage;
+    frames_->AppendFrame(stringifier::kDropMessage, &encoded_stack_trace);
     DCHECK(u_stack_id == -EEXIST || u_stack_id == -EFAULT) << "u_stack_id: " << u_stack_id;
     DCHECK(k_stack_id == -EEXIST || k_stack_id == -EFAULT) << "k_stack_id: " << k_stack_id;
     DCHECK(!(k_stack_id == -EFAULT && u_stack_id == -EFAULT)) << "both invalid.";
   }
 
-  return stack_trace_str;
+  return encoded_stack_trace;
 }
 
 }  // namespace stirling
@@ -23,6 +23,7 @@
 
 #include "src/stirling/bpf_tools/bcc_bpf_intf/upid.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizer.h"
 
 namespace px {
@@ -43,9 +44,12 @@ static constexpr std::string_view kDropMessage = "<stack trace lost>";
 }  // namespace stringifier
 
 // Stringifier serves two purposes:
-// 1. constructs a "folded stack trace string" based on the stack frame addresses.
+// 1. constructs a "folded stack trace" based on the stack frame addresses.
 // 2. memoizes previous results of (1) above in case a "stack-id" is reused
 //
+// The folded stack trace is constructed in its encoded form, i.e. as a sequence of frame IDs
+// of a FrameDictionary, which outlives the stringifier. FoldedStackTraceString() decodes it.
+//
 // A folded stack trace string looks like this (taken from the perf profiler test):
 // __libc_start_main;main;fib52();fib(unsigned long)
 // It is a list of symbols that correspond to the addresses in the underlying stack trace,
@@ -71,24 +75,50 @@ class Stringifier {
    * @param u_symbolizer A symbolizer for user-space addresses.
    * @param k_symbolizer A symbolizer for kernel-space addresses.
    * @param stack_traces Pointer to the BCC collected stack traces.
+   * @param frames The dictionary in which the frames of the stack traces are interned.
    */
   Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
-              ebpf::BPFStackTable* stack_traces);
+              ebpf::BPFStackTable* stack_traces, FrameDictionary* frames);
 
-  // Returns a folded stack trace string based on the stack trace histogram key.
+  /**
+   * Symbolizes the stack traces of the given keys up front: their addresses are read from the
+   * BPF stack trace table, and then symbolized with one batch per process (and one for the
+   * kernel), instead of one address at a time. EncodedStackTrace() of these keys then only
+   * needs to look up the frames of the addresses.
+   */
+  void SymbolizeStackTraces(const std::vector<stack_trace_key_t>& keys);
+
+  // Returns an encoded folded stack trace based on the stack trace histogram key.
   // The key contains both a user & kernel stack-trace-id, which are subsequently
-  // passed into FindOrBuildStackTraceString().
-  std::string FoldedStackTraceString(const stack_trace_key_t& key);
+  // passed into FindOrBuildEncodedStackTrace().
+  std::string EncodedStackTrace(const stack_trace_key_t& key);
+
+  // Returns a folded stack trace string based on the stack trace histogram key.
+  std::string FoldedStackTraceString(const stack_trace_key_t& key) {
+    return frames_->FoldedStackTraceString(EncodedStackTrace(key));
+  }
 
  private:
-  std::string BuildStackTraceString(const std::vector<uintptr_t>& addrs, SymbolizerFn symbolize_fn,
-                                    const std::string_view& suffix);
-  std::string FindOrBuildStackTraceString(const int stack_id, SymbolizerFn symbolize_fn,
-                                          const std::string_view& suffix);
+  const std::vector<uintptr_t>& ReadStackAddrs(const int stack_id);
+  void SymbolizeBatch(Symbolizer* symbolizer, const struct upid_t& upid,
+                      const std::string_view& suffix, std::vector<uintptr_t>* addrs);
+  std::string BuildEncodedStackTrace(const std::vector<uintptr_t>& addrs,
+                                     const struct upid_t& upid, Symbolizer* symbolizer,
+                                     const std::string_view& suffix);
+  std::string FindOrBuildEncodedStackTrace(const int stack_id, const struct upid_t& upid,
+                                           Symbolizer* symbolizer,
+                                           const std::string_view& suffix);
+
+  // Memoized results of previous calls to FindOrBuildEncodedStackTrace():
+  // a map from stack-trace-id to encoded folded stack trace.
+  absl::flat_hash_map<int, std::string> encoded_stack_traces_;
 
-  // Memoized results of previous calls to FindOrBuildStackTraceString():
-  // a map from stack-trace-id to folded stack trace string.
-  absl::flat_hash_map<int, std::string> stack_trace_strs_;
+  // The addresses of the stack traces read from the BPF stack trace table, by stack-trace-id.
+  absl::flat_hash_map<int, std::vector<uintptr_t>> stack_addrs_;
+
+  // The frames of the addresses symbolized by SymbolizeStackTraces(), per process.
+  absl::flat_hash_map<struct upid_t, absl::flat_hash_map<uintptr_t, FrameDictionary::FrameID>>
+      frame_ids_;
 
   // The symbolizer is used to look up a symbol that corresponds to a stack trace address.
   Symbolizer* const u_symbolizer_;
@@ -100,6 +130,8 @@ class Stringifier {
   // to be explicitly cleared (by re-iterating the histogram) after an iteration
   // of the continuous perf. profiler is completed.
   ebpf::BPFStackTable* const stack_traces_;
+
+  FrameDictionary* const frames_;
 };
 
 }  // namespace stirling
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <set>
+#include <utility>
 #include <vector>
 
 #include "src/common/testing/testing.h"
@@ -40,6 +41,7 @@ BPF_SRC_STRVIEW(stringifer_test_bcc_script, stringifier_test_bpf_text);
 
 using ::testing::AnyOfArray;
 using ::testing::EndsWith;
+using ::testing::IsEmpty;
 
 namespace test {
 
@@ -116,9 +118,9 @@ class StringifierTest : public ::testing::Test {
     ASSERT_OK_AND_ASSIGN(symbolizer_, BCCSymbolizer::Create());
 
     // Create our device under test, the stringifier.
-    // It needs a symbolizer and a shared BPF stack traces map.
-    stringifier_ =
-        std::make_unique<Stringifier>(symbolizer_.get(), symbolizer_.get(), stack_traces_.get());
+    // It needs a symbolizer, a shared BPF stack traces map, and a frame dictionary.
+    stringifier_ = std::make_unique<Stringifier>(symbolizer_.get(), symbolizer_.get(),
+                                                 stack_traces_.get(), &frames_);
   }
 
   void TearDown() override {}
@@ -158,6 +160,52 @@ class StringifierTest : public ::testing::Test {
     }
   }
 
+  // Runs Foo() & Bar() with probes attached, and returns our pid, along with the histogram
+  // of the stack traces that were sampled. The stack traces are left in stack_traces_.
+  void CollectStackTraces(uint32_t* pid, std::vector<std::pair<Key, uint64_t>>* histo) {
+    // Values used in creating the [u|k] probe specs.
+    const uint64_t foo_addr = reinterpret_cast<uint64_t>(&::test::Foo);
+    const uint64_t bar_addr = reinterpret_cast<uint64_t>(&::test::Bar);
+    const std::filesystem::path self_path = GetSelfPath().ValueOrDie();
+
+    // uprobe specs, for Foo() and Bar(). We invoke our BPF program,
+    // stack_trace_sampler, when Foo() or Bar() is called.
+    const bpf_tools::UProbeSpec kFooUprobe{.binary_path = self_path,
+                                           .symbol = {},
+                                           .address = foo_addr,
+                                           .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
+                                           .probe_fn = "stack_trace_sampler"};
+    const bpf_tools::UProbeSpec kBarUprobe{.binary_path = self_path,
+                                           .symbol = {},
+                                           .address = bar_addr,
+                                           .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
+                                           .probe_fn = "stack_trace_sampler"};
+
+    // kprobe spec. to attach our BPF program, stack_trace_sampler, to syscall getpid.
+    constexpr bpf_tools::KProbeSpec kPidKprobe{"getpid", bpf_tools::BPFProbeAttachType::kEntry,
+                                               "stack_trace_sampler"};
+
+    // Attach uprobes & kprobes for this test case:
+    ASSERT_OK(bcc_wrapper_.AttachKProbe(kPidKprobe));
+    ASSERT_OK(bcc_wrapper_.AttachUProbe(kFooUprobe));
+    ASSERT_OK(bcc_wrapper_.AttachUProbe(kBarUprobe));
+
+    // Foo() & Bar() tickle our uprobes and kprobe. Both simply return the pid.
+    *pid = ::test::Foo();
+    *pid = ::test::Bar();
+
+    // Detach the probes now that we have collected data.
+    // ... later, we will verify that the stringifier cleared the stack traces map,
+    // as it is required to do. And for this verification to work, we need to
+    // stop collecting data now.
+    bcc_wrapper_.Close();
+
+    constexpr bool kClearTable = true;
+
+    // Move the stack trace histogram out of the BPF shared map into our local map.
+    *histo = histogram_->get_table_offline(kClearTable);
+  }
+
   uint64_t num_stack_ids_reused_ = 0;
 
   bpf_tools::BCCWrapper bcc_wrapper_;
@@ -165,6 +213,7 @@ class StringifierTest : public ::testing::Test {
   std::unique_ptr<Histogram> histogram_;
 
   std::unique_ptr<Symbolizer> symbolizer_;
+  FrameDictionary frames_;
   std::unique_ptr<Stringifier> stringifier_;
 
   // Sets of observed stack-ids for user, kernel, and their union.
@@ -178,50 +227,12 @@ class StringifierTest : public ::testing::Test {
 };
 
 TEST_F(StringifierTest, MemoizationTest) {
-  // Values used in creating the [u|k] probe specs.
-  const uint64_t foo_addr = reinterpret_cast<uint64_t>(&::test::Foo);
-  const uint64_t bar_addr = reinterpret_cast<uint64_t>(&::test::Bar);
-  const std::filesystem::path self_path = GetSelfPath().ValueOrDie();
-
-  // uprobe specs, for Foo() and Bar(). We invoke our BPF program,
-  // stack_trace_sampler, when Foo() or Bar() is called.
-  const bpf_tools::UProbeSpec kFooUprobe{.binary_path = self_path,
-                                         .symbol = {},
-                                         .address = foo_addr,
-                                         .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
-                                         .probe_fn = "stack_trace_sampler"};
-  const bpf_tools::UProbeSpec kBarUprobe{.binary_path = self_path,
-                                         .symbol = {},
-                                         .address = bar_addr,
-                                         .attach_type = bpf_tools::BPFProbeAttachType::kEntry,
-                                         .probe_fn = "stack_trace_sampler"};
-
-  // kprobe spec. to attach our BPF program, stack_trace_sampler, to syscall getpid.
-  constexpr bpf_tools::KProbeSpec kPidKprobe{"getpid", bpf_tools::BPFProbeAttachType::kEntry,
-                                             "stack_trace_sampler"};
-
-  // Attach uprobes & kprobes for this test case:
-  ASSERT_OK(bcc_wrapper_.AttachKProbe(kPidKprobe));
-  ASSERT_OK(bcc_wrapper_.AttachUProbe(kFooUprobe));
-  ASSERT_OK(bcc_wrapper_.AttachUProbe(kBarUprobe));
-
-  // Foo() & Bar() tickle our uprobes and kprobe. Both simply return the pid.
-  uint32_t pid;
-  pid = ::test::Foo();
-  pid = ::test::Bar();
-
-  // Detach the probes now that we have collected data.
-  // ... later, we will verify that the stringifier cleared the stack traces map,
-  // as it is required to do. And for this verification to work, we need to
-  // stop collecting data now.
-  bcc_wrapper_.Close();
-
   // Used below, in calls into BCC APIs.
-  constexpr bool kClearTable = true;
   constexpr bool kNoClearStackId = false;
 
-  // Move the stack trace histogram out of the BPF shared map into our local map.
-  const auto histo = histogram_->get_table_offline(kClearTable);
+  uint32_t pid;
+  std::vector<std::pair<Key, uint64_t>> histo;
+  ASSERT_NO_FATAL_FAILURE(CollectStackTraces(&pid, &histo));
 
   // Use the stringifier to populate folded_strings_map_ (used for memoization check, later).
   // Inside of PopulatedFoldedStringsMap(), we check the following invariants:
@@ -291,6 +302,48 @@ TEST_F(StringifierTest, MemoizationTest) {
   }
 }
 
+// Tests that stack traces are built from the frames symbolized up front, in batches.
+TEST_F(StringifierTest, SymbolizeUpFrontTest) {
+  constexpr bool kNoClearStackId = false;
+
+  uint32_t pid;
+  std::vector<std::pair<Key, uint64_t>> histo;
+  ASSERT_NO_FATAL_FAILURE(CollectStackTraces(&pid, &histo));
+
+  std::vector<Key> keys;
+  for (const auto& [key, count] : histo) {
+    keys.push_back(key);
+  }
+  stringifier_->SymbolizeStackTraces(keys);
+
+  // All the stack traces were read (and cleared) from the stack traces map up front.
+  for (const auto& key : keys) {
+    for (const int stack_id : {key.user_stack_id, key.kernel_stack_id}) {
+      if (stack_id >= 0) {
+        EXPECT_THAT(stack_traces_->get_stack_addr(stack_id, kNoClearStackId), IsEmpty());
+      }
+    }
+  }
+
+  for (const auto& [key, count] : histo) {
+    if (key.upid.pid != pid) {
+      continue;
+    }
+    if (key.user_stack_id >= 0) {
+      constexpr bool is_kernel = false;
+      const Key u_key = MakeUserStackTraceKey(pid, key.user_stack_id);
+      ASSERT_NO_FATAL_FAILURE(PopulatedFoldedStringsMap(key.user_stack_id, u_key, is_kernel));
+    }
+    if (key.kernel_stack_id >= 0) {
+      constexpr bool is_kernel = true;
+      const Key k_key = MakeKernStackTraceKey(pid, key.kernel_stack_id);
+      ASSERT_NO_FATAL_FAILURE(PopulatedFoldedStringsMap(key.kernel_stack_id, k_key, is_kernel));
+    }
+  }
+  EXPECT_GT(u_stack_ids_.size(), 0);
+  EXPECT_GT(k_stack_ids_.size(), 0);
+}
+
 TEST_F(StringifierTest, KernelDropMessageTest) {
   const pid_t pid = getpid();
 
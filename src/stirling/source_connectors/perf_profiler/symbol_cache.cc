@@ -26,7 +26,7 @@ namespace stirling {
 SymbolCache::Symbol::Symbol(SymbolizerFn symbolizer_fn, const uintptr_t addr)
     : symbol_(symbolizer_fn(addr)) {}
 
-SymbolCache::LookupResult SymbolCache::Lookup(const uintptr_t addr) {
+const std::string* SymbolCache::Find(const uintptr_t addr) {
   // Check old cache first, and move result to new cache if we have a hit.
   const auto prev_cache_iter = prev_cache_.find(addr);
   if (prev_cache_iter != prev_cache_.end()) {
@@ -35,12 +35,32 @@ SymbolCache::LookupResult SymbolCache::Lookup(const uintptr_t addr) {
         cache_.try_emplace(addr, std::move(prev_cache_iter->second.symbol_));
     DCHECK(inserted);
     prev_cache_.erase(prev_cache_iter);
-    return SymbolCache::LookupResult{curr_cache_iter->second.symbol_, true};
+    return &curr_cache_iter->second.symbol_;
   }
 
-  // If not in old cache, try the new cache (with automatic insertion if required).
+  const auto iter = cache_.find(addr);
+  if (iter != cache_.end()) {
+    return &iter->second.symbol_;
+  }
+  return nullptr;
+}
+
+SymbolCache::LookupResult SymbolCache::Lookup(const uintptr_t addr) {
+  const std::string* symbol = Find(addr);
+  if (symbol != nullptr) {
+    return SymbolCache::LookupResult{*symbol, true};
+  }
+
+  // Not in either cache, so symbolize the address.
   const auto [iter, inserted] = cache_.try_emplace(addr, symbolizer_fn_, addr);
-  return SymbolCache::LookupResult{iter->second.symbol_, !inserted};
+  DCHECK(inserted);
+  return SymbolCache::LookupResult{iter->second.symbol_, false};
+}
+
+std::string_view SymbolCache::Insert(const uintptr_t addr, std::string_view symbol) {
+  const auto [iter, inserted] = cache_.try_emplace(addr, std::string(symbol));
+  DCHECK(inserted);
+  return iter->second.symbol_;
 }
 
 size_t SymbolCache::PerformEvictions() {
@@ -40,6 +40,18 @@ class SymbolCache {
 
   LookupResult Lookup(const uintptr_t addr);
 
+  /**
+   * Returns the cached symbol of the address, or nullptr if it is not cached.
+   * Unlike Lookup(), a miss does not symbolize the address.
+   */
+  const std::string* Find(const uintptr_t addr);
+
+  /**
+   * Caches the symbol of an address that was symbolized elsewhere (e.g. in a batch),
+   * and returns the cached copy.
+   */
+  std::string_view Insert(const uintptr_t addr, std::string_view symbol);
+
   size_t PerformEvictions();
 
   size_t active_entries() const { return cache_.size(); }
@@ -58,6 +58,28 @@ TEST_F(SymbolCacheTest, Lookup) {
   EXPECT_EQ(result.symbol, "456");
 }
 
+TEST_F(SymbolCacheTest, FindAndInsert) {
+  EXPECT_EQ(sym_cache_->Find(kAddr1), nullptr);
+  EXPECT_EQ(sym_cache_->active_entries(), 0);
+
+  EXPECT_EQ(sym_cache_->Insert(kAddr1, "foo"), "foo");
+  ASSERT_NE(sym_cache_->Find(kAddr1), nullptr);
+  EXPECT_EQ(*sym_cache_->Find(kAddr1), "foo");
+
+  // Inserted symbols are served by Lookup(), instead of calling the symbolization function.
+  SymbolCache::LookupResult result = sym_cache_->Lookup(kAddr1);
+  EXPECT_EQ(result.hit, true);
+  EXPECT_EQ(result.symbol, "foo");
+
+  // Find() also finds entries of the previous generation, and keeps them.
+  sym_cache_->PerformEvictions();
+  EXPECT_EQ(sym_cache_->active_entries(), 0);
+  ASSERT_NE(sym_cache_->Find(kAddr1), nullptr);
+  EXPECT_EQ(*sym_cache_->Find(kAddr1), "foo");
+  EXPECT_EQ(sym_cache_->active_entries(), 1);
+  EXPECT_EQ(sym_cache_->total_entries(), 1);
+}
+
 TEST_F(SymbolCacheTest, EvictOldEntries) {
   SymbolCache::LookupResult result;
 
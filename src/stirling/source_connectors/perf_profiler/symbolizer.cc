@@ -19,6 +19,7 @@
 #include <utility>
 
 #include "src/stirling/bpf_tools/bcc_symbolizer.h"
+#include "src/stirling/obj_tools/elf_build_id.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizer.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
@@ -30,6 +31,14 @@ DEFINE_uint64(
 namespace px {
 namespace stirling {
 
+void Symbolizer::SymbolizeBatch(const struct upid_t& upid, const std::vector<uintptr_t>& addrs,
+                                const BatchSymbolFn& symbol_fn) {
+  SymbolizerFn symbolize = GetSymbolizerFn(upid);
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    symbol_fn(i, symbolize(addrs[i]));
+  }
+}
+
 StatusOr<std::unique_ptr<Symbolizer>> BCCSymbolizer::Create() {
   return std::unique_ptr<Symbolizer>(new BCCSymbolizer());
 }
@@ -60,20 +69,63 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
   return symbolizer;
 }
 
-void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
+void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) {
+  auto iter = symbolizers_.find(upid);
+  if (iter == symbolizers_.end()) {
+    return;
+  }
+  const std::string binary_key = std::move(iter->second.binary_key);
+  symbolizers_.erase(iter);
+
+  // Release the symbol table of the binary once no process uses it.
+  auto binary_iter = binary_symbolizers_.find(binary_key);
+  if (binary_iter != binary_symbolizers_.end() && binary_iter->second.expired()) {
+    binary_symbolizers_.erase(binary_iter);
+  }
+}
 
-StatusOr<std::unique_ptr<ElfReader::Symbolizer>> CreateUPIDSymbolizer(const struct upid_t& upid) {
+StatusOr<std::filesystem::path> UPIDBinaryPath(const struct upid_t& upid) {
   PL_ASSIGN_OR_RETURN(std::unique_ptr<FilePathResolver> fp_resolver,
                       FilePathResolver::Create(upid.pid));
   // TODO(yzhao): Might need to check the start time.
   PL_ASSIGN_OR_RETURN(std::filesystem::path proc_exe,
                       system::ProcParser(system::Config::GetInstance()).GetExePath(upid.pid));
   PL_ASSIGN_OR_RETURN(std::filesystem::path host_proc_exe, fp_resolver->ResolvePath(proc_exe));
-  host_proc_exe = system::Config::GetInstance().ToHostPath(host_proc_exe);
-  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(host_proc_exe));
-  PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader::Symbolizer> upid_symbolizer,
-                      elf_reader->GetSymbolizer());
-  return upid_symbolizer;
+  return system::Config::GetInstance().ToHostPath(host_proc_exe);
+}
+
+Status ElfSymbolizer::CreateUPIDSymbolizer(const struct upid_t& upid,
+                                           UPIDSymbolizer* upid_symbolizer) {
+  PL_ASSIGN_OR_RETURN(std::filesystem::path host_proc_exe, UPIDBinaryPath(upid));
+  PL_ASSIGN_OR_RETURN(std::string binary_key, obj_tools::BinaryContentKey(host_proc_exe));
+
+  std::shared_ptr<ElfReaderSymbolizer> symbolizer;
+  auto binary_iter = binary_symbolizers_.find(binary_key);
+  if (binary_iter != binary_symbolizers_.end()) {
+    symbolizer = binary_iter->second.lock();
+  }
+  if (symbolizer == nullptr) {
+    PL_ASSIGN_OR_RETURN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(host_proc_exe));
+    PL_ASSIGN_OR_RETURN(symbolizer, elf_reader->GetSymbolizer());
+    binary_symbolizers_[binary_key] = symbolizer;
+  }
+
+  upid_symbolizer->binary_key = std::move(binary_key);
+  upid_symbolizer->symbolizer = std::move(symbolizer);
+  return Status::OK();
+}
+
+ElfSymbolizer::ElfReaderSymbolizer* ElfSymbolizer::GetUPIDSymbolizer(const struct upid_t& upid) {
+  UPIDSymbolizer& upid_symbolizer = symbolizers_[upid];
+  if (upid_symbolizer.symbolizer == nullptr) {
+    Status s = CreateUPIDSymbolizer(upid, &upid_symbolizer);
+    if (!s.ok()) {
+      VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
+                                  upid.pid, s.ToString());
+      return nullptr;
+    }
+  }
+  return upid_symbolizer.symbolizer.get();
 }
 
 std::string_view EmptySymbolizerFn(const uintptr_t addr) {
@@ -90,20 +142,25 @@ SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
     return SymbolizerFn(&(BogusKernelSymbolizerFn));
   }
 
-  std::unique_ptr<ElfReader::Symbolizer>& upid_symbolizer = symbolizers_[upid];
+  ElfReaderSymbolizer* upid_symbolizer = GetUPIDSymbolizer(upid);
   if (upid_symbolizer == nullptr) {
-    StatusOr<std::unique_ptr<ElfReader::Symbolizer>> upid_symbolizer_status =
-        CreateUPIDSymbolizer(upid);
-    if (!upid_symbolizer_status.ok()) {
-      VLOG(1) << absl::Substitute("Failed to create Symbolizer function for $0 [error=$1]",
-                                  upid.pid, upid_symbolizer_status.ToString());
-      return SymbolizerFn(&(EmptySymbolizerFn));
-    }
+    return SymbolizerFn(&(EmptySymbolizerFn));
+  }
+
+  return std::bind(&ElfReader::Symbolizer::Lookup, upid_symbolizer, std::placeholders::_1);
+}
 
-    upid_symbolizer = upid_symbolizer_status.ConsumeValueOrDie();
+void ElfSymbolizer::SymbolizeBatch(const struct upid_t& upid, const std::vector<uintptr_t>& addrs,
+                                   const BatchSymbolFn& symbol_fn) {
+  constexpr uint32_t kKernelPID = static_cast<uint32_t>(-1);
+  ElfReaderSymbolizer* upid_symbolizer =
+      upid.pid == kKernelPID ? nullptr : GetUPIDSymbolizer(upid);
+  if (upid_symbolizer == nullptr) {
+    Symbolizer::SymbolizeBatch(upid, addrs, symbol_fn);
+    return;
   }
 
-  return std::bind(&ElfReader::Symbolizer::Lookup, upid_symbolizer.get(), std::placeholders::_1);
+  upid_symbolizer->LookupBatch(addrs, symbol_fn);
 }
 
 StatusOr<std::unique_ptr<Symbolizer>> CachingSymbolizer::Create(
@@ -114,17 +171,51 @@ StatusOr<std::unique_ptr<Symbolizer>> CachingSymbolizer::Create(
   return uptr;
 }
 
-SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
-  using std::placeholders::_1;
+SymbolCache* CachingSymbolizer::GetSymbolCache(const struct upid_t& upid) {
   const auto [iter, inserted] = symbol_caches_.try_emplace(upid, nullptr);
   if (inserted) {
     iter->second = std::make_unique<SymbolCache>(symbolizer_->GetSymbolizerFn(upid));
   }
-  auto& cache = iter->second;
-  auto fn = std::bind(&CachingSymbolizer::Symbolize, this, cache.get(), _1);
+  return iter->second.get();
+}
+
+SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
+  using std::placeholders::_1;
+  auto fn = std::bind(&CachingSymbolizer::Symbolize, this, GetSymbolCache(upid), _1);
   return fn;
 }
 
+void CachingSymbolizer::SymbolizeBatch(const struct upid_t& upid,
+                                       const std::vector<uintptr_t>& addrs,
+                                       const BatchSymbolFn& symbol_fn) {
+  SymbolCache* symbol_cache = GetSymbolCache(upid);
+
+  // Serve the cached symbols, and pass the misses (which remain sorted) down as one batch.
+  std::vector<uintptr_t> miss_addrs;
+  std::vector<size_t> miss_idxs;
+  for (size_t i = 0; i < addrs.size(); ++i) {
+    ++stat_accesses_;
+    const std::string* symbol = symbol_cache->Find(addrs[i]);
+    if (symbol != nullptr) {
+      ++stat_hits_;
+      symbol_fn(i, *symbol);
+    } else {
+      miss_addrs.push_back(addrs[i]);
+      miss_idxs.push_back(i);
+    }
+  }
+
+  if (miss_addrs.empty()) {
+    return;
+  }
+
+  symbolizer_->SymbolizeBatch(
+      upid, miss_addrs,
+      [symbol_cache, &symbol_fn, &miss_addrs, &miss_idxs](size_t i, std::string_view symbol) {
+        symbol_fn(miss_idxs[i], symbol_cache->Insert(miss_addrs[i], symbol));
+      });
+}
+
 void CachingSymbolizer::DeleteUPID(const struct upid_t& upid) {
   // The inner map is owned by a unique_ptr; this will free the memory.
   symbol_caches_.erase(upid);
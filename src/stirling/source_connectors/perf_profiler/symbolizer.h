@@ -21,6 +21,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "src/stirling/bpf_tools/bcc_bpf_intf/upid.h"
 #include "src/stirling/bpf_tools/bcc_symbolizer.h"
@@ -56,6 +57,19 @@ class Symbolizer {
    */
   virtual SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) = 0;
 
+  /**
+   * Symbolize a batch of addresses of the process specified by UPID, e.g. all of the addresses
+   * of the process seen in one iteration of the profiler.
+   * The addresses must be sorted in ascending order, without duplicates.
+   * The symbol of addrs[i] is passed to symbol_fn(i, symbol), in no particular order of i;
+   * the symbol is only valid for the duration of that call.
+   *
+   * By default, the addresses are symbolized one at a time, with the function from
+   * GetSymbolizerFn().
+   */
+  virtual void SymbolizeBatch(const struct upid_t& upid, const std::vector<uintptr_t>& addrs,
+                              const BatchSymbolFn& symbol_fn);
+
   /**
    * Delete the state associated with a symbolizer created by a previous call to GetSymbolizerFn
    */
@@ -87,15 +101,34 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
   static StatusOr<std::unique_ptr<Symbolizer>> Create();
 
   SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override;
+  void SymbolizeBatch(const struct upid_t& upid, const std::vector<uintptr_t>& addrs,
+                      const BatchSymbolFn& symbol_fn) override;
   void DeleteUPID(const struct upid_t& upid) override;
 
+  // The number of distinct binaries for which a symbol table is held.
+  size_t num_symbol_tables() const { return binary_symbolizers_.size(); }
+
  private:
+  using ElfReaderSymbolizer = px::stirling::obj_tools::ElfReader::Symbolizer;
+
+  struct UPIDSymbolizer {
+    // The key of the binary of the process; see obj_tools::BinaryContentKey().
+    std::string binary_key;
+    std::shared_ptr<ElfReaderSymbolizer> symbolizer;
+  };
+
   ElfSymbolizer() = default;
 
+  // Returns the symbolizer of the process, or nullptr if one could not be created.
+  ElfReaderSymbolizer* GetUPIDSymbolizer(const struct upid_t& upid);
+  Status CreateUPIDSymbolizer(const struct upid_t& upid, UPIDSymbolizer* upid_symbolizer);
+
   // A symbolizer per UPID.
-  absl::flat_hash_map<struct upid_t,
-                      std::unique_ptr<px::stirling::obj_tools::ElfReader::Symbolizer>>
-      symbolizers_;
+  absl::flat_hash_map<struct upid_t, UPIDSymbolizer> symbolizers_;
+
+  // The symbolizers by binary. Processes that run copies of the same binary (e.g. the replicas
+  // of a deployment) share one symbol table, instead of each reading its own.
+  absl::flat_hash_map<std::string, std::weak_ptr<ElfReaderSymbolizer>> binary_symbolizers_;
 };
 
 /**
@@ -106,6 +139,8 @@ class CachingSymbolizer : public Symbolizer {
   static StatusOr<std::unique_ptr<Symbolizer>> Create(std::unique_ptr<Symbolizer> inner_symbolizer);
 
   SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override;
+  void SymbolizeBatch(const struct upid_t& upid, const std::vector<uintptr_t>& addrs,
+                      const BatchSymbolFn& symbol_fn) override;
 
   void DeleteUPID(const struct upid_t& upid) override;
   size_t PerformEvictions();
@@ -116,6 +151,7 @@ class CachingSymbolizer : public Symbolizer {
  private:
   CachingSymbolizer() = default;
 
+  SymbolCache* GetSymbolCache(const struct upid_t& upid);
   std::string_view Symbolize(SymbolCache* symbol_cache, const uintptr_t addr);
 
   std::unique_ptr<Symbolizer> symbolizer_;
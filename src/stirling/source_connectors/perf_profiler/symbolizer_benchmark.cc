@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/obj_tools/elf_reader.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolizer.h"
+
+using px::stirling::ElfSymbolizer;
+using px::stirling::Symbolizer;
+using px::stirling::SymbolizerFn;
+using px::stirling::obj_tools::ElfReader;
+using px::stirling::obj_tools::SymbolMatchType;
+
+// The symbolizers symbolize the addresses of this process. This benchmark links in all of
+// Stirling, so its symbol table is that of a large binary.
+struct upid_t SelfUPID(uint64_t start_time_ticks = 0) {
+  return {.pid = static_cast<uint32_t>(getpid()), .start_time_ticks = start_time_ticks};
+}
+
+// Returns addresses within the functions of this binary, in random order and with repeats,
+// like the addresses of the stack traces of one iteration of the profiler.
+std::vector<uintptr_t> RandomFunctionAddrs(size_t num_addrs) {
+  PL_ASSIGN_OR_EXIT(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create("/proc/self/exe"));
+  PL_ASSIGN_OR_EXIT(std::vector<ElfReader::SymbolInfo> symbols,
+                    elf_reader->ListFuncSymbols("", SymbolMatchType::kSubstr));
+  symbols.erase(std::remove_if(symbols.begin(), symbols.end(),
+                               [](const ElfReader::SymbolInfo& s) { return s.size == 0; }),
+                symbols.end());
+  CHECK(!symbols.empty());
+
+  // Stack traces share most of their frames, so only a fraction of the addresses are distinct.
+  constexpr int kRepeats = 4;
+  std::mt19937_64 rng(37);
+  std::vector<uintptr_t> addrs;
+  addrs.reserve(num_addrs);
+  while (addrs.size() < num_addrs) {
+    const ElfReader::SymbolInfo& symbol = symbols[rng() % symbols.size()];
+    const uintptr_t addr = symbol.address + rng() % symbol.size;
+    for (int i = 0; i < kRepeats && addrs.size() < num_addrs; ++i) {
+      addrs.push_back(addr);
+    }
+  }
+  std::shuffle(addrs.begin(), addrs.end(), rng);
+  return addrs;
+}
+
+// Symbolizes the addresses one at a time, the way stack traces used to be symbolized.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_symbolize_one_at_a_time(benchmark::State& state) {
+  const std::vector<uintptr_t> addrs = RandomFunctionAddrs(state.range(0));
+
+  PL_ASSIGN_OR_EXIT(std::unique_ptr<Symbolizer> symbolizer, ElfSymbolizer::Create());
+  // Load the symbol table before measuring.
+  symbolizer->GetSymbolizerFn(SelfUPID());
+
+  for (auto _ : state) {
+    SymbolizerFn symbolize = symbolizer->GetSymbolizerFn(SelfUPID());
+    size_t total_size = 0;
+    for (const uintptr_t addr : addrs) {
+      total_size += symbolize(addr).size();
+    }
+    benchmark::DoNotOptimize(total_size);
+  }
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+
+// Sorts and deduplicates the addresses, and symbolizes them as one batch.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_symbolize_batch(benchmark::State& state) {
+  const std::vector<uintptr_t> addrs = RandomFunctionAddrs(state.range(0));
+
+  PL_ASSIGN_OR_EXIT(std::unique_ptr<Symbolizer> symbolizer, ElfSymbolizer::Create());
+  // Load the symbol table before measuring.
+  symbolizer->GetSymbolizerFn(SelfUPID());
+
+  for (auto _ : state) {
+    std::vector<uintptr_t> batch = addrs;
+    std::sort(batch.begin(), batch.end());
+    batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+
+    size_t total_size = 0;
+    symbolizer->SymbolizeBatch(SelfUPID(), batch, [&total_size](size_t, std::string_view symbol) {
+      total_size += symbol.size();
+    });
+    benchmark::DoNotOptimize(total_size);
+  }
+  state.SetItemsProcessed(state.iterations() * addrs.size());
+}
+
+// Returns the peak resident set size of this process.
+int64_t PeakRSSBytes() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss * 1024;
+}
+
+// Creates the symbolizers of a number of processes that run the same binary, which share
+// one symbol table. (The UPIDs all refer to this process, with made up start times.)
+// NOLINTNEXTLINE : runtime/references.
+static void BM_symbolizers_of_replicas(benchmark::State& state) {
+  const int num_processes = state.range(0);
+
+  for (auto _ : state) {
+    PL_ASSIGN_OR_EXIT(std::unique_ptr<Symbolizer> symbolizer, ElfSymbolizer::Create());
+    for (int i = 0; i < num_processes; ++i) {
+      benchmark::DoNotOptimize(symbolizer->GetSymbolizerFn(SelfUPID(i)));
+    }
+    state.counters["symbol_tables"] =
+        static_cast<ElfSymbolizer*>(symbolizer.get())->num_symbol_tables();
+  }
+
+  state.counters["peak_rss"] = benchmark::Counter(PeakRSSBytes(), benchmark::Counter::kDefaults,
+                                                  benchmark::Counter::OneK::kIs1024);
+}
+
+BENCHMARK(BM_symbolize_one_at_a_time)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_symbolize_batch)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+BENCHMARK(BM_symbolizers_of_replicas)->Arg(1)->Arg(4)->Arg(16);
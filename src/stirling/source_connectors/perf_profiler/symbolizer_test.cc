@@ -18,7 +18,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <set>
+#include <string>
+#include <vector>
 
 #include "src/common/testing/testing.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
@@ -38,6 +41,9 @@ const uintptr_t kBarAddr = reinterpret_cast<uintptr_t>(&test::bar);
 namespace px {
 namespace stirling {
 
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
 template <typename TSymbolizer>
 class SymbolizerTest : public ::testing::Test {
  public:
@@ -65,6 +71,44 @@ TYPED_TEST(SymbolizerTest, UserSymbols) {
   EXPECT_EQ(symbolize(2), std::string("0x0000000000000002"));
 }
 
+TYPED_TEST(SymbolizerTest, UserSymbolsBatch) {
+  struct upid_t this_upid;
+  this_upid.pid = static_cast<uint32_t>(getpid());
+  this_upid.start_time_ticks = 0;
+
+  std::vector<uintptr_t> addrs = {2, kFooAddr, kBarAddr};
+  std::sort(addrs.begin(), addrs.end());
+
+  absl::flat_hash_map<uintptr_t, std::string> symbols;
+  this->symbolizer_->SymbolizeBatch(this_upid, addrs, [&](size_t i, std::string_view symbol) {
+    symbols[addrs[i]] = std::string(symbol);
+  });
+
+  EXPECT_THAT(symbols, UnorderedElementsAre(Pair(kFooAddr, "test::foo()"),
+                                            Pair(kBarAddr, "test::bar()"),
+                                            Pair(2, "0x0000000000000002")));
+}
+
+// Processes that run the same binary share one symbol table.
+TEST_F(ElfSymbolizerTest, SharedSymbolTable) {
+  auto& symbolizer = *static_cast<ElfSymbolizer*>(symbolizer_.get());
+
+  // Two UPIDs of this process stand in for two processes running the same binary.
+  const struct upid_t upid_a = {.pid = static_cast<uint32_t>(getpid()), .start_time_ticks = 0};
+  const struct upid_t upid_b = {.pid = static_cast<uint32_t>(getpid()), .start_time_ticks = 1};
+
+  EXPECT_EQ(symbolizer.GetSymbolizerFn(upid_a)(kFooAddr), "test::foo()");
+  EXPECT_EQ(symbolizer.GetSymbolizerFn(upid_b)(kBarAddr), "test::bar()");
+  EXPECT_EQ(symbolizer.num_symbol_tables(), 1);
+
+  symbolizer.DeleteUPID(upid_a);
+  EXPECT_EQ(symbolizer.num_symbol_tables(), 1);
+  EXPECT_EQ(symbolizer.GetSymbolizerFn(upid_b)(kFooAddr), "test::foo()");
+
+  symbolizer.DeleteUPID(upid_b);
+  EXPECT_EQ(symbolizer.num_symbol_tables(), 0);
+}
+
 TEST_F(BCCSymbolizerTest, KernelSymbols) {
   ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer, BCCSymbolizer::Create());
 
@@ -190,6 +234,26 @@ TEST_F(BCCSymbolizerTest, Caching) {
     EXPECT_EQ(symbolizer.stat_accesses(), 14);
     EXPECT_EQ(symbolizer.stat_hits(), 7);
   }
+
+  // Batches are served from the same cache.
+  {
+    std::vector<uintptr_t> addrs = {kFooAddr, kBarAddr, 0x1234123412341235ULL};
+    std::sort(addrs.begin(), addrs.end());
+    std::vector<std::string> symbols(addrs.size());
+    symbolizer.SymbolizeBatch(this_upid, addrs, [&](size_t i, std::string_view symbol) {
+      symbols[i] = std::string(symbol);
+    });
+    EXPECT_THAT(symbols, UnorderedElementsAre("test::foo()", "test::bar()",
+                                              "0x1234123412341235"));
+    EXPECT_EQ(symbolizer.stat_accesses(), 17);
+    EXPECT_EQ(symbolizer.stat_hits(), 9);
+  }
+  {
+    auto symbolize = symbolizer.GetSymbolizerFn(this_upid);
+    EXPECT_EQ(symbolize(0x1234123412341235ULL), "0x1234123412341235");
+    EXPECT_EQ(symbolizer.stat_accesses(), 18);
+    EXPECT_EQ(symbolizer.stat_hits(), 10);
+  }
 }
 
 }  // namespace stirling
@@ -31,9 +31,15 @@ namespace stirling {
  */
 using SymbolizerFn = std::function<std::string_view(const uintptr_t addr)>;
 
+/**
+ * A function that receives the symbol of the i-th address of a batch of addresses.
+ * See Symbolizer::SymbolizeBatch().
+ */
+using BatchSymbolFn = std::function<void(size_t i, std::string_view symbol)>;
+
 // SymbolicStackTrace identifies a particular stack trace by:
 // * upid
-// * "folded" stack trace string
+// * "folded" stack trace, encoded as a sequence of frame IDs (see FrameDictionary)
 // The stack traces (in kernel & in BPF) are ordered lists of instruction pointers (addresses).
 // Stirling uses BPF to recover the symbols associated with each address, and then
 // uses the "symbolic stack trace" as the histogram key. Some of the stack traces that are
@@ -45,18 +51,18 @@ using SymbolizerFn = std::function<std::string_view(const uintptr_t addr)>;
 // SymbolicStackTrace will serve as a key to the unique stack-trace-id (an integer) in Stirling.
 struct SymbolicStackTrace {
   const md::UPID upid;
-  const std::string stack_trace_str;
+  const std::string encoded_stack_trace;
 
   template <typename H>
   friend H AbslHashValue(H h, const SymbolicStackTrace& s) {
-    return H::combine(std::move(h), s.upid, s.stack_trace_str);
+    return H::combine(std::move(h), s.upid, s.encoded_stack_trace);
   }
 
   friend bool operator==(const SymbolicStackTrace& lhs, const SymbolicStackTrace& rhs) {
     if (lhs.upid != rhs.upid) {
       return false;
     }
-    return lhs.stack_trace_str == rhs.stack_trace_str;
+    return lhs.encoded_stack_trace == rhs.encoded_stack_trace;
   }
 };
 
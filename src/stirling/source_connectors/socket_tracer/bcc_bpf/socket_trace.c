@@ -44,8 +44,19 @@ const int32_t kInvalidFD = -1;
 const int kConnStatsDataThreshold = 65536;
 
 // This is the perf buffer for BPF program to export data from kernel to user space.
+// On kernels with BPF ring buffers, user-space defines ENABLE_RINGBUF, and data and control events
+// go through ring buffers shared by all CPUs instead, which keeps them in order across CPUs.
+#ifdef ENABLE_RINGBUF
+BPF_RINGBUF_OUTPUT(socket_data_events, SOCKET_DATA_RINGBUF_PAGES);
+BPF_RINGBUF_OUTPUT(socket_control_events, SOCKET_CONTROL_RINGBUF_PAGES);
+// The kernel doesn't tell the reader of a ring buffer about events that didn't fit, unlike with
+// perf buffers. So we count them here, and user-space reports them as lost events.
+// Indexed by event_loss_index_t.
+BPF_PERCPU_ARRAY(event_loss_counters, uint64_t, kNumEventLossCounters);
+#else
 BPF_PERF_OUTPUT(socket_data_events);
 BPF_PERF_OUTPUT(socket_control_events);
+#endif
 BPF_PERF_OUTPUT(conn_stats_events);
 
 // This output is used to export notification of processes that have performed an mmap.
@@ -322,6 +333,61 @@ static __inline void read_sockaddr_kernel(struct conn_info_t* conn_info,
   }
 }
 
+/***********************************************************
+ * Event submission
+ ***********************************************************/
+
+#ifdef ENABLE_RINGBUF
+static __inline void count_event_loss(int idx) {
+  uint64_t* count = event_loss_counters.lookup(&idx);
+  if (count != NULL) {
+    ++(*count);
+  }
+}
+#endif
+
+// Returns the memory in which to build a control event. With ring buffers, this is space reserved
+// in socket_control_events, so the event is written in place; otherwise it is stack_event.
+// Returns NULL, and counts the event as lost, if the ring buffer is full.
+static __inline struct socket_control_event_t* reserve_control_event(
+    struct socket_control_event_t* stack_event) {
+#ifdef ENABLE_RINGBUF
+  struct socket_control_event_t* event =
+      socket_control_events.ringbuf_reserve(sizeof(struct socket_control_event_t));
+  if (event == NULL) {
+    count_event_loss(kSocketControlEventLossIndex);
+    return NULL;
+  }
+  __builtin_memset(event, 0, sizeof(struct socket_control_event_t));
+  return event;
+#else
+  return stack_event;
+#endif
+}
+
+// Commits a control event returned by reserve_control_event().
+static __inline void submit_control_event(struct pt_regs* ctx,
+                                          struct socket_control_event_t* event) {
+#ifdef ENABLE_RINGBUF
+  socket_control_events.ringbuf_submit(event, 0);
+#else
+  socket_control_events.perf_submit(ctx, event, sizeof(struct socket_control_event_t));
+#endif
+}
+
+// Data events have a variable size, which the verifier does not accept for a reservation,
+// so with ring buffers they are copied from the per-CPU event buffer.
+static __inline void submit_data_event(struct pt_regs* ctx, struct socket_data_event_t* event,
+                                       size_t size) {
+#ifdef ENABLE_RINGBUF
+  if (socket_data_events.ringbuf_output(event, size, 0) != 0) {
+    count_event_loss(kSocketDataEventLossIndex);
+  }
+#else
+  socket_data_events.perf_submit(ctx, event, size);
+#endif
+}
+
 static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t fd,
                                      const struct sockaddr* addr, const struct socket* socket,
                                      enum endpoint_role_t role) {
@@ -344,25 +410,33 @@ static __inline void submit_new_conn(struct pt_regs* ctx, uint32_t tgid, int32_t
     return;
   }
 
-  struct socket_control_event_t control_event = {};
-  control_event.type = kConnOpen;
-  control_event.timestamp_ns = bpf_ktime_get_ns();
-  control_event.conn_id = conn_info.conn_id;
-  control_event.open.addr = conn_info.addr;
-  control_event.open.role = conn_info.role;
+  struct socket_control_event_t stack_event = {};
+  struct socket_control_event_t* control_event = reserve_control_event(&stack_event);
+  if (control_event == NULL) {
+    return;
+  }
+  control_event->type = kConnOpen;
+  control_event->timestamp_ns = bpf_ktime_get_ns();
+  control_event->conn_id = conn_info.conn_id;
+  control_event->open.addr = conn_info.addr;
+  control_event->open.role = conn_info.role;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_control_event(ctx, control_event);
 }
 
 static __inline void submit_close_event(struct pt_regs* ctx, struct conn_info_t* conn_info) {
-  struct socket_control_event_t control_event = {};
-  control_event.type = kConnClose;
-  control_event.timestamp_ns = bpf_ktime_get_ns();
-  control_event.conn_id = conn_info->conn_id;
-  control_event.close.rd_bytes = conn_info->rd_bytes;
-  control_event.close.wr_bytes = conn_info->wr_bytes;
+  struct socket_control_event_t stack_event = {};
+  struct socket_control_event_t* control_event = reserve_control_event(&stack_event);
+  if (control_event == NULL) {
+    return;
+  }
+  control_event->type = kConnClose;
+  control_event->timestamp_ns = bpf_ktime_get_ns();
+  control_event->conn_id = conn_info->conn_id;
+  control_event->close.rd_bytes = conn_info->rd_bytes;
+  control_event->close.wr_bytes = conn_info->wr_bytes;
 
-  socket_control_events.perf_submit(ctx, &control_event, sizeof(struct socket_control_event_t));
+  submit_control_event(ctx, control_event);
 }
 
 // Writes the input buf to event, and submits the event to the corresponding perf buffer.
@@ -434,7 +508,7 @@ static __inline void perf_submit_buf(struct pt_regs* ctx, const enum traffic_dir
   // If-statement is redundant, but is required to keep the 4.14 verifier happy.
   if (amount_copied > 0) {
     event->attr.msg_buf_size = amount_copied;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr) + amount_copied);
+    submit_data_event(ctx, event, sizeof(event->attr) + amount_copied);
   }
 }
 
@@ -829,7 +903,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
     event->attr.pos = conn_info->wr_bytes;
     event->attr.msg_size = bytes_count;
     event->attr.msg_buf_size = 0;
-    socket_data_events.perf_submit(ctx, event, sizeof(event->attr));
+    submit_data_event(ctx, event, sizeof(event->attr));
   }
 
   update_conn_stats(ctx, conn_info, kEgress, bytes_count);
@@ -32,6 +32,15 @@ const uint64_t kSocketTraceNothing = 0;
 const int64_t kTraceAllTGIDs = -1;
 const char kControlValuesArrayName[] = "control_values";
 
+// Specifies the indexes of the per-cpu counters of events that could not be written to a BPF ring
+// buffer, because it was full. Only used when the events are sent through ring buffers.
+enum event_loss_index_t {
+  kSocketDataEventLossIndex = 0,
+  kSocketControlEventLossIndex,
+  kNumEventLossCounters,
+};
+const char kEventLossCountersArrayName[] = "event_loss_counters";
+
 // Note: A value of 100 results in >4096 BPF instructions, which is too much for older kernels.
 #define CONN_CLEANUP_ITERS 90
 const int kMaxConnMapCleanupItems = CONN_CLEANUP_ITERS;
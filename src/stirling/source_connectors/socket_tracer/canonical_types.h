@@ -62,6 +62,15 @@ constexpr DataElement kLatencyNS = {
     types::PatternType::METRIC_GAUGE,
 };
 
+constexpr DataElement kSampleRatio = {
+    "sample_ratio",
+    "Fraction of the connections that were traced when the record was captured. It is below 1 "
+    "when the socket tracer sheds load; divide counts by it to estimate the totals.",
+    types::DataType::FLOAT64,
+    types::SemanticType::ST_NONE,
+    types::PatternType::METRIC_GAUGE,
+};
+
 constexpr DataElement kPXInfo = {
     "px_info_",
     "Pixie messages regarding the record (e.g. warnings)",
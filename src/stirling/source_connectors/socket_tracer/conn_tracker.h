@@ -306,6 +306,13 @@ class ConnTracker : NotCopyMoveable {
   traffic_protocol_t protocol() const { return protocol_; }
   endpoint_role_t role() const { return role_; }
   bool ssl() const { return ssl_; }
+
+  /**
+   * The lowest fraction of connections that was traced while this connection was traced.
+   * See LoadShedder.
+   */
+  double sample_ratio() const { return sample_ratio_; }
+  void set_sample_ratio(double sample_ratio) { sample_ratio_ = sample_ratio; }
   ConnStatsTracker& conn_stats() { return conn_stats_; }
 
   /**
@@ -670,6 +677,8 @@ class ConnTracker : NotCopyMoveable {
 
   State state_ = State::kCollecting;
 
+  double sample_ratio_ = 1.0;
+
   std::string disable_reason_;
 
   // Iterations before the tracker can be killed.
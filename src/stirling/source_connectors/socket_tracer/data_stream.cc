@@ -121,12 +121,20 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
   parse_result.state = ParseState::kNeedsMoreData;
   parse_result.end_position = 0;
 
+  auto* resume_state = frame_resume_state<TFrameType>();
+  using TResumeStateType = std::remove_pointer_t<decltype(resume_state)>;
+
   while (keep_processing && !data_buffer_.empty()) {
     size_t contiguous_bytes = data_buffer_.Head().size();
 
+    // The saved progress only applies if the head of the stream hasn't moved since it was saved.
+    if (resume_state != nullptr && data_buffer_.position() != frame_resume_pos_) {
+      *resume_state = TResumeStateType();
+    }
+
     // Now parse the raw data.
     parse_result = protocols::ParseFrames(type, data_buffer_, &typed_messages,
-                                          IsSyncRequired(stuck_count_), state);
+                                          IsSyncRequired(stuck_count_), state, resume_state);
 
     if (contiguous_bytes != data_buffer_.size()) {
       // We weren't able to submit all bytes, which means we ran into a missing event.
@@ -154,6 +162,9 @@ void DataStream::ProcessBytesToFrames(message_type_t type, TStateType* state) {
     stat_valid_frames_ += parse_result.frame_positions.size();
     stat_invalid_frames_ += parse_result.invalid_frames;
     stat_raw_data_gaps_ += keep_processing;
+
+    // If the head moved to a new frame, the state is stale and gets reset on the next use.
+    frame_resume_pos_ = data_buffer_.position();
   }
 
   // Check to see if we are blocked on parsing.
@@ -216,6 +227,7 @@ void DataStream::Reset() {
   stuck_count_ = 0;
 
   frames_ = std::monostate();
+  frame_resume_state_.reset();
 }
 
 }  // namespace stirling
@@ -19,10 +19,12 @@
 #pragma once
 
 #include <algorithm>
+#include <any>
 #include <deque>
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
@@ -220,9 +222,31 @@ class DataStream : NotCopyMoveable {
     frames->erase(frames->begin(), iter);
   }
 
+  // Returns the state kept about the partially received frame at the head of the stream,
+  // creating it if necessary. Returns nullptr for protocols that don't keep such state.
+  template <typename TFrameType>
+  typename protocols::FrameResumeState<TFrameType>::type* frame_resume_state() {
+    using TResumeStateType = typename protocols::FrameResumeState<TFrameType>::type;
+    if constexpr (std::is_same_v<TResumeStateType, protocols::NoResumeState>) {
+      return nullptr;
+    } else {
+      auto* ptr = std::any_cast<TResumeStateType>(&frame_resume_state_);
+      if (ptr == nullptr) {
+        ptr = &frame_resume_state_.emplace<TResumeStateType>();
+      }
+      return ptr;
+    }
+  }
+
   // Raw data events from BPF.
   protocols::DataStreamBuffer data_buffer_;
 
+  // The parser's progress on the frame at the head of data_buffer_, so that a frame that arrives
+  // over many iterations is not parsed from its start every time (see FrameResumeState).
+  // Only valid while the head of data_buffer_ is still at frame_resume_pos_.
+  std::any frame_resume_state_;
+  size_t frame_resume_pos_ = 0;
+
   uint32_t retention_capacity_ = 0;
 
   // Vector of parsed HTTP/MySQL messages.
@@ -51,6 +51,7 @@ static constexpr DataElement kDNSElements[] = {
          types::SemanticType::ST_NONE,
          types::PatternType::GENERAL},
         canonical_data_elements::kLatencyNS,
+        canonical_data_elements::kSampleRatio,
 #ifndef NDEBUG
         canonical_data_elements::kPXInfo,
 #endif
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+// splitmix64 finalizer: a fixed hash, so decisions do not depend on the process.
+uint64_t Mix(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+}  // namespace
+
+void LoadShedder::Update(int64_t num_lost_events, std::chrono::nanoseconds drain_duration) {
+  double prev_sample_ratio = sample_ratio_;
+
+  if (num_lost_events > 0 || drain_duration > max_drain_duration_) {
+    sample_ratio_ = std::max(kMinSampleRatio, sample_ratio_ / 2);
+  } else {
+    sample_ratio_ = std::min(1.0, sample_ratio_ + kRecoveryStep);
+  }
+
+  // Only log when shedding more, or when shedding stops, to not log every recovery step.
+  const bool shed_more = sample_ratio_ < prev_sample_ratio;
+  const bool recovered = sample_ratio_ == 1.0 && prev_sample_ratio < 1.0;
+  LOG_IF(INFO, shed_more || recovered) << absl::Substitute(
+      "Socket tracer sample ratio changed from $0 to $1 [lost_events=$2 drain_time=$3ms].",
+      prev_sample_ratio, sample_ratio_, num_lost_events,
+      std::chrono::duration_cast<std::chrono::milliseconds>(drain_duration).count());
+}
+
+bool LoadShedder::ShouldTrace(const struct conn_id_t& conn_id) const {
+  if (sample_ratio_ >= 1.0) {
+    return true;
+  }
+
+  uint64_t h = Mix(conn_id.upid.tgid);
+  h = Mix(h ^ conn_id.upid.start_time_ticks);
+  h = Mix(h ^ static_cast<uint32_t>(conn_id.fd));
+  h = Mix(h ^ conn_id.tsid);
+
+  double point = static_cast<double>(h) / std::numeric_limits<uint64_t>::max();
+  return point < sample_ratio_;
+}
+
+}  // namespace stirling
+}  // namespace px
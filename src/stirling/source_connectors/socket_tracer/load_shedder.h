@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "src/stirling/bpf_tools/bcc_bpf_intf/upid.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Decides which connections to trace when the socket tracer cannot keep up with the traffic.
+ *
+ * Instead of letting the kernel drop random events, which leaves gaps in every connection, a
+ * fraction of the connections is traced in full and the rest is not traced at all. The fraction
+ * is halved whenever events are lost or draining the buffers takes too long, and recovers slowly
+ * once the load is handled again.
+ *
+ * Whether a connection is traced only depends on a hash of its conn_id, so the decision for a
+ * connection never flips back and forth as long as the fraction only goes down.
+ */
+class LoadShedder {
+ public:
+  // The fraction of connections traced never drops below this.
+  static constexpr double kMinSampleRatio = 1.0 / 64;
+
+  // The fraction of connections recovered per iteration without overload.
+  static constexpr double kRecoveryStep = 1.0 / 64;
+
+  /**
+   * @param max_drain_duration Draining the buffers for longer than this counts as overload.
+   */
+  explicit LoadShedder(std::chrono::nanoseconds max_drain_duration)
+      : max_drain_duration_(max_drain_duration) {}
+
+  /**
+   * Updates the sample ratio once per iteration.
+   *
+   * @param num_lost_events The number of events lost by the kernel since the last call.
+   * @param drain_duration The time spent draining the buffers in this iteration.
+   */
+  void Update(int64_t num_lost_events, std::chrono::nanoseconds drain_duration);
+
+  /**
+   * The fraction of connections that are currently traced, in [kMinSampleRatio, 1].
+   */
+  double sample_ratio() const { return sample_ratio_; }
+
+  /**
+   * Returns whether the connection should be traced at the current sample ratio.
+   */
+  bool ShouldTrace(const struct conn_id_t& conn_id) const;
+
+ private:
+  const std::chrono::nanoseconds max_drain_duration_;
+  double sample_ratio_ = 1.0;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
+
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using std::chrono_literals::operator""ms;
+
+constexpr std::chrono::nanoseconds kMaxDrain = 100ms;
+
+struct conn_id_t ConnID(int i) {
+  struct conn_id_t conn_id = {};
+  conn_id.upid.pid = 123;
+  conn_id.upid.start_time_ticks = 456;
+  conn_id.fd = i;
+  conn_id.tsid = 1000 + i;
+  return conn_id;
+}
+
+int NumTraced(const LoadShedder& shedder, int num_conns) {
+  int num_traced = 0;
+  for (int i = 0; i < num_conns; ++i) {
+    num_traced += shedder.ShouldTrace(ConnID(i));
+  }
+  return num_traced;
+}
+
+TEST(LoadShedderTest, TracesEverythingWithoutOverload) {
+  LoadShedder shedder(kMaxDrain);
+  shedder.Update(/*num_lost_events*/ 0, 10ms);
+  EXPECT_EQ(shedder.sample_ratio(), 1.0);
+  EXPECT_EQ(NumTraced(shedder, 1000), 1000);
+}
+
+TEST(LoadShedderTest, ShedsOnLossAndSlowDrain) {
+  LoadShedder shedder(kMaxDrain);
+
+  shedder.Update(/*num_lost_events*/ 10, 10ms);
+  EXPECT_EQ(shedder.sample_ratio(), 0.5);
+
+  shedder.Update(/*num_lost_events*/ 0, 200ms);
+  EXPECT_EQ(shedder.sample_ratio(), 0.25);
+
+  for (int i = 0; i < 100; ++i) {
+    shedder.Update(/*num_lost_events*/ 10, 10ms);
+  }
+  EXPECT_EQ(shedder.sample_ratio(), LoadShedder::kMinSampleRatio);
+}
+
+TEST(LoadShedderTest, Recovers) {
+  LoadShedder shedder(kMaxDrain);
+  shedder.Update(/*num_lost_events*/ 10, 10ms);
+  shedder.Update(/*num_lost_events*/ 0, 10ms);
+  EXPECT_EQ(shedder.sample_ratio(), 0.5 + LoadShedder::kRecoveryStep);
+
+  for (int i = 0; i < 100; ++i) {
+    shedder.Update(/*num_lost_events*/ 0, 10ms);
+  }
+  EXPECT_EQ(shedder.sample_ratio(), 1.0);
+}
+
+TEST(LoadShedderTest, DecisionsAreNestedAndProportional) {
+  constexpr int kNumConns = 10000;
+  LoadShedder shedder(kMaxDrain);
+
+  shedder.Update(/*num_lost_events*/ 10, 10ms);
+  std::vector<bool> traced_at_half;
+  for (int i = 0; i < kNumConns; ++i) {
+    traced_at_half.push_back(shedder.ShouldTrace(ConnID(i)));
+  }
+  EXPECT_NEAR(NumTraced(shedder, kNumConns), kNumConns / 2, kNumConns / 20);
+
+  // Shedding more only stops tracing connections that were traced before.
+  shedder.Update(/*num_lost_events*/ 10, 10ms);
+  EXPECT_NEAR(NumTraced(shedder, kNumConns), kNumConns / 4, kNumConns / 20);
+  for (int i = 0; i < kNumConns; ++i) {
+    if (shedder.ShouldTrace(ConnID(i))) {
+      EXPECT_TRUE(traced_at_half[i]);
+    }
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
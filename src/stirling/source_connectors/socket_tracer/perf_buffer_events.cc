@@ -0,0 +1,241 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/perf_buffer_events.h"
+
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+void ConnIDToPB(const conn_id_t& conn_id, sockeventpb::ConnID* pb) {
+  pb->set_pid(conn_id.upid.pid);
+  pb->set_start_time_ns(conn_id.upid.start_time_ticks);
+  pb->set_fd(conn_id.fd);
+  pb->set_generation(conn_id.tsid);
+}
+
+conn_id_t ConnIDFromPB(const sockeventpb::ConnID& pb) {
+  conn_id_t conn_id = {};
+  conn_id.upid.pid = pb.pid();
+  conn_id.upid.start_time_ticks = pb.start_time_ns();
+  conn_id.fd = pb.fd();
+  conn_id.tsid = pb.generation();
+  return conn_id;
+}
+
+void SockAddrFromPB(const std::string& bytes, sockaddr_t* addr) {
+  std::memcpy(addr, bytes.data(), std::min(bytes.size(), sizeof(sockaddr_t)));
+}
+
+}  // namespace
+
+void SocketDataEventToPB(const SocketDataEvent& event, sockeventpb::SocketDataEvent* pb) {
+  pb->mutable_attr()->set_timestamp_ns(event.attr.timestamp_ns);
+  ConnIDToPB(event.attr.conn_id, pb->mutable_attr()->mutable_conn_id());
+  pb->mutable_attr()->set_protocol(event.attr.protocol);
+  pb->mutable_attr()->set_role(event.attr.role);
+  pb->mutable_attr()->set_direction(event.attr.direction);
+  pb->mutable_attr()->set_pos(event.attr.pos);
+  pb->mutable_attr()->set_msg_size(event.attr.msg_size);
+  pb->mutable_attr()->set_ssl(event.attr.ssl);
+  pb->mutable_attr()->set_source_fn(event.attr.source_fn);
+  pb->set_msg(event.msg);
+}
+
+void SocketControlEventToPB(const socket_control_event_t& event,
+                            sockeventpb::SocketControlEvent* pb) {
+  pb->set_type(event.type);
+  pb->set_timestamp_ns(event.timestamp_ns);
+  ConnIDToPB(event.conn_id, pb->mutable_conn_id());
+  switch (event.type) {
+    case kConnOpen:
+      pb->set_addr(&event.open.addr, sizeof(event.open.addr));
+      pb->set_role(event.open.role);
+      break;
+    case kConnClose:
+      pb->set_wr_bytes(event.close.wr_bytes);
+      pb->set_rd_bytes(event.close.rd_bytes);
+      break;
+  }
+}
+
+void ConnStatsEventToPB(const conn_stats_event_t& event, sockeventpb::ConnStatsEvent* pb) {
+  pb->set_timestamp_ns(event.timestamp_ns);
+  ConnIDToPB(event.conn_id, pb->mutable_conn_id());
+  pb->set_addr(&event.addr, sizeof(event.addr));
+  pb->set_role(event.role);
+  pb->set_wr_bytes(event.wr_bytes);
+  pb->set_rd_bytes(event.rd_bytes);
+  pb->set_conn_events(event.conn_events);
+}
+
+void HTTP2HeaderEventToPB(const HTTP2HeaderEvent& event, sockeventpb::HTTP2HeaderEvent* pb) {
+  pb->mutable_attr()->set_probe_type(event.attr.probe_type);
+  pb->mutable_attr()->set_type(event.attr.type);
+  pb->mutable_attr()->set_timestamp_ns(event.attr.timestamp_ns);
+  ConnIDToPB(event.attr.conn_id, pb->mutable_attr()->mutable_conn_id());
+  pb->mutable_attr()->set_stream_id(event.attr.stream_id);
+  pb->mutable_attr()->set_end_stream(event.attr.end_stream);
+  pb->set_name(event.name);
+  pb->set_value(event.value);
+}
+
+void HTTP2DataEventToPB(const HTTP2DataEvent& event, sockeventpb::HTTP2DataEvent* pb) {
+  pb->mutable_attr()->set_probe_type(event.attr.probe_type);
+  pb->mutable_attr()->set_type(event.attr.type);
+  pb->mutable_attr()->set_timestamp_ns(event.attr.timestamp_ns);
+  ConnIDToPB(event.attr.conn_id, pb->mutable_attr()->mutable_conn_id());
+  pb->mutable_attr()->set_stream_id(event.attr.stream_id);
+  pb->mutable_attr()->set_end_stream(event.attr.end_stream);
+  pb->mutable_attr()->set_pos(event.attr.pos);
+  pb->mutable_attr()->set_data_size(event.attr.data_size);
+  pb->set_payload(event.payload);
+}
+
+std::unique_ptr<SocketDataEvent> SocketDataEventFromPB(const sockeventpb::SocketDataEvent& pb) {
+  auto event = std::make_unique<SocketDataEvent>();
+  const auto& attr = pb.attr();
+  event->attr.timestamp_ns = attr.timestamp_ns();
+  event->attr.conn_id = ConnIDFromPB(attr.conn_id());
+  event->attr.protocol = static_cast<traffic_protocol_t>(attr.protocol());
+  event->attr.role = static_cast<endpoint_role_t>(attr.role());
+  event->attr.direction = static_cast<traffic_direction_t>(attr.direction());
+  event->attr.ssl = attr.ssl();
+  event->attr.source_fn = static_cast<source_function_t>(attr.source_fn());
+  event->attr.pos = attr.pos();
+  event->attr.msg_size = attr.msg_size();
+  // The recorded msg already has the length header prepended and the filler appended, which
+  // SocketDataEvent adds when it is created from the raw perf buffer data.
+  event->msg = pb.msg();
+  event->attr.msg_buf_size = event->msg.size();
+  return event;
+}
+
+socket_control_event_t SocketControlEventFromPB(const sockeventpb::SocketControlEvent& pb) {
+  socket_control_event_t event = {};
+  event.type = static_cast<control_event_type_t>(pb.type());
+  event.timestamp_ns = pb.timestamp_ns();
+  event.conn_id = ConnIDFromPB(pb.conn_id());
+  switch (event.type) {
+    case kConnOpen:
+      SockAddrFromPB(pb.addr(), &event.open.addr);
+      event.open.role = static_cast<endpoint_role_t>(pb.role());
+      break;
+    case kConnClose:
+      event.close.wr_bytes = pb.wr_bytes();
+      event.close.rd_bytes = pb.rd_bytes();
+      break;
+  }
+  return event;
+}
+
+conn_stats_event_t ConnStatsEventFromPB(const sockeventpb::ConnStatsEvent& pb) {
+  conn_stats_event_t event = {};
+  event.timestamp_ns = pb.timestamp_ns();
+  event.conn_id = ConnIDFromPB(pb.conn_id());
+  SockAddrFromPB(pb.addr(), &event.addr);
+  event.role = static_cast<endpoint_role_t>(pb.role());
+  event.wr_bytes = pb.wr_bytes();
+  event.rd_bytes = pb.rd_bytes();
+  event.conn_events = pb.conn_events();
+  return event;
+}
+
+std::unique_ptr<HTTP2HeaderEvent> HTTP2HeaderEventFromPB(const sockeventpb::HTTP2HeaderEvent& pb) {
+  auto event = std::make_unique<HTTP2HeaderEvent>();
+  const auto& attr = pb.attr();
+  event->attr.probe_type = static_cast<http2_probe_type_t>(attr.probe_type());
+  event->attr.type = static_cast<HeaderEventType>(attr.type());
+  event->attr.timestamp_ns = attr.timestamp_ns();
+  event->attr.conn_id = ConnIDFromPB(attr.conn_id());
+  event->attr.stream_id = attr.stream_id();
+  event->attr.end_stream = attr.end_stream();
+  event->name = pb.name();
+  event->value = pb.value();
+  return event;
+}
+
+std::unique_ptr<HTTP2DataEvent> HTTP2DataEventFromPB(const sockeventpb::HTTP2DataEvent& pb) {
+  auto event = std::make_unique<HTTP2DataEvent>();
+  const auto& attr = pb.attr();
+  event->attr.probe_type = static_cast<http2_probe_type_t>(attr.probe_type());
+  event->attr.type = static_cast<DataFrameEventType>(attr.type());
+  event->attr.timestamp_ns = attr.timestamp_ns();
+  event->attr.conn_id = ConnIDFromPB(attr.conn_id());
+  event->attr.stream_id = attr.stream_id();
+  event->attr.end_stream = attr.end_stream();
+  event->attr.pos = attr.pos();
+  event->attr.data_size = attr.data_size();
+  event->payload = pb.payload();
+  event->attr.data_buf_size = event->payload.size();
+  return event;
+}
+
+uint64_t PerfBufferEventTimestamp(const sockeventpb::PerfBufferEvent& event) {
+  switch (event.event_case()) {
+    case sockeventpb::PerfBufferEvent::kDataEvent:
+      return event.data_event().attr().timestamp_ns();
+    case sockeventpb::PerfBufferEvent::kControlEvent:
+      return event.control_event().timestamp_ns();
+    case sockeventpb::PerfBufferEvent::kConnStatsEvent:
+      return event.conn_stats_event().timestamp_ns();
+    case sockeventpb::PerfBufferEvent::kHttp2HeaderEvent:
+      return event.http2_header_event().attr().timestamp_ns();
+    case sockeventpb::PerfBufferEvent::kHttp2DataEvent:
+      return event.http2_data_event().attr().timestamp_ns();
+    default:
+      return 0;
+  }
+}
+
+StatusOr<std::vector<sockeventpb::PerfBufferEvent>> ReadPerfBufferEvents(
+    const std::filesystem::path& path) {
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs.is_open()) {
+    return error::NotFound("Could not open perf buffer events capture $0", path.string());
+  }
+  google::protobuf::io::IstreamInputStream input(&ifs);
+
+  std::vector<sockeventpb::PerfBufferEvent> events;
+  while (true) {
+    sockeventpb::PerfBufferEvent event;
+    bool clean_eof = false;
+    if (!google::protobuf::util::ParseDelimitedFromZeroCopyStream(&event, &input, &clean_eof)) {
+      if (clean_eof) {
+        break;
+      }
+      return error::InvalidArgument("Malformed event #$0 in perf buffer events capture $1",
+                                    events.size(), path.string());
+    }
+    events.push_back(std::move(event));
+  }
+  return events;
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+
+namespace px {
+namespace stirling {
+
+// Conversions between the events received from the perf buffers and their protobuf form, which
+// is used to record them with --perf_buffer_events_output_path and to replay the recordings.
+
+void SocketDataEventToPB(const SocketDataEvent& event, sockeventpb::SocketDataEvent* pb);
+void SocketControlEventToPB(const socket_control_event_t& event,
+                            sockeventpb::SocketControlEvent* pb);
+void ConnStatsEventToPB(const conn_stats_event_t& event, sockeventpb::ConnStatsEvent* pb);
+void HTTP2HeaderEventToPB(const HTTP2HeaderEvent& event, sockeventpb::HTTP2HeaderEvent* pb);
+void HTTP2DataEventToPB(const HTTP2DataEvent& event, sockeventpb::HTTP2DataEvent* pb);
+
+std::unique_ptr<SocketDataEvent> SocketDataEventFromPB(const sockeventpb::SocketDataEvent& pb);
+socket_control_event_t SocketControlEventFromPB(const sockeventpb::SocketControlEvent& pb);
+conn_stats_event_t ConnStatsEventFromPB(const sockeventpb::ConnStatsEvent& pb);
+std::unique_ptr<HTTP2HeaderEvent> HTTP2HeaderEventFromPB(const sockeventpb::HTTP2HeaderEvent& pb);
+std::unique_ptr<HTTP2DataEvent> HTTP2DataEventFromPB(const sockeventpb::HTTP2DataEvent& pb);
+
+/**
+ * Returns the timestamp of the event, in the monotonic clock of the host it was recorded on.
+ */
+uint64_t PerfBufferEventTimestamp(const sockeventpb::PerfBufferEvent& event);
+
+/**
+ * Reads all the events of a capture recorded in the binary format, i.e. with a
+ * --perf_buffer_events_output_path ending in ".bin". The text format is only meant for reading.
+ */
+StatusOr<std::vector<sockeventpb::PerfBufferEvent>> ReadPerfBufferEvents(
+    const std::filesystem::path& path);
+
+}  // namespace stirling
+}  // namespace px
@@ -27,6 +27,14 @@
 
 #include "src/common/base/base.h"
 
+DEFINE_bool(stirling_data_stream_buffer_segmented,
+            gflags::BoolFromEnv("PL_STIRLING_DATA_STREAM_BUFFER_SEGMENTED", false),
+            "If true, data stream buffers store data in pooled fixed-size segments instead of one "
+            "contiguous buffer, which avoids moving the buffered data as it is consumed.");
+DEFINE_uint32(stirling_data_stream_buffer_segment_size,
+              gflags::Uint32FromEnv("PL_STIRLING_DATA_STREAM_BUFFER_SEGMENT_SIZE", 16 * 1024),
+              "The size of the segments used with --stirling_data_stream_buffer_segmented.");
+
 namespace px {
 namespace stirling {
 namespace protocols {
@@ -47,8 +55,49 @@ typename TMapType::const_iterator MapLE(const TMapType& map, size_t key) {
 
 }  // namespace
 
+DataStreamBuffer::DataStreamBuffer(size_t max_capacity) : capacity_(max_capacity) {
+  if (FLAGS_stirling_data_stream_buffer_segmented) {
+    segmented_buffer_ =
+        std::make_unique<SegmentedBuffer>(FLAGS_stirling_data_stream_buffer_segment_size);
+  }
+}
+
+void DataStreamBuffer::ExtendBuffer(size_t new_size) {
+  if (segmented_buffer_ != nullptr) {
+    segmented_buffer_->Extend(new_size);
+  } else {
+    buffer_.resize(new_size);
+  }
+}
+
+void DataStreamBuffer::WriteBuffer(size_t ppos, std::string_view data) {
+  if (segmented_buffer_ != nullptr) {
+    segmented_buffer_->Write(ppos, data);
+  } else {
+    memcpy(buffer_.data() + ppos, data.data(), data.size());
+  }
+}
+
+std::string_view DataStreamBuffer::BufferView(size_t ppos, size_t len) const {
+  if (segmented_buffer_ != nullptr) {
+    return segmented_buffer_->View(ppos, len);
+  }
+  return std::string_view(buffer_.data() + ppos, len);
+}
+
+void DataStreamBuffer::EraseBufferPrefix(size_t n) {
+  if (segmented_buffer_ != nullptr) {
+    segmented_buffer_->RemovePrefix(n);
+  } else {
+    buffer_.erase(0, n);
+  }
+}
+
 void DataStreamBuffer::Reset() {
   buffer_.clear();
+  if (segmented_buffer_ != nullptr) {
+    segmented_buffer_->Clear();
+  }
   chunks_.clear();
   timestamps_.clear();
   position_ = 0;
@@ -137,7 +186,7 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
     data.remove_prefix(prefix);
     pos += prefix;
     ppos_front = 0;
-  } else if (ppos_back > static_cast<ssize_t>(buffer_.size())) {
+  } else if (ppos_back > static_cast<ssize_t>(size())) {
     // Case 3: Data being added extends the buffer. Resize the buffer.
 
     if (pos > position_ + capacity_) {
@@ -167,13 +216,13 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
     DCHECK_GE(ppos_back, 0);
     DCHECK_LE(ppos_back, capacity_);
 
-    ssize_t extension = ppos_back - buffer_.size();
+    ssize_t extension = ppos_back - size();
     DCHECK_GE(extension, 0);
     DCHECK_LE(extension, capacity_);
 
-    buffer_.resize(buffer_.size() + extension);
-    DCHECK_GE(buffer_.size(), 0);
-    DCHECK_LE(buffer_.size(), capacity_);
+    ExtendBuffer(size() + extension);
+    DCHECK_GE(size(), 0);
+    DCHECK_LE(size(), capacity_);
   } else {
     // Case 4: Data being added is completely within the buffer. Write it directly.
 
@@ -181,7 +230,7 @@ void DataStreamBuffer::Add(size_t pos, std::string_view data, uint64_t timestamp
   }
 
   // Now copy the data into the buffer.
-  memcpy(buffer_.data() + ppos_front, data.data(), data.size());
+  WriteBuffer(ppos_front, data);
 
   // Update the metadata.
   AddNewChunk(pos, data.size());
@@ -220,8 +269,8 @@ std::string_view DataStreamBuffer::Get(size_t pos) const {
 
   DCHECK_GE(pos, position_);
   size_t ppos = pos - position_;
-  DCHECK_LT(ppos, buffer_.size());
-  return std::string_view(buffer_.data() + ppos, bytes_available);
+  DCHECK_LT(ppos, size());
+  return BufferView(ppos, bytes_available);
 }
 
 StatusOr<uint64_t> DataStreamBuffer::GetTimestamp(size_t pos) const {
@@ -306,7 +355,7 @@ void DataStreamBuffer::RemovePrefix(ssize_t n) {
     return;
   }
 
-  buffer_.erase(0, n);
+  EraseBufferPrefix(n);
   position_ += n;
 
   CleanupMetadata();
@@ -321,7 +370,7 @@ void DataStreamBuffer::Trim() {
   DCHECK_GE(chunk_pos, position_);
   size_t trim_size = chunk_pos - position_;
 
-  buffer_.erase(0, trim_size);
+  EraseBufferPrefix(trim_size);
   position_ += trim_size;
 }
 
@@ -329,7 +378,7 @@ std::string DataStreamBuffer::DebugInfo() const {
   std::string s;
 
   absl::StrAppend(&s, absl::Substitute("Position: $0\n", position_));
-  absl::StrAppend(&s, absl::Substitute("BufferSize: $0/$1\n", buffer_.size(), capacity_));
+  absl::StrAppend(&s, absl::Substitute("BufferSize: $0/$1\n", size(), capacity_));
   absl::StrAppend(&s, "Chunks:\n");
   for (const auto& [pos, size] : chunks_) {
     absl::StrAppend(&s, absl::Substitute("  position:$0 size:$1\n", pos, size));
@@ -338,7 +387,7 @@ std::string DataStreamBuffer::DebugInfo() const {
   for (const auto& [pos, timestamp] : timestamps_) {
     absl::StrAppend(&s, absl::Substitute("  position:$0 timestamp:$1\n", pos, timestamp));
   }
-  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n", buffer_));
+  absl::StrAppend(&s, absl::Substitute("Buffer: $0\n", BufferView(0, size())));
 
   return s;
 }
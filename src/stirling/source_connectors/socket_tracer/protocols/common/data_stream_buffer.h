@@ -19,9 +19,14 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <string>
 
 #include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/segmented_buffer.h"
+
+DECLARE_bool(stirling_data_stream_buffer_segmented);
+DECLARE_uint32(stirling_data_stream_buffer_segment_size);
 
 namespace px {
 namespace stirling {
@@ -40,12 +45,16 @@ namespace protocols {
  * DataStreamBuffer supports data arriving out-of-order such that they are slotted into the middle
  * of the buffer.
  *
- * The underlying implementation is currently a simple string buffer, but this could be changed
- * in the future, as long as the data is maintained in a contiguous buffer.
+ * The data is stored either in a simple string buffer, or, with
+ * --stirling_data_stream_buffer_segmented, in a SegmentedBuffer of pooled fixed-size segments.
+ * The string buffer must move all remaining data when a prefix is removed or when it reallocates
+ * to grow. The segmented buffer releases whole segments as the data is consumed, and moves data
+ * to a contiguous block at its head once it is read across segments, which is then compacted
+ * lazily.
  */
 class DataStreamBuffer {
  public:
-  explicit DataStreamBuffer(size_t max_capacity) : capacity_(max_capacity) {}
+  explicit DataStreamBuffer(size_t max_capacity);
 
   /**
    * Adds data to the buffer at the specified logical position.
@@ -60,6 +69,8 @@ class DataStreamBuffer {
 
   /**
    * Get all the contiguous data at the specified position of the buffer.
+   * The view is invalidated by any change to the buffer. With the segmented buffer, it is also
+   * invalidated by another Get().
    * @param pos The logical position of the requested data.
    * @return A string_view to the data.
    */
@@ -95,12 +106,12 @@ class DataStreamBuffer {
   /**
    * Current size of the internal buffer. Not all bytes may be populated.
    */
-  size_t size() const { return buffer_.size(); }
+  size_t size() const { return segmented_buffer_ ? segmented_buffer_->size() : buffer_.size(); }
 
   /**
    * Return true if the buffer is empty.
    */
-  bool empty() const { return buffer_.empty(); }
+  bool empty() const { return size() == 0; }
 
   /**
    * Logical position of the head of the buffer.
@@ -126,16 +137,25 @@ class DataStreamBuffer {
   // Umbrella that calls CleanupTimestamps and CleanupChunks.
   void CleanupMetadata();
 
+  // Operations on the underlying storage, which is either buffer_ or segmented_buffer_.
+  // Positions are physical positions, i.e. relative to position_.
+  void ExtendBuffer(size_t new_size);
+  void WriteBuffer(size_t ppos, std::string_view data);
+  std::string_view BufferView(size_t ppos, size_t len) const;
+  void EraseBufferPrefix(size_t n);
+
   const size_t capacity_;
 
   // Logical position of data stream buffer.
   // In other words, the position of buffer_[0].
   size_t position_ = 0;
 
-  // Buffer where all data is stored.
-  // TODO(oazizi): Investigate buffer that is better suited to the rolling buffer (slinky) model.
+  // Buffer where all data is stored, unless segmented_buffer_ is set.
   std::string buffer_;
 
+  // Buffer better suited to the rolling buffer (slinky) model. Used instead of buffer_ if set.
+  std::unique_ptr<SegmentedBuffer> segmented_buffer_;
+
   // Map of chunk start positions to chunk sizes.
   // A chunk is a contiguous sequence of bytes.
   // Adjacent chunks are always fused, so a chunk either ends at a gap or the end of the buffer.
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
+
+// Benchmarks DataStreamBuffer with its contiguous (arg 0 = 0) and segmented (arg 0 = 1) storage.
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+namespace {
+
+constexpr size_t kCapacity = 1024 * 1024;
+
+std::string RandomData(size_t size) {
+  std::mt19937 rng(37);
+  std::string data(size, '\0');
+  for (auto& c : data) {
+    c = 'a' + rng() % 26;
+  }
+  return data;
+}
+
+DataStreamBuffer CreateBuffer(bool segmented) {
+  FLAGS_stirling_data_stream_buffer_segmented = segmented;
+  DataStreamBuffer buffer(kCapacity);
+  FLAGS_stirling_data_stream_buffer_segmented = false;
+  return buffer;
+}
+
+}  // namespace
+
+// A connection streaming large messages: events arrive with neighbouring pairs swapped, and every
+// few events a parser consumes all complete messages, leaving the partial one at the tail.
+// Args: {segmented, event size}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_StreamOutOfOrder(benchmark::State& state) {
+  const bool segmented = state.range(0);
+  const size_t event_size = state.range(1);
+  constexpr int kEventsPerParse = 8;
+  const size_t message_size = 3 * event_size;
+
+  const std::string data = RandomData(event_size);
+  DataStreamBuffer buffer = CreateBuffer(segmented);
+
+  size_t pos = 0;
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kEventsPerParse; i += 2) {
+      buffer.Add(pos + event_size, data, pos + event_size);
+      buffer.Add(pos, data, pos);
+      pos += 2 * event_size;
+    }
+
+    std::string_view head = buffer.Head();
+    benchmark::DoNotOptimize(head.data());
+    buffer.RemovePrefix(head.size() - head.size() % message_size);
+    bytes += kEventsPerParse * event_size;
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+// A parser consuming many small frames from a large backlog, one RemovePrefix() per frame.
+// Args: {segmented, frame size}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RemovePrefixFrames(benchmark::State& state) {
+  const bool segmented = state.range(0);
+  const size_t frame_size = state.range(1);
+  constexpr size_t kBacklogSize = 512 * 1024;
+
+  const std::string data = RandomData(kBacklogSize);
+
+  int64_t bytes = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    DataStreamBuffer buffer = CreateBuffer(segmented);
+    buffer.Add(0, data, 0);
+    state.ResumeTiming();
+
+    while (buffer.Head().size() >= frame_size) {
+      benchmark::DoNotOptimize(buffer.Head().substr(0, frame_size));
+      buffer.RemovePrefix(frame_size);
+    }
+    bytes += kBacklogSize;
+  }
+  state.SetBytesProcessed(bytes);
+}
+
+BENCHMARK(BM_StreamOutOfOrder)->RangeMultiplier(16)->Ranges({{0, 1}, {1024, 64 * 1024}});
+BENCHMARK(BM_RemovePrefixFrames)->RangeMultiplier(32)->Ranges({{0, 1}, {128, 4096}});
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
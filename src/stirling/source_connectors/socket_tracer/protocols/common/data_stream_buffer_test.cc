@@ -18,13 +18,35 @@
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/data_stream_buffer.h"
 
+#include <random>
+#include <string>
+
 #include "src/common/testing/testing.h"
 
 namespace px {
 namespace stirling {
 namespace protocols {
 
-TEST(DataStreamTest, AddAndGet) {
+// Runs every test with both the contiguous and the segmented buffer. The segments are kept tiny
+// so that most of the data spans several of them.
+class DataStreamTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() override {
+    FLAGS_stirling_data_stream_buffer_segmented = GetParam();
+    FLAGS_stirling_data_stream_buffer_segment_size = 4;
+  }
+
+  void TearDown() override {
+    FLAGS_stirling_data_stream_buffer_segmented = false;
+    FLAGS_stirling_data_stream_buffer_segment_size = kDefaultSegmentSize;
+  }
+
+  const uint32_t kDefaultSegmentSize = FLAGS_stirling_data_stream_buffer_segment_size;
+};
+
+INSTANTIATE_TEST_SUITE_P(ContiguousAndSegmented, DataStreamTest, ::testing::Bool());
+
+TEST_P(DataStreamTest, AddAndGet) {
   DataStreamBuffer stream_buffer(15);
 
   // Initially everything should be empty.
@@ -121,7 +143,7 @@ TEST(DataStreamTest, AddAndGet) {
   EXPECT_EQ(stream_buffer.Get(131), "LMNOPQRSTUVWXYZ");
 }
 
-TEST(DataStreamTest, RemovePrefixAndTrim) {
+TEST_P(DataStreamTest, RemovePrefixAndTrim) {
   DataStreamBuffer stream_buffer(15);
 
   // Add some events with a gap.
@@ -175,7 +197,7 @@ TEST(DataStreamTest, RemovePrefixAndTrim) {
   EXPECT_EQ(stream_buffer.Head(), "abcd");
 }
 
-TEST(DataStreamTest, Timestamp) {
+TEST_P(DataStreamTest, Timestamp) {
   DataStreamBuffer stream_buffer(15);
 
   EXPECT_NOT_OK(stream_buffer.GetTimestamp(0));
@@ -193,7 +215,7 @@ TEST(DataStreamTest, Timestamp) {
   EXPECT_NOT_OK(stream_buffer.GetTimestamp(8));
 }
 
-TEST(DataStreamTest, TimestampWithGap) {
+TEST_P(DataStreamTest, TimestampWithGap) {
   DataStreamBuffer stream_buffer(15);
 
   stream_buffer.Add(0, "0123", 0);
@@ -225,7 +247,7 @@ TEST(DataStreamTest, TimestampWithGap) {
   EXPECT_OK_AND_EQ(stream_buffer.GetTimestamp(13), 10);
 }
 
-TEST(DataStreamTest, SizeAndGetPos) {
+TEST_P(DataStreamTest, SizeAndGetPos) {
   DataStreamBuffer stream_buffer(15);
 
   // Start off empty.
@@ -291,6 +313,86 @@ TEST(DataStreamTest, SizeAndGetPos) {
   EXPECT_FALSE(stream_buffer.empty());
 }
 
+TEST_P(DataStreamTest, GrowingHead) {
+  DataStreamBuffer stream_buffer(32);
+
+  stream_buffer.Add(0, "012", 0);
+  stream_buffer.Add(7, "789", 7);
+  EXPECT_EQ(stream_buffer.Head(), "012");
+
+  // Reads see the data filled in after an earlier read.
+  stream_buffer.Add(3, "3456", 3);
+  EXPECT_EQ(stream_buffer.Head(), "0123456789");
+  EXPECT_EQ(stream_buffer.Get(5), "56789");
+
+  stream_buffer.Add(10, "abcdef", 10);
+  EXPECT_EQ(stream_buffer.Head(), "0123456789abcdef");
+  stream_buffer.RemovePrefix(7);
+  EXPECT_EQ(stream_buffer.Head(), "789abcdef");
+  stream_buffer.Add(16, "ghijklmnopqrstuvwxyz", 16);
+  EXPECT_EQ(stream_buffer.Head(), "789abcdefghijklmnopqrstuvwxyz");
+  stream_buffer.RemovePrefix(0);
+  EXPECT_EQ(stream_buffer.Get(30), "uvwxyz");
+
+  stream_buffer.Reset();
+  EXPECT_TRUE(stream_buffer.empty());
+  EXPECT_EQ(stream_buffer.Head(), "");
+  stream_buffer.Add(0, "xyz", 0);
+  EXPECT_EQ(stream_buffer.Head(), "xyz");
+}
+
+// Feeds the same out-of-order events and removals to a contiguous and a segmented buffer, and
+// checks that they always present the same data.
+TEST(DataStreamBufferTest, SegmentedMatchesContiguous) {
+  constexpr size_t kCapacity = 1024;
+  FLAGS_stirling_data_stream_buffer_segmented = false;
+  DataStreamBuffer contiguous(kCapacity);
+  const uint32_t default_segment_size = FLAGS_stirling_data_stream_buffer_segment_size;
+  FLAGS_stirling_data_stream_buffer_segmented = true;
+  FLAGS_stirling_data_stream_buffer_segment_size = 64;
+  DataStreamBuffer segmented(kCapacity);
+  FLAGS_stirling_data_stream_buffer_segmented = false;
+  FLAGS_stirling_data_stream_buffer_segment_size = default_segment_size;
+
+  std::mt19937 rng(37);
+  std::string stream;
+  for (int i = 0; i < 20000; ++i) {
+    stream.push_back('a' + rng() % 26);
+  }
+
+  size_t next_pos = 0;
+  for (int i = 0; i < 5000 && next_pos < stream.size(); ++i) {
+    // Events arrive up to a few events out of order.
+    size_t size = 1 + rng() % 64;
+    size_t pos = next_pos + (rng() % 4 == 0 ? size * (rng() % 3) : 0);
+    if (pos + size > stream.size()) {
+      break;
+    }
+    if (pos == next_pos) {
+      next_pos += size;
+    }
+    std::string_view data = std::string_view(stream).substr(pos, size);
+    contiguous.Add(pos, data, pos);
+    segmented.Add(pos, data, pos);
+
+    ASSERT_EQ(contiguous.Head(), segmented.Head());
+    ASSERT_EQ(contiguous.position(), segmented.position());
+    ASSERT_EQ(contiguous.size(), segmented.size());
+
+    if (rng() % 3 == 0) {
+      size_t n = rng() % (contiguous.Head().size() + 1);
+      contiguous.RemovePrefix(n);
+      segmented.RemovePrefix(n);
+      ASSERT_EQ(contiguous.Head(), segmented.Head());
+    }
+    if (rng() % 16 == 0) {
+      contiguous.Trim();
+      segmented.Trim();
+      ASSERT_EQ(contiguous.Head(), segmented.Head());
+    }
+  }
+}
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
@@ -22,6 +22,7 @@
 #include <map>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -91,17 +92,25 @@ struct ParseResult {
  * @param frames The container to which newly parsed frames are added.
  * @param resync If set to true, Parse will first search for the next frame boundary (even
  * if it is currently at a valid frame boundary).
+ * @param resume_state State about a partially received frame at the head of the buffer,
+ * for protocols that support it (see FrameResumeState).
  *
  * @return ParseResult with locations where parseable frames were found in the source buffer.
  */
-template <typename TFrameType, typename TStateType = NoState>
+template <typename TFrameType, typename TStateType = NoState,
+          typename TResumeStateType = typename FrameResumeState<TFrameType>::type>
 ParseResult ParseFrames(message_type_t type, const DataStreamBuffer& data_stream_buffer,
                         std::deque<TFrameType>* frames, bool resync = false,
-                        TStateType* state = nullptr) {
+                        TStateType* state = nullptr, TResumeStateType* resume_state = nullptr) {
   std::string_view buf = data_stream_buffer.Head();
 
   size_t start_pos = 0;
   if (resync) {
+    // The head frame is being skipped, so any progress on it is moot.
+    if (resume_state != nullptr) {
+      *resume_state = TResumeStateType();
+    }
+
     VLOG(2) << "Finding next frame boundary";
     // Since we've been asked to resync, we search from byte 1 to find a new boundary.
     // Don't want to stay at the same position.
@@ -122,7 +131,7 @@ ParseResult ParseFrames(message_type_t type, const DataStreamBuffer& data_stream
   const size_t prev_size = frames->size();
 
   // Parse and append new frames to the frames vector.
-  ParseResult result = ParseFramesLoop(type, buf, frames, state);
+  ParseResult result = ParseFramesLoop(type, buf, frames, state, resume_state);
 
   VLOG(1) << absl::Substitute("Parsed $0 new frames", frames->size() - prev_size);
 
@@ -152,13 +161,16 @@ ParseResult ParseFrames(message_type_t type, const DataStreamBuffer& data_stream
  * @param type The Type of frames to parse.
  * @param buf The raw bytes to parse
  * @param frames The output where the parsed frames will be placed.
+ * @param resume_state State about a partially received frame at the head of buf.
  *
  * @return ParseResult with locations where parseable frames were found in the source buffer.
  */
 // TODO(oazizi): Convert tests to use ParseFrames() instead of ParseFramesLoop().
-template <typename TFrameType, typename TStateType = NoState>
+template <typename TFrameType, typename TStateType = NoState,
+          typename TResumeStateType = typename FrameResumeState<TFrameType>::type>
 ParseResult ParseFramesLoop(message_type_t type, std::string_view buf,
-                            std::deque<TFrameType>* frames, TStateType* state = nullptr) {
+                            std::deque<TFrameType>* frames, TStateType* state = nullptr,
+                            TResumeStateType* resume_state = nullptr) {
   std::vector<StartEndPos> frame_positions;
   const size_t buf_size = buf.size();
   ParseState s = ParseState::kSuccess;
@@ -168,7 +180,11 @@ ParseResult ParseFramesLoop(message_type_t type, std::string_view buf,
   while (!buf.empty() && s != ParseState::kEOS) {
     TFrameType frame;
 
-    s = ParseFrame(type, &buf, &frame, state);
+    if constexpr (std::is_same_v<TResumeStateType, NoResumeState>) {
+      s = ParseFrame(type, &buf, &frame, state);
+    } else {
+      s = ParseFrame(type, &buf, &frame, state, resume_state);
+    }
 
     bool stop = false;
     bool push = false;
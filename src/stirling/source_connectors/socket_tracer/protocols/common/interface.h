@@ -75,6 +75,21 @@ struct NoState {
   std::monostate recv;
 };
 
+// Parsers may keep state about a frame that has only partially arrived, so that when more data
+// arrives, ParseFrame() resumes where it left off, instead of parsing the frame from its start
+// again. This keeps frames that arrive over many iterations (e.g. large HTTP bodies) from being
+// parsed in quadratic time.
+//
+// A protocol opts in by specializing FrameResumeState for its frame type, and implementing the
+// ParseFrame() overload that takes a resume state. The state is owned by the DataStream, which
+// resets it whenever the head of the stream moves to a different frame.
+struct NoResumeState {};
+
+template <typename TFrameType>
+struct FrameResumeState {
+  using type = NoResumeState;
+};
+
 // NOTE: FindFrameBoundary(), ParseFrame(), and StitchFrames() must be implemented per protocol.
 
 /**
@@ -106,6 +121,17 @@ template <typename TFrameType, typename TStateType = NoState>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, TFrameType* frame,
                       TStateType* state = nullptr);
 
+/**
+ * Same as above, for protocols that can resume the parsing of a partially received frame.
+ *
+ * @param resume_state State about the frame at the head of buf, kept from a previous call that
+ * returned ParseState::kNeedsMoreData. Must be reset by the parser in all other cases.
+ * May be nullptr, in which case the frame is parsed from its start.
+ */
+template <typename TFrameType, typename TStateType, typename TResumeStateType>
+ParseState ParseFrame(message_type_t type, std::string_view* buf, TFrameType* frame,
+                      TStateType* state, TResumeStateType* resume_state);
+
 /**
  * StitchFrames is the entry point of stitcher for all protocols. It loops through the responses,
  * matches them with the corresponding requests, and returns stitched request & response pairs.
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/segmented_buffer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+SegmentPool& SegmentPool::Global() {
+  static auto* pool = new SegmentPool();
+  return *pool;
+}
+
+std::unique_ptr<char[]> SegmentPool::Acquire(size_t segment_size) {
+  {
+    absl::MutexLock lock(&mutex_);
+    auto iter = free_segments_.find(segment_size);
+    if (iter != free_segments_.end() && !iter->second.empty()) {
+      std::unique_ptr<char[]> segment = std::move(iter->second.back());
+      iter->second.pop_back();
+      pooled_bytes_ -= segment_size;
+      return segment;
+    }
+  }
+  return std::unique_ptr<char[]>(new char[segment_size]);
+}
+
+void SegmentPool::Release(std::unique_ptr<char[]> segment, size_t segment_size) {
+  absl::MutexLock lock(&mutex_);
+  if (pooled_bytes_ + segment_size > kMaxPooledBytes) {
+    return;
+  }
+  free_segments_[segment_size].push_back(std::move(segment));
+  pooled_bytes_ += segment_size;
+}
+
+size_t SegmentPool::num_pooled(size_t segment_size) const {
+  absl::MutexLock lock(&mutex_);
+  auto iter = free_segments_.find(segment_size);
+  return iter == free_segments_.end() ? 0 : iter->second.size();
+}
+
+void SegmentedBuffer::Extend(size_t new_size) {
+  DCHECK_GE(new_size, size_);
+  if (segments_.empty() && block_is_tail_) {
+    block_.resize(block_head_ + new_size);
+  } else {
+    block_is_tail_ = false;
+    while (head_ + new_size - block_size() > segments_.size() * segment_size_) {
+      segments_.push_back(SegmentPool::Global().Acquire(segment_size_));
+    }
+  }
+  size_ = new_size;
+}
+
+void SegmentedBuffer::Write(size_t offset, std::string_view data) {
+  DCHECK_LE(offset + data.size(), size_);
+
+  if (offset < block_size()) {
+    size_t n = std::min(data.size(), block_size() - offset);
+    memcpy(block_.data() + block_head_ + offset, data.data(), n);
+    data.remove_prefix(n);
+    offset += n;
+  }
+
+  size_t seg_pos = head_ + offset - block_size();
+  while (!data.empty()) {
+    size_t seg_idx = seg_pos / segment_size_;
+    size_t seg_offset = seg_pos % segment_size_;
+    size_t n = std::min(data.size(), segment_size_ - seg_offset);
+    memcpy(segments_[seg_idx].get() + seg_offset, data.data(), n);
+    data.remove_prefix(n);
+    seg_pos += n;
+  }
+}
+
+void SegmentedBuffer::MoveSegmentsToBlock(size_t end) const {
+  if (block_size() == 0) {
+    block_.clear();
+    block_head_ = 0;
+  }
+  // Make room for the whole buffer at once, growing geometrically like append() would.
+  if (block_.capacity() < block_head_ + size_) {
+    block_.reserve(std::max(block_head_ + size_, 2 * block_.capacity()));
+  }
+  while (block_size() < end) {
+    DCHECK(!segments_.empty());
+    size_t n = std::min(segment_size_ - head_, size_ - block_size());
+    block_.append(segments_.front().get() + head_, n);
+    SegmentPool::Global().Release(std::move(segments_.front()), segment_size_);
+    segments_.pop_front();
+    head_ = 0;
+  }
+  block_is_tail_ = segments_.empty();
+}
+
+std::string_view SegmentedBuffer::View(size_t offset, size_t len) const {
+  DCHECK_LE(offset + len, size_);
+  if (len == 0) {
+    return {};
+  }
+
+  if (offset >= block_size()) {
+    // Fast path: the bytes are all in one segment.
+    size_t seg_pos = head_ + offset - block_size();
+    size_t seg_offset = seg_pos % segment_size_;
+    if (seg_offset + len <= segment_size_) {
+      return std::string_view(segments_[seg_pos / segment_size_].get() + seg_offset, len);
+    }
+  }
+
+  MoveSegmentsToBlock(offset + len);
+  return std::string_view(block_.data() + block_head_ + offset, len);
+}
+
+void SegmentedBuffer::RemovePrefix(size_t n) {
+  // Like std::string::erase(), removing more than the size empties the buffer.
+  n = std::min(n, size_);
+  if (n == 0) {
+    return;
+  }
+  size_ -= n;
+
+  if (block_size() > 0) {
+    size_t block_n = std::min(n, block_size());
+    block_head_ += block_n;
+    n -= block_n;
+    if (block_size() == 0) {
+      // Keep the allocation: a stream that was read across segments is likely to be again.
+      block_.clear();
+      block_head_ = 0;
+    } else if (2 * block_head_ > block_.size()) {
+      // Only compact once most of the block was removed, so that this is amortized over the bytes
+      // that were removed.
+      block_.erase(0, block_head_);
+      block_head_ = 0;
+    }
+  }
+
+  head_ += n;
+  while (head_ >= segment_size_ && !segments_.empty()) {
+    SegmentPool::Global().Release(std::move(segments_.front()), segment_size_);
+    segments_.pop_front();
+    head_ -= segment_size_;
+  }
+}
+
+void SegmentedBuffer::Clear() {
+  for (auto& segment : segments_) {
+    SegmentPool::Global().Release(std::move(segment), segment_size_);
+  }
+  segments_.clear();
+  head_ = 0;
+  block_.clear();
+  block_.shrink_to_fit();
+  block_head_ = 0;
+  block_is_tail_ = false;
+  size_ = 0;
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
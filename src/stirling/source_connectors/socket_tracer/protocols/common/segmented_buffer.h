@@ -0,0 +1,141 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * A process-wide free list of fixed-size segments, so that buffers growing and shrinking at
+ * their ends recycle memory instead of going back to the allocator for every segment.
+ */
+class SegmentPool {
+ public:
+  static SegmentPool& Global();
+
+  std::unique_ptr<char[]> Acquire(size_t segment_size);
+  void Release(std::unique_ptr<char[]> segment, size_t segment_size);
+
+  // Number of free segments of the specified size.
+  size_t num_pooled(size_t segment_size) const;
+
+ private:
+  // Upper bound on the memory held by free segments. Segments released beyond it are freed.
+  static constexpr size_t kMaxPooledBytes = 64 * 1024 * 1024;
+
+  mutable absl::Mutex mutex_;
+  size_t pooled_bytes_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Free segments, keyed by their size.
+  absl::flat_hash_map<size_t, std::vector<std::unique_ptr<char[]>>> free_segments_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+/**
+ * A byte buffer stored as a sequence of fixed-size segments, which supports the operations
+ * DataStreamBuffer needs from its backing store: extending at the tail, writing at any offset and
+ * removing a prefix. Removing a prefix only releases whole segments, and extending only adds
+ * segments, so neither moves the data that remains in the buffer.
+ *
+ * Reads that fall within one segment are served directly. A read that spans segments moves the
+ * segments it covers into a contiguous block at the head of the buffer. Later writes to those
+ * bytes go to the block directly, and while the block is the tail of the buffer, extending grows
+ * the block instead of adding segments. A stream that is read as it arrives is therefore copied
+ * once into the block, not once into the segments and again for every read. The block drops its
+ * consumed prefix lazily, once that is more than half of the block, and like the contiguous
+ * buffer of DataStreamBuffer, it keeps its allocation until Clear().
+ */
+class SegmentedBuffer {
+ public:
+  explicit SegmentedBuffer(size_t segment_size) : segment_size_(segment_size) {
+    DCHECK_GT(segment_size, 0U);
+  }
+
+  ~SegmentedBuffer() { Clear(); }
+
+  /**
+   * Grows the buffer to new_size bytes. The contents of the new bytes are unspecified.
+   */
+  void Extend(size_t new_size);
+
+  /**
+   * Copies data into the buffer at the specified offset. The buffer must already be large
+   * enough to hold the data.
+   */
+  void Write(size_t offset, std::string_view data);
+
+  /**
+   * Returns a contiguous view of len bytes at the specified offset. The view is valid until the
+   * next call to a non-const member function, or to View() for bytes that span segments.
+   */
+  std::string_view View(size_t offset, size_t len) const;
+
+  /**
+   * Removes n bytes from the head of the buffer, or all of them if n is larger than the size.
+   */
+  void RemovePrefix(size_t n);
+
+  void Clear();
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  size_t segment_size() const { return segment_size_; }
+  size_t num_segments() const { return segments_.size(); }
+
+  // Number of bytes at the head of the buffer that are stored in the contiguous block.
+  size_t block_size() const { return block_.size() - block_head_; }
+
+ private:
+  // Moves the segments that hold the first end bytes of the buffer into the block.
+  void MoveSegmentsToBlock(size_t end) const;
+
+  const size_t segment_size_;
+
+  // View() reorganizes the storage, without changing the contents of the buffer.
+
+  // Contiguous block holding the head of the buffer, starting at block_head_.
+  mutable std::string block_;
+  mutable size_t block_head_ = 0;
+
+  // Segments holding the rest of the buffer, after the block.
+  mutable std::deque<std::unique_ptr<char[]>> segments_;
+
+  // Offset of the first byte after the block within segments_.front(). Always 0 when the block is
+  // not empty.
+  mutable size_t head_ = 0;
+
+  // Whether the block holds the tail of the buffer, in which case Extend() grows the block.
+  mutable bool block_is_tail_ = false;
+
+  size_t size_ = 0;
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/segmented_buffer.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+TEST(SegmentedBufferTest, WriteAndView) {
+  SegmentedBuffer buffer(4);
+  EXPECT_TRUE(buffer.empty());
+
+  buffer.Extend(10);
+  EXPECT_EQ(buffer.size(), 10);
+  EXPECT_EQ(buffer.num_segments(), 3);
+
+  buffer.Write(0, "0123456789");
+  EXPECT_EQ(buffer.View(0, 10), "0123456789");
+  EXPECT_EQ(buffer.View(1, 2), "12");
+  EXPECT_EQ(buffer.View(3, 3), "345");
+  EXPECT_EQ(buffer.View(9, 1), "9");
+  EXPECT_EQ(buffer.View(4, 0), "");
+
+  // Writes to bytes that were moved to the block are visible in later views.
+  EXPECT_EQ(buffer.View(2, 8), "23456789");
+  EXPECT_EQ(buffer.num_segments(), 0);
+  EXPECT_EQ(buffer.block_size(), 10);
+  buffer.Write(5, "ab");
+  EXPECT_EQ(buffer.View(2, 8), "234ab789");
+  EXPECT_EQ(buffer.View(3, 5), "34ab7");
+}
+
+TEST(SegmentedBufferTest, ExtendAfterView) {
+  SegmentedBuffer buffer(4);
+  buffer.Extend(6);
+  buffer.Write(0, "012345");
+  EXPECT_EQ(buffer.View(0, 6), "012345");
+
+  // The block is the tail of the buffer, so it grows instead of adding segments.
+  buffer.Extend(12);
+  EXPECT_EQ(buffer.num_segments(), 0);
+  buffer.Write(6, "6789ab");
+  EXPECT_EQ(buffer.View(0, 12), "0123456789ab");
+  EXPECT_EQ(buffer.View(4, 8), "456789ab");
+
+  // So does a block that was consumed entirely.
+  buffer.RemovePrefix(12);
+  EXPECT_TRUE(buffer.empty());
+  buffer.Extend(5);
+  EXPECT_EQ(buffer.num_segments(), 0);
+  buffer.Write(0, "cdefg");
+  EXPECT_EQ(buffer.View(1, 4), "defg");
+}
+
+TEST(SegmentedBufferTest, ViewAfterBlock) {
+  SegmentedBuffer buffer(4);
+  buffer.Extend(10);
+  buffer.Write(0, "0123456789");
+  EXPECT_EQ(buffer.View(2, 3), "234");
+  EXPECT_EQ(buffer.block_size(), 8);
+  EXPECT_EQ(buffer.num_segments(), 1);
+
+  // Views after the block are served from the segments, or extend the block if they span them.
+  buffer.Extend(14);
+  buffer.Write(10, "abcd");
+  EXPECT_EQ(buffer.View(8, 4), "89ab");
+  EXPECT_EQ(buffer.block_size(), 8);
+  EXPECT_EQ(buffer.View(3, 8), "3456789a");
+  EXPECT_EQ(buffer.block_size(), 12);
+  EXPECT_EQ(buffer.num_segments(), 1);
+
+  // Removing part of the block leaves the rest of it, and the segments after it, in place.
+  buffer.RemovePrefix(4);
+  EXPECT_EQ(buffer.block_size(), 8);
+  EXPECT_EQ(buffer.View(8, 2), "cd");
+  buffer.RemovePrefix(9);
+  EXPECT_EQ(buffer.block_size(), 0);
+  EXPECT_EQ(buffer.View(0, 1), "d");
+}
+
+TEST(SegmentedBufferTest, RemovePrefix) {
+  SegmentedBuffer buffer(4);
+  buffer.Extend(10);
+  buffer.Write(0, "0123456789");
+
+  buffer.RemovePrefix(3);
+  EXPECT_EQ(buffer.size(), 7);
+  EXPECT_EQ(buffer.num_segments(), 3);
+  EXPECT_EQ(buffer.View(3, 1), "6");
+
+  // Only whole segments are released.
+  buffer.RemovePrefix(2);
+  EXPECT_EQ(buffer.num_segments(), 2);
+  EXPECT_EQ(buffer.View(0, 5), "56789");
+
+  buffer.Extend(9);
+  buffer.Write(5, "abcd");
+  EXPECT_EQ(buffer.View(0, 9), "56789abcd");
+
+  // Removing more than the size empties the buffer.
+  buffer.RemovePrefix(100);
+  EXPECT_TRUE(buffer.empty());
+  buffer.Extend(3);
+  buffer.Write(0, "xyz");
+  EXPECT_EQ(buffer.View(0, 3), "xyz");
+
+  buffer.Clear();
+  EXPECT_TRUE(buffer.empty());
+  EXPECT_EQ(buffer.num_segments(), 0);
+}
+
+TEST(SegmentPoolTest, Recycle) {
+  constexpr size_t kSegmentSize = 1024;
+  SegmentPool& pool = SegmentPool::Global();
+  size_t num_pooled = pool.num_pooled(kSegmentSize);
+  {
+    SegmentedBuffer buffer(kSegmentSize);
+    buffer.Extend(4 * kSegmentSize);
+    buffer.RemovePrefix(2 * kSegmentSize);
+    EXPECT_EQ(pool.num_pooled(kSegmentSize), num_pooled + 2);
+  }
+  EXPECT_EQ(pool.num_pooled(kSegmentSize), num_pooled + 4);
+
+  SegmentedBuffer buffer(kSegmentSize);
+  buffer.Extend(kSegmentSize);
+  EXPECT_EQ(pool.num_pooled(kSegmentSize), num_pooled + 3);
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
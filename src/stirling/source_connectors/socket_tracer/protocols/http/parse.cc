@@ -24,6 +24,21 @@
 #include <string>
 #include <utility>
 
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/pattern_matcher.h"
+
+#if defined(__x86_64__)
+// picohttpparser built with SSE4.2 enabled, and its functions renamed with an _sse42 suffix.
+// See bazel/external/picohttpparser.BUILD.
+extern "C" {
+int phr_parse_request_sse42(const char* buf, size_t len, const char** method, size_t* method_len,
+                            const char** path, size_t* path_len, int* minor_version,
+                            struct phr_header* headers, size_t* num_headers, size_t last_len);
+int phr_parse_response_sse42(const char* buf, size_t len, int* minor_version, int* status,
+                             const char** msg, size_t* msg_len, struct phr_header* headers,
+                             size_t* num_headers, size_t last_len);
+}
+#endif
+
 namespace px {
 namespace stirling {
 namespace protocols {
@@ -51,27 +66,65 @@ namespace pico_wrapper {
 
 namespace {
 
-// TODO(oazizi): ParseChunk makes a copy of the data. Consider finding a way
+// The SSE4.2 build of picohttpparser scans header bytes 16 at a time, but can only run on CPUs
+// that support it, so the build to use is picked at run-time.
+bool UseSSE42() {
+#if defined(__x86_64__)
+  static const bool kHasSSE42 = __builtin_cpu_supports("sse4.2");
+  return kHasSSE42;
+#else
+  return false;
+#endif
+}
+
+int PicoParseRequest(const char* buf, size_t len, const char** method, size_t* method_len,
+                     const char** path, size_t* path_len, int* minor_version,
+                     struct phr_header* headers, size_t* num_headers, size_t last_len) {
+#if defined(__x86_64__)
+  if (UseSSE42()) {
+    return phr_parse_request_sse42(buf, len, method, method_len, path, path_len, minor_version,
+                                   headers, num_headers, last_len);
+  }
+#endif
+  return phr_parse_request(buf, len, method, method_len, path, path_len, minor_version, headers,
+                           num_headers, last_len);
+}
+
+int PicoParseResponse(const char* buf, size_t len, int* minor_version, int* status,
+                      const char** msg, size_t* msg_len, struct phr_header* headers,
+                      size_t* num_headers, size_t last_len) {
+#if defined(__x86_64__)
+  if (UseSSE42()) {
+    return phr_parse_response_sse42(buf, len, minor_version, status, msg, msg_len, headers,
+                                    num_headers, last_len);
+  }
+#endif
+  return phr_parse_response(buf, len, minor_version, status, msg, msg_len, headers, num_headers,
+                            last_len);
+}
+
+// Decodes a chunked body, resuming from the decoder state saved by previous calls on the same
+// message, so that only the bytes that arrived since then are copied and decoded.
+//
+// TODO(oazizi): ParseChunk makes a copy of the new data. Consider finding a way
 //               to mutate the input buffer such that we can avoid this copy.
 //               phr_decode_chunked() already mutates the input buffer, but
 //               this needs to be done in a way that doesn't mess up the rest of
 //               the parsing, since there will be "unused" bytes at the end of the
 //               chunk, but before the rest of the data in the DataStreamBuffer.
-//               Note that the copy is not overhead when a complete message is found,
-//               since the data is std::moved to the result.
-ParseState ParseChunk(std::string_view* data, Message* result) {
-  phr_chunked_decoder chunk_decoder = {};
-  std::string data_copy(*data);
+ParseState ParseChunk(std::string_view* data, ResumeState* resume_state, Message* result) {
+  DCHECK_LE(resume_state->chunked_bytes_decoded, data->size());
+  std::string data_copy(data->substr(resume_state->chunked_bytes_decoded));
   char* buf = data_copy.data();
   size_t buf_size = data_copy.size();
-  ssize_t retval = phr_decode_chunked(&chunk_decoder, buf, &buf_size);
+  ssize_t retval = phr_decode_chunked(&resume_state->chunk_decoder, buf, &buf_size);
   if (retval == -1) {
     // Parse failed.
     return ParseState::kInvalid;
   } else if (retval >= 0) {
     // Complete message.
-    data_copy.resize(buf_size);
-    result->body = std::move(data_copy);
+    resume_state->chunked_body.append(buf, buf_size);
+    result->body = std::move(resume_state->chunked_body);
     // phr_decode_chunked rewrites the buffer in place, removing chunked-encoding headers.
     // So we cannot simply remove the prefix, but rather have to shorten the buffer too.
     // This is done via retval, which specifies how many unprocessed bytes are left.
@@ -82,7 +135,9 @@ ParseState ParseChunk(std::string_view* data, Message* result) {
     }
     return ParseState::kSuccess;
   } else if (retval == -2) {
-    // Incomplete message.
+    // Incomplete message. The decoder has consumed all the new data.
+    resume_state->chunked_body.append(buf, buf_size);
+    resume_state->chunked_bytes_decoded = data->size();
     return ParseState::kNeedsMoreData;
   }
   LOG(DFATAL) << "Unexpected retval from phr_decode_chunked()";
@@ -91,7 +146,7 @@ ParseState ParseChunk(std::string_view* data, Message* result) {
 
 }  // namespace
 
-ParseState ParseBody(std::string_view* buf, Message* result) {
+ParseState ParseBody(std::string_view* buf, ResumeState* resume_state, Message* result) {
   // Try to find boundary of message by looking at Content-Length and Transfer-Encoding.
 
   // From https://tools.ietf.org/html/rfc7230:
@@ -130,7 +185,7 @@ ParseState ParseBody(std::string_view* buf, Message* result) {
   const auto transfer_encoding_iter = result->headers.find(kTransferEncoding);
   if (transfer_encoding_iter != result->headers.end() &&
       transfer_encoding_iter->second == "chunked") {
-    return ParseChunk(buf, result);
+    return ParseChunk(buf, resume_state, result);
   }
 
   // Case 3: Message has content, but no Content-Length or Transfer-Encoding.
@@ -200,7 +255,8 @@ ParseState ParseBody(std::string_view* buf, Message* result) {
   return ParseState::kInvalid;
 }
 
-ParseState ParseRequest(std::string_view* buf, Message* result) {
+// Parses the request line and headers, and consumes them from buf.
+ParseState ParseRequestHeaders(std::string_view* buf, Message* result) {
   // Fields populated by phr_parse_response.
   const char* method = nullptr;
   size_t method_len;
@@ -215,8 +271,8 @@ ParseState ParseRequest(std::string_view* buf, Message* result) {
   size_t num_headers = kMaxNumHeaders;
 
   const int retval =
-      phr_parse_request(buf->data(), buf->size(), &method, &method_len, &path, &path_len,
-                        &minor_version, headers, &num_headers, /*last_len*/ 0);
+      PicoParseRequest(buf->data(), buf->size(), &method, &method_len, &path, &path_len,
+                       &minor_version, headers, &num_headers, /*last_len*/ 0);
   if (retval >= 0) {
     buf->remove_prefix(retval);
 
@@ -227,7 +283,7 @@ ParseState ParseRequest(std::string_view* buf, Message* result) {
     result->req_path = std::string(path, path_len);
     result->headers_byte_size = retval;
 
-    return ParseBody(buf, result);
+    return ParseState::kSuccess;
   }
   if (retval == -2) {
     return ParseState::kNeedsMoreData;
@@ -235,7 +291,8 @@ ParseState ParseRequest(std::string_view* buf, Message* result) {
   return ParseState::kInvalid;
 }
 
-ParseState ParseResponse(std::string_view* buf, Message* result) {
+// Parses the status line and headers, and consumes them from buf.
+ParseState ParseResponseHeaders(std::string_view* buf, Message* result) {
   // Fields populated by phr_parse_response.
   const char* msg = nullptr;
   size_t msg_len = 0;
@@ -247,8 +304,8 @@ ParseState ParseResponse(std::string_view* buf, Message* result) {
   // Set header number to maximum we can accept.
   // Pico will change it to the number of headers parsed for us.
   size_t num_headers = kMaxNumHeaders;
-  const int retval = phr_parse_response(buf->data(), buf->size(), &minor_version, &status, &msg,
-                                        &msg_len, headers, &num_headers, /*last_len*/ 0);
+  const int retval = PicoParseResponse(buf->data(), buf->size(), &minor_version, &status, &msg,
+                                       &msg_len, headers, &num_headers, /*last_len*/ 0);
   if (retval >= 0) {
     buf->remove_prefix(retval);
 
@@ -259,7 +316,7 @@ ParseState ParseResponse(std::string_view* buf, Message* result) {
     result->resp_message = std::string(msg, msg_len);
     result->headers_byte_size = retval;
 
-    return ParseBody(buf, result);
+    return ParseState::kSuccess;
   }
   if (retval == -2) {
     return ParseState::kNeedsMoreData;
@@ -276,18 +333,50 @@ ParseState ParseResponse(std::string_view* buf, Message* result) {
  * @param type: request or response
  * @param buf: The source buffer to parse. The prefix of this buffer will be consumed to indicate
  * the point until which the parse has progressed.
+ * @param resume_state: The progress made on the message at the head of buf by a previous call that
+ * returned kNeedsMoreData. It is updated if this call also returns kNeedsMoreData,
+ * and reset otherwise.
  * @param result: A parsed HTTP message, if parse was successful (must consider return value).
  * @return parse state indicating how the parse progressed.
  */
-ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* result) {
-  switch (type) {
-    case message_type_t::kRequest:
-      return pico_wrapper::ParseRequest(buf, result);
-    case message_type_t::kResponse:
-      return pico_wrapper::ParseResponse(buf, result);
-    default:
-      return ParseState::kInvalid;
+ParseState ParseFrame(message_type_t type, std::string_view* buf, ResumeState* resume_state,
+                      Message* result) {
+  std::string_view body_buf = *buf;
+
+  if (resume_state->headers_parsed) {
+    DCHECK_LE(resume_state->message.headers_byte_size, buf->size());
+    body_buf.remove_prefix(resume_state->message.headers_byte_size);
+  } else {
+    ParseState headers_state;
+    switch (type) {
+      case message_type_t::kRequest:
+        headers_state = pico_wrapper::ParseRequestHeaders(&body_buf, &resume_state->message);
+        break;
+      case message_type_t::kResponse:
+        headers_state = pico_wrapper::ParseResponseHeaders(&body_buf, &resume_state->message);
+        break;
+      default:
+        headers_state = ParseState::kInvalid;
+        break;
+    }
+    if (headers_state != ParseState::kSuccess) {
+      *resume_state = ResumeState();
+      return headers_state;
+    }
+    resume_state->headers_parsed = true;
+  }
+
+  ParseState body_state = pico_wrapper::ParseBody(&body_buf, resume_state, &resume_state->message);
+  if (body_state == ParseState::kNeedsMoreData) {
+    return body_state;
+  }
+
+  *buf = body_buf;
+  if (body_state == ParseState::kSuccess || body_state == ParseState::kEOS) {
+    *result = std::move(resume_state->message);
   }
+  *resume_state = ResumeState();
+  return body_state;
 }
 
 // TODO(oazizi/yzhao): This function should use is_http_{response,request} inside
@@ -306,21 +395,21 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   // https://developer.mozilla.org/en-US/docs/Web/HTTP/Messages
   static constexpr std::string_view kHTTPRespStartPatternArray[] = {"HTTP/1.1 ", "HTTP/1.0 "};
 
-  static constexpr ArrayView<std::string_view> kHTTPReqStartPatterns =
-      ArrayView<std::string_view>(kHTTPReqStartPatternArray);
-  static constexpr ArrayView<std::string_view> kHTTPRespStartPatterns =
-      ArrayView<std::string_view>(kHTTPRespStartPatternArray);
+  static const PatternMatcher kHTTPReqStartMatcher{
+      ArrayView<std::string_view>(kHTTPReqStartPatternArray)};
+  static const PatternMatcher kHTTPRespStartMatcher{
+      ArrayView<std::string_view>(kHTTPRespStartPatternArray)};
 
   static constexpr std::string_view kBoundaryMarker = "\r\n\r\n";
 
   // Choose the right set of patterns for request vs response.
-  const ArrayView<std::string_view>* start_patterns = nullptr;
+  const PatternMatcher* start_matcher = nullptr;
   switch (type) {
     case message_type_t::kRequest:
-      start_patterns = &kHTTPReqStartPatterns;
+      start_matcher = &kHTTPReqStartMatcher;
       break;
     case message_type_t::kResponse:
-      start_patterns = &kHTTPRespStartPatterns;
+      start_matcher = &kHTTPRespStartMatcher;
       break;
     case message_type_t::kUnknown:
       return std::string::npos;
@@ -346,17 +435,9 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
 
     std::string_view buf_substr = buf.substr(start_pos, marker_pos - start_pos);
 
-    size_t substr_pos = std::string::npos;
-    for (auto& start_pattern : *start_patterns) {
-      size_t current_substr_pos = buf_substr.rfind(start_pattern);
-      if (current_substr_pos != std::string::npos) {
-        // Found a match. Check if it is closer to the marker than our previous match.
-        // We want to return the match that is closest to the marker, so we aren't
-        // matching to something in a previous message's body.
-        substr_pos = (substr_pos == std::string::npos) ? current_substr_pos
-                                                       : std::max(substr_pos, current_substr_pos);
-      }
-    }
+    // We want the match that is closest to the marker, so we aren't
+    // matching to something in a previous message's body.
+    size_t substr_pos = start_matcher->RFind(buf_substr);
 
     if (substr_pos != std::string::npos) {
       return start_pos + substr_pos;
@@ -372,7 +453,17 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
 template <>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, http::Message* result,
                       NoState* /*state*/) {
-  return http::ParseFrame(type, buf, result);
+  http::ResumeState resume_state;
+  return http::ParseFrame(type, buf, &resume_state, result);
+}
+
+template <>
+ParseState ParseFrame(message_type_t type, std::string_view* buf, http::Message* result,
+                      NoState* state, http::ResumeState* resume_state) {
+  if (resume_state == nullptr) {
+    return ParseFrame(type, buf, result, state);
+  }
+  return http::ParseFrame(type, buf, resume_state, result);
 }
 
 template <>
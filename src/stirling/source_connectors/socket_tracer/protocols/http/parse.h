@@ -35,6 +35,14 @@ template <>
 ParseState ParseFrame(message_type_t type, std::string_view* buf, http::Message* frame,
                       NoState* state);
 
+/**
+ * Parses a single HTTP message from the input string, resuming from the progress saved in
+ * resume_state by a previous call that returned kNeedsMoreData.
+ */
+template <>
+ParseState ParseFrame(message_type_t type, std::string_view* buf, http::Message* frame,
+                      NoState* state, http::ResumeState* resume_state);
+
 template <>
 size_t FindFrameBoundary<http::Message>(message_type_t type, std::string_view buf, size_t start_pos,
                                         NoState* state);
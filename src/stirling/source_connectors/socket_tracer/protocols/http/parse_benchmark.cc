@@ -0,0 +1,192 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/pattern_matcher.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+namespace {
+
+// A mix of requests and responses, in the shapes seen on ingress traffic: small API calls with
+// browser-like headers, and responses with JSON, HTML and chunked bodies.
+constexpr std::string_view kRequests[] = {
+    "GET /api/v1/users/1234 HTTP/1.1\r\n"
+    "Host: frontend.default.svc.cluster.local\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko)\r\n"
+    "Accept: application/json, text/plain, */*\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Accept-Language: en-US,en;q=0.9\r\n"
+    "Cookie: session=8f2a9c1e4b7d; theme=dark\r\n"
+    "X-Request-Id: 5d1c0b7e-6f43-4c1e-9a2b-0c9e8d7f6a5b\r\n"
+    "\r\n",
+    "POST /api/v1/orders HTTP/1.1\r\n"
+    "Host: checkout.default.svc.cluster.local\r\n"
+    "Content-Type: application/json\r\n"
+    "Content-Length: 61\r\n"
+    "X-Forwarded-For: 10.8.0.12\r\n"
+    "\r\n"
+    "{\"user_id\": 1234, \"items\": [{\"sku\": \"A-100\", \"quantity\": 2}]}",
+};
+
+constexpr std::string_view kResponses[] = {
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/json; charset=utf-8\r\n"
+    "Content-Length: 48\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Date: Mon, 04 Jan 2021 18:20:00 GMT\r\n"
+    "\r\n"
+    "{\"id\": 1234, \"name\": \"Jane Doe\", \"active\": true}",
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/html\r\n"
+    "Transfer-Encoding: chunked\r\n"
+    "\r\n"
+    "1c\r\n<html><body>Hello</body></ht\r\n"
+    "4\r\nml>\n\r\n"
+    "0\r\n\r\n",
+    "HTTP/1.1 404 Not Found\r\n"
+    "Content-Type: text/plain\r\n"
+    "Content-Length: 9\r\n"
+    "\r\n"
+    "Not Found",
+};
+
+// Text that looks like a large body: words, with blank lines between paragraphs.
+std::string BodyText(size_t size) {
+  static constexpr std::string_view kWords[] = {"the ",   "quick ", "brown ",   "fox ",
+                                                "jumps ", "over ",  "Pixie ",   "TRACES ",
+                                                "HTTP ",  "GETS ",  "DELETED ", "POSTS "};
+  std::mt19937 rng(37);
+  std::string body;
+  while (body.size() < size) {
+    body.append(kWords[rng() % std::size(kWords)]);
+    if (rng() % 32 == 0) {
+      body.append("\r\n\r\n");
+    }
+  }
+  body.resize(size);
+  return body;
+}
+
+std::string MessageMix(ArrayView<std::string_view> messages, size_t size) {
+  std::string buf;
+  for (size_t i = 0; buf.size() < size; ++i) {
+    buf.append(messages[i % messages.size()]);
+  }
+  return buf;
+}
+
+}  // namespace
+
+// Parses a stream of requests, and a stream of responses, message by message.
+// Arg: {stream size}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ParseFrames(benchmark::State& state) {
+  const std::string requests = MessageMix(ArrayView<std::string_view>(kRequests), state.range(0));
+  const std::string responses =
+      MessageMix(ArrayView<std::string_view>(kResponses), state.range(0));
+
+  for (auto _ : state) {
+    for (auto [type, stream] : {std::make_pair(message_type_t::kRequest, &requests),
+                                std::make_pair(message_type_t::kResponse, &responses)}) {
+      std::string_view buf = *stream;
+      Message msg;
+      while (!buf.empty() &&
+             ParseFrame(type, &buf, &msg, /*state*/ nullptr) == ParseState::kSuccess) {
+        benchmark::DoNotOptimize(msg);
+      }
+    }
+  }
+  state.SetBytesProcessed(state.iterations() * (requests.size() + responses.size()));
+}
+
+// Resyncs on a response that follows the tail of a large text body, as after lost events.
+// Arg: {body size}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_FindFrameBoundary(benchmark::State& state) {
+  const std::string buf = BodyText(state.range(0)) + std::string(kResponses[0]);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        FindFrameBoundary<Message>(message_type_t::kResponse, buf, 0, /*state*/ nullptr));
+  }
+  state.SetBytesProcessed(state.iterations() * buf.size());
+}
+
+// The backwards search for request methods that FindFrameBoundary() runs between markers.
+// Args: {text size, implementation: 0 = rfind() per method, 1 = scalar, 2 = vectorized}.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_RFindMethod(benchmark::State& state) {
+  static constexpr std::string_view kMethods[] = {
+      "GET ", "HEAD ", "POST ", "PUT ", "DELETE ", "CONNECT ", "OPTIONS ", "TRACE ", "PATCH ",
+  };
+  const PatternMatcher matcher((ArrayView<std::string_view>(kMethods)));
+  // No method in the text, so the whole text is searched.
+  const std::string text = BodyText(state.range(0));
+
+  for (auto _ : state) {
+    size_t pos = std::string::npos;
+    switch (state.range(1)) {
+      case 0:
+        for (std::string_view method : kMethods) {
+          size_t method_pos = text.rfind(method);
+          if (method_pos != std::string::npos) {
+            pos = (pos == std::string::npos) ? method_pos : std::max(pos, method_pos);
+          }
+        }
+        break;
+      case 1:
+        pos = matcher.RFindScalar(text);
+        break;
+      default:
+        pos = matcher.RFind(text);
+        break;
+    }
+    benchmark::DoNotOptimize(pos);
+  }
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ParseFrames)->Arg(16 * 1024)->Arg(256 * 1024);
+BENCHMARK(BM_FindFrameBoundary)->RangeMultiplier(8)->Range(512, 256 * 1024);
+BENCHMARK(BM_RFindMethod)
+    ->Args({1024, 0})
+    ->Args({1024, 1})
+    ->Args({1024, 2})
+    ->Args({64 * 1024, 0})
+    ->Args({64 * 1024, 1})
+    ->Args({64 * 1024, 2});
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
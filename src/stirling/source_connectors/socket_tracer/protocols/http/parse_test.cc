@@ -468,6 +468,30 @@ TEST_F(HTTPParserTest, ParseIncompleteChunks) {
   EXPECT_THAT(parsed_messages, IsEmpty());
 }
 
+// Feeds a message one byte at a time, keeping the parser's progress across calls like DataStream
+// does, and checks that the result is the same as when the message is parsed at once.
+TEST_F(HTTPParserTest, ResumeParsingAcrossCalls) {
+  for (const std::string& msg : {HTTPRespWithChunkedBody({"pixielabs", " is awesome!"}),
+                                 HTTPRespWithSizedBody("pixielabs is awesome!")}) {
+    std::deque<Message> expected_messages;
+    ParseFramesLoop(message_type_t::kResponse, msg, &expected_messages);
+    ASSERT_EQ(expected_messages.size(), 1);
+
+    NoState* no_state = nullptr;
+    ResumeState resume_state;
+    std::deque<Message> parsed_messages;
+    size_t pos = 0;
+    for (size_t len = 1; len <= msg.size() && parsed_messages.empty(); ++len) {
+      ParseResult result = ParseFramesLoop(message_type_t::kResponse,
+                                           std::string_view(msg).substr(pos, len - pos),
+                                           &parsed_messages, no_state, &resume_state);
+      pos += result.end_position;
+    }
+    EXPECT_EQ(expected_messages, parsed_messages);
+    EXPECT_FALSE(resume_state.headers_parsed);
+  }
+}
+
 // Note that many other tests already use requests with no content-length,
 // but keeping this explicitly here in case the other tests change.
 TEST_F(HTTPParserTest, ParseRequestWithoutLengthOrChunking) {
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/pattern_matcher.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+PatternMatcher::PatternMatcher(ArrayView<std::string_view> patterns) {
+  for (std::string_view pattern : patterns) {
+    DCHECK(!pattern.empty());
+    patterns_.push_back(pattern);
+    const uint8_t first_byte = pattern.front();
+    if (!is_first_byte_[first_byte]) {
+      is_first_byte_[first_byte] = true;
+      first_bytes_.push_back(pattern.front());
+    }
+  }
+  CHECK_LE(first_bytes_.size(), kMaxFirstBytes);
+}
+
+size_t PatternMatcher::RFind(std::string_view buf) const {
+#if defined(__x86_64__)
+  static const bool kHasAVX2 = __builtin_cpu_supports("avx2");
+  return kHasAVX2 ? RFindAVX2(buf) : RFindSSE2(buf);
+#else
+  return RFindScalar(buf);
+#endif
+}
+
+size_t PatternMatcher::RFindScalar(std::string_view buf) const {
+  return RFindScalar(buf, buf.size());
+}
+
+size_t PatternMatcher::RFindScalar(std::string_view buf, size_t end) const {
+  for (size_t pos = end; pos-- > 0;) {
+    if (MatchesAt(buf, pos)) {
+      return pos;
+    }
+  }
+  return std::string::npos;
+}
+
+#if defined(__x86_64__)
+
+// SSE2 is part of the x86-64 baseline, so this needs no run-time check.
+size_t PatternMatcher::RFindSSE2(std::string_view buf) const {
+  constexpr size_t kBlockSize = sizeof(__m128i);
+
+  __m128i needles[kMaxFirstBytes];
+  for (size_t i = 0; i < first_bytes_.size(); ++i) {
+    needles[i] = _mm_set1_epi8(first_bytes_[i]);
+  }
+
+  // Scan blocks backwards from the end, so the first match found is the last one in the buffer.
+  size_t end = buf.size();
+  while (end >= kBlockSize) {
+    const size_t block_pos = end - kBlockSize;
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf.data() + block_pos));
+    __m128i eq = _mm_setzero_si128();
+    for (size_t i = 0; i < first_bytes_.size(); ++i) {
+      eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[i]));
+    }
+
+    uint32_t mask = _mm_movemask_epi8(eq);
+    while (mask != 0) {
+      const int bit = 31 - __builtin_clz(mask);
+      if (MatchesAt(buf, block_pos + bit)) {
+        return block_pos + bit;
+      }
+      mask &= ~(1u << bit);
+    }
+    end = block_pos;
+  }
+
+  return RFindScalar(buf, end);
+}
+
+__attribute__((target("avx2"))) size_t PatternMatcher::RFindAVX2(std::string_view buf) const {
+  constexpr size_t kBlockSize = sizeof(__m256i);
+
+  __m256i needles[kMaxFirstBytes];
+  for (size_t i = 0; i < first_bytes_.size(); ++i) {
+    needles[i] = _mm256_set1_epi8(first_bytes_[i]);
+  }
+
+  size_t end = buf.size();
+  while (end >= kBlockSize) {
+    const size_t block_pos = end - kBlockSize;
+    const __m256i block =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf.data() + block_pos));
+    __m256i eq = _mm256_setzero_si256();
+    for (size_t i = 0; i < first_bytes_.size(); ++i) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[i]));
+    }
+
+    uint32_t mask = _mm256_movemask_epi8(eq);
+    while (mask != 0) {
+      const int bit = 31 - __builtin_clz(mask);
+      if (MatchesAt(buf, block_pos + bit)) {
+        return block_pos + bit;
+      }
+      mask &= ~(1u << bit);
+    }
+    end = block_pos;
+  }
+
+  return RFindScalar(buf, end);
+}
+
+#else
+
+size_t PatternMatcher::RFindSSE2(std::string_view buf) const { return RFindScalar(buf); }
+
+size_t PatternMatcher::RFindAVX2(std::string_view buf) const { return RFindScalar(buf); }
+
+#endif
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
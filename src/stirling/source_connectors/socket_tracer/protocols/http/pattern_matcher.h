@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+/**
+ * Searches a buffer for the last occurrence of any of a small set of patterns, such as the
+ * methods that start an HTTP request.
+ *
+ * Instead of one std::string_view::rfind() per pattern, the buffer is scanned backwards once,
+ * comparing whole blocks of bytes against the first byte of every pattern with SSE2 or AVX2
+ * (whichever the CPU supports), and only checking the patterns at the candidate positions.
+ */
+class PatternMatcher {
+ public:
+  // At most this many distinct first bytes among the patterns are supported.
+  static constexpr size_t kMaxFirstBytes = 8;
+
+  explicit PatternMatcher(ArrayView<std::string_view> patterns);
+
+  /**
+   * Returns the position of the last occurrence of any of the patterns that lies entirely
+   * within buf, or std::string::npos if there is none.
+   * Equivalent to the largest of buf.rfind(pattern) over all patterns.
+   */
+  size_t RFind(std::string_view buf) const;
+
+  // Same as RFind(), but without vector instructions. Exposed for tests and benchmarks.
+  size_t RFindScalar(std::string_view buf) const;
+
+ private:
+  // Returns true if one of the patterns starts at pos and fits in buf.
+  bool MatchesAt(std::string_view buf, size_t pos) const {
+    if (!is_first_byte_[static_cast<uint8_t>(buf[pos])]) {
+      return false;
+    }
+    for (std::string_view pattern : patterns_) {
+      if (buf.size() - pos >= pattern.size() && buf.compare(pos, pattern.size(), pattern) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Scans the positions before end, for patterns that fit in buf.
+  size_t RFindScalar(std::string_view buf, size_t end) const;
+  size_t RFindSSE2(std::string_view buf) const;
+  size_t RFindAVX2(std::string_view buf) const;
+
+  std::vector<std::string_view> patterns_;
+  std::vector<char> first_bytes_;
+  std::array<bool, 256> is_first_byte_ = {};
+};
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
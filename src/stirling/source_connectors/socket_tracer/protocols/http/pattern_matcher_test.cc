@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/pattern_matcher.h"
+
+#include <random>
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace http {
+
+constexpr std::string_view kPatterns[] = {"GET ", "HEAD ", "POST ", "PUT ", "DELETE "};
+
+// The result of the straightforward search that PatternMatcher replaces.
+size_t RFindEachPattern(std::string_view buf) {
+  size_t pos = std::string::npos;
+  for (std::string_view pattern : kPatterns) {
+    size_t pattern_pos = buf.rfind(pattern);
+    if (pattern_pos != std::string::npos) {
+      pos = (pos == std::string::npos) ? pattern_pos : std::max(pos, pattern_pos);
+    }
+  }
+  return pos;
+}
+
+TEST(PatternMatcherTest, Basic) {
+  const PatternMatcher matcher((ArrayView<std::string_view>(kPatterns)));
+
+  EXPECT_EQ(matcher.RFind(""), std::string::npos);
+  EXPECT_EQ(matcher.RFind("GET"), std::string::npos);
+  EXPECT_EQ(matcher.RFind("GET "), 0);
+  EXPECT_EQ(matcher.RFind("xxGET /a HTTP/1.1\r\nxxPOST /b"), 21);
+  // A pattern must fit in the buffer to match.
+  EXPECT_EQ(matcher.RFind("PUT /index.html HTTP/1.1\r\nHost: a.com\r\nDELETE"), 0);
+
+  // Matches across the blocks that the vectorized search compares at once.
+  const std::string body(100, 'x');
+  EXPECT_EQ(matcher.RFind(body + "HEAD " + body), body.size());
+  EXPECT_EQ(matcher.RFind("HEAD " + body), 0);
+  EXPECT_EQ(matcher.RFind(body.substr(0, 30) + "DELETE " + body.substr(0, 1)), 30);
+}
+
+// Compares against rfind() on random buffers that are dense in partial matches.
+TEST(PatternMatcherTest, MatchesRFind) {
+  const PatternMatcher matcher((ArrayView<std::string_view>(kPatterns)));
+
+  std::mt19937 rng(37);
+  constexpr std::string_view kAlphabet = "GETHADPOSULxx  ";
+  for (int i = 0; i < 10000; ++i) {
+    std::string buf(rng() % 100, ' ');
+    for (char& c : buf) {
+      c = kAlphabet[rng() % kAlphabet.size()];
+    }
+    ASSERT_EQ(matcher.RFind(buf), RFindEachPattern(buf)) << buf;
+    ASSERT_EQ(matcher.RFindScalar(buf), RFindEachPattern(buf)) << buf;
+  }
+}
+
+}  // namespace http
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <picohttpparser.h>
+
 #include <chrono>
 #include <string>
 
@@ -78,6 +80,20 @@ struct Message : public FrameBase {
   }
 };
 
+// The progress of the parser on a message whose body has not fully arrived yet.
+// Lets the parser resume without parsing the headers, or decoding the body, again.
+struct ResumeState {
+  // Set once the headers of the message have been parsed into message.
+  bool headers_parsed = false;
+  Message message;
+
+  // Progress on a chunked body: the decoder state, the body decoded so far, and the number of
+  // bytes after the headers that were fed to the decoder.
+  phr_chunked_decoder chunk_decoder = {};
+  std::string chunked_body;
+  size_t chunked_bytes_decoded = 0;
+};
+
 //-----------------------------------------------------------------------------
 // Table Store Entry Level Structs
 //-----------------------------------------------------------------------------
@@ -106,6 +122,12 @@ struct ProtocolTraits : public BaseProtocolTraits<Record> {
 };
 
 }  // namespace http
+
+template <>
+struct FrameResumeState<http::Message> {
+  using type = http::ResumeState;
+};
+
 }  // namespace protocols
 }  // namespace stirling
 }  // namespace px
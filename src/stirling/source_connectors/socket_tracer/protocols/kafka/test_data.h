@@ -18,6 +18,7 @@
 
 #pragma once
 #include "src/common/base/base.h"
+#include "src/common/testing/testing.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/kafka/parse.h"
 
 namespace px {
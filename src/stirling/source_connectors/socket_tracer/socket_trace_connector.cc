@@ -21,7 +21,9 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <filesystem>
+#include <numeric>
 #include <utility>
 
 #include <absl/container/flat_hash_map.h>
@@ -39,6 +41,7 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/go_grpc_types.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
+#include "src/stirling/source_connectors/socket_tracer/perf_buffer_events.h"
 #include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/grpc.h"
@@ -55,17 +58,33 @@ DEFINE_uint32(
     std::chrono::minutes(10) / px::stirling::SocketTraceConnector::kSamplingPeriod,
     "Ratio of how frequently conn_stats_table is populated relative to the base sampling period");
 
+DEFINE_int32(stirling_socket_tracer_transfer_threads,
+             gflags::Int32FromEnv("PL_STIRLING_SOCKET_TRACER_TRANSFER_THREADS", 1),
+             "Number of threads that parse the data of connections into records. "
+             "With 1, connections are processed on the thread of the socket tracer.");
+
+DEFINE_bool(stirling_socket_tracer_use_ring_buffers,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_USE_RING_BUFFERS", true),
+            "If true, and the kernel supports BPF ring buffers (Linux 5.8+), socket data and "
+            "control events are sent through ring buffers shared by all CPUs, instead of per-CPU "
+            "perf buffers.");
+
+DEFINE_bool(stirling_socket_tracer_load_shedding,
+            gflags::BoolFromEnv("PL_STIRLING_SOCKET_TRACER_LOAD_SHEDDING", false),
+            "If true, when events are lost or draining them falls behind, the socket tracer "
+            "stops tracing a fraction of the connections, instead of losing random events of all "
+            "connections. Records carry the fraction of connections traced in sample_ratio.");
+
 DEFINE_bool(stirling_enable_periodic_bpf_map_cleanup, true,
             "Disable periodic BPF map cleanup (for testing)");
 
 DEFINE_int32(test_only_socket_trace_target_pid, kTraceAllTGIDs, "The process to trace.");
-// TODO(yzhao): If we ever need to write all events from different perf buffers, then we need either
-// write to different files for individual perf buffers, or create a protobuf message with an oneof
-// field to include all supported message types.
 DEFINE_string(perf_buffer_events_output_path, "",
               "If not empty, specifies the path & format to a file to which the socket tracer "
-              "writes data events. If the filename ends with '.bin', the events are serialized in "
-              "binary format; otherwise, text format.");
+              "writes data, control and conn stats events, and the header and data events of the "
+              "Go gRPC uprobes. If the filename ends with '.bin', the events are serialized in "
+              "binary format, which can be replayed with SocketTraceReplayer; otherwise, text "
+              "format.");
 
 // PROTOCOL_LIST: Requires update on new protocols.
 DEFINE_bool(stirling_enable_http_tracing, true,
@@ -194,13 +213,33 @@ Status SocketTraceConnector::InitImpl() {
         "timestamps in a way that matches how /proc/stat does it");
   }
 
-  PL_RETURN_IF_ERROR(InitBPFProgram(socket_trace_bcc_script));
+  use_ring_buffers_ = FLAGS_stirling_socket_tracer_use_ring_buffers && KernelSupportsRingBuffers();
+  std::vector<std::string> cflags;
+  if (use_ring_buffers_) {
+    cflags.push_back("-DENABLE_RINGBUF");
+    cflags.push_back(absl::Substitute("-DSOCKET_DATA_RINGBUF_PAGES=$0",
+                                      BufferNumPages(kTargetDataBufferSize)));
+    cflags.push_back(absl::Substitute("-DSOCKET_CONTROL_RINGBUF_PAGES=$0",
+                                      BufferNumPages(kTargetControlBufferSize)));
+  }
+
+  PL_RETURN_IF_ERROR(InitBPFProgram(socket_trace_bcc_script, cflags));
   PL_RETURN_IF_ERROR(AttachKProbes(kProbeSpecs));
   LOG(INFO) << absl::Substitute("Number of kprobes deployed = $0", kProbeSpecs.size());
   LOG(INFO) << "Probes successfully deployed.";
 
-  PL_RETURN_IF_ERROR(OpenPerfBuffers(kPerfBufferSpecs, this));
-  LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0", kPerfBufferSpecs.size());
+  int num_ring_buffers = 0;
+  for (const auto& spec : kPerfBufferSpecs) {
+    if (use_ring_buffers_ && (spec.name == "socket_data_events" ||
+                             spec.name == "socket_control_events")) {
+      PL_RETURN_IF_ERROR(OpenRingBuffer(spec, this));
+      ++num_ring_buffers;
+    } else {
+      PL_RETURN_IF_ERROR(OpenPerfBuffer(spec, this));
+    }
+  }
+  LOG(INFO) << absl::Substitute("Number of perf buffers opened = $0, ring buffers opened = $1",
+                                kPerfBufferSpecs.size() - num_ring_buffers, num_ring_buffers);
 
   // Set trace role to BPF probes.
   for (const auto& p : TrafficProtocolEnumValues()) {
@@ -341,6 +380,20 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // No data is lost, but this is a side-effect of sorts that affects timing of transfers.
   // It may be worth noting during debug.
   PollPerfBuffers();
+  if (use_ring_buffers_) {
+    ReportRingBufferEventLoss();
+  }
+
+  if (FLAGS_stirling_socket_tracer_load_shedding) {
+    // With ring buffers, these include the events that BPF dropped because the ring buffers were
+    // full, which ReportRingBufferEventLoss() has just added.
+    int64_t num_lost_events = stats_.Get(StatKey::kLossSocketDataEvent) +
+                              stats_.Get(StatKey::kLossSocketControlEvent);
+    auto drain_duration = std::chrono::nanoseconds(AdjustedSteadyClockNowNS() -
+                                                   perf_buffer_drain_time_);
+    load_shedder_.Update(num_lost_events - num_lost_events_, drain_duration);
+    num_lost_events_ = num_lost_events;
+  }
 
   // Set-up current state for connection inference purposes.
   if (socket_info_mgr_ != nullptr) {
@@ -368,6 +421,54 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   }
 }
 
+void SocketTraceConnector::ReportRingBufferEventLoss() {
+  auto counters = GetPerCPUArrayTable<uint64_t>(kEventLossCountersArrayName);
+  std::array<uint64_t, kNumEventLossCounters> totals = ring_buffer_lost_events_;
+  for (int idx = 0; idx < kNumEventLossCounters; ++idx) {
+    std::vector<uint64_t> values;
+    auto status = counters.get_value(idx, values);
+    if (!status.ok()) {
+      LOG_FIRST_N(WARNING, 1) << absl::Substitute("Failed to read $0[$1], error message: $2",
+                                                  kEventLossCountersArrayName, idx, status.msg());
+      continue;
+    }
+    totals[idx] = std::accumulate(values.begin(), values.end(), uint64_t{0});
+  }
+  HandleRingBufferEventLoss(totals);
+}
+
+void SocketTraceConnector::HandleRingBufferEventLoss(
+    const std::array<uint64_t, kNumEventLossCounters>& totals) {
+  static constexpr auto kLossHandlers = MakeArray<void (*)(void*, uint64_t)>({
+      // Indexed by event_loss_index_t.
+      HandleDataEventLoss,
+      HandleControlEventLoss,
+  });
+  static_assert(kLossHandlers.size() == kNumEventLossCounters);
+
+  for (int idx = 0; idx < kNumEventLossCounters; ++idx) {
+    uint64_t lost = totals[idx] - ring_buffer_lost_events_[idx];
+    ring_buffer_lost_events_[idx] = totals[idx];
+    if (lost > 0) {
+      kLossHandlers[idx](this, lost);
+    }
+  }
+}
+
+void SocketTraceConnector::ApplyLoadShedding(ConnTracker* tracker) {
+  if (!FLAGS_stirling_socket_tracer_load_shedding ||
+      tracker->state() == ConnTracker::State::kDisabled) {
+    return;
+  }
+
+  if (!load_shedder_.ShouldTrace(tracker->conn_id())) {
+    // Disabling also tells BPF to stop sending the data of the connection.
+    tracker->Disable("Load shedding");
+    return;
+  }
+  tracker->set_sample_ratio(std::min(tracker->sample_ratio(), load_shedder_.sample_ratio()));
+}
+
 void SocketTraceConnector::UpdateTrackerTraceLevel(ConnTracker* tracker) {
   if (pids_to_trace_.contains(tracker->conn_id().upid.pid)) {
     tracker->SetDebugTrace(2);
@@ -416,18 +517,23 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx,
     }
   }
 
-  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
-    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
-    DataTable* data_table = data_tables[transfer_spec.table_num];
+  if (FLAGS_stirling_socket_tracer_transfer_threads > 1) {
+    TransferStreamsParallel(ctx, data_tables, cluster_cidrs);
+  } else {
+    for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
+      const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+      DataTable* data_table = data_tables[transfer_spec.table_num];
 
-    UpdateTrackerTraceLevel(conn_tracker);
+      UpdateTrackerTraceLevel(conn_tracker);
+      ApplyLoadShedding(conn_tracker);
 
-    conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
-                                   socket_info_mgr_.get());
-    if (transfer_spec.enabled && transfer_spec.transfer_fn && data_table != nullptr) {
-      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+      conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
+                                     socket_info_mgr_.get());
+      if (transfer_spec.enabled && transfer_spec.transfer_fn && data_table != nullptr) {
+        transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+      }
+      conn_tracker->IterationPostTick();
     }
-    conn_tracker->IterationPostTick();
   }
 
   // Once we've cleared all the debug trace levels for this pid, we can remove it from the list.
@@ -569,7 +675,9 @@ ConnTracker& SocketTraceConnector::GetOrCreateConnTracker(struct conn_id_t conn_
 
 void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> event) {
   if (perf_buffer_events_output_stream_ != nullptr) {
-    WriteDataEvent(*event);
+    sockeventpb::PerfBufferEvent pb;
+    SocketDataEventToPB(*event, pb.mutable_data_event());
+    WritePerfBufferEvent(pb);
   }
 
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
@@ -577,21 +685,45 @@ void SocketTraceConnector::AcceptDataEvent(std::unique_ptr<SocketDataEvent> even
 }
 
 void SocketTraceConnector::AcceptControlEvent(socket_control_event_t event) {
+  if (perf_buffer_events_output_stream_ != nullptr) {
+    sockeventpb::PerfBufferEvent pb;
+    SocketControlEventToPB(event, pb.mutable_control_event());
+    WritePerfBufferEvent(pb);
+  }
+
   ConnTracker& tracker = GetOrCreateConnTracker(event.conn_id);
   tracker.AddControlEvent(event);
 }
 
 void SocketTraceConnector::AcceptConnStatsEvent(conn_stats_event_t event) {
+  if (perf_buffer_events_output_stream_ != nullptr) {
+    sockeventpb::PerfBufferEvent pb;
+    ConnStatsEventToPB(event, pb.mutable_conn_stats_event());
+    WritePerfBufferEvent(pb);
+  }
+
   ConnTracker& tracker = conn_trackers_mgr_.GetOrCreateConnTracker(event.conn_id);
   tracker.AddConnStats(event);
 }
 
 void SocketTraceConnector::AcceptHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> event) {
+  if (perf_buffer_events_output_stream_ != nullptr) {
+    sockeventpb::PerfBufferEvent pb;
+    HTTP2HeaderEventToPB(*event, pb.mutable_http2_header_event());
+    WritePerfBufferEvent(pb);
+  }
+
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddHTTP2Header(std::move(event));
 }
 
 void SocketTraceConnector::AcceptHTTP2Data(std::unique_ptr<HTTP2DataEvent> event) {
+  if (perf_buffer_events_output_stream_ != nullptr) {
+    sockeventpb::PerfBufferEvent pb;
+    HTTP2DataEventToPB(*event, pb.mutable_http2_data_event());
+    WritePerfBufferEvent(pb);
+  }
+
   ConnTracker& tracker = GetOrCreateConnTracker(event->attr.conn_id);
   tracker.AddHTTP2Data(std::move(event));
 }
@@ -656,6 +788,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body"), kMaxBodyBytes>(std::move(resp_message.body));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_message.timestamp_ns, resp_message.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -735,6 +868,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(std::move(resp_data));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_stream->timestamp_ns, resp_stream->timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -758,6 +892,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body"), kMaxBodyBytes>(std::move(entry.resp.msg));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -781,6 +916,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body"), kMaxBodyBytes>(std::move(entry.resp.msg));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -804,6 +940,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp_body")>(entry.resp.msg);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -826,6 +963,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
   r.Append<r.ColIndex("req_cmd")>(ToString(entry.req.tag, /* is_req */ true));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -870,6 +1008,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp")>(std::string(entry.resp.payload));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(entry.req.timestamp_ns, entry.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -891,6 +1030,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("cmd")>(record.req.command);
   r.Append<r.ColIndex("body")>(record.req.options);
   r.Append<r.ColIndex("resp")>(record.resp.command);
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -917,6 +1057,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("resp"), kMaxKafkaBodyBytes>(std::move(record.resp.msg));
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(record.req.timestamp_ns, record.resp.timestamp_ns));
+  r.Append<r.ColIndex("sample_ratio")>(conn_tracker.sample_ratio());
 #ifndef NDEBUG
   r.Append<r.ColIndex("px_info_")>(ToString(conn_tracker.conn_id()));
 #endif
@@ -936,31 +1077,12 @@ void SocketTraceConnector::SetupOutput(const std::filesystem::path& path) {
   LOG(INFO) << absl::Substitute("Writing output to: $0 in $1 format.", abs_path.string(), format);
 }
 
-namespace {
-void SocketDataEventToPB(const SocketDataEvent& event, sockeventpb::SocketDataEvent* pb) {
-  pb->mutable_attr()->set_timestamp_ns(event.attr.timestamp_ns);
-  pb->mutable_attr()->mutable_conn_id()->set_pid(event.attr.conn_id.upid.pid);
-  pb->mutable_attr()->mutable_conn_id()->set_start_time_ns(
-      event.attr.conn_id.upid.start_time_ticks);
-  pb->mutable_attr()->mutable_conn_id()->set_fd(event.attr.conn_id.fd);
-  pb->mutable_attr()->mutable_conn_id()->set_generation(event.attr.conn_id.tsid);
-  pb->mutable_attr()->set_protocol(event.attr.protocol);
-  pb->mutable_attr()->set_role(event.attr.role);
-  pb->mutable_attr()->set_direction(event.attr.direction);
-  pb->mutable_attr()->set_pos(event.attr.pos);
-  pb->mutable_attr()->set_msg_size(event.attr.msg_size);
-  pb->set_msg(event.msg);
-}
-}  // namespace
-
-void SocketTraceConnector::WriteDataEvent(const SocketDataEvent& event) {
+void SocketTraceConnector::WritePerfBufferEvent(const sockeventpb::PerfBufferEvent& pb) {
   using ::google::protobuf::TextFormat;
   using ::google::protobuf::util::SerializeDelimitedToOstream;
 
   DCHECK(perf_buffer_events_output_stream_ != nullptr);
 
-  sockeventpb::SocketDataEvent pb;
-  SocketDataEventToPB(event, &pb);
   std::string text;
   switch (perf_buffer_events_output_format_) {
     case OutputFormat::kTxt:
@@ -1002,6 +1124,64 @@ void SocketTraceConnector::TransferStream(ConnectorContext* ctx, ConnTracker* tr
   }
 }
 
+void SocketTraceConnector::TransferStreamsParallel(ConnectorContext* ctx,
+                                                   const std::vector<DataTable*>& data_tables,
+                                                   const std::vector<CIDRBlock>& cluster_cidrs) {
+  // IterationPreTick() and IterationPostTick() look up shared state (/proc, socket info), so they
+  // run serially. Everything in between only touches the tracker itself.
+  std::vector<ConnTracker*> trackers;
+  for (const auto& conn_tracker : conn_trackers_mgr_.active_trackers()) {
+    UpdateTrackerTraceLevel(conn_tracker);
+    ApplyLoadShedding(conn_tracker);
+    conn_tracker->IterationPreTick(iteration_time_, cluster_cidrs, proc_parser_.get(),
+                                   socket_info_mgr_.get());
+    trackers.push_back(conn_tracker);
+  }
+
+  if (transfer_pool_ == nullptr ||
+      transfer_pool_->num_threads() != FLAGS_stirling_socket_tracer_transfer_threads) {
+    transfer_pool_ = std::make_unique<WorkerPool>(FLAGS_stirling_socket_tracer_transfer_threads);
+    transfer_shards_.clear();
+  }
+
+  // Each worker appends records to its own copy of the data tables. The copies are kept across
+  // iterations, so their column buffers are reused.
+  transfer_shards_.resize(transfer_pool_->num_threads());
+  for (auto& shard : transfer_shards_) {
+    shard.resize(data_tables.size());
+    for (size_t i = 0; i < data_tables.size(); ++i) {
+      if (data_tables[i] == nullptr) {
+        shard[i] = nullptr;
+      } else if (shard[i] == nullptr || shard[i]->id() != data_tables[i]->id()) {
+        shard[i] = std::make_unique<DataTable>(data_tables[i]->id(), kTables[i]);
+      }
+    }
+  }
+
+  // A tracker is always processed by a single worker, so the records of a connection keep their
+  // order; records of different connections are ordered by time in ConsumeRecords().
+  transfer_pool_->ParallelFor(trackers.size(), [&](int worker_idx, size_t item_idx) {
+    ConnTracker* conn_tracker = trackers[item_idx];
+    const auto& transfer_spec = protocol_transfer_specs_[conn_tracker->protocol()];
+    DataTable* data_table = transfer_shards_[worker_idx][transfer_spec.table_num].get();
+    if (transfer_spec.enabled && transfer_spec.transfer_fn && data_table != nullptr) {
+      transfer_spec.transfer_fn(*this, ctx, conn_tracker, data_table);
+    }
+  });
+
+  for (auto& shard : transfer_shards_) {
+    for (size_t i = 0; i < data_tables.size(); ++i) {
+      if (shard[i] != nullptr) {
+        data_tables[i]->MoveRecordsFrom(shard[i].get());
+      }
+    }
+  }
+
+  for (ConnTracker* conn_tracker : trackers) {
+    conn_tracker->IterationPostTick();
+  }
+}
+
 void SocketTraceConnector::TransferConnStats(ConnectorContext* ctx, DataTable* data_table) {
   namespace idx = ::px::stirling::conn_stats_idx;
 
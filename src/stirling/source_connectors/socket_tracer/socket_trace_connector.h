@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <array>
 #include <fstream>
 #include <list>
 #include <map>
@@ -41,14 +42,20 @@
 #include "src/stirling/source_connectors/socket_tracer/conn_stats.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
 #include "src/stirling/source_connectors/socket_tracer/conn_trackers_manager.h"
+#include "src/stirling/source_connectors/socket_tracer/load_shedder.h"
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_tables.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_manager.h"
 #include "src/stirling/utils/proc_path_tools.h"
 #include "src/stirling/utils/proc_tracker.h"
+#include "src/stirling/utils/worker_pool.h"
 
 DECLARE_uint32(stirling_conn_stats_sampling_ratio);
 DECLARE_bool(stirling_enable_periodic_bpf_map_cleanup);
+DECLARE_int32(stirling_socket_tracer_transfer_threads);
+DECLARE_bool(stirling_socket_tracer_use_ring_buffers);
+DECLARE_bool(stirling_socket_tracer_load_shedding);
 DECLARE_string(perf_buffer_events_output_path);
 DECLARE_bool(stirling_enable_http_tracing);
 DECLARE_bool(stirling_enable_http2_tracing);
@@ -205,6 +212,8 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   inline static constexpr int64_t kTargetControlBufferSize =
       kTargetControlBytesPerSec * kSamplingPeriod.count() / 1000;
 
+  // When BPF ring buffers are in use, socket_data_events and socket_control_events are opened as
+  // ring buffers of the same size, shared by all CPUs (see socket_trace.c).
   inline static const auto kPerfBufferSpecs = MakeArray<bpf_tools::PerfBufferSpec>({
       // For data events. The order must be consistent with output tables.
       {"socket_data_events", HandleDataEvent, HandleDataEventLoss, kTargetDataBufferSize},
@@ -244,6 +253,11 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   void TransferStreams(ConnectorContext* ctx, uint32_t table_num, DataTable* data_table);
   void TransferConnStats(ConnectorContext* ctx, DataTable* data_table);
 
+  // Transfers the data of all active trackers, spreading the trackers over the threads of
+  // transfer_pool_. Used when --stirling_socket_tracer_transfer_threads is greater than 1.
+  void TransferStreamsParallel(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables,
+                               const std::vector<CIDRBlock>& cluster_cidrs);
+
   template <typename TProtocolTraits>
   void TransferStream(ConnectorContext* ctx, ConnTracker* tracker, DataTable* data_table);
 
@@ -255,6 +269,18 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   void UpdateTrackerTraceLevel(ConnTracker* tracker);
 
+  // Stops tracing the connection if the load shedder sampled it out, otherwise records the sample
+  // ratio that applies to its records.
+  void ApplyLoadShedding(ConnTracker* tracker);
+
+  // Reads the events that BPF could not write to the ring buffers, and reports them with
+  // HandleRingBufferEventLoss(). Only used if the ring buffers are in use.
+  void ReportRingBufferEventLoss();
+  // Passes the increase of the event_loss_counters (summed over all CPUs, and indexed by
+  // event_loss_index_t) since the last call to the loss handlers. Like perf buffer losses, they
+  // count as lost events for load shedding.
+  void HandleRingBufferEventLoss(const std::array<uint64_t, kNumEventLossCounters>& totals);
+
   template <typename TRecordType>
   static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
                             TRecordType record, DataTable* data_table);
@@ -264,8 +290,8 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Setups output file stream object writing to the input file path.
   void SetupOutput(const std::filesystem::path& file);
 
-  // Writes data event to the specified output file.
-  void WriteDataEvent(const SocketDataEvent& event);
+  // Writes an event received from the perf buffers to the specified output file.
+  void WritePerfBufferEvent(const sockeventpb::PerfBufferEvent& event);
 
   ConnTrackersManager conn_trackers_mgr_;
 
@@ -298,6 +324,16 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   //   Example: data_table->SetConsumeRecordsCutoffTime(perf_buffer_drain_time_);
   uint64_t perf_buffer_drain_time_ = 0;
 
+  // Decides which connections are traced when events are lost or draining is too slow.
+  // Only used with --stirling_socket_tracer_load_shedding.
+  LoadShedder load_shedder_{kSamplingPeriod / 2};
+  int64_t num_lost_events_ = 0;
+
+  // Whether socket_data_events and socket_control_events are BPF ring buffers.
+  bool use_ring_buffers_ = false;
+  // The sum over all CPUs of each of the event_loss_counters, when they were last read.
+  std::array<uint64_t, kNumEventLossCounters> ring_buffer_lost_events_ = {};
+
   // If not a nullptr, writes the events received from perf buffers to this stream.
   std::unique_ptr<std::ofstream> perf_buffer_events_output_stream_;
   enum class OutputFormat {
@@ -326,6 +362,12 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   utils::StatCounter<StatKey> stats_;
 
+  // Threads and per-thread data tables used by TransferStreamsParallel(). Created on first use.
+  std::unique_ptr<WorkerPool> transfer_pool_;
+  std::vector<std::vector<std::unique_ptr<DataTable>>> transfer_shards_;
+
+  friend class SocketTraceReplayer;
+
   FRIEND_TEST(SocketTraceConnectorTest, AppendNonContiguousEvents);
   FRIEND_TEST(SocketTraceConnectorTest, NoEvents);
   FRIEND_TEST(SocketTraceConnectorTest, SortedByResponseTime);
@@ -357,6 +399,7 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   FRIEND_TEST(SocketTraceConnectorTest, HTTP2StreamSandwich);
   FRIEND_TEST(SocketTraceConnectorTest, HTTP2StreamIDRace);
   FRIEND_TEST(SocketTraceConnectorTest, HTTP2OldStream);
+  FRIEND_TEST(SocketTraceConnectorTest, LoadSheddingOnRingBufferLoss);
 };
 
 }  // namespace stirling
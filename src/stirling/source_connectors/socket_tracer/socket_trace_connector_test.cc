@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 
 #include <sys/socket.h>
+#include <algorithm>
 #include <memory>
 
 #include "src/shared/metadata/metadata.h"
@@ -305,6 +306,101 @@ TEST_F(SocketTraceConnectorTest, HTTPContentType) {
                           source_->ConvertToRealTime(7), source_->ConvertToRealTime(9)));
 }
 
+TEST_F(SocketTraceConnectorTest, HTTPParallelTransfer) {
+  FLAGS_stirling_socket_tracer_transfer_threads = 4;
+  constexpr int kNumConns = 16;
+
+  // Interleave the events of the connections, so records of different connections alternate in
+  // time, and must be merged back into time order.
+  std::vector<testing::EventGenerator> event_gens;
+  for (int i = 0; i < kNumConns; ++i) {
+    event_gens.emplace_back(&mock_clock_, kPID, kFD + i);
+    source_->AcceptControlEvent(event_gens[i].InitConn());
+  }
+  for (int i = 0; i < kNumConns; ++i) {
+    source_->AcceptDataEvent(event_gens[i].InitSendEvent<kProtocolHTTP>(kReq0));
+  }
+  for (int i = 0; i < kNumConns; ++i) {
+    source_->AcceptDataEvent(event_gens[i].InitRecvEvent<kProtocolHTTP>(kJSONResp));
+  }
+  for (int i = 0; i < kNumConns; ++i) {
+    source_->AcceptControlEvent(event_gens[i].InitClose());
+  }
+
+  connector_->TransferData(ctx_.get(), data_tables_->tables());
+  FLAGS_stirling_socket_tracer_transfer_threads = 1;
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_FALSE(tablets.empty());
+  RecordBatch record_batch = tablets[0].records;
+
+  EXPECT_THAT(record_batch, Each(ColWrapperSizeIs(kNumConns)));
+  std::vector<int64_t> times = ToIntVector<types::Time64NSValue>(record_batch[kHTTPTimeIdx]);
+  EXPECT_TRUE(std::is_sorted(times.begin(), times.end()));
+  EXPECT_THAT(ToStringVector(record_batch[kHTTPRespBodyIdx]), Each(std::string("foo")));
+}
+
+TEST_F(SocketTraceConnectorTest, HTTPLoadShedding) {
+  FLAGS_stirling_socket_tracer_load_shedding = true;
+  constexpr int kNumConns = 64;
+
+  // Lost events make the connector trace only half of the connections.
+  SocketTraceConnector::HandleDataEventLoss(source_, 100);
+
+  std::vector<testing::EventGenerator> event_gens;
+  for (int i = 0; i < kNumConns; ++i) {
+    event_gens.emplace_back(&mock_clock_, kPID, kFD + i);
+    source_->AcceptControlEvent(event_gens[i].InitConn());
+    source_->AcceptDataEvent(event_gens[i].InitSendEvent<kProtocolHTTP>(kReq0));
+    source_->AcceptDataEvent(event_gens[i].InitRecvEvent<kProtocolHTTP>(kJSONResp));
+    source_->AcceptControlEvent(event_gens[i].InitClose());
+  }
+
+  connector_->TransferData(ctx_.get(), data_tables_->tables());
+  FLAGS_stirling_socket_tracer_load_shedding = false;
+
+  int num_traced = 0;
+  for (int i = 0; i < kNumConns; ++i) {
+    ASSERT_OK_AND_ASSIGN(const ConnTracker* tracker, source_->GetConnTracker(kPID, kFD + i));
+    if (tracker->state() != ConnTracker::State::kDisabled) {
+      ++num_traced;
+    }
+  }
+  EXPECT_GT(num_traced, 0);
+  EXPECT_LT(num_traced, kNumConns);
+
+  std::vector<TaggedRecordBatch> tablets = http_table_->ConsumeRecords();
+  ASSERT_FALSE(tablets.empty());
+  RecordBatch record_batch = tablets[0].records;
+  EXPECT_THAT(record_batch, Each(ColWrapperSizeIs(num_traced)));
+  const auto& sample_ratios = record_batch[kHTTPTable.ColIndex("sample_ratio")];
+  for (size_t i = 0; i < sample_ratios->Size(); ++i) {
+    EXPECT_EQ(sample_ratios->Get<types::Float64Value>(i).val, 0.5);
+  }
+}
+
+// With ring buffers, BPF counts the events it drops, and those drive load shedding too.
+TEST_F(SocketTraceConnectorTest, LoadSheddingOnRingBufferLoss) {
+  FLAGS_stirling_socket_tracer_load_shedding = true;
+
+  // Only the increase of the counters since the last call counts as lost.
+  source_->HandleRingBufferEventLoss({10, 5});
+  EXPECT_EQ(source_->stats_.Get(SocketTraceConnector::StatKey::kLossSocketDataEvent), 10);
+  EXPECT_EQ(source_->stats_.Get(SocketTraceConnector::StatKey::kLossSocketControlEvent), 5);
+  source_->HandleRingBufferEventLoss({10, 7});
+  EXPECT_EQ(source_->stats_.Get(SocketTraceConnector::StatKey::kLossSocketDataEvent), 10);
+  EXPECT_EQ(source_->stats_.Get(SocketTraceConnector::StatKey::kLossSocketControlEvent), 7);
+
+  connector_->TransferData(ctx_.get(), data_tables_->tables());
+  EXPECT_EQ(source_->load_shedder_.sample_ratio(), 0.5);
+
+  // No more losses, so the connector starts to recover.
+  source_->HandleRingBufferEventLoss({10, 7});
+  connector_->TransferData(ctx_.get(), data_tables_->tables());
+  EXPECT_GT(source_->load_shedder_.sample_ratio(), 0.5);
+  FLAGS_stirling_socket_tracer_load_shedding = false;
+}
+
 // Use CQL protocol to check sorting, because it supports parallel request-response streams.
 TEST_F(SocketTraceConnectorTest, SortedByResponseTime) {
   using cass::testutils::CreateCQLEmptyEvent;
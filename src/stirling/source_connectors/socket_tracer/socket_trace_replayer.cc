@@ -0,0 +1,123 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_replayer.h"
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "src/stirling/source_connectors/socket_tracer/perf_buffer_events.h"
+
+namespace px {
+namespace stirling {
+
+Status SocketTraceReplayer::Replay(ConnectorContext* ctx,
+                                   const std::vector<DataTable*>& data_tables,
+                                   const std::vector<sockeventpb::PerfBufferEvent>& events) {
+  if (events.empty()) {
+    connector_->TransferData(ctx, data_tables);
+    ++stats_.transfers;
+    return Status::OK();
+  }
+
+  // Events are recorded in the order in which they were drained from the perf buffers, which is
+  // close to, but not exactly, timestamp order.
+  uint64_t min_timestamp = std::numeric_limits<uint64_t>::max();
+  uint64_t max_timestamp = 0;
+  for (const auto& event : events) {
+    uint64_t timestamp = PerfBufferEventTimestamp(event);
+    min_timestamp = std::min(min_timestamp, timestamp);
+    max_timestamp = std::max(max_timestamp, timestamp);
+  }
+
+  // Unsigned arithmetic wraps around, so the shift works in both directions.
+  uint64_t now = CurrentSteadyTimeNS();
+  uint64_t timestamp_shift = now - (speed_ == Speed::kMax ? max_timestamp : min_timestamp);
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t next_transfer_timestamp = min_timestamp + transfer_period_.count();
+  for (const auto& event : events) {
+    uint64_t timestamp = PerfBufferEventTimestamp(event);
+    if (speed_ == Speed::kOriginal && timestamp > min_timestamp) {
+      std::this_thread::sleep_until(start + std::chrono::nanoseconds(timestamp - min_timestamp));
+    }
+    if (timestamp >= next_transfer_timestamp) {
+      connector_->TransferData(ctx, data_tables);
+      ++stats_.transfers;
+      next_transfer_timestamp = timestamp + transfer_period_.count();
+    }
+    Accept(event, timestamp_shift);
+  }
+
+  connector_->TransferData(ctx, data_tables);
+  ++stats_.transfers;
+  return Status::OK();
+}
+
+void SocketTraceReplayer::Accept(const sockeventpb::PerfBufferEvent& event,
+                                 uint64_t timestamp_shift) {
+  switch (event.event_case()) {
+    case sockeventpb::PerfBufferEvent::kDataEvent: {
+      std::unique_ptr<SocketDataEvent> data_event = SocketDataEventFromPB(event.data_event());
+      data_event->attr.timestamp_ns += timestamp_shift;
+      ++stats_.data_events;
+      stats_.data_bytes += data_event->msg.size();
+      connector_->AcceptDataEvent(std::move(data_event));
+      break;
+    }
+    case sockeventpb::PerfBufferEvent::kControlEvent: {
+      socket_control_event_t control_event = SocketControlEventFromPB(event.control_event());
+      control_event.timestamp_ns += timestamp_shift;
+      ++stats_.control_events;
+      connector_->AcceptControlEvent(control_event);
+      break;
+    }
+    case sockeventpb::PerfBufferEvent::kConnStatsEvent: {
+      conn_stats_event_t conn_stats_event = ConnStatsEventFromPB(event.conn_stats_event());
+      conn_stats_event.timestamp_ns += timestamp_shift;
+      ++stats_.conn_stats_events;
+      connector_->AcceptConnStatsEvent(conn_stats_event);
+      break;
+    }
+    case sockeventpb::PerfBufferEvent::kHttp2HeaderEvent: {
+      std::unique_ptr<HTTP2HeaderEvent> header_event =
+          HTTP2HeaderEventFromPB(event.http2_header_event());
+      header_event->attr.timestamp_ns += timestamp_shift;
+      ++stats_.http2_header_events;
+      connector_->AcceptHTTP2Header(std::move(header_event));
+      break;
+    }
+    case sockeventpb::PerfBufferEvent::kHttp2DataEvent: {
+      std::unique_ptr<HTTP2DataEvent> data_event = HTTP2DataEventFromPB(event.http2_data_event());
+      data_event->attr.timestamp_ns += timestamp_shift;
+      ++stats_.http2_data_events;
+      stats_.data_bytes += data_event->payload.size();
+      connector_->AcceptHTTP2Data(std::move(data_event));
+      break;
+    }
+    default:
+      LOG(DFATAL) << "Perf buffer event without an event.";
+      break;
+  }
+}
+
+}  // namespace stirling
+}  // namespace px
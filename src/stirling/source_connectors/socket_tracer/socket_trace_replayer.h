@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/core/data_table.h"
+#include "src/stirling/source_connectors/socket_tracer/proto/sock_event.pb.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_connector.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Feeds a capture recorded with --perf_buffer_events_output_path through a SocketTraceConnector,
+ * in place of the perf buffers. This runs the parsing, stitching and transfer of the records
+ * without BPF, so it can be measured and regression tested on any machine.
+ *
+ * The events are fed through the same Accept*() functions as the perf buffer callbacks, and
+ * TransferData() is called once every transfer period of capture time. Event timestamps are
+ * shifted onto the current monotonic clock: in real time the events are fed at the pace at which
+ * they were recorded, and at max speed the whole capture is placed in the past so every record is
+ * ready to be transferred.
+ */
+class SocketTraceReplayer {
+ public:
+  enum class Speed {
+    kOriginal,
+    kMax,
+  };
+
+  struct Stats {
+    int64_t data_events = 0;
+    int64_t data_bytes = 0;
+    int64_t control_events = 0;
+    int64_t conn_stats_events = 0;
+    int64_t http2_header_events = 0;
+    int64_t http2_data_events = 0;
+    int64_t transfers = 0;
+  };
+
+  SocketTraceReplayer(
+      SocketTraceConnector* connector, Speed speed,
+      std::chrono::nanoseconds transfer_period = SocketTraceConnector::kSamplingPeriod)
+      : connector_(connector), speed_(speed), transfer_period_(transfer_period) {}
+
+  /**
+   * Replays the events, in order, and transfers the resulting records to the data tables. Ends
+   * with a final transfer after the last event.
+   */
+  Status Replay(ConnectorContext* ctx, const std::vector<DataTable*>& data_tables,
+                const std::vector<sockeventpb::PerfBufferEvent>& events);
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  void Accept(const sockeventpb::PerfBufferEvent& event, uint64_t timestamp_shift);
+
+  SocketTraceConnector* connector_;
+  Speed speed_;
+  std::chrono::nanoseconds transfer_period_;
+  Stats stats_;
+};
+
+}  // namespace stirling
+}  // namespace px
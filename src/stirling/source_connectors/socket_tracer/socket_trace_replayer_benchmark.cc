@@ -0,0 +1,282 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/core/connector_context.h"
+#include "src/stirling/source_connectors/socket_tracer/perf_buffer_events.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/kafka/test_data.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/test_data.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/mysql/test_utils.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/pgsql/test_data.h"
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_replayer.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/event_generator.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/http2_stream_generator.h"
+#include "src/stirling/testing/common.h"
+
+// Benchmarks the user-space half of the socket tracer: feeding perf buffer events through
+// SocketTraceConnector, and parsing, stitching and transferring the resulting records.
+//
+// Besides the synthesized captures below, a capture recorded on a live system with
+// --perf_buffer_events_output_path=<path>.bin can be replayed with --replay_capture_path.
+DEFINE_string(replay_capture_path, "", "A binary capture of perf buffer events to replay.");
+
+namespace px {
+namespace stirling {
+
+namespace kafka = protocols::kafka;
+namespace mysql = protocols::mysql;
+namespace pgsql = protocols::pgsql;
+
+using sockeventpb::PerfBufferEvent;
+
+namespace {
+
+void AddControlEvent(const socket_control_event_t& event, std::vector<PerfBufferEvent>* events) {
+  SocketControlEventToPB(event, events->emplace_back().mutable_control_event());
+}
+
+void AddDataEvent(const SocketDataEvent& event, std::vector<PerfBufferEvent>* events) {
+  SocketDataEventToPB(event, events->emplace_back().mutable_data_event());
+}
+
+void AddHTTP2HeaderEvent(const HTTP2HeaderEvent& event, std::vector<PerfBufferEvent>* events) {
+  HTTP2HeaderEventToPB(event, events->emplace_back().mutable_http2_header_event());
+}
+
+void AddHTTP2DataEvent(const HTTP2DataEvent& event, std::vector<PerfBufferEvent>* events) {
+  HTTP2DataEventToPB(event, events->emplace_back().mutable_http2_data_event());
+}
+
+// Synthesizes a capture of num_conns connections, with num_reqs request/response pairs each.
+// The connections are interleaved, as they would be in the perf buffers. gen_req_resp appends the
+// events of the r-th request/response pair of a connection.
+template <typename TGenReqResp>
+std::vector<PerfBufferEvent> GenCapture(testing::Clock* clock, int num_conns, int num_reqs,
+                                        TGenReqResp gen_req_resp) {
+  std::vector<testing::EventGenerator> event_gens;
+  for (int i = 0; i < num_conns; ++i) {
+    event_gens.emplace_back(clock, testing::kPID, /* fd */ i + 1);
+  }
+
+  std::vector<PerfBufferEvent> events;
+  std::vector<conn_id_t> conn_ids;
+  for (auto& event_gen : event_gens) {
+    socket_control_event_t conn = event_gen.InitConn();
+    conn_ids.push_back(conn.conn_id);
+    AddControlEvent(conn, &events);
+  }
+  for (int r = 0; r < num_reqs; ++r) {
+    for (size_t i = 0; i < event_gens.size(); ++i) {
+      gen_req_resp(&event_gens[i], conn_ids[i], r, &events);
+    }
+  }
+  for (auto& event_gen : event_gens) {
+    AddControlEvent(event_gen.InitClose(), &events);
+  }
+  return events;
+}
+
+std::vector<PerfBufferEvent> GenHTTPCapture(int num_conns, int num_reqs) {
+  testing::MockClock clock;
+  return GenCapture(&clock, num_conns, num_reqs,
+                    [](testing::EventGenerator* event_gen, conn_id_t, int,
+                       std::vector<PerfBufferEvent>* events) {
+                      AddDataEvent(*event_gen->InitSendEvent<kProtocolHTTP>(testing::kHTTPReq0),
+                                   events);
+                      AddDataEvent(*event_gen->InitRecvEvent<kProtocolHTTP>(testing::kHTTPResp0),
+                                   events);
+                    });
+}
+
+// gRPC calls traced by the Go uprobes, one stream per call. Like the replayer test, this uses the
+// real clock, as the uprobe events would otherwise be cleaned up as stale.
+std::vector<PerfBufferEvent> GenHTTP2Capture(int num_conns, int num_reqs) {
+  testing::RealClock clock;
+  return GenCapture(
+      &clock, num_conns, num_reqs,
+      [&clock](testing::EventGenerator*, conn_id_t conn_id, int r,
+               std::vector<PerfBufferEvent>* events) {
+        // Client-initiated streams have odd IDs.
+        testing::StreamEventGenerator frame_gen(&clock, conn_id, /* stream_id */ 2 * r + 1);
+        AddHTTP2HeaderEvent(*frame_gen.GenHeader<kHeaderEventWrite>(":method", "post"), events);
+        AddHTTP2HeaderEvent(*frame_gen.GenHeader<kHeaderEventWrite>(":path", "/magic"), events);
+        AddHTTP2DataEvent(
+            *frame_gen.GenDataFrame<kDataFrameEventWrite>("Request", /* end_stream */ true),
+            events);
+        AddHTTP2DataEvent(*frame_gen.GenDataFrame<kDataFrameEventRead>("Response"), events);
+        AddHTTP2HeaderEvent(*frame_gen.GenHeader<kHeaderEventRead>(":status", "200"), events);
+        AddHTTP2HeaderEvent(*frame_gen.GenEndStreamHeader<kHeaderEventRead>(), events);
+      });
+}
+
+// MySQL queries that return a multi-packet resultset.
+std::vector<PerfBufferEvent> GenMySQLCapture(int num_conns, int num_reqs) {
+  const std::string query_req = mysql::testutils::GenRawPacket(
+      mysql::testutils::GenStringRequest(mysql::testdata::kQueryRequest, mysql::Command::kQuery));
+  std::vector<std::string> query_resp;
+  for (const auto& packet : mysql::testutils::GenResultset(mysql::testdata::kQueryResultset)) {
+    query_resp.push_back(mysql::testutils::GenRawPacket(packet));
+  }
+
+  testing::MockClock clock;
+  return GenCapture(&clock, num_conns, num_reqs,
+                    [&](testing::EventGenerator* event_gen, conn_id_t, int,
+                        std::vector<PerfBufferEvent>* events) {
+                      AddDataEvent(*event_gen->InitSendEvent<kProtocolMySQL>(query_req), events);
+                      for (const auto& packet : query_resp) {
+                        AddDataEvent(*event_gen->InitRecvEvent<kProtocolMySQL>(packet), events);
+                      }
+                    });
+}
+
+// PostgreSQL extended queries: Parse, Describe, Bind and Execute, answered with a row.
+std::vector<PerfBufferEvent> GenPGSQLCapture(int num_conns, int num_reqs) {
+  const std::string query_req =
+      absl::StrCat(pgsql::kParseData1, pgsql::kDescData, pgsql::kBindData, pgsql::kExecData);
+  const std::string query_resp =
+      absl::StrCat(pgsql::kParseCmplData, pgsql::kParamDescData, pgsql::kRowDescData,
+                   pgsql::kBindCmplData, pgsql::kDataRowData, pgsql::kCmdCmplData);
+
+  testing::MockClock clock;
+  return GenCapture(&clock, num_conns, num_reqs,
+                    [&](testing::EventGenerator* event_gen, conn_id_t, int,
+                        std::vector<PerfBufferEvent>* events) {
+                      AddDataEvent(*event_gen->InitSendEvent<kProtocolPGSQL>(query_req), events);
+                      AddDataEvent(*event_gen->InitRecvEvent<kProtocolPGSQL>(query_resp), events);
+                    });
+}
+
+// Returns a copy of the raw Kafka packet, with the big-endian correlation ID at pos replaced.
+std::string WithCorrelationID(std::string_view packet, size_t pos, int32_t correlation_id) {
+  std::string result(packet);
+  for (size_t i = 0; i < sizeof(correlation_id); ++i) {
+    result[pos + i] = static_cast<char>(correlation_id >> (8 * (sizeof(correlation_id) - 1 - i)));
+  }
+  return result;
+}
+
+// Kafka Produce requests. Responses are matched to requests by correlation ID, so every request
+// of a connection gets its own.
+std::vector<PerfBufferEvent> GenKafkaCapture(int num_conns, int num_reqs) {
+  // The correlation ID follows the length, API key and API version in requests, and the length
+  // in responses.
+  constexpr size_t kReqCorrelationIDPos = 8;
+  constexpr size_t kRespCorrelationIDPos = 4;
+  const auto produce_req =
+      CreateStringView<char>(CharArrayStringView<uint8_t>(kafka::testdata::kProduceRequest));
+  const auto produce_resp =
+      CreateStringView<char>(CharArrayStringView<uint8_t>(kafka::testdata::kProduceResponse));
+
+  testing::MockClock clock;
+  return GenCapture(
+      &clock, num_conns, num_reqs,
+      [&](testing::EventGenerator* event_gen, conn_id_t, int r,
+          std::vector<PerfBufferEvent>* events) {
+        AddDataEvent(*event_gen->InitSendEvent<kProtocolKafka>(
+                         WithCorrelationID(produce_req, kReqCorrelationIDPos, r)),
+                     events);
+        AddDataEvent(*event_gen->InitRecvEvent<kProtocolKafka>(
+                         WithCorrelationID(produce_resp, kRespCorrelationIDPos, r)),
+                     events);
+      });
+}
+
+void ReplayCapture(benchmark::State& state,  // NOLINT : runtime/references.
+                   const std::vector<PerfBufferEvent>& events) {
+  FLAGS_stirling_check_proc_for_conn_close = false;
+
+  StandaloneContext ctx;
+  PL_CHECK_OK(ctx.SetClusterCIDR("1.2.3.4/32"));
+
+  int64_t data_bytes = 0;
+  int64_t num_events = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::unique_ptr<SourceConnector> connector =
+        SocketTraceConnector::Create("socket_trace_connector");
+    auto* source = dynamic_cast<SocketTraceConnector*>(connector.get());
+    testing::DataTables data_tables(SocketTraceConnector::kTables);
+    state.ResumeTiming();
+
+    SocketTraceReplayer replayer(source, SocketTraceReplayer::Speed::kMax);
+    PL_CHECK_OK(replayer.Replay(&ctx, data_tables.tables(), events));
+
+    data_bytes += replayer.stats().data_bytes;
+    num_events += events.size();
+  }
+  state.SetBytesProcessed(data_bytes);
+  state.SetItemsProcessed(num_events);
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayHTTP(benchmark::State& state) {
+  ReplayCapture(state, GenHTTPCapture(state.range(0), state.range(1)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayHTTP2(benchmark::State& state) {
+  ReplayCapture(state, GenHTTP2Capture(state.range(0), state.range(1)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayMySQL(benchmark::State& state) {
+  ReplayCapture(state, GenMySQLCapture(state.range(0), state.range(1)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayPGSQL(benchmark::State& state) {
+  ReplayCapture(state, GenPGSQLCapture(state.range(0), state.range(1)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayKafka(benchmark::State& state) {
+  ReplayCapture(state, GenKafkaCapture(state.range(0), state.range(1)));
+}
+
+// NOLINTNEXTLINE : runtime/references.
+static void BM_ReplayCaptureFile(benchmark::State& state) {
+  if (FLAGS_replay_capture_path.empty()) {
+    state.SkipWithError("--replay_capture_path is not set.");
+    return;
+  }
+  PL_ASSIGN_OR_EXIT(std::vector<PerfBufferEvent> events,
+                    ReadPerfBufferEvents(FLAGS_replay_capture_path));
+  ReplayCapture(state, events);
+}
+
+// Arguments are {number of connections, requests per connection}.
+BENCHMARK(BM_ReplayHTTP)->RangeMultiplier(16)->Ranges({{1, 256}, {16, 256}});
+BENCHMARK(BM_ReplayHTTP2)->RangeMultiplier(16)->Ranges({{1, 256}, {16, 256}});
+BENCHMARK(BM_ReplayMySQL)->RangeMultiplier(16)->Ranges({{1, 256}, {16, 256}});
+BENCHMARK(BM_ReplayPGSQL)->RangeMultiplier(16)->Ranges({{1, 256}, {16, 256}});
+BENCHMARK(BM_ReplayKafka)->RangeMultiplier(16)->Ranges({{1, 256}, {16, 256}});
+BENCHMARK(BM_ReplayCaptureFile);
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/socket_trace_replayer.h"
+
+#include <gtest/gtest.h>
+
+#include <google/protobuf/util/delimited_message_util.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/stirling/source_connectors/socket_tracer/perf_buffer_events.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/event_generator.h"
+#include "src/stirling/source_connectors/socket_tracer/testing/http2_stream_generator.h"
+#include "src/stirling/testing/common.h"
+
+namespace px {
+namespace stirling {
+
+class SocketTraceReplayerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    connector_ = SocketTraceConnector::Create("socket_trace_connector");
+    source_ = dynamic_cast<SocketTraceConnector*>(connector_.get());
+    ASSERT_NE(nullptr, source_);
+
+    ctx_ = std::make_unique<StandaloneContext>();
+    PL_CHECK_OK(ctx_->SetClusterCIDR("1.2.3.4/32"));
+
+    FLAGS_stirling_check_proc_for_conn_close = false;
+    data_tables_ = std::make_unique<testing::DataTables>(SocketTraceConnector::kTables);
+  }
+
+  // Records the events of one HTTP request and response, in the same way as the connector.
+  std::vector<sockeventpb::PerfBufferEvent> RecordHTTPConn() {
+    testing::EventGenerator event_gen(&mock_clock_);
+    std::vector<sockeventpb::PerfBufferEvent> events(4);
+    SocketControlEventToPB(event_gen.InitConn(), events[0].mutable_control_event());
+    SocketDataEventToPB(*event_gen.InitSendEvent<kProtocolHTTP>(testing::kHTTPReq0),
+                        events[1].mutable_data_event());
+    SocketDataEventToPB(*event_gen.InitRecvEvent<kProtocolHTTP>(testing::kHTTPResp0),
+                        events[2].mutable_data_event());
+    SocketControlEventToPB(event_gen.InitClose(), events[3].mutable_control_event());
+    return events;
+  }
+
+  // Records the events of one gRPC call traced by the Go uprobes. Like the connector tests, this
+  // uses the real clock, as the uprobe events would otherwise be cleaned up as stale.
+  std::vector<sockeventpb::PerfBufferEvent> RecordHTTP2Conn() {
+    testing::EventGenerator event_gen(&real_clock_);
+    socket_control_event_t conn = event_gen.InitConn();
+    testing::StreamEventGenerator frame_gen(&real_clock_, conn.conn_id, 7);
+
+    std::vector<sockeventpb::PerfBufferEvent> events(9);
+    SocketControlEventToPB(conn, events[0].mutable_control_event());
+    HTTP2HeaderEventToPB(*frame_gen.GenHeader<kHeaderEventWrite>(":method", "post"),
+                         events[1].mutable_http2_header_event());
+    HTTP2HeaderEventToPB(*frame_gen.GenHeader<kHeaderEventWrite>(":path", "/magic"),
+                         events[2].mutable_http2_header_event());
+    HTTP2DataEventToPB(*frame_gen.GenDataFrame<kDataFrameEventWrite>("Req"),
+                       events[3].mutable_http2_data_event());
+    HTTP2DataEventToPB(
+        *frame_gen.GenDataFrame<kDataFrameEventWrite>("uest", /* end_stream */ true),
+        events[4].mutable_http2_data_event());
+    HTTP2DataEventToPB(*frame_gen.GenDataFrame<kDataFrameEventRead>("Response"),
+                       events[5].mutable_http2_data_event());
+    HTTP2HeaderEventToPB(*frame_gen.GenHeader<kHeaderEventRead>(":status", "200"),
+                         events[6].mutable_http2_header_event());
+    HTTP2HeaderEventToPB(*frame_gen.GenEndStreamHeader<kHeaderEventRead>(),
+                         events[7].mutable_http2_header_event());
+    SocketControlEventToPB(event_gen.InitClose(), events[8].mutable_control_event());
+    return events;
+  }
+
+  std::unique_ptr<testing::DataTables> data_tables_;
+  std::unique_ptr<SourceConnector> connector_;
+  SocketTraceConnector* source_ = nullptr;
+  std::unique_ptr<StandaloneContext> ctx_;
+  testing::MockClock mock_clock_;
+  testing::RealClock real_clock_;
+};
+
+TEST_F(SocketTraceReplayerTest, EventsRoundTrip) {
+  testing::EventGenerator event_gen(&mock_clock_);
+  socket_control_event_t conn = event_gen.InitConn(kRoleClient);
+  testing::SetIPv4RemoteAddr(&conn, "1.1.1.1", 8080);
+  std::unique_ptr<SocketDataEvent> data = event_gen.InitSendEvent<kProtocolHTTP>("abc");
+
+  sockeventpb::SocketControlEvent conn_pb;
+  SocketControlEventToPB(conn, &conn_pb);
+  socket_control_event_t conn_copy = SocketControlEventFromPB(conn_pb);
+  EXPECT_EQ(conn.timestamp_ns, conn_copy.timestamp_ns);
+  EXPECT_EQ(conn.conn_id, conn_copy.conn_id);
+  EXPECT_EQ(kRoleClient, conn_copy.open.role);
+  EXPECT_EQ(conn.open.addr.in4.sin_port, conn_copy.open.addr.in4.sin_port);
+  EXPECT_EQ(conn.open.addr.in4.sin_addr.s_addr, conn_copy.open.addr.in4.sin_addr.s_addr);
+
+  sockeventpb::SocketDataEvent data_pb;
+  SocketDataEventToPB(*data, &data_pb);
+  std::unique_ptr<SocketDataEvent> data_copy = SocketDataEventFromPB(data_pb);
+  EXPECT_EQ(data->attr.timestamp_ns, data_copy->attr.timestamp_ns);
+  EXPECT_EQ(data->attr.conn_id, data_copy->attr.conn_id);
+  EXPECT_EQ(data->attr.protocol, data_copy->attr.protocol);
+  EXPECT_EQ(data->attr.direction, data_copy->attr.direction);
+  EXPECT_EQ(data->attr.pos, data_copy->attr.pos);
+  EXPECT_EQ("abc", data_copy->msg);
+  EXPECT_EQ(3, data_copy->attr.msg_buf_size);
+}
+
+TEST_F(SocketTraceReplayerTest, HTTP2EventsRoundTrip) {
+  testing::EventGenerator event_gen(&mock_clock_);
+  testing::StreamEventGenerator frame_gen(&mock_clock_, event_gen.InitConn().conn_id, 7);
+  std::unique_ptr<HTTP2HeaderEvent> header =
+      frame_gen.GenHeader<kHeaderEventRead>(":path", "/magic");
+  std::unique_ptr<HTTP2DataEvent> data =
+      frame_gen.GenDataFrame<kDataFrameEventWrite>("abc", /* end_stream */ true);
+
+  sockeventpb::HTTP2HeaderEvent header_pb;
+  HTTP2HeaderEventToPB(*header, &header_pb);
+  std::unique_ptr<HTTP2HeaderEvent> header_copy = HTTP2HeaderEventFromPB(header_pb);
+  EXPECT_EQ(header->attr.timestamp_ns, header_copy->attr.timestamp_ns);
+  EXPECT_EQ(header->attr.conn_id, header_copy->attr.conn_id);
+  EXPECT_EQ(kHeaderEventRead, header_copy->attr.type);
+  EXPECT_EQ(7, header_copy->attr.stream_id);
+  EXPECT_EQ(":path", header_copy->name);
+  EXPECT_EQ("/magic", header_copy->value);
+
+  sockeventpb::HTTP2DataEvent data_pb;
+  HTTP2DataEventToPB(*data, &data_pb);
+  std::unique_ptr<HTTP2DataEvent> data_copy = HTTP2DataEventFromPB(data_pb);
+  EXPECT_EQ(data->attr.timestamp_ns, data_copy->attr.timestamp_ns);
+  EXPECT_EQ(data->attr.conn_id, data_copy->attr.conn_id);
+  EXPECT_EQ(kDataFrameEventWrite, data_copy->attr.type);
+  EXPECT_TRUE(data_copy->attr.end_stream);
+  EXPECT_EQ("abc", data_copy->payload);
+  EXPECT_EQ(3, data_copy->attr.data_buf_size);
+}
+
+TEST_F(SocketTraceReplayerTest, ReplayCaptureFile) {
+  std::vector<sockeventpb::PerfBufferEvent> events = RecordHTTPConn();
+
+  px::testing::TempDir temp_dir;
+  std::filesystem::path path = temp_dir.path() / "capture.bin";
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    for (const auto& event : events) {
+      ASSERT_TRUE(google::protobuf::util::SerializeDelimitedToOstream(event, &ofs));
+    }
+  }
+  ASSERT_OK_AND_ASSIGN(std::vector<sockeventpb::PerfBufferEvent> read_events,
+                       ReadPerfBufferEvents(path));
+  ASSERT_EQ(events.size(), read_events.size());
+
+  SocketTraceReplayer replayer(source_, SocketTraceReplayer::Speed::kMax);
+  ASSERT_OK(replayer.Replay(ctx_.get(), data_tables_->tables(), read_events));
+  EXPECT_EQ(2, replayer.stats().data_events);
+  EXPECT_EQ(2, replayer.stats().control_events);
+
+  DataTable* http_table = (*data_tables_)[SocketTraceConnector::kHTTPTableNum];
+  std::vector<TaggedRecordBatch> tablets = http_table->ConsumeRecords();
+  ASSERT_EQ(1, tablets.size());
+  types::ColumnWrapperRecordBatch& records = tablets[0].records;
+  ASSERT_EQ(1, records[kHTTPReqPathIdx]->Size());
+  EXPECT_EQ("/index.html", records[kHTTPReqPathIdx]->Get<types::StringValue>(0));
+  EXPECT_EQ("pixie", records[kHTTPRespBodyIdx]->Get<types::StringValue>(0));
+}
+
+TEST_F(SocketTraceReplayerTest, ReplayHTTP2Capture) {
+  std::vector<sockeventpb::PerfBufferEvent> events = RecordHTTP2Conn();
+
+  SocketTraceReplayer replayer(source_, SocketTraceReplayer::Speed::kMax);
+  ASSERT_OK(replayer.Replay(ctx_.get(), data_tables_->tables(), events));
+  EXPECT_EQ(4, replayer.stats().http2_header_events);
+  EXPECT_EQ(3, replayer.stats().http2_data_events);
+
+  DataTable* http_table = (*data_tables_)[SocketTraceConnector::kHTTPTableNum];
+  std::vector<TaggedRecordBatch> tablets = http_table->ConsumeRecords();
+  ASSERT_EQ(1, tablets.size());
+  types::ColumnWrapperRecordBatch& records = tablets[0].records;
+  ASSERT_EQ(1, records[kHTTPReqPathIdx]->Size());
+  EXPECT_EQ("/magic", records[kHTTPReqPathIdx]->Get<types::StringValue>(0));
+  EXPECT_EQ("Request", records[kHTTPReqBodyIdx]->Get<types::StringValue>(0));
+  EXPECT_EQ("Response", records[kHTTPRespBodyIdx]->Get<types::StringValue>(0));
+  EXPECT_EQ(200, records[kHTTPRespStatusIdx]->Get<types::Int64Value>(0));
+}
+
+TEST_F(SocketTraceReplayerTest, MalformedCapture) {
+  px::testing::TempDir temp_dir;
+  std::filesystem::path path = temp_dir.path() / "capture.bin";
+  {
+    std::ofstream ofs(path, std::ios::binary);
+    // A length prefix that runs past the end of the file.
+    ofs << '\x7f' << "abc";
+  }
+  EXPECT_NOT_OK(ReadPerfBufferEvents(path));
+  EXPECT_NOT_OK(ReadPerfBufferEvents(temp_dir.path() / "missing.bin"));
+}
+
+}  // namespace stirling
+}  // namespace px
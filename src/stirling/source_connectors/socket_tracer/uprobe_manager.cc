@@ -31,6 +31,7 @@
 #include "src/common/fs/fs_wrapper.h"
 #include "src/stirling/bpf_tools/macros.h"
 #include "src/stirling/obj_tools/dwarf_reader.h"
+#include "src/stirling/obj_tools/elf_build_id.h"
 #include "src/stirling/obj_tools/go_syms.h"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
@@ -42,6 +43,10 @@ DEFINE_bool(stirling_rescan_for_dlopen, false,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_int32(stirling_uprobe_dwarf_index_threads,
+             gflags::Int32FromEnv("PL_STIRLING_UPROBE_DWARF_INDEX_THREADS", 2),
+             "Number of threads that index the DWARF info of a Go binary, to resolve the symaddrs "
+             "of its uprobes.");
 
 namespace px {
 namespace stirling {
@@ -49,7 +54,10 @@ namespace stirling {
 using ::px::stirling::obj_tools::DwarfReader;
 using ::px::stirling::obj_tools::ElfReader;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc),
+      go_symaddrs_cache_("go", FLAGS_stirling_uprobe_symaddrs_cache_dir),
+      openssl_symaddrs_cache_("openssl", FLAGS_stirling_uprobe_symaddrs_cache_dir) {
   proc_parser_ = std::make_unique<system::ProcParser>(system::Config::GetInstance());
 }
 
@@ -130,46 +138,45 @@ StatusOr<int> UProbeManager::AttachUProbeTmpl(const ArrayView<UProbeTmpl>& probe
 }
 
 Status UProbeManager::UpdateOpenSSLSymAddrs(std::filesystem::path libcrypto_path, uint32_t pid) {
-  PL_ASSIGN_OR_RETURN(struct openssl_symaddrs_t symaddrs, OpenSSLSymAddrs(libcrypto_path));
+  // The symaddrs depend only on the library, so processes with the same library share them.
+  StatusOr<std::string> content_key = obj_tools::BinaryContentKey(libcrypto_path);
+  const struct openssl_symaddrs_t* cached_symaddrs =
+      content_key.ok() ? openssl_symaddrs_cache_.Lookup(content_key.ValueOrDie()) : nullptr;
+
+  struct openssl_symaddrs_t symaddrs;
+  if (cached_symaddrs != nullptr) {
+    symaddrs = *cached_symaddrs;
+  } else {
+    PL_ASSIGN_OR_RETURN(symaddrs, OpenSSLSymAddrs(libcrypto_path));
+    if (content_key.ok()) {
+      openssl_symaddrs_cache_.Insert(content_key.ValueOrDie(), symaddrs);
+    }
+  }
 
   openssl_symaddrs_map_->UpdateValue(pid, symaddrs);
 
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
+                                           const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
-
-  return Status::OK();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
+                                          const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
-
-  return Status::OK();
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PL_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
+                                        const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
-
-  return Status::OK();
 }
 
 Status UProbeManager::UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
@@ -359,18 +366,17 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(uint32_t pid) {
   return kOpenSSLUProbes.size() + count;
 }
 
-StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
-                                                obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
-                                                const std::vector<int32_t>& pids) {
+StatusOr<int> UProbeManager::AttachGoTLSUProbes(
+    const std::string& binary, obj_tools::ElfReader* elf_reader,
+    const std::optional<struct go_tls_symaddrs_t>& symaddrs, const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!symaddrs.has_value()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
     return 0;
   }
+  UpdateGoTLSSymAddrs(symaddrs.value(), pids);
 
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
@@ -385,15 +391,14 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
 // That allows the BPF code and companion user-space code for uprobe & kprobe be separated
 // cleanly. For example, right now, enabling uprobe & kprobe simultaneously can crash Stirling,
 // because of the mixed & duplicate data events from these 2 sources.
-StatusOr<int> UProbeManager::AttachGoHTTP2Probes(const std::string& binary,
-                                                 obj_tools::ElfReader* elf_reader,
-                                                 obj_tools::DwarfReader* dwarf_reader,
-                                                 const std::vector<int32_t>& pids) {
+StatusOr<int> UProbeManager::AttachGoHTTP2Probes(
+    const std::string& binary, obj_tools::ElfReader* elf_reader,
+    const std::optional<struct go_http2_symaddrs_t>& symaddrs, const std::vector<int32_t>& pids) {
   // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!symaddrs.has_value()) {
     return 0;
   }
+  UpdateGoHTTP2SymAddrs(symaddrs.value(), pids);
 
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
@@ -439,6 +444,44 @@ std::map<std::string, std::vector<int32_t>> ConvertPIDsListToMap(
   return pids;
 }
 
+// Resolves the symaddrs of a binary for Go uprobes, from its ELF and DWARF info.
+// Returns an error if the binary could not be analyzed; such results are not cached.
+StatusOr<GoBinarySymaddrs> ResolveGoBinarySymaddrs(const std::string& binary,
+                                                   ElfReader* elf_reader) {
+  GoBinarySymaddrs symaddrs;
+
+  // Avoid going passed this point if not a golang program.
+  // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
+  if (!IsGoExecutable(elf_reader)) {
+    return symaddrs;
+  }
+  symaddrs.is_go_binary = true;
+
+  PL_ASSIGN_OR_RETURN(std::unique_ptr<DwarfReader> dwarf_reader,
+                      DwarfReader::CreateIndexingAllLazily(
+                          binary, FLAGS_stirling_uprobe_dwarf_index_threads));
+
+  StatusOr<struct go_common_symaddrs_t> common = GoCommonSymAddrs(elf_reader, dwarf_reader.get());
+  if (!common.ok()) {
+    // Without the mandatory symbols, none of the probes are useful.
+    return symaddrs;
+  }
+  symaddrs.common = common.ConsumeValueOrDie();
+
+  // HTTP2 symaddrs are resolved even if HTTP2 tracing is disabled, so that cached entries are
+  // complete regardless of the configuration.
+  StatusOr<struct go_tls_symaddrs_t> tls = GoTLSSymAddrs(elf_reader, dwarf_reader.get());
+  if (tls.ok()) {
+    symaddrs.tls = tls.ConsumeValueOrDie();
+  }
+  StatusOr<struct go_http2_symaddrs_t> http2 = GoHTTP2SymAddrs(elf_reader, dwarf_reader.get());
+  if (http2.ok()) {
+    symaddrs.http2 = http2.ConsumeValueOrDie();
+  }
+
+  return symaddrs;
+}
+
 }  // namespace
 
 std::thread UProbeManager::RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids) {
@@ -520,6 +563,15 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       }
     }
 
+    // Copies of a binary (e.g. in the containers of different pods) share their symaddrs,
+    // so they are looked up by the contents of the binary, rather than its path.
+    StatusOr<std::string> content_key = obj_tools::BinaryContentKey(binary);
+    const GoBinarySymaddrs* cached_symaddrs =
+        content_key.ok() ? go_symaddrs_cache_.Lookup(content_key.ValueOrDie()) : nullptr;
+    if (cached_symaddrs != nullptr && !cached_symaddrs->is_go_binary) {
+      continue;
+    }
+
     // Read binary's symbols.
     StatusOr<std::unique_ptr<ElfReader>> elf_reader_status = ElfReader::Create(binary);
     if (!elf_reader_status.ok()) {
@@ -532,34 +584,40 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     }
     std::unique_ptr<ElfReader> elf_reader = elf_reader_status.ConsumeValueOrDie();
 
-    // Avoid going passed this point if not a golang program.
-    // The DwarfReader is memory intensive, and the remaining probes are Golang specific.
-    if (!IsGoExecutable(elf_reader.get())) {
-      continue;
+    GoBinarySymaddrs symaddrs;
+    if (cached_symaddrs != nullptr) {
+      symaddrs = *cached_symaddrs;
+    } else {
+      StatusOr<GoBinarySymaddrs> symaddrs_status =
+          ResolveGoBinarySymaddrs(binary, elf_reader.get());
+      if (!symaddrs_status.ok()) {
+        VLOG(1) << absl::Substitute(
+            "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
+            "Message = $1",
+            binary, symaddrs_status.msg());
+        continue;
+      }
+      symaddrs = symaddrs_status.ConsumeValueOrDie();
+      if (content_key.ok()) {
+        go_symaddrs_cache_.Insert(content_key.ValueOrDie(), symaddrs);
+      }
     }
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
+    if (!symaddrs.is_go_binary) {
       continue;
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
 
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
+    if (!symaddrs.common.has_value()) {
       VLOG(1) << absl::Substitute(
           "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
       continue;
     }
+    UpdateGoCommonSymAddrs(symaddrs.common.value(), pid_vec);
 
     // GoTLS Probes.
     {
       StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+          AttachGoTLSUProbes(binary, elf_reader.get(), symaddrs.tls, pid_vec);
       if (!attach_status.ok()) {
         LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach GoTLS Uprobes to $0: $1",
                                                      binary, attach_status.ToString());
@@ -571,7 +629,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     // Go HTTP2 Probes.
     if (cfg_enable_http2_tracing_) {
       StatusOr<int> attach_status =
-          AttachGoHTTP2Probes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+          AttachGoHTTP2Probes(binary, elf_reader.get(), symaddrs.http2, pid_vec);
       if (!attach_status.ok()) {
         LOG_FIRST_N(WARNING, 10) << absl::Substitute("Failed to attach HTTP2 Uprobes to $0: $1",
                                                      binary, attach_status.ToString());
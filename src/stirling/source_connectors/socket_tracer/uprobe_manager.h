@@ -20,6 +20,7 @@
 
 #include <map>
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -32,6 +33,7 @@
 
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
 
 #include "src/stirling/utils/detect_application.h"
 #include "src/stirling/utils/proc_path_tools.h"
@@ -39,6 +41,7 @@
 
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_int32(stirling_uprobe_dwarf_index_threads);
 
 namespace px {
 namespace stirling {
@@ -363,7 +366,7 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs The Go HTTP2 symaddrs of the binary, if it has the required symbols.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
@@ -371,7 +374,7 @@ class UProbeManager {
    *         zero.
    */
   StatusOr<int> AttachGoHTTP2Probes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                    obj_tools::DwarfReader* dwarf_reader,
+                                    const std::optional<struct go_http2_symaddrs_t>& symaddrs,
                                     const std::vector<int32_t>& pids);
 
   /**
@@ -380,14 +383,14 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs The Go TLS symaddrs of the binary, if it has the required symbols.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
   StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+                                   const std::optional<struct go_tls_symaddrs_t>& symaddrs,
                                    const std::vector<int32_t>& new_pids);
 
   /**
@@ -428,14 +431,12 @@ class UProbeManager {
   absl::flat_hash_set<md::UPID> PIDsToRescanForUProbes();
 
   Status UpdateOpenSSLSymAddrs(std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
+  void UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
+                              const std::vector<int32_t>& pids);
+  void UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                              const std::vector<int32_t>& pids);
+  void UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
+                           const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
 
@@ -479,6 +480,11 @@ class UProbeManager {
   absl::flat_hash_set<std::string> go_tls_probed_binaries_;
   absl::flat_hash_set<std::string> nodejs_binaries_;
 
+  // The symaddrs resolved from binaries, keyed on the contents of the binaries, so that the
+  // ELF and DWARF info of copies of the same binary (e.g. in different pods) is analyzed once.
+  SymaddrsCache<GoBinarySymaddrs> go_symaddrs_cache_;
+  SymaddrsCache<struct openssl_symaddrs_t> openssl_symaddrs_cache_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>>
       openssl_symaddrs_map_;
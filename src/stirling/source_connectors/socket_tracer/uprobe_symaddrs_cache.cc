@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+
+DEFINE_string(stirling_uprobe_symaddrs_cache_dir,
+              gflags::StringFromEnv("PL_STIRLING_UPROBE_SYMADDRS_CACHE_DIR", ""),
+              "If set, the symaddrs resolved from binaries for uprobes are persisted in this "
+              "directory, so they don't have to be resolved again after a restart.");
+
+namespace px {
+namespace stirling {
+namespace internal {
+
+namespace {
+
+// Identifies the layout of persisted entries.
+// Must be bumped whenever the layout of the cached structs changes.
+constexpr uint32_t kFormatVersion = 1;
+
+struct EntryHeader {
+  uint32_t format_version;
+  uint32_t value_size;
+};
+
+}  // namespace
+
+StatusOr<std::string> ReadSymaddrsCacheEntry(const std::filesystem::path& path,
+                                             size_t value_size) {
+  PL_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(path, std::ios_base::binary));
+
+  EntryHeader header;
+  if (contents.size() != sizeof(header) + value_size) {
+    return error::Internal("Unexpected size of symaddrs cache entry $0", path.string());
+  }
+  std::memcpy(&header, contents.data(), sizeof(header));
+  if (header.format_version != kFormatVersion || header.value_size != value_size) {
+    return error::Internal("Symaddrs cache entry $0 has an outdated format", path.string());
+  }
+
+  return contents.substr(sizeof(header));
+}
+
+Status WriteSymaddrsCacheEntry(const std::filesystem::path& path, std::string_view value) {
+  PL_RETURN_IF_ERROR(fs::CreateDirectories(path.parent_path()));
+
+  EntryHeader header = {kFormatVersion, static_cast<uint32_t>(value.size())};
+  std::string contents(reinterpret_cast<const char*>(&header), sizeof(header));
+  contents.append(value);
+
+  std::filesystem::path tmp_path = path;
+  tmp_path += absl::StrCat(".tmp", getpid());
+  PL_RETURN_IF_ERROR(WriteFileFromString(tmp_path, contents, std::ios_base::binary));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::System("Failed to rename $0 to $1. Message: $2", tmp_path.string(),
+                         path.string(), ec.message());
+  }
+  return Status::OK();
+}
+
+}  // namespace internal
+}  // namespace stirling
+}  // namespace px
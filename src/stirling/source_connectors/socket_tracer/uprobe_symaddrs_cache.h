@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+
+DECLARE_string(stirling_uprobe_symaddrs_cache_dir);
+
+namespace px {
+namespace stirling {
+
+/**
+ * The symaddrs resolved from a binary for Go uprobes.
+ * Binaries that are not Go binaries are recorded too, so they can be skipped.
+ * A member without a value means the binary lacks the symbols for that set of probes.
+ */
+struct GoBinarySymaddrs {
+  bool is_go_binary = false;
+  std::optional<struct go_common_symaddrs_t> common;
+  std::optional<struct go_tls_symaddrs_t> tls;
+  std::optional<struct go_http2_symaddrs_t> http2;
+};
+
+namespace internal {
+
+// Reads a persisted cache entry. Returns an error if it doesn't exist or has an unexpected format.
+StatusOr<std::string> ReadSymaddrsCacheEntry(const std::filesystem::path& path, size_t value_size);
+
+// Persists a cache entry. The file is written under a temporary name and then renamed, so that
+// concurrent readers never see a partially written entry.
+Status WriteSymaddrsCacheEntry(const std::filesystem::path& path, std::string_view value);
+
+}  // namespace internal
+
+/**
+ * A cache of the symaddrs resolved from binaries, keyed on the contents of the binary
+ * (see obj_tools::BinaryContentKey()). Copies of the same binary, like the executables of all the
+ * pods of a deployment, are then analyzed only once.
+ *
+ * If a directory is specified, entries are also persisted there, one file per entry, so that they
+ * survive restarts. Values are persisted as raw bytes, so they must be trivially copyable.
+ * NOTE: Bump kFormatVersion (in the .cc) whenever the layout of the symaddrs structs changes.
+ */
+template <typename TValue>
+class SymaddrsCache {
+  static_assert(std::is_trivially_copyable_v<TValue>, "Values are persisted as raw bytes.");
+
+ public:
+  /**
+   * @param name Distinguishes the entries of this cache from others in the same directory.
+   * @param persist_dir Directory in which to persist entries. Empty to keep them in memory only.
+   */
+  explicit SymaddrsCache(std::string_view name, std::filesystem::path persist_dir = {})
+      : persist_dir_(persist_dir.empty() ? persist_dir : persist_dir / name) {}
+
+  /**
+   * Returns the cached value for the key, or nullptr if there is none.
+   * Falls back to the persisted entries on an in-memory miss.
+   */
+  const TValue* Lookup(const std::string& key) {
+    auto iter = entries_.find(key);
+    if (iter != entries_.end()) {
+      return &iter->second;
+    }
+    if (persist_dir_.empty()) {
+      return nullptr;
+    }
+
+    StatusOr<std::string> bytes_or =
+        internal::ReadSymaddrsCacheEntry(persist_dir_ / key, sizeof(TValue));
+    if (!bytes_or.ok()) {
+      return nullptr;
+    }
+    TValue value;
+    std::memcpy(&value, bytes_or.ValueOrDie().data(), sizeof(TValue));
+    return &entries_.insert_or_assign(key, value).first->second;
+  }
+
+  /**
+   * Caches the value for the key, and persists it if the cache has a directory.
+   */
+  void Insert(const std::string& key, const TValue& value) {
+    entries_.insert_or_assign(key, value);
+    if (persist_dir_.empty()) {
+      return;
+    }
+
+    std::string_view bytes(reinterpret_cast<const char*>(&value), sizeof(TValue));
+    Status s = internal::WriteSymaddrsCacheEntry(persist_dir_ / key, bytes);
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Could not persist symaddrs for $0: $1", key,
+                                                 s.msg());
+  }
+
+  size_t size() const { return entries_.size(); }
+
+ private:
+  const std::filesystem::path persist_dir_;
+  absl::flat_hash_map<std::string, TValue> entries_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include "src/common/base/file.h"
+#include "src/common/fs/fs_wrapper.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+GoBinarySymaddrs TestGoBinarySymaddrs() {
+  GoBinarySymaddrs symaddrs;
+  symaddrs.is_go_binary = true;
+  symaddrs.common = go_common_symaddrs_t{};
+  symaddrs.common->FD_Sysfd_offset = 16;
+  symaddrs.tls = go_tls_symaddrs_t{};
+  symaddrs.tls->Write_c_loc = {kLocationTypeStack, 8};
+  return symaddrs;
+}
+
+TEST(SymaddrsCacheTest, InMemory) {
+  SymaddrsCache<GoBinarySymaddrs> cache("go");
+
+  EXPECT_EQ(cache.Lookup("gnu-1234"), nullptr);
+
+  cache.Insert("gnu-1234", TestGoBinarySymaddrs());
+  cache.Insert("gnu-5678", GoBinarySymaddrs{});
+  EXPECT_EQ(cache.size(), 2);
+
+  const GoBinarySymaddrs* symaddrs = cache.Lookup("gnu-1234");
+  ASSERT_NE(symaddrs, nullptr);
+  EXPECT_TRUE(symaddrs->is_go_binary);
+  ASSERT_TRUE(symaddrs->common.has_value());
+  EXPECT_EQ(symaddrs->common->FD_Sysfd_offset, 16);
+  ASSERT_TRUE(symaddrs->tls.has_value());
+  EXPECT_EQ(symaddrs->tls->Write_c_loc.offset, 8);
+  EXPECT_FALSE(symaddrs->http2.has_value());
+
+  symaddrs = cache.Lookup("gnu-5678");
+  ASSERT_NE(symaddrs, nullptr);
+  EXPECT_FALSE(symaddrs->is_go_binary);
+}
+
+TEST(SymaddrsCacheTest, Persisted) {
+  px::testing::TempDir tmp_dir;
+
+  {
+    SymaddrsCache<GoBinarySymaddrs> cache("go", tmp_dir.path());
+    cache.Insert("gnu-1234", TestGoBinarySymaddrs());
+  }
+
+  // A new cache, like after a restart, finds the entry in the directory.
+  SymaddrsCache<GoBinarySymaddrs> cache("go", tmp_dir.path());
+  EXPECT_EQ(cache.size(), 0);
+  const GoBinarySymaddrs* symaddrs = cache.Lookup("gnu-1234");
+  ASSERT_NE(symaddrs, nullptr);
+  ASSERT_TRUE(symaddrs->common.has_value());
+  EXPECT_EQ(symaddrs->common->FD_Sysfd_offset, 16);
+  EXPECT_EQ(cache.size(), 1);
+
+  // Caches with different names don't see each other's entries.
+  SymaddrsCache<GoBinarySymaddrs> other_cache("other", tmp_dir.path());
+  EXPECT_EQ(other_cache.Lookup("gnu-1234"), nullptr);
+}
+
+TEST(SymaddrsCacheTest, IgnoresCorruptEntries) {
+  px::testing::TempDir tmp_dir;
+  ASSERT_OK(fs::CreateDirectories(tmp_dir.path() / "go"));
+  ASSERT_OK(WriteFileFromString(tmp_dir.path() / "go" / "gnu-1234", "garbage"));
+
+  SymaddrsCache<GoBinarySymaddrs> cache("go", tmp_dir.path());
+  EXPECT_EQ(cache.Lookup("gnu-1234"), nullptr);
+}
+
+}  // namespace stirling
+}  // namespace px
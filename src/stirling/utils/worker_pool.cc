@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/worker_pool.h"
+
+namespace px {
+namespace stirling {
+
+WorkerPool::WorkerPool(int num_threads) {
+  DCHECK_GE(num_threads, 1);
+  for (int i = 1; i < num_threads; ++i) {
+    threads_.emplace_back(&WorkerPool::WorkerLoop, this, i);
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    stop_ = true;
+    work_cv_.SignalAll();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::RunItems(int worker_idx) {
+  for (size_t i = next_item_.fetch_add(1, std::memory_order_relaxed); i < num_items_;
+       i = next_item_.fetch_add(1, std::memory_order_relaxed)) {
+    (*fn_)(worker_idx, i);
+  }
+}
+
+void WorkerPool::WorkerLoop(int worker_idx) {
+  uint64_t generation = 0;
+  while (true) {
+    {
+      absl::MutexLock lock(&mutex_);
+      while (!stop_ && generation_ == generation) {
+        work_cv_.Wait(&mutex_);
+      }
+      if (stop_) {
+        return;
+      }
+      generation = generation_;
+    }
+
+    RunItems(worker_idx);
+
+    absl::MutexLock lock(&mutex_);
+    if (--num_busy_ == 0) {
+      done_cv_.Signal();
+    }
+  }
+}
+
+void WorkerPool::ParallelFor(size_t num_items, const std::function<void(int, size_t)>& fn) {
+  // Not worth waking up the workers.
+  if (threads_.empty() || num_items <= 1) {
+    for (size_t i = 0; i < num_items; ++i) {
+      fn(0, i);
+    }
+    return;
+  }
+
+  {
+    absl::MutexLock lock(&mutex_);
+    fn_ = &fn;
+    num_items_ = num_items;
+    next_item_.store(0, std::memory_order_relaxed);
+    num_busy_ = threads_.size();
+    ++generation_;
+    work_cv_.SignalAll();
+  }
+
+  RunItems(0);
+
+  absl::MutexLock lock(&mutex_);
+  while (num_busy_ > 0) {
+    done_cv_.Wait(&mutex_);
+  }
+  fn_ = nullptr;
+}
+
+}  // namespace stirling
+}  // namespace px
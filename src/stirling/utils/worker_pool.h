@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <absl/synchronization/mutex.h>
+
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * WorkerPool runs batches of independent work items on a fixed set of threads.
+ * The threads are started once and reused by every batch, so it is cheap enough to run a batch
+ * on every sampling iteration of a source connector.
+ */
+class WorkerPool : public NotCopyable {
+ public:
+  /**
+   * @param num_threads The number of threads that run the work items, including the thread that
+   * calls ParallelFor(). num_threads - 1 threads are started.
+   */
+  explicit WorkerPool(int num_threads);
+  ~WorkerPool();
+
+  int num_threads() const { return threads_.size() + 1; }
+
+  /**
+   * Calls fn(worker_idx, item_idx) once for every item_idx in [0, num_items), on the workers and
+   * the calling thread, and returns once all the calls have returned.
+   *
+   * worker_idx is in [0, num_threads()), and no two concurrent calls get the same worker_idx, so
+   * it can be used to index per-worker state without synchronization. Items are handed out in
+   * increasing order, but may complete in any order.
+   *
+   * Must not be called concurrently, or from within fn.
+   */
+  void ParallelFor(size_t num_items, const std::function<void(int, size_t)>& fn);
+
+ private:
+  void WorkerLoop(int worker_idx);
+  void RunItems(int worker_idx);
+
+  std::vector<std::thread> threads_;
+
+  absl::Mutex mutex_;
+  absl::CondVar work_cv_;
+  absl::CondVar done_cv_;
+
+  // Incremented for every batch, to wake up the workers.
+  uint64_t generation_ ABSL_GUARDED_BY(mutex_) = 0;
+  // Number of workers that have not finished the current batch.
+  int num_busy_ ABSL_GUARDED_BY(mutex_) = 0;
+  bool stop_ ABSL_GUARDED_BY(mutex_) = false;
+
+  // The current batch. Set under mutex_ before generation_ is incremented, and only read by the
+  // workers after they observe the new generation.
+  const std::function<void(int, size_t)>* fn_ = nullptr;
+  size_t num_items_ = 0;
+  std::atomic<size_t> next_item_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
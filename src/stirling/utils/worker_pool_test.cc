@@ -0,0 +1,59 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/utils/worker_pool.h"
+
+#include <numeric>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+TEST(WorkerPoolTest, RunsEveryItemOnce) {
+  WorkerPool pool(4);
+  EXPECT_EQ(pool.num_threads(), 4);
+
+  // Run several batches, to check that the threads are reused.
+  for (size_t num_items : {0, 1, 3, 1000, 10000}) {
+    std::vector<int> counts(num_items, 0);
+    std::vector<int> worker_items(pool.num_threads(), 0);
+    pool.ParallelFor(num_items, [&](int worker_idx, size_t item_idx) {
+      ++counts[item_idx];
+      ++worker_items[worker_idx];
+    });
+    EXPECT_THAT(counts, ::testing::Each(1));
+    EXPECT_EQ(std::accumulate(worker_items.begin(), worker_items.end(), 0), num_items);
+  }
+}
+
+TEST(WorkerPoolTest, SingleThread) {
+  WorkerPool pool(1);
+  EXPECT_EQ(pool.num_threads(), 1);
+
+  std::vector<size_t> items;
+  pool.ParallelFor(5, [&](int worker_idx, size_t item_idx) {
+    EXPECT_EQ(worker_idx, 0);
+    items.push_back(item_idx);
+  });
+  EXPECT_THAT(items, ::testing::ElementsAre(0, 1, 2, 3, 4));
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,297 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/cold_column.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/zlib/zlib_wrapper.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+// Returns the number of bytes needed to hold any value up to max_value.
+int PackedWidth(uint64_t max_value) {
+  if (max_value <= 0xff) {
+    return 1;
+  }
+  if (max_value <= 0xffff) {
+    return 2;
+  }
+  if (max_value <= 0xffffffff) {
+    return 4;
+  }
+  return 8;
+}
+
+// Packed values are stored in host byte order, which is little endian on every platform that the
+// table store runs on.
+void AppendPacked(uint64_t value, int width, std::string* packed) {
+  packed->append(reinterpret_cast<const char*>(&value), width);
+}
+
+uint64_t ReadPacked(const std::string& packed, int width, int64_t idx) {
+  uint64_t value = 0;
+  memcpy(&value, packed.data() + idx * width, width);
+  return value;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<ColdColumn>> ColdColumn::Create(types::DataType type,
+                                                          std::shared_ptr<arrow::Array> arr,
+                                                          bool encode) {
+  int64_t logical_bytes = 0;
+#define TYPE_CASE(_dt_) logical_bytes = types::GetArrowArrayBytes<_dt_>(arr.get());
+  PL_SWITCH_FOREACH_DATATYPE(type, TYPE_CASE);
+#undef TYPE_CASE
+  std::unique_ptr<ColdColumn> col(new ColdColumn(type, arr->length(), logical_bytes));
+
+  if (encode && arr->length() > 0) {
+    switch (type) {
+      case types::DataType::STRING:
+        PL_RETURN_IF_ERROR(col->EncodeStrings(static_cast<const arrow::StringArray*>(arr.get())));
+        break;
+      case types::DataType::INT64:
+      case types::DataType::TIME64NS:
+        col->EncodeInts(static_cast<const arrow::Int64Array*>(arr.get()));
+        break;
+      default:
+        break;
+    }
+  }
+
+  if (col->encoding_ == Encoding::kPlain) {
+    col->plain_ = std::move(arr);
+    col->physical_bytes_ = logical_bytes;
+  }
+  return col;
+}
+
+Status ColdColumn::EncodeStrings(const arrow::StringArray* arr) {
+  // Try a dictionary first. Give up as soon as it's clear that the values are not repetitive.
+  absl::flat_hash_map<std::string_view, int64_t> dict;
+  std::vector<int64_t> codes;
+  codes.reserve(length_);
+  bool use_dict = true;
+  for (int64_t i = 0; i < length_; ++i) {
+    int32_t len = 0;
+    const uint8_t* data = arr->GetValue(i, &len);
+    auto [it, inserted] = dict.try_emplace(
+        std::string_view(reinterpret_cast<const char*>(data), len), dict.size());
+    if (inserted && (static_cast<int64_t>(dict.size()) > kMaxDictionarySize ||
+                     static_cast<int64_t>(dict.size()) * 2 > length_)) {
+      use_dict = false;
+      break;
+    }
+    codes.push_back(it->second);
+  }
+
+  int64_t dict_bytes = std::numeric_limits<int64_t>::max();
+  int dict_width = 0;
+  if (use_dict) {
+    dict_width = PackedWidth(dict.size() - 1);
+    int64_t dict_data_bytes = 0;
+    for (const auto& [value, code] : dict) {
+      dict_data_bytes += value.size();
+    }
+    dict_bytes = dict_data_bytes + (dict.size() + 1) * sizeof(int32_t) + length_ * dict_width;
+  }
+
+  std::string compressed;
+  int64_t compressed_bytes = std::numeric_limits<int64_t>::max();
+  if (logical_bytes_ >= kMinCompressBytes) {
+    std::string_view values(reinterpret_cast<const char*>(arr->value_data()->data()) +
+                                arr->value_offset(0),
+                            logical_bytes_);
+    PL_ASSIGN_OR_RETURN(compressed, zlib::Deflate(values));
+    compressed_bytes = compressed.size() + (length_ + 1) * sizeof(int32_t);
+  }
+
+  if (std::min(dict_bytes, compressed_bytes) >= logical_bytes_) {
+    return Status::OK();
+  }
+
+  if (dict_bytes <= compressed_bytes) {
+    encoding_ = Encoding::kDictionary;
+    std::vector<std::string_view> entries(dict.size());
+    for (const auto& [value, code] : dict) {
+      entries[code] = value;
+    }
+    offsets_.reserve(entries.size() + 1);
+    offsets_.push_back(0);
+    for (const auto& entry : entries) {
+      dict_data_.append(entry);
+      offsets_.push_back(dict_data_.size());
+    }
+    packed_width_ = dict_width;
+    packed_.reserve(length_ * dict_width);
+    for (int64_t code : codes) {
+      AppendPacked(code, dict_width, &packed_);
+    }
+    physical_bytes_ = dict_bytes;
+    return Status::OK();
+  }
+
+  encoding_ = Encoding::kCompressed;
+  compressed_ = std::move(compressed);
+  offsets_.reserve(length_ + 1);
+  offsets_.push_back(0);
+  for (int64_t i = 0; i < length_; ++i) {
+    offsets_.push_back(offsets_.back() + arr->value_length(i));
+  }
+  physical_bytes_ = compressed_bytes;
+  return Status::OK();
+}
+
+void ColdColumn::EncodeInts(const arrow::Int64Array* arr) {
+  bool non_decreasing = true;
+  int64_t min = arr->Value(0);
+  int64_t max = arr->Value(0);
+  uint64_t max_delta = 0;
+  for (int64_t i = 1; i < length_; ++i) {
+    int64_t prev = arr->Value(i - 1);
+    int64_t val = arr->Value(i);
+    min = std::min(min, val);
+    max = std::max(max, val);
+    if (val < prev) {
+      non_decreasing = false;
+    } else {
+      max_delta = std::max(max_delta, static_cast<uint64_t>(val) - static_cast<uint64_t>(prev));
+    }
+  }
+
+  int width = non_decreasing
+                  ? PackedWidth(max_delta)
+                  : PackedWidth(static_cast<uint64_t>(max) - static_cast<uint64_t>(min));
+  if (width >= static_cast<int>(sizeof(int64_t))) {
+    return;
+  }
+
+  packed_width_ = width;
+  packed_.reserve(length_ * width);
+  if (non_decreasing) {
+    encoding_ = Encoding::kDelta;
+    base_ = arr->Value(0);
+    AppendPacked(0, width, &packed_);
+    for (int64_t i = 1; i < length_; ++i) {
+      AppendPacked(static_cast<uint64_t>(arr->Value(i)) - static_cast<uint64_t>(arr->Value(i - 1)),
+                   width, &packed_);
+    }
+  } else {
+    encoding_ = Encoding::kFrameOfReference;
+    base_ = min;
+    for (int64_t i = 0; i < length_; ++i) {
+      AppendPacked(static_cast<uint64_t>(arr->Value(i)) - static_cast<uint64_t>(min), width,
+                   &packed_);
+    }
+  }
+  physical_bytes_ = packed_.size() + sizeof(base_);
+}
+
+StatusOr<std::shared_ptr<arrow::Array>> ColdColumn::Read(int64_t offset, int64_t length,
+                                                         arrow::MemoryPool* mem_pool) const {
+  if (offset < 0 || length < 0 || offset + length > length_) {
+    return error::InvalidArgument("Rows [$0, $1) are out of range for a column of $2 rows", offset,
+                                  offset + length, length_);
+  }
+  std::shared_ptr<arrow::Array> out;
+  switch (encoding_) {
+    case Encoding::kPlain:
+      return plain_->Slice(offset, length);
+    case Encoding::kDictionary:
+    case Encoding::kCompressed:
+      PL_RETURN_IF_ERROR(DecodeStrings(offset, length, mem_pool, &out));
+      return out;
+    case Encoding::kDelta:
+    case Encoding::kFrameOfReference:
+      PL_RETURN_IF_ERROR(DecodeInts(offset, length, mem_pool, &out));
+      return out;
+  }
+  return error::Internal("Unknown cold column encoding");
+}
+
+Status ColdColumn::DecodeStrings(int64_t offset, int64_t length, arrow::MemoryPool* mem_pool,
+                                 std::shared_ptr<arrow::Array>* out) const {
+  arrow::StringBuilder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+
+  if (encoding_ == Encoding::kDictionary) {
+    int64_t data_bytes = 0;
+    for (int64_t i = offset; i < offset + length; ++i) {
+      auto code = ReadPacked(packed_, packed_width_, i);
+      data_bytes += offsets_[code + 1] - offsets_[code];
+    }
+    PL_RETURN_IF_ERROR(builder.ReserveData(data_bytes));
+    for (int64_t i = offset; i < offset + length; ++i) {
+      auto code = ReadPacked(packed_, packed_width_, i);
+      builder.UnsafeAppend(dict_data_.data() + offsets_[code], offsets_[code + 1] - offsets_[code]);
+    }
+    PL_RETURN_IF_ERROR(builder.Finish(out));
+    return Status::OK();
+  }
+
+  PL_ASSIGN_OR_RETURN(std::string values, zlib::Inflate(compressed_, logical_bytes_ + 1));
+  PL_RETURN_IF_ERROR(builder.ReserveData(offsets_[offset + length] - offsets_[offset]));
+  for (int64_t i = offset; i < offset + length; ++i) {
+    builder.UnsafeAppend(values.data() + offsets_[i], offsets_[i + 1] - offsets_[i]);
+  }
+  PL_RETURN_IF_ERROR(builder.Finish(out));
+  return Status::OK();
+}
+
+Status ColdColumn::DecodeInts(int64_t offset, int64_t length, arrow::MemoryPool* mem_pool,
+                              std::shared_ptr<arrow::Array>* out) const {
+  arrow::Int64Builder builder(mem_pool);
+  PL_RETURN_IF_ERROR(builder.Reserve(length));
+
+  if (encoding_ == Encoding::kDelta) {
+    // Sum up the deltas before the first requested row.
+    uint64_t value = static_cast<uint64_t>(base_);
+    for (int64_t i = 0; i < offset; ++i) {
+      value += ReadPacked(packed_, packed_width_, i);
+    }
+    for (int64_t i = offset; i < offset + length; ++i) {
+      value += ReadPacked(packed_, packed_width_, i);
+      builder.UnsafeAppend(static_cast<int64_t>(value));
+    }
+    PL_RETURN_IF_ERROR(builder.Finish(out));
+    return Status::OK();
+  }
+
+  for (int64_t i = offset; i < offset + length; ++i) {
+    builder.UnsafeAppend(
+        static_cast<int64_t>(static_cast<uint64_t>(base_) + ReadPacked(packed_, packed_width_, i)));
+  }
+  PL_RETURN_IF_ERROR(builder.Finish(out));
+  return Status::OK();
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * ColdColumn holds a single column of a cold batch. Columns are either kept as the plain arrow
+ * array produced by compaction, or encoded into the most compact representation that applies to
+ * their type:
+ *  - STRING columns with few distinct values are dictionary encoded.
+ *  - Other large STRING columns are compressed with zlib.
+ *  - INT64 and TIME64NS columns are delta encoded when they never decrease (e.g. time_), and
+ *    frame of reference encoded otherwise, packing each value into the fewest bytes that fit.
+ * An encoding is only used if it is smaller than the plain column. Encoded columns are decoded on
+ * read.
+ */
+class ColdColumn {
+ public:
+  enum class Encoding {
+    kPlain,
+    kDictionary,
+    kCompressed,
+    kDelta,
+    kFrameOfReference,
+  };
+
+  // Strings with fewer bytes than this are never compressed.
+  static constexpr int64_t kMinCompressBytes = 4 * 1024;
+  // Dictionaries with more entries than this are not worth the lookup.
+  static constexpr int64_t kMaxDictionarySize = 64 * 1024;
+
+  /**
+   * Creates a cold column from the compacted arrow array.
+   * @param type the type of the column.
+   * @param arr the column.
+   * @param encode whether to try to encode the column. If false the array is kept as is.
+   */
+  static StatusOr<std::unique_ptr<ColdColumn>> Create(types::DataType type,
+                                                      std::shared_ptr<arrow::Array> arr,
+                                                      bool encode);
+
+  /**
+   * Reads a range of rows of the column. Plain columns are sliced without copying, encoded columns
+   * are decoded into new arrays allocated from mem_pool.
+   */
+  StatusOr<std::shared_ptr<arrow::Array>> Read(int64_t offset, int64_t length,
+                                               arrow::MemoryPool* mem_pool) const;
+  StatusOr<std::shared_ptr<arrow::Array>> ReadAll(arrow::MemoryPool* mem_pool) const {
+    return Read(0, length_, mem_pool);
+  }
+
+  types::DataType type() const { return type_; }
+  Encoding encoding() const { return encoding_; }
+  int64_t length() const { return length_; }
+  // The size of the column as a plain arrow array, as counted by GetArrowArrayBytes.
+  int64_t logical_bytes() const { return logical_bytes_; }
+  // The number of bytes that the column actually holds.
+  int64_t physical_bytes() const { return physical_bytes_; }
+
+ private:
+  ColdColumn(types::DataType type, int64_t length, int64_t logical_bytes)
+      : type_(type), length_(length), logical_bytes_(logical_bytes) {}
+
+  Status EncodeStrings(const arrow::StringArray* arr);
+  // INT64 and TIME64NS columns are both stored as arrow::Int64Array.
+  void EncodeInts(const arrow::Int64Array* arr);
+
+  Status DecodeStrings(int64_t offset, int64_t length, arrow::MemoryPool* mem_pool,
+                       std::shared_ptr<arrow::Array>* out) const;
+  Status DecodeInts(int64_t offset, int64_t length, arrow::MemoryPool* mem_pool,
+                    std::shared_ptr<arrow::Array>* out) const;
+
+  types::DataType type_;
+  Encoding encoding_ = Encoding::kPlain;
+  int64_t length_;
+  int64_t logical_bytes_;
+  int64_t physical_bytes_ = 0;
+
+  // kPlain.
+  std::shared_ptr<arrow::Array> plain_;
+
+  // kDictionary: dictionary entry j is dict_data_[offsets_[j], offsets_[j+1]).
+  // kCompressed: the deflated concatenation of all the values, where value i is at
+  // [offsets_[i], offsets_[i+1]) once inflated.
+  std::string dict_data_;
+  std::vector<int32_t> offsets_;
+  std::string compressed_;
+
+  // kDictionary: the code of each value. kDelta: the difference of each value to the previous
+  // value, the first being 0. kFrameOfReference: the difference of each value to base_. Each
+  // element is packed into packed_width_ little endian bytes.
+  std::string packed_;
+  int packed_width_ = 0;
+  int64_t base_ = 0;
+};
+
+}  // namespace table_store
+}  // namespace px
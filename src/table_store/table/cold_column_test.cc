@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/strings/str_cat.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/cold_column.h"
+
+namespace px {
+namespace table_store {
+
+using Encoding = ColdColumn::Encoding;
+
+template <typename TValueType>
+std::shared_ptr<arrow::Array> ToArrow(const std::vector<TValueType>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+// Checks that every range of the column decodes to the same values as the input.
+void ExpectRoundTrip(const ColdColumn& col, const std::shared_ptr<arrow::Array>& input) {
+  ASSERT_OK_AND_ASSIGN(auto all, col.ReadAll(arrow::default_memory_pool()));
+  EXPECT_TRUE(all->Equals(input));
+  int64_t offset = input->length() / 3;
+  int64_t length = input->length() / 2;
+  ASSERT_OK_AND_ASSIGN(auto slice, col.Read(offset, length, arrow::default_memory_pool()));
+  EXPECT_TRUE(slice->Equals(input->Slice(offset, length)));
+}
+
+TEST(ColdColumnTest, plain_without_encoding) {
+  std::vector<types::StringValue> strs(100, "abc");
+  auto arr = ToArrow(strs);
+  ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Create(types::DataType::STRING, arr, false));
+  EXPECT_EQ(Encoding::kPlain, col->encoding());
+  EXPECT_EQ(300, col->logical_bytes());
+  EXPECT_EQ(300, col->physical_bytes());
+  ExpectRoundTrip(*col, arr);
+}
+
+TEST(ColdColumnTest, dictionary_strings) {
+  std::vector<types::StringValue> strs;
+  for (int i = 0; i < 1000; ++i) {
+    strs.emplace_back(i % 3 == 0 ? "/api/v1/orders" : "/healthz");
+  }
+  auto arr = ToArrow(strs);
+  ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Create(types::DataType::STRING, arr, true));
+  EXPECT_EQ(Encoding::kDictionary, col->encoding());
+  EXPECT_LT(col->physical_bytes() * 5, col->logical_bytes());
+  ExpectRoundTrip(*col, arr);
+}
+
+TEST(ColdColumnTest, compressed_strings) {
+  std::vector<types::StringValue> strs;
+  for (int i = 0; i < 1000; ++i) {
+    strs.emplace_back(absl::StrCat("{\"id\": ", i, ", \"status\": \"ok\", \"items\": []}"));
+  }
+  auto arr = ToArrow(strs);
+  ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Create(types::DataType::STRING, arr, true));
+  EXPECT_EQ(Encoding::kCompressed, col->encoding());
+  EXPECT_LT(col->physical_bytes(), col->logical_bytes());
+  ExpectRoundTrip(*col, arr);
+}
+
+TEST(ColdColumnTest, delta_times) {
+  std::vector<types::Time64NSValue> times;
+  for (int64_t i = 0; i < 1000; ++i) {
+    times.emplace_back(1600000000000000000 + i * 1000 + i % 7);
+  }
+  auto arr = ToArrow(times);
+  ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Create(types::DataType::TIME64NS, arr, true));
+  EXPECT_EQ(Encoding::kDelta, col->encoding());
+  EXPECT_EQ(2 * 1000 + 8, col->physical_bytes());
+  ExpectRoundTrip(*col, arr);
+}
+
+TEST(ColdColumnTest, frame_of_reference_ints) {
+  std::vector<types::Int64Value> ints;
+  for (int64_t i = 0; i < 1000; ++i) {
+    ints.emplace_back(-100 + (i * 37) % 200);
+  }
+  auto arr = ToArrow(ints);
+  ASSERT_OK_AND_ASSIGN(auto col, ColdColumn::Create(types::DataType::INT64, arr, true));
+  EXPECT_EQ(Encoding::kFrameOfReference, col->encoding());
+  EXPECT_EQ(1000 + 8, col->physical_bytes());
+  ExpectRoundTrip(*col, arr);
+}
+
+TEST(ColdColumnTest, unencodable_columns_stay_plain) {
+  std::vector<types::Int64Value> ints = {0, std::numeric_limits<int64_t>::max(), -1};
+  auto int_arr = ToArrow(ints);
+  ASSERT_OK_AND_ASSIGN(auto int_col, ColdColumn::Create(types::DataType::INT64, int_arr, true));
+  EXPECT_EQ(Encoding::kPlain, int_col->encoding());
+  ExpectRoundTrip(*int_col, int_arr);
+
+  // Short, distinct strings.
+  std::vector<types::StringValue> strs = {"a", "b", "c", "d"};
+  auto str_arr = ToArrow(strs);
+  ASSERT_OK_AND_ASSIGN(auto str_col, ColdColumn::Create(types::DataType::STRING, str_arr, true));
+  EXPECT_EQ(Encoding::kPlain, str_col->encoding());
+
+  EXPECT_NOT_OK(str_col->Read(2, 3, arrow::default_memory_pool()));
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * SPSCRing is a fixed capacity ring buffer with one producer and one consumer that never block
+ * each other. The producer publishes an element by advancing tail_ with release semantics, and the
+ * consumer frees its slots by advancing head_, so neither side needs a lock. Callers are
+ * responsible for making sure that there is only one producer and one consumer at a time (for
+ * example by holding a producer side and a consumer side mutex).
+ */
+template <typename T>
+class SPSCRing : public NotCopyable {
+ public:
+  explicit SPSCRing(size_t capacity) : slots_(capacity) { DCHECK_GT(capacity, 0U); }
+
+  /**
+   * Moves the value into the ring. Must only be called by the producer.
+   * @return false, without touching the value, if the ring is full.
+   */
+  bool TryPush(T* value) {
+    auto tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size()) {
+      return false;
+    }
+    slots_[tail % slots_.size()] = std::move(*value);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pops every element that was published before the call, in push order, and passes it to fn.
+   * Must only be called by the consumer.
+   * @return the number of elements popped.
+   */
+  template <typename TFn>
+  size_t Drain(TFn fn) {
+    auto head = head_.load(std::memory_order_relaxed);
+    auto tail = tail_.load(std::memory_order_acquire);
+    for (auto i = head; i != tail; ++i) {
+      auto& slot = slots_[i % slots_.size()];
+      fn(std::move(slot));
+      // Release whatever the moved from element still holds before giving the slot back.
+      slot = T();
+    }
+    head_.store(tail, std::memory_order_release);
+    return tail - head;
+  }
+
+  size_t capacity() const { return slots_.size(); }
+
+ private:
+  std::vector<T> slots_;
+  // Monotonically increasing positions, the slot of a position is position % capacity.
+  std::atomic<size_t> head_ = 0;
+  std::atomic<size_t> tail_ = 0;
+};
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/table_store/table/spsc_ring.h"
+
+namespace px {
+namespace table_store {
+
+TEST(SPSCRingTest, push_and_drain) {
+  SPSCRing<std::unique_ptr<int>> ring(2);
+  auto a = std::make_unique<int>(1);
+  auto b = std::make_unique<int>(2);
+  auto c = std::make_unique<int>(3);
+  EXPECT_TRUE(ring.TryPush(&a));
+  EXPECT_TRUE(ring.TryPush(&b));
+  EXPECT_FALSE(ring.TryPush(&c));
+  // A failed push leaves the value alone.
+  ASSERT_NE(nullptr, c);
+
+  std::vector<int> out;
+  EXPECT_EQ(2, ring.Drain([&out](std::unique_ptr<int> val) { out.push_back(*val); }));
+  EXPECT_THAT(out, ::testing::ElementsAre(1, 2));
+
+  EXPECT_TRUE(ring.TryPush(&c));
+  EXPECT_EQ(1, ring.Drain([&out](std::unique_ptr<int> val) { out.push_back(*val); }));
+  EXPECT_THAT(out, ::testing::ElementsAre(1, 2, 3));
+  EXPECT_EQ(0, ring.Drain([](std::unique_ptr<int>) {}));
+}
+
+TEST(SPSCRingTest, threaded) {
+  SPSCRing<int64_t> ring(16);
+  constexpr int64_t kNumValues = 100000;
+
+  std::thread producer([&ring]() {
+    for (int64_t i = 0; i < kNumValues; ++i) {
+      int64_t val = i;
+      while (!ring.TryPush(&val)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int64_t expected = 0;
+  while (expected < kNumValues) {
+    ring.Drain([&expected](int64_t val) {
+      EXPECT_EQ(expected, val);
+      ++expected;
+    });
+  }
+  producer.join();
+  EXPECT_EQ(kNumValues, expected);
+}
+
+}  // namespace table_store
+}  // namespace px
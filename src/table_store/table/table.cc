@@ -17,6 +17,7 @@
  */
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
 #include <iterator>
@@ -37,6 +38,14 @@ DEFINE_int32(table_store_table_size_limit,
              gflags::Int32FromEnv("PL_TABLE_STORE_TABLE_SIZE_LIMIT", 1024 * 1024 * 64),
              "The maximal size a table allows. When the size grows beyond this limit, "
              "old data will be discarded.");
+DEFINE_bool(table_store_encode_cold_batches,
+            gflags::BoolFromEnv("PL_TABLE_STORE_ENCODE_COLD_BATCHES", false),
+            "Whether to dictionary, delta or zlib encode the columns of batches in cold storage, "
+            "trading CPU on read for more data retained under the table size limit.");
+DEFINE_bool(table_store_convert_hot_batches_on_write,
+            gflags::BoolFromEnv("PL_TABLE_STORE_CONVERT_HOT_BATCHES_ON_WRITE", true),
+            "Whether to convert record batches to arrow when they are written to a table, rather "
+            "than on their first read.");
 
 namespace px {
 namespace table_store {
@@ -86,7 +95,11 @@ Table::Table(std::string_view table_name, const schema::Relation& relation, size
       rel_(relation),
       max_table_size_(max_table_size),
       min_cold_batch_size_(min_cold_batch_size),
-      ring_capacity_(max_table_size / min_cold_batch_size) {
+      encode_cold_batches_(FLAGS_table_store_encode_cold_batches),
+      convert_hot_batches_on_write_(FLAGS_table_store_convert_hot_batches_on_write),
+      // The ring grows when it fills up (see AdvanceRingBufferUnlocked), so this is only a starting
+      // point. It is exact when cold batches aren't encoded.
+      ring_capacity_(std::max<int64_t>(1, max_table_size / min_cold_batch_size)) {
   absl::MutexLock gen_lock(&generation_lock_);
   absl::MutexLock cold_lock(&cold_lock_);
   absl::MutexLock hot_lock(&hot_lock_);
@@ -141,20 +154,32 @@ Status Table::ExpireRowBatches(int64_t row_batch_size) {
     return error::InvalidArgument("RowBatch size ($0) is bigger than maximum table size ($1).",
                                   row_batch_size, max_table_size_);
   }
+  return ExpireToSize(max_table_size_ - row_batch_size).status();
+}
+
+StatusOr<int64_t> Table::ExpireToSize(int64_t target_bytes) {
+  auto start = std::chrono::steady_clock::now();
   int64_t bytes;
   {
     absl::base_internal::SpinLockHolder lock(&stats_lock_);
     bytes = cold_bytes_ + hot_bytes_;
   }
-  while (bytes + row_batch_size > max_table_size_) {
+  int64_t num_expired = 0;
+  while (bytes > target_bytes) {
     PL_RETURN_IF_ERROR(ExpireBatch());
+    ++num_expired;
     {
       absl::base_internal::SpinLockHolder lock(&stats_lock_);
       batches_expired_++;
       bytes = cold_bytes_ + hot_bytes_;
     }
   }
-  return Status::OK();
+  if (num_expired > 0) {
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    metrics_.batches_expired_counter.Increment(num_expired);
+    metrics_.expiration_seconds_counter.Increment(elapsed.count());
+  }
+  return num_expired;
 }
 
 Status Table::WriteRowBatch(const schema::RowBatch& rb) {
@@ -182,11 +207,7 @@ Status Table::WriteRowBatch(const schema::RowBatch& rb) {
   }
 
   PL_RETURN_IF_ERROR(ExpireRowBatches(rb_bytes));
-  PL_RETURN_IF_ERROR(WriteHot(rb));
-  absl::base_internal::SpinLockHolder lock(&stats_lock_);
-  hot_bytes_ += rb_bytes;
-  ++batches_added_;
-  return Status::OK();
+  return WriteHot(rb, rb_bytes);
 }
 
 Status Table::TransferRecordBatch(
@@ -216,13 +237,7 @@ Status Table::TransferRecordBatch(
   }
 
   PL_RETURN_IF_ERROR(ExpireRowBatches(rb_bytes));
-  PL_RETURN_IF_ERROR(WriteHot(std::move(record_batch)));
-
-  absl::base_internal::SpinLockHolder lock(&stats_lock_);
-  hot_bytes_ += rb_bytes;
-  ++batches_added_;
-
-  return Status::OK();
+  return WriteHot(std::move(record_batch), rb_bytes);
 }
 
 static inline bool IntervalComparatorLowerBound(const std::pair<int64_t, int64_t> interval,
@@ -241,44 +256,52 @@ StatusOr<BatchSlice> Table::FindBatchSliceGreaterThanOrEqual(int64_t time,
     return error::InvalidArgument(
         "Cannot call FindBatchSliceGreaterThanOrEqual on table without a time column.");
   }
-  absl::MutexLock gen_lock(&generation_lock_);
+  // The time column is read after the locks are released, see the class comment.
+  std::shared_ptr<const ColdColumn> cold_time_col;
+  HotBatchPtr hot_batch;
+  int64_t batch_index = -1;
+  RowIDInterval row_ids;
+  int64_t generation = -1;
   {
-    absl::MutexLock cold_lock(&cold_lock_);
-    auto it =
-        std::lower_bound(cold_time_.begin(), cold_time_.end(), time, IntervalComparatorLowerBound);
-    if (it != cold_time_.end()) {
-      auto index = std::distance(cold_time_.begin(), it);
-      auto ring_index = RingIndexUnlocked(index);
-      auto time_col = cold_column_buffers_[time_col_idx_][ring_index];
-      auto row_offset = types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          time_col.get(), time);
-      auto row_ids = cold_row_ids_[index];
-      return BatchSlice::Cold(ring_index, row_offset, time_col->length() - 1, generation_,
-                              row_ids.first + row_offset, row_ids.second);
+    absl::MutexLock gen_lock(&generation_lock_);
+    generation = generation_;
+    {
+      absl::MutexLock cold_lock(&cold_lock_);
+      auto it = std::lower_bound(cold_time_.begin(), cold_time_.end(), time,
+                                 IntervalComparatorLowerBound);
+      if (it != cold_time_.end()) {
+        auto index = std::distance(cold_time_.begin(), it);
+        batch_index = RingIndexUnlocked(index);
+        row_ids = cold_row_ids_[index];
+        cold_time_col = cold_column_buffers_[time_col_idx_][batch_index];
+      }
+    }
+    // If the time wasn't found in the cold batches, we look in the hot batches.
+    if (cold_time_col == nullptr) {
+      absl::MutexLock hot_lock(&hot_lock_);
+      DrainPendingHotBatchesUnlocked();
+      auto it =
+          std::lower_bound(hot_time_.begin(), hot_time_.end(), time, IntervalComparatorLowerBound);
+      if (it == hot_time_.end()) {
+        return BatchSlice::Invalid();
+      }
+      batch_index = std::distance(hot_time_.begin(), it);
+      row_ids = hot_row_ids_[batch_index];
+      hot_batch = hot_batches_[batch_index];
     }
   }
-  // If the time wasn't found in the cold batches, we look in the hot batches.
-  absl::MutexLock hot_lock(&hot_lock_);
-  auto it =
-      std::lower_bound(hot_time_.begin(), hot_time_.end(), time, IntervalComparatorLowerBound);
-  if (it == hot_time_.end()) {
-    return BatchSlice::Invalid();
-  }
-  auto index = std::distance(hot_time_.begin(), it);
 
-  ArrowArrayPtr time_col;
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-    auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-    time_col = GetHotColumnUnlocked(record_batch_ptr, time_col_idx_, mem_pool);
-  } else {
-    auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-    time_col = row_batch.columns().at(time_col_idx_);
+  if (cold_time_col != nullptr) {
+    PL_ASSIGN_OR_RETURN(auto time_col, cold_time_col->ReadAll(mem_pool));
+    auto row_offset =
+        types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
+    return BatchSlice::Cold(batch_index, row_offset, time_col->length() - 1, generation,
+                            row_ids.first + row_offset, row_ids.second);
   }
-
+  auto time_col = GetHotColumn(*hot_batch, time_col_idx_, mem_pool);
   auto row_offset =
       types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
-  auto row_ids = hot_row_ids_[index];
-  return BatchSlice::Hot(index, row_offset, time_col->length() - 1, generation_,
+  return BatchSlice::Hot(batch_index, row_offset, time_col->length() - 1, generation,
                          row_ids.first + row_offset, row_ids.second);
 }
 
@@ -288,7 +311,7 @@ StatusOr<Table::StopPosition> Table::FindStopPositionForTime(int64_t time,
     return error::InvalidArgument(
         "Cannot call FindStopPositionForTime on table without a time column.");
   }
-  auto stop = FindStopTime(time, mem_pool);
+  PL_ASSIGN_OR_RETURN(auto stop, FindStopTime(time, mem_pool));
   if (stop == -1) {
     // If all the data is after the stop time then we return the first unique row identifier in the
     // table, which will cause no results to be returned.
@@ -309,151 +332,228 @@ TableStats Table::GetTableStats() const {
   info.num_batches = num_batches;
   info.bytes = hot_bytes_ + cold_bytes_;
   info.cold_bytes = cold_bytes_;
+  info.logical_bytes = hot_bytes_ + cold_logical_bytes_;
+  info.cold_logical_bytes = cold_logical_bytes_;
   info.compacted_batches = compacted_batches_;
   info.max_table_size = max_table_size_;
 
   return info;
 }
 
-Status Table::UpdateTimeRowIndices(types::ColumnWrapperRecordBatch* record_batch) {
+Status Table::WriteHot(RecordBatchPtr record_batch, int64_t batch_bytes) {
   auto batch_length = record_batch->at(0)->Size();
+  if (convert_hot_batches_on_write_) {
+    schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), batch_length);
+    for (const auto& col : *record_batch) {
+      PL_RETURN_IF_ERROR(
+          rb.AddColumn(types::ConvertToArrowZeroCopy(col, arrow::default_memory_pool())));
+    }
+    return WriteHot(rb, batch_bytes);
+  }
   DCHECK_GT(batch_length, 0);
+  TimeInterval time(-1, -1);
   if (time_col_idx_ != -1) {
-    auto first_time = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(0);
-    auto last_time = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(batch_length - 1);
-    hot_time_.emplace_back(first_time.val, last_time.val);
+    time.first = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(0).val;
+    time.second = record_batch->at(time_col_idx_)->Get<types::Time64NSValue>(batch_length - 1).val;
   }
-  auto first_row_id = next_row_id_;
-  next_row_id_ += batch_length;
-  hot_row_ids_.emplace_back(first_row_id, next_row_id_ - 1);
-  return Status::OK();
-}
-
-Status Table::WriteHot(RecordBatchPtr record_batch) {
-  absl::MutexLock hot_lock(&hot_lock_);
-  PL_RETURN_IF_ERROR(UpdateTimeRowIndices(record_batch.get()));
-  auto rb = RecordBatchWithCache{
+  auto rb = std::make_shared<RecordOrRowBatch>(RecordBatchWithCache{
       std::move(record_batch),
       std::vector<ArrowArrayPtr>(rel_.NumColumns()),
       std::vector<bool>(rel_.NumColumns(), false),
-  };
-  hot_batches_.emplace_back(std::move(rb));
+  });
+  AppendHot(std::move(rb), batch_length, batch_bytes, time);
   return Status::OK();
 }
 
-Status Table::UpdateTimeRowIndices(const schema::RowBatch& rb) {
+Status Table::WriteHot(const schema::RowBatch& rb, int64_t batch_bytes) {
   auto batch_length = rb.ColumnAt(0)->length();
   DCHECK_GT(batch_length, 0);
+  TimeInterval time(-1, -1);
   if (time_col_idx_ != -1) {
     auto time_col = rb.ColumnAt(time_col_idx_);
-    auto first_time = types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), 0);
-    auto last_time =
+    time.first = types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), 0);
+    time.second =
         types::GetValueFromArrowArray<types::DataType::TIME64NS>(time_col.get(), batch_length - 1);
-    hot_time_.emplace_back(first_time, last_time);
   }
-  auto first_row_id = next_row_id_;
-  next_row_id_ += batch_length;
-  hot_row_ids_.emplace_back(first_row_id, next_row_id_ - 1);
+  AppendHot(std::make_shared<RecordOrRowBatch>(rb), batch_length, batch_bytes, time);
   return Status::OK();
 }
 
-Status Table::WriteHot(const schema::RowBatch& rb) {
-  absl::MutexLock hot_lock(&hot_lock_);
-  PL_RETURN_IF_ERROR(UpdateTimeRowIndices(rb));
-  hot_batches_.emplace_back(rb);
-  return Status::OK();
+void Table::AppendHot(HotBatchPtr batch, int64_t batch_length, int64_t batch_bytes,
+                      TimeInterval time) {
+  absl::MutexLock append_lock(&append_lock_);
+  {
+    // Compaction and expiry subtract the bytes of the batch as soon as they can see it, so they
+    // have to be added before it is published.
+    absl::base_internal::SpinLockHolder stats_lock(&stats_lock_);
+    hot_bytes_ += batch_bytes;
+    ++batches_added_;
+  }
+  auto first_row_id = next_row_id_.load(std::memory_order_relaxed);
+  PendingHotBatch pending{std::move(batch), {first_row_id, first_row_id + batch_length - 1}, time};
+  if (!pending_hot_batches_.TryPush(&pending)) {
+    // Nobody has drained the pending batches in a while (eg. there are no readers and compaction
+    // hasn't run), so make room ourselves. This is the only place where AppendHot waits on readers,
+    // see the class comment.
+    absl::MutexLock hot_lock(&hot_lock_);
+    DrainPendingHotBatchesUnlocked();
+    CHECK(pending_hot_batches_.TryPush(&pending));
+  }
+  // Only make the rows visible through End() once the batch holding them has been published.
+  next_row_id_.store(first_row_id + batch_length, std::memory_order_release);
+}
+
+void Table::DrainPendingHotBatchesUnlocked() const {
+  pending_hot_batches_.Drain([this](PendingHotBatch pending) {
+    hot_batches_.push_back(std::move(pending.batch));
+    hot_row_ids_.push_back(pending.row_ids);
+    if (time_col_idx_ != -1) {
+      hot_time_.push_back(pending.time);
+    }
+  });
 }
 
-Status Table::CompactSingleBatch(arrow::MemoryPool* mem_pool) {
+StatusOr<int64_t> Table::CompactSingleBatch(arrow::MemoryPool* mem_pool) {
+  absl::MutexLock compaction_lock(&compaction_lock_);
   ArrowArrayCompactor builder(rel_, mem_pool);
   int64_t first_time = -1;
   int64_t last_time = -1;
   int64_t first_row_id = -1;
   int64_t last_row_id = -1;
-  absl::MutexLock gen_lock(&generation_lock_);
-  // We first get the necessary batches to compact from hot storage. Then we compact those batches
-  // into one batch. Then we push that batch into cold storage.
-  {
-    absl::MutexLock hot_lock(&hot_lock_);
-    for (auto it = hot_batches_.begin(); it != hot_batches_.end();) {
-      if (builder.Size() >= min_cold_batch_size_) {
+  int64_t num_batches = 0;
+  // We first compact batches from the front of hot storage into one batch, and encode it. Only
+  // then do we remove those batches from hot storage, and push the new batch into cold storage.
+  // The hot lock is only held to look up each batch, so that reads and expiry (and so writes to a
+  // full table) don't wait on compaction.
+  while (builder.Size() < min_cold_batch_size_) {
+    HotBatchPtr hot_batch;
+    RowIDInterval row_ids;
+    TimeInterval times;
+    {
+      absl::MutexLock hot_lock(&hot_lock_);
+      DrainPendingHotBatchesUnlocked();
+      if (num_batches >= static_cast<int64_t>(hot_batches_.size())) {
         break;
       }
-      std::vector<std::shared_ptr<arrow::Array>> column_arrays;
-      if (std::holds_alternative<RecordBatchWithCache>(*it)) {
-        auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&(*it));
-        for (int64_t col_idx = 0; col_idx < static_cast<int64_t>(rel_.NumColumns()); ++col_idx) {
-          if (record_batch_ptr->cache_validity[col_idx]) {
-            PL_RETURN_IF_ERROR(
-                builder.AppendColumn(col_idx, record_batch_ptr->arrow_cache[col_idx]));
-          } else {
-            PL_RETURN_IF_ERROR(builder.AppendColumn(
-                col_idx, record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool)));
-          }
-        }
-      } else {
-        auto row_batch = std::get<schema::RowBatch>(*it);
-        for (auto [col_idx, col] : Enumerate(row_batch.columns())) {
-          PL_RETURN_IF_ERROR(builder.AppendColumn(col_idx, col));
-        }
-      }
-      auto row_ids = hot_row_ids_.front();
-      if (first_row_id == -1) {
-        first_row_id = row_ids.first;
-      }
-      last_row_id = row_ids.second;
-
-      it = hot_batches_.erase(it);
-      hot_row_ids_.pop_front();
-
+      hot_batch = hot_batches_[num_batches];
+      row_ids = hot_row_ids_[num_batches];
       if (time_col_idx_ != -1) {
-        auto times = hot_time_.front();
-        if (first_time == -1) {
-          first_time = times.first;
-        }
-        last_time = times.second;
-        hot_time_.pop_front();
+        times = hot_time_[num_batches];
+      }
+    }
+    if (num_batches > 0 && row_ids.first != last_row_id + 1) {
+      // Hot batches expired while we were compacting them, so they aren't contiguous anymore.
+      // Leave it to the next call.
+      return 0;
+    }
+    for (int64_t col_idx = 0; col_idx < static_cast<int64_t>(rel_.NumColumns()); ++col_idx) {
+      PL_RETURN_IF_ERROR(
+          builder.AppendColumn(col_idx, GetHotColumn(*hot_batch, col_idx, mem_pool)));
+    }
+    if (first_row_id == -1) {
+      first_row_id = row_ids.first;
+    }
+    last_row_id = row_ids.second;
+    if (time_col_idx_ != -1) {
+      if (first_time == -1) {
+        first_time = times.first;
       }
+      last_time = times.second;
     }
+    ++num_batches;
+  }
+  if (num_batches == 0) {
+    return 0;
   }
   PL_RETURN_IF_ERROR(builder.Finish());
+  PL_ASSIGN_OR_RETURN(auto zone_map, ZoneMap::Create(rel_.col_types(), builder.output_columns()));
+  std::vector<std::shared_ptr<const ColdColumn>> cold_columns;
+  // The bloom filters of the zone map are a sizable fraction of a small cold batch, so they count
+  // towards the table size.
+  int64_t physical_bytes = zone_map->NumBytes();
+  for (const auto& [col_idx, col] : Enumerate(builder.output_columns())) {
+    PL_ASSIGN_OR_RETURN(std::shared_ptr<const ColdColumn> cold_column,
+                        ColdColumn::Create(rel_.GetColumnType(col_idx), col, encode_cold_batches_));
+    physical_bytes += cold_column->physical_bytes();
+    cold_columns.push_back(std::move(cold_column));
+  }
+
   {
-    absl::MutexLock cold_lock(&cold_lock_);
-    PL_RETURN_IF_ERROR(AdvanceRingBufferUnlocked());
-    for (const auto& [col_idx, col] : Enumerate(builder.output_columns())) {
-      cold_column_buffers_[col_idx][ring_back_idx_] = col;
+    absl::MutexLock gen_lock(&generation_lock_);
+    {
+      absl::MutexLock hot_lock(&hot_lock_);
+      if (hot_row_ids_.empty() || hot_row_ids_.front().first != first_row_id) {
+        // The first of the batches expired while we were compacting them.
+        return 0;
+      }
+      for (int64_t i = 0; i < num_batches; ++i) {
+        hot_batches_.pop_front();
+        hot_row_ids_.pop_front();
+        if (time_col_idx_ != -1) {
+          hot_time_.pop_front();
+        }
+      }
     }
-    cold_row_ids_.emplace_back(first_row_id, last_row_id);
-    if (time_col_idx_ != -1) {
-      cold_time_.emplace_back(first_time, last_time);
+    {
+      absl::MutexLock cold_lock(&cold_lock_);
+      PL_RETURN_IF_ERROR(AdvanceRingBufferUnlocked());
+      for (const auto& [col_idx, col] : Enumerate(cold_columns)) {
+        cold_column_buffers_[col_idx][ring_back_idx_] = col;
+      }
+      cold_row_ids_.emplace_back(first_row_id, last_row_id);
+      cold_zone_maps_.push_back(std::move(zone_map));
+      if (time_col_idx_ != -1) {
+        cold_time_.emplace_back(first_time, last_time);
+      }
     }
+    generation_++;
   }
   {
     absl::base_internal::SpinLockHolder stat_lock(&stats_lock_);
     hot_bytes_ -= builder.Size();
-    cold_bytes_ += builder.Size();
+    cold_bytes_ += physical_bytes;
+    cold_logical_bytes_ += builder.Size();
     compacted_batches_++;
   }
-  generation_++;
-  return Status::OK();
+  return builder.Size();
 }
 
 Status Table::CompactHotToCold(arrow::MemoryPool* mem_pool) {
-  for (size_t i = 0; i < kMaxBatchesPerCompactionCall; ++i) {
+  return CompactHotToCold(mem_pool, kMaxBatchesPerCompactionCall).status();
+}
+
+StatusOr<int64_t> Table::CompactHotToCold(arrow::MemoryPool* mem_pool, int64_t max_batches) {
+  auto start = std::chrono::steady_clock::now();
+  int64_t num_compacted = 0;
+  int64_t compacted_bytes = 0;
+  int64_t hot_bytes;
+  while (true) {
     {
       absl::base_internal::SpinLockHolder stats_lock(&stats_lock_);
-      if (hot_bytes_ < min_cold_batch_size_) {
-        return Status::OK();
-      }
+      hot_bytes = hot_bytes_;
+    }
+    if (hot_bytes < min_cold_batch_size_ || num_compacted >= max_batches) {
+      break;
     }
-    PL_RETURN_IF_ERROR(CompactSingleBatch(mem_pool));
+    PL_ASSIGN_OR_RETURN(auto bytes, CompactSingleBatch(mem_pool));
+    if (bytes == 0) {
+      // Hot batches expired during compaction. The next call picks up from the new front.
+      break;
+    }
+    compacted_bytes += bytes;
+    ++num_compacted;
   }
-
-  return Status::OK();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  metrics_.compacted_bytes_counter.Increment(compacted_bytes);
+  metrics_.compaction_seconds_counter.Increment(elapsed.count());
+  metrics_.compacted_batches_counter.Increment(num_compacted);
+  metrics_.compaction_lag_bytes_gauge.Set(hot_bytes);
+  return num_compacted;
 }
 
 StatusOr<bool> Table::ExpireCold() {
   int64_t rb_bytes = 0;
+  int64_t rb_logical_bytes = 0;
   {
     absl::MutexLock gen_lock(&generation_lock_);
     absl::MutexLock cold_lock(&cold_lock_);
@@ -461,13 +561,13 @@ StatusOr<bool> Table::ExpireCold() {
       return false;
     }
     cold_row_ids_.pop_front();
+    rb_bytes += cold_zone_maps_.front()->NumBytes();
+    cold_zone_maps_.pop_front();
     if (time_col_idx_ != -1) cold_time_.pop_front();
 
     for (size_t col_idx = 0; col_idx < rel_.NumColumns(); col_idx++) {
-#define TYPE_CASE(_dt_) \
-  rb_bytes += types::GetArrowArrayBytes<_dt_>(cold_column_buffers_[col_idx][ring_front_idx_].get());
-      PL_SWITCH_FOREACH_DATATYPE(rel_.GetColumnType(col_idx), TYPE_CASE);
-#undef TYPE_CASE
+      rb_bytes += cold_column_buffers_[col_idx][ring_front_idx_]->physical_bytes();
+      rb_logical_bytes += cold_column_buffers_[col_idx][ring_front_idx_]->logical_bytes();
       cold_column_buffers_[col_idx][ring_front_idx_].reset();
     }
     if (ring_front_idx_ == ring_back_idx_) {
@@ -481,33 +581,35 @@ StatusOr<bool> Table::ExpireCold() {
   }
   absl::base_internal::SpinLockHolder lock(&stats_lock_);
   cold_bytes_ -= rb_bytes;
+  cold_logical_bytes_ -= rb_logical_bytes;
   return true;
 }
 
 Status Table::ExpireHot() {
-  RecordOrRowBatch record_or_row_batch;
+  HotBatchPtr hot_batch;
   {
     absl::MutexLock gen_lock(&generation_lock_);
     absl::MutexLock hot_lock(&hot_lock_);
+    DrainPendingHotBatchesUnlocked();
     if (hot_batches_.size() == 0) {
       return error::InvalidArgument("Failed to expire row batch, no row batches in table");
     }
     if (time_col_idx_ != -1) hot_time_.pop_front();
     hot_row_ids_.pop_front();
-    record_or_row_batch = std::move(hot_batches_.front());
+    hot_batch = std::move(hot_batches_.front());
     hot_batches_.pop_front();
     // Expire the first hot batch invalidates all hot indices, so we have to increase the
     // generation.
     generation_++;
   }
   int64_t rb_bytes = 0;
-  if (std::holds_alternative<RecordBatchWithCache>(record_or_row_batch)) {
-    auto record_batch = std::move(std::get<RecordBatchWithCache>(record_or_row_batch));
+  if (std::holds_alternative<RecordBatchWithCache>(*hot_batch)) {
+    const auto& record_batch = std::get<RecordBatchWithCache>(*hot_batch);
     for (const auto& col : *record_batch.record_batch) {
       rb_bytes += col->Bytes();
     }
   } else {
-    auto row_batch = std::get<schema::RowBatch>(record_or_row_batch);
+    const auto& row_batch = std::get<schema::RowBatch>(*hot_batch);
     for (const auto& [col_idx, col] : Enumerate(row_batch.columns())) {
 #define TYPE_CASE(_dt_) rb_bytes += types::GetArrowArrayBytes<_dt_>(col.get());
       PL_SWITCH_FOREACH_DATATYPE(rel_.GetColumnType(col_idx), TYPE_CASE);
@@ -534,44 +636,39 @@ Status Table::ExpireBatch() {
 Status Table::AddBatchSliceToRowBatch(const BatchSlice& slice, const std::vector<int64_t>& cols,
                                       schema::RowBatch* output_rb,
                                       arrow::MemoryPool* mem_pool) const {
-  absl::MutexLock gen_lock(&generation_lock_);
-  PL_RETURN_IF_ERROR(UpdateSliceUnlocked(slice));
-  // After this point, as long as gen_lock is held, the unsafe properties of slice are valid.
-  if (!slice.unsafe_is_hot) {
-    absl::MutexLock cold_lock(&cold_lock_);
-    for (auto col_idx : cols) {
-      auto arr = cold_column_buffers_[col_idx][slice.unsafe_batch_index]->Slice(
-          slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
-      PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
+  // Take references to the columns of the batch with the locks held, and read them after the locks
+  // are released, see the class comment.
+  std::vector<std::shared_ptr<const ColdColumn>> cold_columns;
+  HotBatchPtr hot_batch;
+  int64_t row_start;
+  int64_t num_rows;
+  {
+    absl::MutexLock gen_lock(&generation_lock_);
+    PL_RETURN_IF_ERROR(UpdateSliceUnlocked(slice));
+    // After this point, as long as gen_lock is held, the unsafe properties of slice are valid.
+    row_start = slice.unsafe_row_start;
+    num_rows = slice.unsafe_row_end + 1 - slice.unsafe_row_start;
+    if (slice.unsafe_is_hot) {
+      absl::MutexLock hot_lock(&hot_lock_);
+      hot_batch = hot_batches_[slice.unsafe_batch_index];
+    } else {
+      absl::MutexLock cold_lock(&cold_lock_);
+      for (auto col_idx : cols) {
+        cold_columns.push_back(cold_column_buffers_[col_idx][slice.unsafe_batch_index]);
+      }
     }
-    return Status::OK();
   }
 
-  absl::MutexLock hot_lock(&hot_lock_);
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[slice.unsafe_batch_index])) {
-    auto record_batch_ptr =
-        std::get_if<RecordBatchWithCache>(&hot_batches_[slice.unsafe_batch_index]);
-    for (auto col_idx : cols) {
-      if (record_batch_ptr->cache_validity[col_idx]) {
-        auto arr = record_batch_ptr->arrow_cache[col_idx]->Slice(
-            slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
-        PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
-        continue;
-      }
-      // Arrow array wasn't in cache, Convert to arrow and then add to cache.
-      auto arr = record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool);
-      record_batch_ptr->arrow_cache[col_idx] = arr;
-      record_batch_ptr->cache_validity[col_idx] = true;
-      PL_RETURN_IF_ERROR(output_rb->AddColumn(
-          arr->Slice(slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start)));
-    }
-  } else {
-    const auto& row_batch = std::get<schema::RowBatch>(hot_batches_[slice.unsafe_batch_index]);
-    for (auto col_idx : cols) {
-      auto arr = row_batch.ColumnAt(col_idx)->Slice(
-          slice.unsafe_row_start, slice.unsafe_row_end + 1 - slice.unsafe_row_start);
+  if (hot_batch == nullptr) {
+    for (const auto& cold_column : cold_columns) {
+      PL_ASSIGN_OR_RETURN(auto arr, cold_column->Read(row_start, num_rows, mem_pool));
       PL_RETURN_IF_ERROR(output_rb->AddColumn(arr));
     }
+    return Status::OK();
+  }
+  for (auto col_idx : cols) {
+    auto arr = GetHotColumn(*hot_batch, col_idx, mem_pool);
+    PL_RETURN_IF_ERROR(output_rb->AddColumn(arr->Slice(row_start, num_rows)));
   }
   return Status::OK();
 }
@@ -580,6 +677,7 @@ int64_t Table::NumBatches() const {
   absl::MutexLock gen_lock(&generation_lock_);
   absl::MutexLock cold_lock(&cold_lock_);
   absl::MutexLock hot_lock(&hot_lock_);
+  DrainPendingHotBatchesUnlocked();
   return RingSizeUnlocked() + hot_batches_.size();
 }
 
@@ -595,6 +693,7 @@ BatchSlice Table::FirstBatch() const {
   }
   // No cold batches, return first hot batch or invalid if there are no hot batches.
   absl::MutexLock hot_lock(&hot_lock_);
+  DrainPendingHotBatchesUnlocked();
   if (hot_batches_.size() == 0) {
     return BatchSlice::Invalid();
   }
@@ -602,10 +701,7 @@ BatchSlice Table::FirstBatch() const {
   return BatchSlice::Hot(0, 0, HotBatchLengthUnlocked(0) - 1, generation_, row_ids);
 }
 
-int64_t Table::End() const {
-  absl::MutexLock hot_lock(&hot_lock_);
-  return next_row_id_;
-}
+int64_t Table::End() const { return next_row_id_.load(std::memory_order_acquire); }
 
 BatchSlice Table::NextBatch(const BatchSlice& slice, int64_t stop_row_id) const {
   auto next_slice = NextBatchWithoutStop(slice);
@@ -633,6 +729,7 @@ BatchSlice Table::NextBatchWithoutStop(const BatchSlice& slice) const {
     auto next_ring_index = RingNextAddrUnlocked(slice.unsafe_batch_index);
     if (next_ring_index == -1) {
       absl::MutexLock hot_lock(&hot_lock_);
+      DrainPendingHotBatchesUnlocked();
       // This is the last cold batch so return the first hot batch. If there are no hot batches
       // return an invalid batch.
       if (hot_batches_.size() == 0) {
@@ -648,6 +745,7 @@ BatchSlice Table::NextBatchWithoutStop(const BatchSlice& slice) const {
   }
 
   absl::MutexLock hot_lock(&hot_lock_);
+  DrainPendingHotBatchesUnlocked();
   auto batch_length = HotBatchLengthUnlocked(slice.unsafe_batch_index);
   if (slice.unsafe_row_end < batch_length - 1) {
     auto new_batch_size = batch_length - slice.unsafe_row_end;
@@ -664,65 +762,75 @@ BatchSlice Table::NextBatchWithoutStop(const BatchSlice& slice) const {
   return BatchSlice::Hot(next_index, 0, next_length - 1, generation_, hot_row_ids_[next_index]);
 }
 
-int64_t Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
-  absl::MutexLock gen_lock(&generation_lock_);
+StatusOr<int64_t> Table::FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const {
+  // The time column is read after the locks are released, see the class comment.
+  HotBatchPtr hot_batch;
+  std::shared_ptr<const ColdColumn> cold_time_col;
+  int64_t first_row_id = -1;
   {
-    absl::MutexLock hot_lock(&hot_lock_);
-    auto it =
-        std::upper_bound(hot_time_.begin(), hot_time_.end(), time, IntervalComparatorUpperBound);
-    if (it != hot_time_.begin()) {
-      it--;
-      auto index = std::distance(hot_time_.begin(), it);
-      ArrowArrayPtr time_col;
-      if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-        auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-        time_col = GetHotColumnUnlocked(record_batch_ptr, time_col_idx_, mem_pool);
-      } else {
-        auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-        time_col = row_batch.columns().at(time_col_idx_);
+    absl::MutexLock gen_lock(&generation_lock_);
+    {
+      absl::MutexLock hot_lock(&hot_lock_);
+      DrainPendingHotBatchesUnlocked();
+      auto it =
+          std::upper_bound(hot_time_.begin(), hot_time_.end(), time, IntervalComparatorUpperBound);
+      if (it != hot_time_.begin()) {
+        it--;
+        auto hot_index = std::distance(hot_time_.begin(), it);
+        hot_batch = hot_batches_[hot_index];
+        first_row_id = hot_row_ids_[hot_index].first;
       }
-      auto row_offset =
-          types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
-      return hot_row_ids_[index].first + row_offset;
+    }
+    if (hot_batch == nullptr) {
+      absl::MutexLock cold_lock(&cold_lock_);
+      auto it = std::upper_bound(cold_time_.begin(), cold_time_.end(), time,
+                                 IntervalComparatorUpperBound);
+      if (it == cold_time_.begin()) {
+        return -1;
+      }
+      it--;
+      auto index = it - cold_time_.begin();
+      cold_time_col = cold_column_buffers_[time_col_idx_][RingIndexUnlocked(index)];
+      first_row_id = cold_row_ids_[index].first;
     }
   }
-  absl::MutexLock cold_lock(&cold_lock_);
-  auto it =
-      std::upper_bound(cold_time_.begin(), cold_time_.end(), time, IntervalComparatorUpperBound);
-  if (it == cold_time_.begin()) {
-    return -1;
+
+  ArrowArrayPtr time_col;
+  if (hot_batch != nullptr) {
+    time_col = GetHotColumn(*hot_batch, time_col_idx_, mem_pool);
+  } else {
+    PL_ASSIGN_OR_RETURN(time_col, cold_time_col->ReadAll(mem_pool));
   }
-  it--;
-  auto index = it - cold_time_.begin();
-  auto ring_index = RingIndexUnlocked(index);
-  auto time_col = cold_column_buffers_[time_col_idx_][ring_index];
   auto row_offset =
       types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(time_col.get(), time);
-  return cold_row_ids_[index].first + row_offset;
+  return first_row_id + row_offset;
 }
 
 int64_t Table::ColdBatchLengthUnlocked(int64_t index) const {
   return cold_column_buffers_[0].at(index)->length();
 }
 int64_t Table::HotBatchLengthUnlocked(int64_t index) const {
-  if (std::holds_alternative<RecordBatchWithCache>(hot_batches_[index])) {
-    auto record_batch_ptr = std::get_if<RecordBatchWithCache>(&hot_batches_[index]);
-    return record_batch_ptr->record_batch->at(0)->Size();
-  } else {
-    auto row_batch = std::get<schema::RowBatch>(hot_batches_[index]);
-    return row_batch.num_rows();
+  const auto& hot_batch = *hot_batches_[index];
+  if (std::holds_alternative<RecordBatchWithCache>(hot_batch)) {
+    return std::get<RecordBatchWithCache>(hot_batch).record_batch->at(0)->Size();
   }
+  return std::get<schema::RowBatch>(hot_batch).num_rows();
 }
 
-Table::ArrowArrayPtr Table::GetHotColumnUnlocked(const RecordBatchWithCache* record_batch_ptr,
-                                                 int64_t col_idx,
-                                                 arrow::MemoryPool* mem_pool) const {
-  if (record_batch_ptr->cache_validity[col_idx]) {
-    return record_batch_ptr->arrow_cache[col_idx];
+Table::ArrowArrayPtr Table::GetHotColumn(const RecordOrRowBatch& hot_batch, int64_t col_idx,
+                                         arrow::MemoryPool* mem_pool) const {
+  if (std::holds_alternative<schema::RowBatch>(hot_batch)) {
+    return std::get<schema::RowBatch>(hot_batch).ColumnAt(col_idx);
+  }
+  const auto& record_batch = std::get<RecordBatchWithCache>(hot_batch);
+  absl::MutexLock cache_lock(&hot_cache_lock_);
+  if (record_batch.cache_validity[col_idx]) {
+    return record_batch.arrow_cache[col_idx];
   }
-  auto arrow_array_sptr = record_batch_ptr->record_batch->at(col_idx)->ConvertToArrow(mem_pool);
-  record_batch_ptr->arrow_cache[col_idx] = arrow_array_sptr;
-  record_batch_ptr->cache_validity[col_idx] = true;
+  auto arrow_array_sptr =
+      types::ConvertToArrowZeroCopy(record_batch.record_batch->at(col_idx), mem_pool);
+  record_batch.arrow_cache[col_idx] = arrow_array_sptr;
+  record_batch.cache_validity[col_idx] = true;
   return arrow_array_sptr;
 }
 
@@ -744,6 +852,19 @@ BatchSlice Table::SliceIfPastStop(const BatchSlice& slice, int64_t stop_row_id)
   return slice;
 }
 
+bool Table::BatchMayMatch(const BatchSlice& slice,
+                          const std::vector<ColumnPredicate>& predicates) const {
+  if (predicates.empty() || !slice.IsValid()) {
+    return true;
+  }
+  absl::MutexLock gen_lock(&generation_lock_);
+  if (!UpdateSliceUnlocked(slice).ok() || slice.unsafe_is_hot) {
+    return true;
+  }
+  absl::MutexLock cold_lock(&cold_lock_);
+  return cold_zone_maps_[RingVectorIndexUnlocked(slice.unsafe_batch_index)]->MayMatch(predicates);
+}
+
 int64_t Table::RingVectorIndexUnlocked(int64_t ring_index) const {
   // This function assumes the ring_index is valid. If it's not valid the resulting vector index
   // will also not be valid.
@@ -781,13 +902,30 @@ int64_t Table::RingNextAddrUnlocked(int64_t ring_index) const {
 Status Table::AdvanceRingBufferUnlocked() {
   auto next_ring_back_idx = (ring_back_idx_ + 1) % ring_capacity_;
   if (ring_back_idx_ != -1 && next_ring_back_idx == ring_front_idx_) {
-    return error::Internal(
-        "Failed to add new cold batch, ring buffer alreadRingNextAddrUnlocked full");
+    // Encoded cold batches take up less than min_cold_batch_size_ bytes each, so more of them fit
+    // under the table size limit than the ring was sized for.
+    GrowRingBufferUnlocked();
+    next_ring_back_idx = ring_back_idx_ + 1;
   }
   ring_back_idx_ = next_ring_back_idx;
   return Status::OK();
 }
 
+void Table::GrowRingBufferUnlocked() {
+  auto size = RingSizeUnlocked();
+  auto new_capacity = 2 * ring_capacity_;
+  for (auto& column_buffer : cold_column_buffers_) {
+    ColumnBuffer new_buffer(new_capacity);
+    for (int64_t i = 0; i < size; ++i) {
+      new_buffer[i] = std::move(column_buffer[RingIndexUnlocked(i)]);
+    }
+    column_buffer = std::move(new_buffer);
+  }
+  ring_front_idx_ = 0;
+  ring_back_idx_ = size - 1;
+  ring_capacity_ = new_capacity;
+}
+
 Status Table::UpdateSliceUnlocked(const BatchSlice& slice) const {
   if (slice.generation == generation_) {
     return Status::OK();
@@ -814,6 +952,7 @@ Status Table::UpdateSliceUnlocked(const BatchSlice& slice) const {
     }
   }
   absl::MutexLock hot_lock(&hot_lock_);
+  DrainPendingHotBatchesUnlocked();
   auto it = std::lower_bound(hot_row_ids_.begin(), hot_row_ids_.end(), slice.uniq_row_start_idx,
                              IntervalComparatorLowerBound);
   if (it == hot_row_ids_.end()) {
@@ -22,6 +22,7 @@
 #include <arrow/array.h>
 #include <arrow/record_batch.h>
 #include <algorithm>
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <string>
@@ -40,9 +41,14 @@
 #include "src/table_store/schema/row_batch.h"
 #include "src/table_store/schema/row_descriptor.h"
 #include "src/table_store/schemapb/schema.pb.h"
+#include "src/table_store/table/cold_column.h"
+#include "src/table_store/table/spsc_ring.h"
 #include "src/table_store/table/table_metrics.h"
+#include "src/table_store/table/zone_map.h"
 
 DECLARE_int32(table_store_table_size_limit);
+DECLARE_bool(table_store_encode_cold_batches);
+DECLARE_bool(table_store_convert_hot_batches_on_write);
 
 namespace px {
 namespace table_store {
@@ -50,8 +56,12 @@ namespace table_store {
 using RecordBatchSPtr = std::shared_ptr<arrow::RecordBatch>;
 
 struct TableStats {
+  // bytes and cold_bytes are the number of bytes held by the table, which count towards
+  // max_table_size. The logical byte counts are what the data would take up unencoded.
   int64_t bytes;
   int64_t cold_bytes;
+  int64_t logical_bytes;
+  int64_t cold_logical_bytes;
   int64_t num_batches;
   int64_t batches_added;
   int64_t batches_expired;
@@ -150,12 +160,34 @@ class ArrowArrayCompactor {
  * transferred to cold, don't also need to convert to arrow.
  *
  * Synchronization Scheme:
- * The hot and cold partitions are synchronized separately with spinlocks. Additionally, the
- * generation of the store is protected by a spinlock.
+ * The hot and cold partitions are synchronized separately with mutexes. Additionally, the
+ * generation of the store is protected by a mutex.
+ *
+ * Appending a batch doesn't take the hot lock. The writer (there is normally exactly one, Stirling)
+ * assigns the row IDs of a batch and publishes it to a lock-free ring of pending hot batches, and
+ * then publishes the new end of the table through the atomic next_row_id_. Anyone that takes the
+ * hot lock first drains the pending batches into the hot partition, so readers always see every
+ * batch before End(). Writers are serialized among themselves by append_lock_.
+ *
+ * Writes are not entirely wait-free though. A write waits for readers that hold the hot or
+ * generation lock (which readers only hold to look up a batch, see below) in two cases:
+ *  - The ring is full, because neither a reader nor compaction has drained it since the last
+ *    kPendingHotBatchesCapacity writes. The writer drains the ring itself.
+ *  - The table is full. The writer expires the oldest batches inline (ExpireRowBatches).
+ *    TableCompactionScheduler expires every table below its limit each cycle, so this only
+ *    happens when a table fills up between two cycles.
+ *
+ * Hot batches and cold columns are reference counted. Readers only hold the generation lock (and
+ * the hot or cold lock) while they look up the batch of a BatchSlice and take a reference to it.
+ * Converting hot batches to arrow and decoding cold columns happen after the locks are released,
+ * so expiry, and therefore writes to a full table, never wait on them. A batch that expires while
+ * it is being read is freed once the reader drops its reference. The arrow caches of hot batches
+ * are synchronized by hot_cache_lock_.
  *
  * Compaction Scheme:
  * Hot batches are compacted into batches of minimum size min_cold_batch_size_ bytes. The compaction
- * routine should be called periodically but that is not the responsibility of this class.
+ * routine should be called periodically but that is not the responsibility of this class (see
+ * TableCompactionScheduler).
  *
  * Time and Row Indexing:
  * The first and last values of the time columns for each batch are stored as intervals in
@@ -172,11 +204,30 @@ class ArrowArrayCompactor {
  * identifiers of the first and last row of that batch, so that when NextBatch is called on that
  * batch it can work out that it needs to return a slice of the batch with the original "second"
  * batch's data.
+ *
+ * Hot Conversion:
+ * If FLAGS_table_store_convert_hot_batches_on_write is set when the table is created, record
+ * batches from Stirling are converted to arrow once by the writer, and stored as hot RowBatches.
+ * Columns of 64 bit values are wrapped without copying (see types::ConvertToArrowZeroCopy), and
+ * string columns are copied into a single offsets and data buffer. Otherwise, hot batches are
+ * converted on their first read.
+ *
+ * Cold Encoding:
+ * If FLAGS_table_store_encode_cold_batches is set when the table is created, the columns of cold
+ * batches are dictionary, delta or zlib encoded (see ColdColumn), and decoded again on read. The
+ * table size limit applies to the encoded size, so the same limit retains more history. The ring
+ * buffer of cold batches is sized for unencoded batches, and doubles whenever more batches fit.
+ *
+ * Zone Maps:
+ * Every cold batch gets a ZoneMap (min/max values and bloom filters of its columns) when it is
+ * compacted. Readers with simple predicates on the table columns can use BatchMayMatch to skip
+ * cold batches without reading their arrays. Hot batches are never skipped. The memory of a zone
+ * map counts towards the size of its cold batch.
  */
 class Table : public NotCopyable {
   using RecordBatchPtr = std::unique_ptr<px::types::ColumnWrapperRecordBatch>;
   using ArrowArrayPtr = std::shared_ptr<arrow::Array>;
-  using ColumnBuffer = std::vector<ArrowArrayPtr>;
+  using ColumnBuffer = std::vector<std::shared_ptr<const ColdColumn>>;
   using TimeInterval = std::pair<int64_t, int64_t>;
   using RowIDInterval = std::pair<int64_t, int64_t>;
 
@@ -189,8 +240,17 @@ class Table : public NotCopyable {
   };
 
   using RecordOrRowBatch = std::variant<RecordBatchWithCache, schema::RowBatch>;
+  using HotBatchPtr = std::shared_ptr<const RecordOrRowBatch>;
+
+  // A hot batch that has been written, but not yet moved into hot_batches_.
+  struct PendingHotBatch {
+    HotBatchPtr batch;
+    RowIDInterval row_ids;
+    TimeInterval time;
+  };
 
   static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
+  static inline constexpr size_t kPendingHotBatchesCapacity = 1024;
 
  public:
   static inline constexpr int64_t kMaxBatchesPerCompactionCall = 256;
@@ -306,6 +366,16 @@ class Table : public NotCopyable {
    */
   BatchSlice SliceIfPastStop(const BatchSlice& slice, StopPosition stop) const;
 
+  /**
+   * Checks the zone map of the batch that the slice belongs to against the predicates.
+   * @param slice the BatchSlice to check.
+   * @param predicates predicates on the columns of the table, which must all hold for a row to
+   * match.
+   * @return false if no row of the slice can match the predicates. true if some rows may match,
+   * or if the slice is in hot storage.
+   */
+  bool BatchMayMatch(const BatchSlice& slice, const std::vector<ColumnPredicate>& predicates) const;
+
   /**
    * Compacts hot batches into min_cold_batch_size_ sized cold batches. Each call to
    * CompactHotToCold will create a maximum of kMaxBatchesPerCompactionCall cold batches.
@@ -313,6 +383,20 @@ class Table : public NotCopyable {
    */
   Status CompactHotToCold(arrow::MemoryPool* mem_pool);
 
+  /**
+   * Same as above, but creates at most max_batches cold batches.
+   * @return the number of cold batches created.
+   */
+  StatusOr<int64_t> CompactHotToCold(arrow::MemoryPool* mem_pool, int64_t max_batches);
+
+  /**
+   * Expires the oldest batches until the table holds at most target_bytes. Writes only expire
+   * batches once the table would grow past its maximum size, so expiring ahead of time (see
+   * TableCompactionScheduler) keeps that work off of the write path.
+   * @return the number of batches expired.
+   */
+  StatusOr<int64_t> ExpireToSize(int64_t target_bytes);
+
  private:
   TableMetrics metrics_;
   Status ExpireRowBatches(int64_t row_batch_size);
@@ -322,14 +406,32 @@ class Table : public NotCopyable {
   mutable absl::base_internal::SpinLock stats_lock_;
   int64_t batches_expired_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t cold_bytes_ ABSL_GUARDED_BY(stats_lock_) = 0;
+  int64_t cold_logical_bytes_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t hot_bytes_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t batches_added_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t max_table_size_ = 0;
   int64_t min_cold_batch_size_;
+  const bool encode_cold_batches_;
+  const bool convert_hot_batches_on_write_;
+
+  // Serializes writers. Besides the cases listed in the class comment, writers only wait on each
+  // other for as long as it takes to publish a batch to pending_hot_batches_.
+  absl::Mutex append_lock_;
+  // Batches written since the hot partition was last drained. Pushed to with append_lock_ held and
+  // drained with hot_lock_ held.
+  mutable SPSCRing<PendingHotBatch> pending_hot_batches_{kPendingHotBatchesCapacity};
 
   mutable absl::Mutex hot_lock_;
-  std::deque<RecordOrRowBatch> hot_batches_ ABSL_GUARDED_BY(hot_lock_);
+  // The hot partition is mutable since const readers drain pending_hot_batches_ into it.
+  mutable std::deque<HotBatchPtr> hot_batches_ ABSL_GUARDED_BY(hot_lock_);
+  // Guards the arrow_cache and cache_validity of every hot batch. Never held while taking another
+  // lock of the table.
+  mutable absl::Mutex hot_cache_lock_;
+
+  // Serializes compactions. Compaction builds a cold batch without holding the other locks, see
+  // CompactSingleBatch.
+  absl::Mutex compaction_lock_;
 
   mutable absl::Mutex cold_lock_;
   std::vector<ColumnBuffer> cold_column_buffers_ ABSL_GUARDED_BY(cold_lock_);
@@ -346,32 +448,41 @@ class Table : public NotCopyable {
   int64_t ring_back_idx_ ABSL_GUARDED_BY(cold_lock_) = -1;
   int64_t ring_capacity_ ABSL_GUARDED_BY(cold_lock_);
 
-  // Counter to assign a unique row ID to each row. Synchronized by hot_lock_ since its only
-  // accessed on a hot write.
-  int64_t next_row_id_ ABSL_GUARDED_BY(hot_lock_) = 0;
-  std::deque<RowIDInterval> hot_row_ids_ ABSL_GUARDED_BY(hot_lock_);
-  std::deque<TimeInterval> hot_time_ ABSL_GUARDED_BY(hot_lock_);
+  // Counter to assign a unique row ID to each row. Only written with append_lock_ held, and stored
+  // after the batch holding the rows is published, so that every row before End() is readable.
+  std::atomic<int64_t> next_row_id_ = 0;
+  mutable std::deque<RowIDInterval> hot_row_ids_ ABSL_GUARDED_BY(hot_lock_);
+  mutable std::deque<TimeInterval> hot_time_ ABSL_GUARDED_BY(hot_lock_);
   std::deque<RowIDInterval> cold_row_ids_ ABSL_GUARDED_BY(cold_lock_);
   std::deque<TimeInterval> cold_time_ ABSL_GUARDED_BY(cold_lock_);
+  // The zone map of each cold batch, in the same order as cold_row_ids_.
+  std::deque<std::unique_ptr<ZoneMap>> cold_zone_maps_ ABSL_GUARDED_BY(cold_lock_);
 
   int64_t time_col_idx_ = -1;
 
-  Status WriteHot(RecordBatchPtr record_batch);
-  Status WriteHot(const schema::RowBatch& rb);
-  Status UpdateTimeRowIndices(const schema::RowBatch& rb) ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
-  Status UpdateTimeRowIndices(types::ColumnWrapperRecordBatch* record_batch)
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  Status WriteHot(RecordBatchPtr record_batch, int64_t batch_bytes);
+  Status WriteHot(const schema::RowBatch& rb, int64_t batch_bytes);
+  // Accounts for the bytes of the batch, assigns row IDs to it and publishes it to
+  // pending_hot_batches_.
+  void AppendHot(HotBatchPtr batch, int64_t batch_length, int64_t batch_bytes, TimeInterval time)
+      ABSL_LOCKS_EXCLUDED(append_lock_, hot_lock_, stats_lock_);
+  // Moves all published pending hot batches into the hot partition.
+  void DrainPendingHotBatchesUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
 
   Status ExpireBatch();
   Status ExpireHot();
   StatusOr<bool> ExpireCold();
-  Status CompactSingleBatch(arrow::MemoryPool* mem_pool);
+  // Returns the number of hot bytes that were compacted. Returns 0 if there are no hot batches, or
+  // if some of the batches expired during compaction.
+  StatusOr<int64_t> CompactSingleBatch(arrow::MemoryPool* mem_pool);
 
   Status AddBatchSliceToRowBatch(const BatchSlice& slice, const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb, arrow::MemoryPool* mem_pool) const;
-  ArrowArrayPtr GetHotColumnUnlocked(const RecordBatchWithCache* record_batch_ptr, int64_t col_idx,
-                                     arrow::MemoryPool* mem_pool) const
-      ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
+  // Returns the given column of a hot batch as an arrow array, converting it and adding it to the
+  // arrow cache of the batch if needed.
+  ArrowArrayPtr GetHotColumn(const RecordOrRowBatch& hot_batch, int64_t col_idx,
+                             arrow::MemoryPool* mem_pool) const
+      ABSL_LOCKS_EXCLUDED(hot_cache_lock_);
 
   int64_t NumBatches() const;
   int64_t ColdBatchLengthUnlocked(int64_t ring_index) const
@@ -379,7 +490,7 @@ class Table : public NotCopyable {
   int64_t HotBatchLengthUnlocked(int64_t hot_index) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(hot_lock_);
 
   // Returns the unique identifier of the last row less than or equal to the given time.
-  int64_t FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const;
+  StatusOr<int64_t> FindStopTime(int64_t time, arrow::MemoryPool* mem_pool) const;
 
   // Returns the index into cold_row_ids_ or cold_time_ given the ring buffer location.
   int64_t RingVectorIndexUnlocked(int64_t ring_index) const
@@ -389,6 +500,9 @@ class Table : public NotCopyable {
   int64_t RingSizeUnlocked() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
   int64_t RingNextAddrUnlocked(int64_t ring_index) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
   Status AdvanceRingBufferUnlocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
+  // Doubles the capacity of the ring buffer, moving its batches to the front. This changes the
+  // ring index of every cold batch, so the generation must be incremented afterwards.
+  void GrowRingBufferUnlocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(cold_lock_);
 
   Status UpdateSliceUnlocked(const BatchSlice& slice) const
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(generation_lock_);
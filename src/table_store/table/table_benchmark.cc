@@ -19,11 +19,14 @@
 #include <absl/synchronization/barrier.h>
 #include <absl/synchronization/notification.h>
 #include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <deque>
 #include <numeric>
 #include <random>
 #include <thread>
+#include <vector>
 
 #include "src/shared/types/types.h"
 #include "src/table_store/table/table.h"
@@ -336,6 +339,102 @@ static void BM_TableThreaded(benchmark::State& state) {
   state.counters["Write"] = benchmark::Counter(write_average_time);
 }
 
+// Returns the value at the given percentile (0-100) of the sorted values.
+static inline double Percentile(const std::vector<double>& sorted_values, double percentile) {
+  if (sorted_values.empty()) {
+    return 0;
+  }
+  auto idx = static_cast<size_t>(percentile / 100 * (sorted_values.size() - 1));
+  return sorted_values[idx];
+}
+
+// Measures the latency distribution of TransferRecordBatch from a single writer (like Stirling),
+// while state.range(0) readers continuously stream the table and compaction runs in the
+// background. The table holds state.range(1) MiB. With 1024 MiB the writer never has to expire
+// batches, which measures appends alone. With 16 MiB the table fills up after the first few
+// thousand writes, and every write after that expires batches, which is the steady state of a
+// table in production. Latencies are reported in microseconds.
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TableTransferTailLatency(benchmark::State& state) {
+  int num_read_threads = state.range(0);
+  int64_t batch_length = 256;
+  int64_t num_writes = 32 * 1024;
+  auto table = MakeTable(state.range(1) * 1024 * 1024, 64 * 1024);
+
+  absl::Notification done;
+  std::atomic<int64_t> rows_read = 0;
+
+  std::thread compaction_thread([&]() {
+    while (!done.WaitForNotificationWithTimeout(absl::Milliseconds(10))) {
+      PL_CHECK_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+    }
+  });
+
+  // Each reader streams the table the way a MemorySourceNode on an infinite stream does, polling
+  // for new batches once it reaches the end.
+  auto reader_work = [&]() {
+    auto slice = table->FirstBatch();
+    while (!done.HasBeenNotified()) {
+      if (!slice.IsValid()) {
+        slice = table->FirstBatch();
+        continue;
+      }
+      auto batch_or_s = table->GetRowBatchSlice(slice, {0, 1}, arrow::default_memory_pool());
+      if (batch_or_s.ok()) {
+        rows_read += batch_or_s.ValueOrDie()->num_rows();
+      }
+      auto next = table->NextBatch(slice);
+      while (!next.IsValid() && !done.HasBeenNotified()) {
+        std::this_thread::yield();
+        next = table->NextBatch(slice);
+      }
+      slice = next;
+    }
+  };
+  std::vector<std::thread> reader_threads;
+  for (int i = 0; i < num_read_threads; ++i) {
+    reader_threads.emplace_back(reader_work);
+  }
+
+  std::vector<std::unique_ptr<types::ColumnWrapperRecordBatch>> batches;
+  for (int64_t i = 0; i < num_writes; ++i) {
+    batches.push_back(MakeHotBatch(batch_length));
+  }
+  std::vector<double> latencies;
+  latencies.reserve(num_writes);
+
+  for (auto _ : state) {
+    auto write_start = std::chrono::high_resolution_clock::now();
+    for (auto& batch : batches) {
+      auto start = std::chrono::high_resolution_clock::now();
+      PL_CHECK_OK(table->TransferRecordBatch(std::move(batch)));
+      auto end = std::chrono::high_resolution_clock::now();
+      latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+    }
+    auto write_end = std::chrono::high_resolution_clock::now();
+    state.SetIterationTime(
+        std::chrono::duration_cast<std::chrono::duration<double>>(write_end - write_start)
+            .count());
+  }
+
+  done.Notify();
+  compaction_thread.join();
+  for (auto& reader_thread : reader_threads) {
+    reader_thread.join();
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  state.counters["p50_us"] = benchmark::Counter(Percentile(latencies, 50));
+  state.counters["p99_us"] = benchmark::Counter(Percentile(latencies, 99));
+  state.counters["p999_us"] = benchmark::Counter(Percentile(latencies, 99.9));
+  state.counters["max_us"] = benchmark::Counter(latencies.back());
+  state.counters["rows_read"] = benchmark::Counter(rows_read.load());
+  state.counters["batches_expired"] =
+      benchmark::Counter(table->GetTableStats().batches_expired);
+  int64_t batch_size = batch_length * sizeof(int64_t) + batch_length * sizeof(double);
+  state.SetBytesProcessed(num_writes * batch_size);
+}
+
 BENCHMARK(BM_TableReadAllHot);
 BENCHMARK(BM_TableReadAllCold);
 BENCHMARK(BM_TableReadLastBatchAllHot)->Iterations(1000);
@@ -344,5 +443,16 @@ BENCHMARK(BM_TableWriteEmpty);
 BENCHMARK(BM_TableWriteFull);
 BENCHMARK(BM_TableCompaction);
 BENCHMARK(BM_TableThreaded)->UseManualTime()->Iterations(1);
+BENCHMARK(BM_TableTransferTailLatency)
+    ->UseManualTime()
+    ->Iterations(1)
+    ->Args({0, 1024})
+    ->Args({1, 1024})
+    ->Args({4, 1024})
+    ->Args({8, 1024})
+    ->Args({0, 16})
+    ->Args({1, 16})
+    ->Args({4, 16})
+    ->Args({8, 16});
 
 }  // namespace px::table_store
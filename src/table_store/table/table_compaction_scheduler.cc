@@ -0,0 +1,111 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/table_compaction_scheduler.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <absl/time/time.h>
+
+DEFINE_int32(table_store_compaction_period_ms,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_PERIOD_MS", 1000),
+             "How often the table store compacts and expires its tables in the background.");
+DEFINE_int32(table_store_compaction_max_batches_per_cycle,
+             gflags::Int32FromEnv("PL_TABLE_STORE_COMPACTION_MAX_BATCHES_PER_CYCLE", 256),
+             "The maximum number of cold batches that a single background compaction cycle "
+             "creates across all tables.");
+DEFINE_int32(table_store_expiration_low_watermark_percent,
+             gflags::Int32FromEnv("PL_TABLE_STORE_EXPIRATION_LOW_WATERMARK_PERCENT", 95),
+             "Background expiration shrinks tables to this percentage of their size limit, so that "
+             "writes rarely have to expire batches themselves.");
+
+namespace px {
+namespace table_store {
+
+void TableCompactionScheduler::Start() {
+  DCHECK(!thread_.joinable());
+  thread_ = std::thread(&TableCompactionScheduler::Run, this);
+}
+
+void TableCompactionScheduler::Stop() {
+  if (!stop_.HasBeenNotified()) {
+    stop_.Notify();
+  }
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+}
+
+void TableCompactionScheduler::Run() {
+  while (!stop_.WaitForNotificationWithTimeout(absl::FromChrono(period_))) {
+    // RunCycle logs its errors itself.
+    PL_UNUSED(RunCycle());
+  }
+}
+
+Status TableCompactionScheduler::RunCycle() {
+  struct TableHotBytes {
+    std::shared_ptr<Table> table;
+    int64_t hot_bytes;
+  };
+  std::vector<TableHotBytes> tables;
+  for (auto& table : table_store_->GetTables()) {
+    auto stats = table->GetTableStats();
+    tables.push_back({std::move(table), stats.bytes - stats.cold_bytes});
+  }
+  // The tables with the most hot data are the most expensive to read from, so they get the
+  // compaction budget first.
+  std::sort(tables.begin(), tables.end(), [](const TableHotBytes& a, const TableHotBytes& b) {
+    return a.hot_bytes > b.hot_bytes;
+  });
+
+  // Errors are logged and skipped, so that one broken table doesn't starve the others.
+  Status first_error;
+  int64_t remaining_batches = max_batches_per_cycle_;
+  for (const auto& t : tables) {
+    if (remaining_batches <= 0) {
+      break;
+    }
+    auto num_compacted_or = t.table->CompactHotToCold(mem_pool_, remaining_batches);
+    if (!num_compacted_or.ok()) {
+      LOG(ERROR) << "Failed to compact table: " << num_compacted_or.msg();
+      if (first_error.ok()) {
+        first_error = num_compacted_or.status();
+      }
+      continue;
+    }
+    remaining_batches -= num_compacted_or.ConsumeValueOrDie();
+  }
+
+  for (const auto& t : tables) {
+    auto max_table_size = t.table->GetTableStats().max_table_size;
+    auto num_expired_or = t.table->ExpireToSize(max_table_size * low_watermark_percent_ / 100);
+    if (!num_expired_or.ok()) {
+      LOG(ERROR) << "Failed to expire table: " << num_expired_or.msg();
+      if (first_error.ok()) {
+        first_error = num_expired_or.status();
+      }
+    }
+  }
+  return first_error;
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <chrono>
+#include <thread>
+
+#include <absl/synchronization/notification.h>
+
+#include "src/common/base/base.h"
+#include "src/table_store/table/table_store.h"
+
+DECLARE_int32(table_store_compaction_period_ms);
+DECLARE_int32(table_store_compaction_max_batches_per_cycle);
+DECLARE_int32(table_store_expiration_low_watermark_percent);
+
+namespace px {
+namespace table_store {
+
+/**
+ * TableCompactionScheduler compacts and expires the tables of a TableStore on its own thread, so
+ * that neither Stirling writes nor query reads pay for it.
+ *
+ * Every cycle compacts the tables with the most hot bytes first, creating at most
+ * max_batches_per_cycle cold batches across all the tables, so that a burst of writes can't make a
+ * single cycle arbitrarily long. Each table is then expired down to low_watermark_percent of its
+ * maximum size. Writes only expire batches themselves if the table still fills up before the next
+ * cycle. Compaction and expiration metrics are reported through the TableMetrics of each table.
+ */
+class TableCompactionScheduler : public NotCopyable {
+ public:
+  TableCompactionScheduler(TableStore* table_store, arrow::MemoryPool* mem_pool,
+                           std::chrono::milliseconds period, int64_t max_batches_per_cycle,
+                           int64_t low_watermark_percent)
+      : table_store_(table_store),
+        mem_pool_(mem_pool),
+        period_(period),
+        max_batches_per_cycle_(max_batches_per_cycle),
+        low_watermark_percent_(low_watermark_percent) {}
+
+  ~TableCompactionScheduler() { Stop(); }
+
+  /**
+   * Starts the background thread, which runs a cycle every period until Stop is called.
+   */
+  void Start();
+
+  /**
+   * Stops the background thread and waits for the current cycle to finish.
+   */
+  void Stop();
+
+  /**
+   * Runs a single compaction and expiration cycle on the calling thread. A table that fails to
+   * compact or expire doesn't stop the cycle for the other tables: its error is logged, and the
+   * first error is returned at the end.
+   */
+  Status RunCycle();
+
+ private:
+  void Run();
+
+  TableStore* table_store_;
+  arrow::MemoryPool* mem_pool_;
+  const std::chrono::milliseconds period_;
+  const int64_t max_batches_per_cycle_;
+  const int64_t low_watermark_percent_;
+
+  absl::Notification stop_;
+  std::thread thread_;
+};
+
+}  // namespace table_store
+}  // namespace px
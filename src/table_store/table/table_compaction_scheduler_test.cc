@@ -0,0 +1,164 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arrow/memory_pool.h>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/table_compaction_scheduler.h"
+
+namespace px {
+namespace table_store {
+
+// Fails every allocation larger than max_allocation_bytes, so that compacting large batches fails.
+class SmallAllocationsMemoryPool : public arrow::ProxyMemoryPool {
+ public:
+  explicit SmallAllocationsMemoryPool(int64_t max_allocation_bytes)
+      : arrow::ProxyMemoryPool(arrow::default_memory_pool()),
+        max_allocation_bytes_(max_allocation_bytes) {}
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override {
+    if (size > max_allocation_bytes_) {
+      return arrow::Status::OutOfMemory("test pool only allows small allocations");
+    }
+    return arrow::ProxyMemoryPool::Allocate(size, out);
+  }
+
+  arrow::Status Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override {
+    if (new_size > max_allocation_bytes_) {
+      return arrow::Status::OutOfMemory("test pool only allows small allocations");
+    }
+    return arrow::ProxyMemoryPool::Reallocate(old_size, new_size, ptr);
+  }
+
+ private:
+  const int64_t max_allocation_bytes_;
+};
+
+class TableCompactionSchedulerTest : public ::testing::Test {
+ protected:
+  // Each batch holds 10 INT64 rows, ie. 80 bytes, which is also the min cold batch size.
+  static constexpr int64_t kBatchBytes = 80;
+
+  std::shared_ptr<Table> AddTable(const std::string& name, int64_t max_size) {
+    auto table = std::make_shared<Table>(name, rel_, max_size, kBatchBytes);
+    table_store_.AddTable(table, name);
+    return table;
+  }
+
+  void WriteBatches(Table* table, int64_t num_batches, int64_t rows_per_batch = 10) {
+    for (int64_t i = 0; i < num_batches; ++i) {
+      schema::RowBatch rb(schema::RowDescriptor(rel_.col_types()), rows_per_batch);
+      std::vector<types::Int64Value> col(rows_per_batch, i);
+      EXPECT_OK(rb.AddColumn(types::ToArrow(col, arrow::default_memory_pool())));
+      EXPECT_OK(table->WriteRowBatch(rb));
+    }
+  }
+
+  schema::Relation rel_{{types::DataType::INT64}, {"col"}};
+  // Cold batches hold on to memory allocated from this pool, so it must outlive the tables.
+  SmallAllocationsMemoryPool small_allocations_pool_{4 * 1024};
+  TableStore table_store_;
+};
+
+TEST_F(TableCompactionSchedulerTest, compacts_tables_with_most_hot_bytes_first) {
+  auto small = AddTable("small", 10 * 1024);
+  auto large = AddTable("large", 10 * 1024);
+  WriteBatches(small.get(), 2);
+  WriteBatches(large.get(), 5);
+
+  TableCompactionScheduler scheduler(&table_store_, arrow::default_memory_pool(),
+                                     std::chrono::milliseconds(10), /* max_batches_per_cycle */ 4,
+                                     /* low_watermark_percent */ 100);
+  EXPECT_OK(scheduler.RunCycle());
+  // The whole budget goes to the table with the most hot bytes.
+  EXPECT_EQ(4, large->GetTableStats().compacted_batches);
+  EXPECT_EQ(0, small->GetTableStats().compacted_batches);
+
+  EXPECT_OK(scheduler.RunCycle());
+  EXPECT_EQ(5, large->GetTableStats().compacted_batches);
+  EXPECT_EQ(2, small->GetTableStats().compacted_batches);
+}
+
+TEST_F(TableCompactionSchedulerTest, expires_to_low_watermark) {
+  auto table = AddTable("table", 10 * kBatchBytes);
+  WriteBatches(table.get(), 10);
+  EXPECT_EQ(10 * kBatchBytes, table->GetTableStats().bytes);
+  EXPECT_EQ(0, table->GetTableStats().batches_expired);
+
+  TableCompactionScheduler scheduler(&table_store_, arrow::default_memory_pool(),
+                                     std::chrono::milliseconds(10), /* max_batches_per_cycle */ 256,
+                                     /* low_watermark_percent */ 50);
+  EXPECT_OK(scheduler.RunCycle());
+  auto stats = table->GetTableStats();
+  // The batches are compacted first, and the zone maps of the cold batches count towards the
+  // table size, so more than half of the batches expire.
+  EXPECT_EQ(10, stats.compacted_batches);
+  EXPECT_GE(5 * kBatchBytes, stats.bytes);
+  EXPECT_LE(5, stats.batches_expired);
+  EXPECT_EQ(10 - stats.batches_expired, stats.num_batches);
+
+  // The next write fits without expiring anything.
+  WriteBatches(table.get(), 1);
+  EXPECT_EQ(stats.batches_expired, table->GetTableStats().batches_expired);
+}
+
+TEST_F(TableCompactionSchedulerTest, keeps_going_when_a_table_fails) {
+  // The batches of the broken table are 8KB each, too large for the memory pool to compact them.
+  auto broken = AddTable("broken", 4 * 1024 * 8);
+  auto healthy = AddTable("healthy", 10 * 1024);
+  WriteBatches(broken.get(), 4, /* rows_per_batch */ 1024);
+  WriteBatches(healthy.get(), 3);
+
+  TableCompactionScheduler scheduler(&table_store_, &small_allocations_pool_,
+                                     std::chrono::milliseconds(10),
+                                     /* max_batches_per_cycle */ 256,
+                                     /* low_watermark_percent */ 50);
+  auto status = scheduler.RunCycle();
+  // The broken table has the most hot bytes, so it is compacted first. Its error is returned, but
+  // only after the other table is compacted and both are expired.
+  EXPECT_NOT_OK(status);
+  EXPECT_THAT(status.msg(), ::testing::HasSubstr("test pool only allows small allocations"));
+  EXPECT_EQ(0, broken->GetTableStats().compacted_batches);
+  EXPECT_EQ(2, broken->GetTableStats().batches_expired);
+  EXPECT_EQ(3, healthy->GetTableStats().compacted_batches);
+  EXPECT_EQ(0, healthy->GetTableStats().batches_expired);
+}
+
+TEST_F(TableCompactionSchedulerTest, background_thread) {
+  auto table = AddTable("table", 10 * 1024);
+  WriteBatches(table.get(), 3);
+
+  TableCompactionScheduler scheduler(&table_store_, arrow::default_memory_pool(),
+                                     std::chrono::milliseconds(1), /* max_batches_per_cycle */ 256,
+                                     /* low_watermark_percent */ 100);
+  scheduler.Start();
+  while (table->GetTableStats().compacted_batches < 3) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  scheduler.Stop();
+  EXPECT_EQ(0, table->GetTableStats().bytes - table->GetTableStats().cold_bytes);
+}
+
+}  // namespace table_store
+}  // namespace px
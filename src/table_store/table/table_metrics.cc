@@ -60,4 +60,25 @@ TableMetrics::TableMetrics(prometheus::Registry* registry, std::string table_nam
                                .Name("table_max_table_size")
                                .Help("The table size")
                                .Register(*registry)
-                               .Add({{"name", table_name}})) {}
+                               .Add({{"name", table_name}})),
+      compacted_bytes_counter(prometheus::BuildCounter()
+                                  .Name("table_compacted_bytes")
+                                  .Help("Total hot bytes compacted into cold batches")
+                                  .Register(*registry)
+                                  .Add({{"name", table_name}})),
+      compaction_seconds_counter(prometheus::BuildCounter()
+                                     .Name("table_compaction_seconds")
+                                     .Help("Total time spent compacting the table")
+                                     .Register(*registry)
+                                     .Add({{"name", table_name}})),
+      compaction_lag_bytes_gauge(prometheus::BuildGauge()
+                                     .Name("table_compaction_lag_bytes")
+                                     .Help("Hot bytes left waiting for compaction after the last "
+                                           "compaction of the table")
+                                     .Register(*registry)
+                                     .Add({{"name", table_name}})),
+      expiration_seconds_counter(prometheus::BuildCounter()
+                                     .Name("table_expiration_seconds")
+                                     .Help("Total time spent expiring batches from the table")
+                                     .Register(*registry)
+                                     .Add({{"name", table_name}})) {}
@@ -33,4 +33,8 @@ struct TableMetrics {
   prometheus::Counter& batches_expired_counter;
   prometheus::Counter& compacted_batches_counter;
   prometheus::Gauge& max_table_size_gauge;
+  prometheus::Counter& compacted_bytes_counter;
+  prometheus::Counter& compaction_seconds_counter;
+  prometheus::Gauge& compaction_lag_bytes_gauge;
+  prometheus::Counter& expiration_seconds_counter;
 };
@@ -45,11 +45,12 @@ StatusOr<Table*> TableStore::CreateNewTablet(uint64_t table_id, const types::Tab
 
   std::shared_ptr<Table> new_tablet = Table::Create(table_info.table_name, relation);
 
-  TableIDTablet id_key = {table_id, tablet_id};
-  id_to_table_map_[id_key] = new_tablet;
-
   const std::string& table_name = table_info.table_name;
   DCHECK(relation == name_to_relation_map_.find(table_name)->second);
+
+  absl::MutexLock lock(&tables_lock_);
+  TableIDTablet id_key = {table_id, tablet_id};
+  id_to_table_map_[id_key] = new_tablet;
   NameTablet name_key = {table_name, tablet_id};
   name_to_table_map_[name_key] = new_tablet;
   return new_tablet.get();
@@ -67,6 +68,7 @@ Status TableStore::AppendData(uint64_t table_id, types::TabletID tablet_id,
 
 table_store::Table* TableStore::GetTable(const std::string& table_name,
                                          const types::TabletID& tablet_id) const {
+  absl::ReaderMutexLock lock(&tables_lock_);
   auto name_to_table_iter = name_to_table_map_.find(NameTablet{table_name, tablet_id});
   if (name_to_table_iter == name_to_table_map_.end()) {
     return nullptr;
@@ -76,6 +78,7 @@ table_store::Table* TableStore::GetTable(const std::string& table_name,
 
 table_store::Table* TableStore::GetTable(uint64_t table_id,
                                          const types::TabletID& tablet_id) const {
+  absl::ReaderMutexLock lock(&tables_lock_);
   auto id_to_table_iter = id_to_table_map_.find(TableIDTablet{table_id, tablet_id});
   if (id_to_table_iter == id_to_table_map_.end()) {
     return nullptr;
@@ -93,6 +96,7 @@ void TableStore::RegisterTableName(const std::string& table_name, const types::T
     DCHECK_EQ(name_to_relation_map_iter->second, table_relation);
   }
 
+  absl::MutexLock lock(&tables_lock_);
   NameTablet key = {table_name, tablet_id};
   name_to_table_map_[key] = table;
 }
@@ -108,6 +112,7 @@ void TableStore::RegisterTableID(uint64_t table_id, TableInfo table_info,
     DCHECK_EQ(id_to_table_info_map_iter->second.relation, table_info.relation);
   }
 
+  absl::MutexLock lock(&tables_lock_);
   TableIDTablet key{table_id, tablet_id};
   id_to_table_map_[key] = table;
 }
@@ -126,14 +131,18 @@ void TableStore::AddTable(std::shared_ptr<table_store::Table> table, const std::
 }
 
 Status TableStore::AddTableAlias(uint64_t table_id, const std::string& table_name) {
-  auto table_iter = name_to_table_map_.find({table_name, ""});
-  if (table_iter == name_to_table_map_.end()) {
-    return error::Internal(
-        "Could not create table alias. Could not find table for $0 If the target table is "
-        "tabletized, aliasing is not yet supported.",
-        table_name);
+  std::shared_ptr<Table> table_ptr;
+  {
+    absl::ReaderMutexLock lock(&tables_lock_);
+    auto table_iter = name_to_table_map_.find({table_name, ""});
+    if (table_iter == name_to_table_map_.end()) {
+      return error::Internal(
+          "Could not create table alias. Could not find table for $0 If the target table is "
+          "tabletized, aliasing is not yet supported.",
+          table_name);
+    }
+    table_ptr = table_iter->second;
   }
-  std::shared_ptr<Table> table_ptr = table_iter->second;
 
   auto relation_iter = name_to_relation_map_.find(table_name);
   if (relation_iter == name_to_relation_map_.end()) {
@@ -151,6 +160,7 @@ Status TableStore::SchemaAsProto(schemapb::Schema* schema) const {
 }
 
 std::vector<uint64_t> TableStore::GetTableIDs() const {
+  absl::ReaderMutexLock lock(&tables_lock_);
   std::vector<uint64_t> ids;
   for (const auto& it : id_to_table_map_) {
     ids.emplace_back(it.first.table_id_);
@@ -159,11 +169,21 @@ std::vector<uint64_t> TableStore::GetTableIDs() const {
 }
 
 Status TableStore::RunCompaction(arrow::MemoryPool* mem_pool) {
-  for (const auto& it : name_to_table_map_) {
-    PL_RETURN_IF_ERROR(it.second->CompactHotToCold(mem_pool));
+  for (const auto& table : GetTables()) {
+    PL_RETURN_IF_ERROR(table->CompactHotToCold(mem_pool));
   }
   return Status::OK();
 }
 
+std::vector<std::shared_ptr<Table>> TableStore::GetTables() const {
+  absl::ReaderMutexLock lock(&tables_lock_);
+  std::vector<std::shared_ptr<Table>> tables;
+  tables.reserve(name_to_table_map_.size());
+  for (const auto& [name_tablet, table] : name_to_table_map_) {
+    tables.push_back(table);
+  }
+  return tables;
+}
+
 }  // namespace table_store
 }  // namespace px
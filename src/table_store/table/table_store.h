@@ -25,6 +25,7 @@
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/synchronization/mutex.h>
 
 #include "src/common/base/base.h"
 #include "src/shared/types/column_wrapper.h"
@@ -167,6 +168,12 @@ class TableStore {
 
   Status RunCompaction(arrow::MemoryPool* mem_pool);
 
+  /**
+   * @return all the tables (and tablets) in the table store. The tables stay alive as long as the
+   * returned pointers, even if they are removed from the table store.
+   */
+  std::vector<std::shared_ptr<Table>> GetTables() const;
+
  private:
   void RegisterTableName(const std::string& table_name, const types::TabletID& tablet_id,
                          const schema::Relation& table_relation,
@@ -186,10 +193,15 @@ class TableStore {
 
   // The default value for tablets, when tablet is not specified.
   inline static types::TabletID kDefaultTablet = "";
+  // Protects the table maps, since tables are looked up and compacted from other threads than the
+  // one that adds them (see TableCompactionScheduler).
+  mutable absl::Mutex tables_lock_;
   // Map a name to a table.
-  absl::flat_hash_map<NameTablet, std::shared_ptr<Table>> name_to_table_map_;
+  absl::flat_hash_map<NameTablet, std::shared_ptr<Table>> name_to_table_map_
+      ABSL_GUARDED_BY(tables_lock_);
   // Map an id to a table.
-  absl::flat_hash_map<TableIDTablet, std::shared_ptr<Table>> id_to_table_map_;
+  absl::flat_hash_map<TableIDTablet, std::shared_ptr<Table>> id_to_table_map_
+      ABSL_GUARDED_BY(tables_lock_);
   // Mapping from name to relation for adding new tablets.
   // TODO(oazizi): value should likely be shared_ptr<schema::Relation> because the
   //               same information is in id_to_table_info_map_ TableInfo.
@@ -218,7 +218,12 @@ TEST(TableTest, bytes_test_w_compaction) {
 
   EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
 
-  EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size + rb3_size);
+  // The zone map of the cold batch counts towards the table size, on top of its data.
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(stats.logical_bytes, rb1_size + rb2_size + rb3_size);
+  EXPECT_EQ(stats.cold_logical_bytes, rb1_size + rb2_size);
+  EXPECT_GT(stats.cold_bytes, stats.cold_logical_bytes);
+  EXPECT_EQ(stats.bytes, stats.cold_bytes + rb3_size);
 }
 
 TEST(TableTest, expiry_test) {
@@ -377,7 +382,9 @@ TEST(TableTest, expiry_test_w_compaction) {
 
   EXPECT_OK(table.WriteRowBatch(rb2));
   EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
-  EXPECT_EQ(table.GetTableStats().bytes, rb1_size + rb2_size);
+  // The zone map of the cold batch also counts towards the table size, so the table is over its
+  // limit until the next write expires the cold batch.
+  EXPECT_EQ(table.GetTableStats().logical_bytes, rb1_size + rb2_size);
 
   EXPECT_OK(table.WriteRowBatch(rb3));
   EXPECT_EQ(table.GetTableStats().bytes, rb3_size);
@@ -524,6 +531,198 @@ TEST(TableTest, hot_batches_w_compaction_test) {
   EXPECT_TRUE(rb2->ColumnAt(1)->Equals(types::ToArrow(col2_in2, arrow::default_memory_pool())));
 }
 
+TEST(TableTest, hot_batches_converted_on_write) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+
+  for (bool convert_on_write : {true, false}) {
+    gflags::FlagSaver flag_saver;
+    FLAGS_table_store_convert_hot_batches_on_write = convert_on_write;
+    Table table("test_table", rel, 128 * 1024, 1024);
+
+    auto col1 = types::ColumnWrapper::Make(types::DataType::INT64, 0);
+    col1->AppendFromVector(std::vector<types::Int64Value>{1, 2, 3});
+    auto col2 = types::ColumnWrapper::Make(types::DataType::STRING, 0);
+    col2->AppendFromVector(std::vector<types::StringValue>{"a", "bc", "def"});
+    const void* col1_data = col1->UnsafeRawData();
+    auto rb_wrapper = std::make_unique<types::ColumnWrapperRecordBatch>();
+    rb_wrapper->push_back(std::move(col1));
+    rb_wrapper->push_back(std::move(col2));
+    EXPECT_OK(table.TransferRecordBatch(std::move(rb_wrapper)));
+
+    auto slice = table.FirstBatch();
+    slice.uniq_row_start_idx = 1;
+    slice.generation = -1;
+    ASSERT_OK_AND_ASSIGN(auto rb,
+                         table.GetRowBatchSlice(slice, {0, 1}, arrow::default_memory_pool()));
+    EXPECT_TRUE(rb->ColumnAt(0)->Equals(types::ToArrow(std::vector<types::Int64Value>{2, 3},
+                                                       arrow::default_memory_pool())));
+    EXPECT_TRUE(rb->ColumnAt(1)->Equals(types::ToArrow(std::vector<types::StringValue>{"bc", "def"},
+                                                       arrow::default_memory_pool())));
+    // The int column is read straight out of the record batch, in both cases.
+    auto int_col = std::static_pointer_cast<arrow::Int64Array>(rb->ColumnAt(0));
+    EXPECT_EQ(static_cast<const int64_t*>(col1_data) + 1, int_col->raw_values());
+
+    EXPECT_EQ(3 * 8 + 6, table.GetTableStats().bytes);
+    EXPECT_OK(table.ExpireToSize(0));
+    EXPECT_EQ(0, table.GetTableStats().bytes);
+  }
+}
+
+TEST(TableTest, zone_maps_skip_cold_batches) {
+  schema::Relation rel({types::DataType::INT64, types::DataType::STRING}, {"col1", "col2"});
+  // Every hot batch is compacted into its own cold batch.
+  Table table("test_table", rel, 128 * 1024, 1);
+
+  auto rb1 = schema::RowBatch(schema::RowDescriptor(rel.col_types()), 3);
+  std::vector<types::Int64Value> col1_in1 = {1, 2, 3};
+  std::vector<types::StringValue> col2_in1 = {"a", "b", "c"};
+  EXPECT_OK(rb1.AddColumn(types::ToArrow(col1_in1, arrow::default_memory_pool())));
+  EXPECT_OK(rb1.AddColumn(types::ToArrow(col2_in1, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb1));
+
+  auto rb2 = schema::RowBatch(schema::RowDescriptor(rel.col_types()), 2);
+  std::vector<types::Int64Value> col1_in2 = {10, 20};
+  std::vector<types::StringValue> col2_in2 = {"d", "e"};
+  EXPECT_OK(rb2.AddColumn(types::ToArrow(col1_in2, arrow::default_memory_pool())));
+  EXPECT_OK(rb2.AddColumn(types::ToArrow(col2_in2, arrow::default_memory_pool())));
+  EXPECT_OK(table.WriteRowBatch(rb2));
+
+  ColumnPredicate gt_five;
+  gt_five.col_idx = 0;
+  gt_five.op = ColumnPredicate::Op::kGreaterThan;
+  gt_five.type = types::DataType::INT64;
+  gt_five.int64_value = 5;
+
+  ColumnPredicate eq_b;
+  eq_b.col_idx = 1;
+  eq_b.op = ColumnPredicate::Op::kEqual;
+  eq_b.type = types::DataType::STRING;
+  eq_b.string_value = "b";
+
+  // Hot batches are never skipped.
+  auto slice = table.FirstBatch();
+  EXPECT_TRUE(table.BatchMayMatch(slice, {gt_five}));
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  EXPECT_EQ(2, table.GetTableStats().compacted_batches);
+
+  slice = table.FirstBatch();
+  EXPECT_FALSE(table.BatchMayMatch(slice, {gt_five}));
+  EXPECT_TRUE(table.BatchMayMatch(slice, {eq_b}));
+  EXPECT_FALSE(table.BatchMayMatch(slice, {eq_b, gt_five}));
+  EXPECT_TRUE(table.BatchMayMatch(slice, {}));
+
+  slice = table.NextBatch(slice);
+  EXPECT_TRUE(table.BatchMayMatch(slice, {gt_five}));
+  EXPECT_FALSE(table.BatchMayMatch(slice, {eq_b}));
+}
+
+TEST(TableTest, encoded_cold_batches) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_table_store_encode_cold_batches = true;
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "req_path"});
+  Table table("test_table", rel, 1024 * 1024, 4 * 1024);
+
+  std::vector<types::Time64NSValue> all_times;
+  std::vector<types::StringValue> all_paths;
+  int64_t bytes_written = 0;
+  for (int64_t batch = 0; batch < 10; ++batch) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> paths;
+    for (int64_t i = 0; i < 100; ++i) {
+      times.emplace_back(1000 * (batch * 100 + i));
+      paths.emplace_back(i % 4 == 0 ? "/api/v1/orders" : "/healthz");
+      bytes_written += sizeof(int64_t) + paths.back().size();
+    }
+    all_times.insert(all_times.end(), times.begin(), times.end());
+    all_paths.insert(all_paths.end(), paths.begin(), paths.end());
+
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), times.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(paths, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+  }
+
+  EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  auto stats = table.GetTableStats();
+  EXPECT_LT(0, stats.compacted_batches);
+  EXPECT_EQ(bytes_written, stats.logical_bytes);
+  EXPECT_LT(stats.cold_bytes * 3, stats.cold_logical_bytes);
+  EXPECT_LT(stats.bytes, stats.logical_bytes);
+
+  // The encoded batches read back the same as they were written.
+  std::vector<types::Time64NSValue> times_out;
+  std::vector<types::StringValue> paths_out;
+  for (auto slice = table.FirstBatch(); slice.IsValid(); slice = table.NextBatch(slice)) {
+    ASSERT_OK_AND_ASSIGN(auto rb,
+                         table.GetRowBatchSlice(slice, {0, 1}, arrow::default_memory_pool()));
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      times_out.push_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+      paths_out.push_back(
+          types::GetValueFromArrowArray<types::DataType::STRING>(rb->ColumnAt(1).get(), i));
+    }
+  }
+  EXPECT_EQ(all_times, times_out);
+  EXPECT_EQ(all_paths, paths_out);
+
+  // Time lookups work on the encoded time column.
+  ASSERT_OK_AND_ASSIGN(
+      auto slice, table.FindBatchSliceGreaterThanOrEqual(150500, arrow::default_memory_pool()));
+  ASSERT_OK_AND_ASSIGN(auto rb, table.GetRowBatchSlice(slice, {0}, arrow::default_memory_pool()));
+  EXPECT_EQ(151000,
+            types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), 0));
+}
+
+TEST(TableTest, encoded_cold_batches_past_ring_capacity) {
+  gflags::FlagSaver flag_saver;
+  FLAGS_table_store_encode_cold_batches = true;
+
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::STRING}, {"time_", "req_path"});
+  int64_t max_table_size = 64 * 1024;
+  int64_t min_cold_batch_size = 4 * 1024;
+  Table table("test_table", rel, max_table_size, min_cold_batch_size);
+
+  // Each batch compacts into its own cold batch, which encodes to much less than
+  // min_cold_batch_size bytes, even with its zone map. Write 2 times as many of them as there would
+  // be room for unencoded.
+  int64_t num_batches = 2 * max_table_size / min_cold_batch_size;
+  int64_t rows_per_batch = 300;
+  for (int64_t batch = 0; batch < num_batches; ++batch) {
+    std::vector<types::Time64NSValue> times;
+    std::vector<types::StringValue> paths;
+    for (int64_t i = 0; i < rows_per_batch; ++i) {
+      times.emplace_back(1000 * (batch * rows_per_batch + i));
+      paths.emplace_back(i % 4 == 0 ? "/api/v1/orders" : "/healthz");
+    }
+    auto rb = schema::RowBatch(schema::RowDescriptor(rel.col_types()), times.size());
+    EXPECT_OK(rb.AddColumn(types::ToArrow(times, arrow::default_memory_pool())));
+    EXPECT_OK(rb.AddColumn(types::ToArrow(paths, arrow::default_memory_pool())));
+    EXPECT_OK(table.WriteRowBatch(rb));
+    EXPECT_OK(table.CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  auto stats = table.GetTableStats();
+  EXPECT_EQ(num_batches, stats.compacted_batches);
+  EXPECT_EQ(num_batches, stats.num_batches);
+  EXPECT_EQ(0, stats.batches_expired);
+  EXPECT_LT(max_table_size, stats.logical_bytes);
+  EXPECT_GE(max_table_size, stats.bytes);
+
+  // All of the rows are still readable, in order.
+  int64_t num_rows = 0;
+  for (auto slice = table.FirstBatch(); slice.IsValid(); slice = table.NextBatch(slice)) {
+    ASSERT_OK_AND_ASSIGN(auto rb, table.GetRowBatchSlice(slice, {0}, arrow::default_memory_pool()));
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      EXPECT_EQ(1000 * num_rows,
+                types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+      ++num_rows;
+    }
+  }
+  EXPECT_EQ(num_batches * rows_per_batch, num_rows);
+}
+
 TEST(TableTest, find_batch_slice_greater_or_eq) {
   schema::Relation rel(std::vector<types::DataType>({types::DataType::TIME64NS}),
                        std::vector<std::string>({"time_"}));
@@ -891,6 +1090,140 @@ TEST(TableTest, threaded) {
   reader_thread.join();
 }
 
+// Same as above, but the table is full for most of the test, so writes expire batches while they
+// are being compacted and read.
+TEST(TableTest, threaded_full_table) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  int64_t max_table_size = 256 * 1024;
+  std::shared_ptr<Table> table_ptr =
+      std::make_shared<Table>("test_table", rel, max_table_size, 5 * 1024);
+
+  int64_t max_time_counter = 1024 * 1024;
+
+  auto done = std::make_shared<absl::Notification>();
+
+  std::thread compaction_thread([table_ptr, done]() {
+    while (!done->WaitForNotificationWithTimeout(absl::Milliseconds(1))) {
+      EXPECT_OK(table_ptr->CompactHotToCold(arrow::default_memory_pool()));
+      // The bytes of a hot batch are counted before compaction or expiry can take them away.
+      auto stats = table_ptr->GetTableStats();
+      EXPECT_LE(stats.cold_bytes, stats.bytes);
+    }
+  });
+
+  std::thread writer_thread([table_ptr, done, max_time_counter]() {
+    std::default_random_engine gen;
+    std::uniform_int_distribution<int64_t> dist(256, 1024);
+    int64_t time_counter = 0;
+    while (time_counter < max_time_counter) {
+      int64_t batch_size = std::min(dist(gen), max_time_counter - time_counter);
+      std::vector<types::Time64NSValue> time_col(batch_size);
+      for (int row_idx = 0; row_idx < batch_size; row_idx++) {
+        time_col[row_idx] = time_counter++;
+      }
+      auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(batch_size);
+      col_wrapper->Clear();
+      col_wrapper->AppendFromVector(time_col);
+      wrapper_batch->push_back(col_wrapper);
+      EXPECT_OK(table_ptr->TransferRecordBatch(std::move(wrapper_batch)));
+    }
+    done->Notify();
+  });
+
+  // The reader can fall behind the expiry of the table, so it only checks that the rows it reads
+  // are in order. When its slice has expired, or it has caught up with the writer, it looks up the
+  // rows after the last one it read.
+  std::thread reader_thread([table_ptr, done]() {
+    int64_t last_time = -1;
+    BatchSlice slice = BatchSlice::Invalid();
+    while (!done->HasBeenNotified()) {
+      if (!slice.IsValid()) {
+        slice = table_ptr->FindBatchSliceGreaterThanOrEqual(last_time + 1,
+                                                            arrow::default_memory_pool())
+                    .ConsumeValueOrDie();
+        continue;
+      }
+      auto batch_or_s = table_ptr->GetRowBatchSlice(slice, {0}, arrow::default_memory_pool());
+      if (!batch_or_s.ok()) {
+        slice = BatchSlice::Invalid();
+        continue;
+      }
+      auto time_col =
+          std::static_pointer_cast<arrow::Int64Array>(batch_or_s.ValueOrDie()->ColumnAt(0));
+      for (int i = 0; i < time_col->length(); ++i) {
+        EXPECT_LT(last_time, time_col->Value(i));
+        last_time = time_col->Value(i);
+      }
+      slice = table_ptr->NextBatch(slice);
+    }
+  });
+
+  writer_thread.join();
+  compaction_thread.join();
+  reader_thread.join();
+
+  auto stats = table_ptr->GetTableStats();
+  EXPECT_LT(0, stats.batches_expired);
+  EXPECT_GE(max_table_size, stats.bytes);
+
+  // The rows that remain are the last ones written, without gaps.
+  std::vector<int64_t> times;
+  for (auto slice = table_ptr->FirstBatch(); slice.IsValid(); slice = table_ptr->NextBatch(slice)) {
+    ASSERT_OK_AND_ASSIGN(auto batch,
+                         table_ptr->GetRowBatchSlice(slice, {0}, arrow::default_memory_pool()));
+    auto time_col = std::static_pointer_cast<arrow::Int64Array>(batch->ColumnAt(0));
+    for (int64_t i = 0; i < time_col->length(); ++i) {
+      times.push_back(time_col->Value(i));
+    }
+  }
+  ASSERT_FALSE(times.empty());
+  EXPECT_EQ(max_time_counter - 1, times.back());
+  for (size_t i = 1; i < times.size(); ++i) {
+    EXPECT_EQ(times[i - 1] + 1, times[i]);
+  }
+}
+
+TEST(TableTest, writes_without_readers) {
+  schema::Relation rel({types::DataType::TIME64NS}, {"time_"});
+  Table table("test_table", rel, 8 * 1024 * 1024, 5 * 1024);
+
+  // Write more batches than fit in the ring of pending hot batches without ever reading, so that
+  // the writer has to drain the ring itself.
+  int64_t num_batches = 3000;
+  int64_t batch_size = 4;
+  int64_t time_counter = 0;
+  for (int64_t batch_idx = 0; batch_idx < num_batches; ++batch_idx) {
+    std::vector<types::Time64NSValue> time_col(batch_size);
+    for (int64_t row_idx = 0; row_idx < batch_size; ++row_idx) {
+      time_col[row_idx] = time_counter++;
+    }
+    auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+    auto col_wrapper = std::make_shared<types::Time64NSValueColumnWrapper>(batch_size);
+    col_wrapper->Clear();
+    col_wrapper->AppendFromVector(time_col);
+    wrapper_batch->push_back(col_wrapper);
+    EXPECT_OK(table.TransferRecordBatch(std::move(wrapper_batch)));
+  }
+  EXPECT_EQ(num_batches * batch_size, table.End());
+  EXPECT_EQ(num_batches, table.GetTableStats().num_batches);
+
+  int64_t expected_time = 0;
+  for (auto slice = table.FirstBatch(); slice.IsValid(); slice = table.NextBatch(slice)) {
+    ASSERT_OK_AND_ASSIGN(auto batch,
+                         table.GetRowBatchSlice(slice, {0}, arrow::default_memory_pool()));
+    auto time_col = std::static_pointer_cast<arrow::Int64Array>(batch->ColumnAt(0));
+    for (int64_t i = 0; i < time_col->length(); ++i) {
+      EXPECT_EQ(expected_time, time_col->Value(i));
+      expected_time++;
+    }
+  }
+  EXPECT_EQ(num_batches * batch_size, expected_time);
+
+  ASSERT_OK_AND_ASSIGN(auto stop, table.FindStopPositionForTime(10, arrow::default_memory_pool()));
+  EXPECT_EQ(11, stop);
+}
+
 TEST(TableTest, NextBatch_generation_bug) {
   auto rd = schema::RowDescriptor({types::DataType::INT64, types::DataType::STRING});
   schema::Relation rel(rd.types(), {"col1", "col2"});
@@ -0,0 +1,202 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/table_store/table/zone_map.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+
+namespace {
+
+template <typename T>
+bool RangeMayMatch(ColumnPredicate::Op op, T min, T max, T value) {
+  switch (op) {
+    case ColumnPredicate::Op::kEqual:
+      return min <= value && value <= max;
+    case ColumnPredicate::Op::kLessThan:
+      return min < value;
+    case ColumnPredicate::Op::kLessThanEqual:
+      return min <= value;
+    case ColumnPredicate::Op::kGreaterThan:
+      return max > value;
+    case ColumnPredicate::Op::kGreaterThanEqual:
+      return max >= value;
+  }
+  return true;
+}
+
+// UINT128 values go into the bloom filter as their 16 bytes, high word first.
+std::string UInt128Key(absl::uint128 val) {
+  uint64_t words[2] = {absl::Uint128High64(val), absl::Uint128Low64(val)};
+  return std::string(reinterpret_cast<const char*>(words), sizeof(words));
+}
+
+template <types::DataType DT>
+void ComputeInt64MinMax(const arrow::Array* arr, int64_t* min, int64_t* max) {
+  *min = types::GetValueFromArrowArray<DT>(arr, 0);
+  *max = *min;
+  for (int64_t i = 1; i < arr->length(); ++i) {
+    int64_t val = types::GetValueFromArrowArray<DT>(arr, i);
+    *min = std::min(*min, val);
+    *max = std::max(*max, val);
+  }
+}
+
+// NaNs compare false against everything, so they would poison std::min/std::max. They are skipped
+// instead: no predicate on a value can match a NaN row, so the bounds don't need to cover them.
+// Returns false if every value is NaN.
+bool ComputeFloat64MinMax(const arrow::Array* arr, double* min, double* max) {
+  auto* float_arr = static_cast<const arrow::DoubleArray*>(arr);
+  bool found = false;
+  for (int64_t i = 0; i < arr->length(); ++i) {
+    double val = float_arr->Value(i);
+    if (std::isnan(val)) {
+      continue;
+    }
+    *min = found ? std::min(*min, val) : val;
+    *max = found ? std::max(*max, val) : val;
+    found = true;
+  }
+  return found;
+}
+
+}  // namespace
+
+StatusOr<std::unique_ptr<ZoneMap>> ZoneMap::Create(
+    const std::vector<types::DataType>& types,
+    const std::vector<std::shared_ptr<arrow::Array>>& columns) {
+  DCHECK_EQ(types.size(), columns.size());
+  std::unique_ptr<ZoneMap> zone_map(new ZoneMap());
+  zone_map->columns_.resize(types.size());
+  for (size_t col_idx = 0; col_idx < types.size(); ++col_idx) {
+    auto& col_zone_map = zone_map->columns_[col_idx];
+    const arrow::Array* arr = columns[col_idx].get();
+    col_zone_map.type = types[col_idx];
+    if (arr->length() == 0) {
+      // Leave the column unindexed, it's not worth special casing empty batches.
+      col_zone_map.type = types::DataType::DATA_TYPE_UNKNOWN;
+      continue;
+    }
+    switch (types[col_idx]) {
+      case types::DataType::BOOLEAN:
+        ComputeInt64MinMax<types::DataType::BOOLEAN>(arr, &col_zone_map.int64_min,
+                                                     &col_zone_map.int64_max);
+        break;
+      case types::DataType::INT64:
+        ComputeInt64MinMax<types::DataType::INT64>(arr, &col_zone_map.int64_min,
+                                                   &col_zone_map.int64_max);
+        break;
+      case types::DataType::TIME64NS:
+        ComputeInt64MinMax<types::DataType::TIME64NS>(arr, &col_zone_map.int64_min,
+                                                      &col_zone_map.int64_max);
+        break;
+      case types::DataType::FLOAT64:
+        if (!ComputeFloat64MinMax(arr, &col_zone_map.float64_min, &col_zone_map.float64_max)) {
+          col_zone_map.type = types::DataType::DATA_TYPE_UNKNOWN;
+        }
+        break;
+      case types::DataType::STRING: {
+        PL_ASSIGN_OR_RETURN(col_zone_map.bloom_filter,
+                            bloomfilter::XXHash64BloomFilter::Create(
+                                std::min(arr->length(), kMaxBloomFilterEntries),
+                                kBloomFilterErrorRate));
+        auto* str_arr = static_cast<const arrow::StringArray*>(arr);
+        for (int64_t i = 0; i < arr->length(); ++i) {
+          int32_t len = 0;
+          const uint8_t* data = str_arr->GetValue(i, &len);
+          col_zone_map.bloom_filter->Insert(
+              std::string_view(reinterpret_cast<const char*>(data), len));
+        }
+        break;
+      }
+      case types::DataType::UINT128: {
+        PL_ASSIGN_OR_RETURN(col_zone_map.bloom_filter,
+                            bloomfilter::XXHash64BloomFilter::Create(
+                                std::min(arr->length(), kMaxBloomFilterEntries),
+                                kBloomFilterErrorRate));
+        for (int64_t i = 0; i < arr->length(); ++i) {
+          types::UInt128Value val =
+              types::GetValueFromArrowArray<types::DataType::UINT128>(arr, i);
+          col_zone_map.bloom_filter->Insert(UInt128Key(val.val));
+        }
+        break;
+      }
+      default:
+        col_zone_map.type = types::DataType::DATA_TYPE_UNKNOWN;
+        break;
+    }
+  }
+  return zone_map;
+}
+
+bool ZoneMap::MayMatch(const std::vector<ColumnPredicate>& predicates) const {
+  for (const auto& predicate : predicates) {
+    if (!ColumnMayMatch(predicate)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ZoneMap::ColumnMayMatch(const ColumnPredicate& predicate) const {
+  if (predicate.col_idx < 0 || predicate.col_idx >= static_cast<int64_t>(columns_.size())) {
+    return true;
+  }
+  const auto& col_zone_map = columns_[predicate.col_idx];
+  if (col_zone_map.type != predicate.type) {
+    return true;
+  }
+  switch (col_zone_map.type) {
+    case types::DataType::BOOLEAN:
+    case types::DataType::INT64:
+    case types::DataType::TIME64NS:
+      return RangeMayMatch(predicate.op, col_zone_map.int64_min, col_zone_map.int64_max,
+                           predicate.int64_value);
+    case types::DataType::FLOAT64:
+      return RangeMayMatch(predicate.op, col_zone_map.float64_min, col_zone_map.float64_max,
+                           predicate.float64_value);
+    case types::DataType::STRING:
+      return predicate.op != ColumnPredicate::Op::kEqual ||
+             col_zone_map.bloom_filter->Contains(predicate.string_value);
+    case types::DataType::UINT128:
+      return predicate.op != ColumnPredicate::Op::kEqual ||
+             col_zone_map.bloom_filter->Contains(UInt128Key(predicate.uint128_value));
+    default:
+      return true;
+  }
+}
+
+int64_t ZoneMap::NumBytes() const {
+  int64_t bytes = sizeof(ZoneMap) + columns_.capacity() * sizeof(ColumnZoneMap);
+  for (const auto& col_zone_map : columns_) {
+    if (col_zone_map.bloom_filter != nullptr) {
+      bytes += col_zone_map.bloom_filter->buffer_size_bytes();
+    }
+  }
+  return bytes;
+}
+
+}  // namespace table_store
+}  // namespace px
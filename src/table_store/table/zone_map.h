@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <absl/numeric/int128.h>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace table_store {
+
+/**
+ * A predicate of the form `column <op> value` on a single column of a table. Predicates are only
+ * used to skip batches that can't hold any matching rows, they are never evaluated on rows.
+ */
+struct ColumnPredicate {
+  enum class Op {
+    kEqual,
+    kLessThan,
+    kLessThanEqual,
+    kGreaterThan,
+    kGreaterThanEqual,
+  };
+
+  // The index of the column in the table.
+  int64_t col_idx = 0;
+  Op op = Op::kEqual;
+  // The value is stored in the field that matches the type of the column: int64_value holds
+  // BOOLEAN, INT64 and TIME64NS values.
+  types::DataType type = types::DataType::DATA_TYPE_UNKNOWN;
+  int64_t int64_value = 0;
+  double float64_value = 0;
+  absl::uint128 uint128_value = 0;
+  std::string string_value;
+};
+
+/**
+ * ZoneMap summarizes the values of each column of a batch, so that batches can be skipped without
+ * reading their arrays:
+ *  - BOOLEAN, INT64, FLOAT64 and TIME64NS columns keep their min and max value.
+ *  - STRING and UINT128 columns keep a small bloom filter of their values, which can only rule out
+ *    equality predicates.
+ */
+class ZoneMap {
+ public:
+  // The bloom filters are sized for at most this many values. Batches with more distinct values
+  // just get a higher false positive rate.
+  static constexpr int64_t kMaxBloomFilterEntries = 1024;
+  static constexpr double kBloomFilterErrorRate = 0.01;
+
+  /**
+   * Builds the zone map of a batch.
+   * @param types The types of the columns.
+   * @param columns The columns of the batch, all of the same length.
+   */
+  static StatusOr<std::unique_ptr<ZoneMap>> Create(
+      const std::vector<types::DataType>& types,
+      const std::vector<std::shared_ptr<arrow::Array>>& columns);
+
+  /**
+   * @return false if no row of the batch can satisfy all of the predicates, true otherwise.
+   */
+  bool MayMatch(const std::vector<ColumnPredicate>& predicates) const;
+
+  /**
+   * @return An estimate of the memory held by the zone map, in bytes.
+   */
+  int64_t NumBytes() const;
+
+ private:
+  struct ColumnZoneMap {
+    types::DataType type = types::DataType::DATA_TYPE_UNKNOWN;
+    int64_t int64_min = 0;
+    int64_t int64_max = 0;
+    double float64_min = 0;
+    double float64_max = 0;
+    std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter;
+  };
+
+  ZoneMap() = default;
+
+  bool ColumnMayMatch(const ColumnPredicate& predicate) const;
+
+  std::vector<ColumnZoneMap> columns_;
+};
+
+}  // namespace table_store
+}  // namespace px
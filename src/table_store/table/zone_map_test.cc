@@ -0,0 +1,130 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/zone_map.h"
+
+namespace px {
+namespace table_store {
+
+ColumnPredicate Int64Predicate(int64_t col_idx, ColumnPredicate::Op op, int64_t value) {
+  ColumnPredicate predicate;
+  predicate.col_idx = col_idx;
+  predicate.op = op;
+  predicate.type = types::DataType::INT64;
+  predicate.int64_value = value;
+  return predicate;
+}
+
+TEST(ZoneMapTest, min_max) {
+  std::vector<types::Int64Value> ints = {5, -3, 12, 7};
+  std::vector<types::Float64Value> floats = {0.5, 1.5, -2.5, 0};
+  ASSERT_OK_AND_ASSIGN(
+      auto zone_map,
+      ZoneMap::Create({types::DataType::INT64, types::DataType::FLOAT64},
+                      {types::ToArrow(ints, arrow::default_memory_pool()),
+                       types::ToArrow(floats, arrow::default_memory_pool())}));
+
+  using Op = ColumnPredicate::Op;
+  EXPECT_TRUE(zone_map->MayMatch({Int64Predicate(0, Op::kEqual, 7)}));
+  // Values between min and max may match, even if they aren't in the batch.
+  EXPECT_TRUE(zone_map->MayMatch({Int64Predicate(0, Op::kEqual, 6)}));
+  EXPECT_FALSE(zone_map->MayMatch({Int64Predicate(0, Op::kEqual, 13)}));
+  EXPECT_FALSE(zone_map->MayMatch({Int64Predicate(0, Op::kLessThan, -3)}));
+  EXPECT_TRUE(zone_map->MayMatch({Int64Predicate(0, Op::kLessThanEqual, -3)}));
+  EXPECT_FALSE(zone_map->MayMatch({Int64Predicate(0, Op::kGreaterThan, 12)}));
+  EXPECT_TRUE(zone_map->MayMatch({Int64Predicate(0, Op::kGreaterThanEqual, 12)}));
+
+  ColumnPredicate float_predicate;
+  float_predicate.col_idx = 1;
+  float_predicate.op = Op::kGreaterThan;
+  float_predicate.type = types::DataType::FLOAT64;
+  float_predicate.float64_value = 1.5;
+  EXPECT_FALSE(zone_map->MayMatch({float_predicate}));
+  float_predicate.float64_value = 1.0;
+  EXPECT_TRUE(zone_map->MayMatch({float_predicate}));
+
+  // Predicates that don't match the column type can't be used to skip the batch.
+  EXPECT_TRUE(zone_map->MayMatch({Int64Predicate(1, Op::kGreaterThan, 100)}));
+}
+
+TEST(ZoneMapTest, nan_floats) {
+  double nan = std::numeric_limits<double>::quiet_NaN();
+  std::vector<types::Float64Value> floats = {nan, 3.0, -1.0};
+  std::vector<types::Float64Value> nans = {nan, nan};
+  ASSERT_OK_AND_ASSIGN(
+      auto zone_map,
+      ZoneMap::Create({types::DataType::FLOAT64, types::DataType::FLOAT64},
+                      {types::ToArrow(floats, arrow::default_memory_pool()),
+                       types::ToArrow(nans, arrow::default_memory_pool())}));
+
+  // The NaN row is skipped, so the bounds still cover the other rows.
+  ColumnPredicate float_predicate;
+  float_predicate.col_idx = 0;
+  float_predicate.op = ColumnPredicate::Op::kGreaterThan;
+  float_predicate.type = types::DataType::FLOAT64;
+  float_predicate.float64_value = 2.0;
+  EXPECT_TRUE(zone_map->MayMatch({float_predicate}));
+  float_predicate.op = ColumnPredicate::Op::kLessThan;
+  float_predicate.float64_value = 0.0;
+  EXPECT_TRUE(zone_map->MayMatch({float_predicate}));
+  float_predicate.float64_value = -1.0;
+  EXPECT_FALSE(zone_map->MayMatch({float_predicate}));
+
+  // A column of only NaNs is left unindexed.
+  float_predicate.col_idx = 1;
+  EXPECT_TRUE(zone_map->MayMatch({float_predicate}));
+}
+
+TEST(ZoneMapTest, bloom_filters) {
+  std::vector<types::StringValue> strs = {"foo", "bar"};
+  std::vector<types::UInt128Value> upids = {types::UInt128Value(1, 2), types::UInt128Value(3, 4)};
+  ASSERT_OK_AND_ASSIGN(
+      auto zone_map, ZoneMap::Create({types::DataType::STRING, types::DataType::UINT128},
+                                     {types::ToArrow(strs, arrow::default_memory_pool()),
+                                      types::ToArrow(upids, arrow::default_memory_pool())}));
+
+  ColumnPredicate str_predicate;
+  str_predicate.col_idx = 0;
+  str_predicate.type = types::DataType::STRING;
+  str_predicate.string_value = "bar";
+  EXPECT_TRUE(zone_map->MayMatch({str_predicate}));
+  str_predicate.string_value = "baz";
+  EXPECT_FALSE(zone_map->MayMatch({str_predicate}));
+  // Bloom filters can only rule out equality.
+  str_predicate.op = ColumnPredicate::Op::kLessThan;
+  EXPECT_TRUE(zone_map->MayMatch({str_predicate}));
+
+  ColumnPredicate upid_predicate;
+  upid_predicate.col_idx = 1;
+  upid_predicate.type = types::DataType::UINT128;
+  upid_predicate.uint128_value = absl::MakeUint128(3, 4);
+  EXPECT_TRUE(zone_map->MayMatch({upid_predicate}));
+  upid_predicate.uint128_value = absl::MakeUint128(4, 3);
+  EXPECT_FALSE(zone_map->MayMatch({upid_predicate}));
+}
+
+}  // namespace table_store
+}  // namespace px
@@ -639,6 +639,8 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
                 "The size of this table in bytes"),
         ColInfo("cold_size", types::DataType::INT64, types::PatternType::GENERAL,
                 "The number of bytes in cold storage"),
+        ColInfo("cold_logical_size", types::DataType::INT64, types::PatternType::GENERAL,
+                "The number of bytes that the data in cold storage would take up unencoded"),
         ColInfo("max_table_size", types::DataType::INT64, types::PatternType::GENERAL,
                 "The maximum size of this table"));
   }
@@ -665,6 +667,7 @@ class GetDebugTableInfo final : public carnot::udf::UDTF<GetDebugTableInfo> {
     rw->Append<IndexOf("compacted_batches")>(info.compacted_batches);
     rw->Append<IndexOf("size")>(info.bytes);
     rw->Append<IndexOf("cold_size")>(info.cold_bytes);
+    rw->Append<IndexOf("cold_logical_size")>(info.cold_logical_bytes);
     rw->Append<IndexOf("max_table_size")>(info.max_table_size);
 
     ++current_idx_;
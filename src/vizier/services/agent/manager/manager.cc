@@ -185,6 +185,9 @@ Status Manager::Stop(std::chrono::milliseconds timeout) {
   stop_called_ = true;
 
   dispatcher_->Stop();
+  if (table_compaction_scheduler_ != nullptr) {
+    table_compaction_scheduler_->Stop();
+  }
   auto s = StopImpl(timeout);
 
   // Wait for a limited amount of time for main thread to stop processing.
@@ -310,17 +313,15 @@ Status Manager::PostRegisterHook(uint32_t asid) {
         std::bind(&Manager::NATSMessageHandler, this, std::placeholders::_1));
   }
 
-  tablestore_compaction_timer_ = dispatcher()->CreateTimer([this]() {
-    // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
-    // will need to figure out how to use the correct memory pool here, but for now we can just use
-    // the default pool.
-    auto status = table_store()->RunCompaction(arrow::default_memory_pool());
-    LOG_IF(ERROR, !status.ok()) << status.msg();
-    if (tablestore_compaction_timer_) {
-      tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
-    }
-  });
-  tablestore_compaction_timer_->EnableTimer(kTableStoreCompactionPeriod);
+  // TODO(james): when we change ExecState::exec_mem_pool to not return just the default pool, we
+  // will need to figure out how to use the correct memory pool here, but for now we can just use
+  // the default pool.
+  table_compaction_scheduler_ = std::make_unique<table_store::TableCompactionScheduler>(
+      table_store(), arrow::default_memory_pool(),
+      std::chrono::milliseconds(FLAGS_table_store_compaction_period_ms),
+      FLAGS_table_store_compaction_max_batches_per_cycle,
+      FLAGS_table_store_expiration_low_watermark_percent);
+  table_compaction_scheduler_->Start();
 
   return Status::OK();
 }
@@ -31,6 +31,7 @@
 #include "src/common/event/nats.h"
 #include "src/common/uuid/uuid.h"
 #include "src/shared/metadata/metadata.h"
+#include "src/table_store/table/table_compaction_scheduler.h"
 #include "src/vizier/funcs/context/vizier_context.h"
 #include "src/vizier/messages/messagespb/messages.pb.h"
 #include "src/vizier/services/agent/manager/chan_cache.h"
@@ -59,8 +60,6 @@ constexpr auto kChanCacheCleanupChansionPeriod = std::chrono::minutes(5);
  */
 constexpr auto kChanIdleGracePeriod = std::chrono::minutes(1);
 
-constexpr auto kTableStoreCompactionPeriod = std::chrono::minutes(1);
-
 /**
  * Info tracks basic information about and agent such as:
  * id, asid, hostname.
@@ -227,8 +226,8 @@ class Manager : public px::NotCopyable {
   // Factory context for vizier functions.
   funcs::VizierFuncFactoryContext func_context_;
 
-  // Timer to manage table store compaction.
-  px::event::TimerUPtr tablestore_compaction_timer_;
+  // Compacts and expires the tables of table_store_ in the background.
+  std::unique_ptr<table_store::TableCompactionScheduler> table_compaction_scheduler_;
 };
 
 /**